@@ -88,6 +88,7 @@ const uint16_t		MsgMessage = 0x6d67;			// 'mg'
 const uint16_t	  MsgNearFlag = 0x4e66;		   // 'Nf'
 const uint16_t		MsgNewRabbit = 0x6e52;			// 'nR'
 const uint16_t		MsgNegotiateFlags = 0x6e66;		// 'nf'
+const uint16_t		MsgNewPlayer = 0x6e70;			// 'np'
 const uint16_t		MsgPause = 0x7061;			// 'pa'
 const uint16_t		MsgPlayerInfo = 0x7062;			// 'pb'
 const uint16_t		MsgPlayerUpdate = 0x7075;		// 'pu'
@@ -96,6 +97,7 @@ const uint16_t		MsgQueryGame = 0x7167;			// 'qg'
 const uint16_t		MsgQueryPlayers = 0x7170;		// 'qp'
 const uint16_t		MsgReject = 0x726a;			// 'rj'
 const uint16_t		MsgRemovePlayer = 0x7270;		// 'rp'
+const uint16_t		MsgRobotMessage = 0x726d;		// 'rm'
 const uint16_t		MsgReplayReset = 0x7272;		// 'rr'
 const uint16_t		MsgShotBegin = 0x7362;			// 'sb'
 const uint16_t		MsgScore = 0x7363;			// 'sc'
@@ -189,6 +191,9 @@ const uint16_t		MsgServerControl = 0x6f69;		// 'oi'
 // lag ping sent by server to client and reply from client
 const uint16_t		MsgLagPing = 0x7069;			// 'pi'
 
+// what the server can do, sent after the player id in MsgAccept
+const uint8_t		AcceptNewPlayer = 0x01;			// takes MsgNewPlayer
+
 /* server communication protocol:
   --> incoming messages (to server)
   <-- outgoing messages to single player
@@ -198,7 +203,7 @@ player to server messages:
   MsgEnter		player is joining game
 			--> id, type, team, name, motto
 			<-- MsgReject (if rejected)
-			<-- MsgAccept (if accepted)
+			<-- MsgAccept (if accepted): id, Accept* flags
 			if accepted, new player is sent (following MsgAccept):
 			<-- MsgTeamUpdate (one per team)
 			<-- MsgFlagUpdate (one per existing flag)
@@ -249,6 +254,17 @@ player to server messages:
   MsgWantWHash		(player wants md5 of world file
 			-->
   MsgNegotiateFlags     -->flagCount/[flagabbv]
+  MsgNewPlayer		player adds a robot that plays over its connection,
+			if its MsgAccept had AcceptNewPlayer
+			--> robot (the player's own number for it), then
+			    what MsgEnter sends
+			<-- robot, id (0xff if refused)
+			then as for MsgEnter, but nothing is sent to the
+			robot: its player gets it all, see MsgRobotMessage.
+			messages about the robot go over the player's
+			connection, and those that carry no player id get
+			the robot's id appended (MsgExit, MsgAlive,
+			MsgKilled, MsgShotEnd, MsgTeleport)
   MsgPause		-->true or false
 
 server to player messages:
@@ -266,6 +282,10 @@ server to player messages:
 			<== id, type, team, name, motto
   MsgRemovePlayer	player has exited the server
 			<== id
+  MsgRobotMessage	message for a robot added with MsgNewPlayer, to the
+			player who added it: only MsgReject, and MsgMessage
+			sent to the robot alone
+			<-- id (robot), code, message
   MsgAdminInfo		update of players' IP addresses
 			only sent to players with the PLAYERLIST permission.
 			<-- count, [chunklen, id, bitfield, address]*
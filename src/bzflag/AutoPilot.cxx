@@ -19,6 +19,7 @@
 
 /* local headers */
 #include "Roster.h"
+#include "ShotGrid.h"
 #include "TargetingUtils.h"
 #include "World.h"
 #include "WorldPlayer.h"
@@ -76,71 +77,36 @@ static bool isFlagUseful(FlagType *type)
   return ((float)flagValue) >= avg;
 }
 
-static ShotPath *findWorstBullet(float &minDistance)
+static ShotPath *findWorstBullet(float &minDistance, float range)
 {
   LocalPlayer *myTank = LocalPlayer::getMyTank();
   const float *pos = myTank->getPosition();
   ShotPath *minPath = NULL;
+  WorldPlayer *wp = World::getWorld()->getWorldWeapons();
 
   minDistance = Infinity;
-  for (int t = 0; t < curMaxPlayers; t++) {
-    if (t == myTank->getId() || !remotePlayers[t])
-      continue;
-
-    const int maxShots = remotePlayers[t]->getMaxShots();
-    for (int s = 0; s < maxShots; s++) {
-      ShotPath* shot = remotePlayers[t]->getShot(s);
-      if (!shot || shot->isExpired())
-	continue;
-
-      if ((shot->getFlag() == Flags::InvisibleBullet) &&
-	  (myTank->getFlag() != Flags::Seer))
-	continue; //Theoretically Roger could triangulate the sound
-      if (remotePlayers[t]->isPhantomZoned() && !myTank->isPhantomZoned())
-	continue;
-      if ((shot->getFlag() == Flags::Laser) &&
-	  (myTank->getFlag() == Flags::Cloaking))
-	continue; //cloaked tanks can't die from lasers
-
-      const float* shotPos = shot->getPosition();
-      if ((fabs(shotPos[2] - pos[2]) > BZDBCache::tankHeight) &&
-	  (shot->getFlag() != Flags::GuidedMissile))
-	continue;
-
-      const float dist = TargetingUtils::getTargetDistance(pos, shotPos);
-      if (dist < minDistance) {
-	const float *shotVel = shot->getVelocity();
-	float shotAngle = atan2f(shotVel[1], shotVel[0]);
-	float shotUnitVec[2] = {cosf(shotAngle), sinf(shotAngle)};
-
-	float trueVec[2] = { (pos[0] - shotPos[0]) / dist, (pos[1] - shotPos[1]) / dist };
-	float dotProd = trueVec[0] * shotUnitVec[0] + trueVec[1] * shotUnitVec[1];
-
-	if (dotProd <= 0.1f) //pretty wide angle, evasive actions prolly aren't gonna work
-	  continue;
-
-	minDistance = dist;
-	minPath = shot;
-      }
-    }
-  }
-  float oldDistance = minDistance;
-  WorldPlayer *wp = World::getWorld()->getWorldWeapons();
-  for (int w = 0; w < wp->getMaxShots(); w++) {
-    ShotPath* shot = wp->getShot(w);
-    if (!shot || shot->isExpired())
+  std::vector<ShotGrid::Shot> shots;
+  SHOTGRID.findShotsNear(pos, range, shots);
+  for (unsigned int i = 0; i < shots.size(); i++) {
+    if (shots[i].owner == myTank)
       continue;
 
-    if (shot->getFlag() == Flags::InvisibleBullet && myTank->getFlag() != Flags::Seer)
+    ShotPath* shot = shots[i].path;
+    if ((shot->getFlag() == Flags::InvisibleBullet) &&
+	(myTank->getFlag() != Flags::Seer))
       continue; //Theoretically Roger could triangulate the sound
-    if (shot->getFlag() == Flags::Laser && myTank->getFlag() == Flags::Cloaking)
+    if ((shots[i].owner != wp) && shots[i].owner->isPhantomZoned() && !myTank->isPhantomZoned())
+      continue;
+    if ((shot->getFlag() == Flags::Laser) &&
+	(myTank->getFlag() == Flags::Cloaking))
       continue; //cloaked tanks can't die from lasers
 
     const float* shotPos = shot->getPosition();
-    if ((fabs(shotPos[2] - pos[2]) > BZDBCache::tankHeight) && (shot->getFlag() != Flags::GuidedMissile))
+    if ((fabs(shotPos[2] - pos[2]) > BZDBCache::tankHeight) &&
+	(shot->getFlag() != Flags::GuidedMissile))
       continue;
 
-    const float dist = TargetingUtils::getTargetDistance( pos, shotPos );
+    const float dist = TargetingUtils::getTargetDistance(pos, shotPos);
     if (dist < minDistance) {
       const float *shotVel = shot->getVelocity();
       float shotAngle = atan2f(shotVel[1], shotVel[0]);
@@ -156,8 +122,6 @@ static ShotPath *findWorstBullet(float &minDistance)
       minPath = shot;
     }
   }
-  if (oldDistance < minDistance)
-    minDistance = oldDistance; //pick the closer bullet
   return minPath;
 }
 
@@ -202,7 +166,7 @@ static bool avoidBullet(float &rotation, float &speed)
     return false; // take our chances
 
   float minDistance;
-  ShotPath *shot = findWorstBullet(minDistance);
+  ShotPath *shot = findWorstBullet(minDistance, 100.0f);
 
   if ((shot == NULL) || (minDistance > 100.0f))
     return false;
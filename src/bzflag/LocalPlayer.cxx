@@ -707,7 +707,7 @@ void			LocalPlayer::doUpdateMotion(float dt)
       } else {
 	// save teleport info
 	setTeleport(lastTime, source, targetTele);
-	server->sendTeleport(source, targetTele);
+	server->sendTeleport(getId(), source, targetTele);
 	if (gettingSound) {
 	  playLocalSound(SFX_TELEPORT);
 	}
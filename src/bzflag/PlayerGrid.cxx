@@ -0,0 +1,145 @@
+/* bzflag
+ * Copyright (c) 1993-2011 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+// interface header
+#include "PlayerGrid.h"
+
+/* system implementation headers */
+#include <algorithm>
+#include <math.h>
+
+/* common implementation headers */
+#include "BZDBCache.h"
+
+/* local implementation headers */
+#include "LocalPlayer.h"
+#include "World.h"
+
+// initialize the singleton
+template <>
+PlayerGrid* Singleton<PlayerGrid>::_instance = (PlayerGrid*)0;
+
+// a side of the grid has at most this many cells
+static const int maxGridSize = 128;
+
+
+PlayerGrid::PlayerGrid() : size(0), cellSize(1.0f), origin(0.0f),
+			   maxRadius(0.0f), built(false)
+{
+}
+
+PlayerGrid::~PlayerGrid()
+{
+}
+
+void			PlayerGrid::clear()
+{
+  entries.clear();
+  binStart.clear();
+  size = 0;
+  maxRadius = 0.0f;
+  built = false;
+}
+
+void			PlayerGrid::build()
+{
+  clear();
+  World* world = World::getWorld();
+  if (!world)
+    return;
+
+  // a few tank lengths a cell: the robots look a few tank radii around
+  cellSize = std::max(4.0f * BZDBCache::tankLength, 1.0f);
+  size = std::min(std::max((int)ceilf(BZDBCache::worldSize / cellSize), 1), maxGridSize);
+  cellSize = std::max(BZDBCache::worldSize / (float)size, cellSize);
+  origin = -0.5f * (float)size * cellSize;
+
+  addPlayer(LocalPlayer::getMyTank());
+  for (int i = 0; i < world->getCurMaxPlayers(); i++)
+    addPlayer(world->getPlayer(i));
+
+  // sort the players by team, then by cell
+  const int binCount = NumTeams * size * size;
+  binStart.assign(binCount + 1, 0);
+  for (unsigned int i = 0; i < entries.size(); i++)
+    binStart[entries[i].bin + 1]++;
+  for (int b = 0; b < binCount; b++)
+    binStart[b + 1] += binStart[b];
+  std::vector<Entry> added;
+  added.swap(entries);
+  entries.resize(added.size());
+  std::vector<int> next(binStart.begin(), binStart.end() - 1);
+  for (unsigned int i = 0; i < added.size(); i++)
+    entries[next[added[i].bin]++] = added[i];
+  built = true;
+}
+
+void			PlayerGrid::addPlayer(Player* player)
+{
+  if (!player)
+    return;
+  const int team = (int)player->getTeam();
+  if (team < 0 || team >= NumTeams)
+    return;
+
+  const float* pos = player->getPosition();
+  Entry entry;
+  entry.player = player;
+  entry.pos[0] = pos[0];
+  entry.pos[1] = pos[1];
+  entry.bin = team * size * size + getCellCoord(pos[0]) + size * getCellCoord(pos[1]);
+  entries.push_back(entry);
+  maxRadius = std::max(maxRadius, player->getRadius());
+}
+
+int			PlayerGrid::getCellCoord(float coord) const
+{
+  // players outside the world go in the border cells
+  const int cell = (int)floorf((coord - origin) / cellSize);
+  return std::min(std::max(cell, 0), size - 1);
+}
+
+void			PlayerGrid::findPlayersNear(const float* pos, float radius,
+						    TeamColor team,
+						    std::vector<Player*>& players) const
+{
+  players.clear();
+  if (!built)
+    return;
+
+  const int xMin = getCellCoord(pos[0] - radius), xMax = getCellCoord(pos[0] + radius);
+  const int yMin = getCellCoord(pos[1] - radius), yMax = getCellCoord(pos[1] + radius);
+  const int firstTeam = (team == NoTeam) ? 0 : (int)team;
+  const int lastTeam = (team == NoTeam) ? NumTeams - 1 : (int)team;
+  const float radius2 = radius * radius;
+  for (int t = firstTeam; t <= lastTeam; t++) {
+    for (int y = yMin; y <= yMax; y++) {
+      // the cells of a row are next to each other
+      const int rowBin = t * size * size + size * y;
+      for (int i = binStart[rowBin + xMin]; i < binStart[rowBin + xMax + 1]; i++) {
+	const float dx = entries[i].pos[0] - pos[0];
+	const float dy = entries[i].pos[1] - pos[1];
+	if (dx * dx + dy * dy <= radius2)
+	  players.push_back(entries[i].player);
+      }
+    }
+  }
+}
+
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
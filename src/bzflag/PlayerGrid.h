@@ -0,0 +1,105 @@
+/* bzflag
+ * Copyright (c) 1993-2011 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* PlayerGrid:
+ *	A uniform grid of the positions of the local player and the remote
+ *	players, one per team, so that the robots find the players around
+ *	them (teammates to keep apart from, targets, steamrollers) without
+ *	going over every player.
+ *
+ *	The grid holds Player pointers: it is built when the robots are
+ *	updated, and must be cleared before players can be removed (i.e.
+ *	before the next server messages are handled).
+ */
+
+#ifndef	BZF_PLAYER_GRID_H
+#define	BZF_PLAYER_GRID_H
+
+#include "common.h"
+
+/* system interface headers */
+#include <vector>
+
+/* common interface headers */
+#include "global.h"
+#include "Singleton.h"
+
+/* local interface headers */
+#include "Player.h"
+
+#define PLAYERGRID (PlayerGrid::instance())
+
+
+class PlayerGrid : public Singleton<PlayerGrid> {
+public:
+  /** index the players of the current world where they are now
+   */
+  void		build();
+
+  /** forget every player
+   */
+  void		clear();
+
+  bool		isBuilt() const { return built; }
+
+  /** find the players within a distance of a position, in x and y
+   * @param pos The position.
+   * @param radius The distance.
+   * @param team Only the players of this team, or of every team if NoTeam.
+   * @param players Gets the players, cleared first.
+   */
+  void		findPlayersNear(const float* pos, float radius, TeamColor team,
+				std::vector<Player*>& players) const;
+
+  /** the largest radius of the players indexed
+   */
+  float		getMaxRadius() const { return maxRadius; }
+
+  /** the distance from which every player is found, whatever the position
+   */
+  float		getWorldSpan() const { return 2.0f * (float)size * cellSize; }
+
+protected:
+  friend class Singleton<PlayerGrid>;
+
+private:
+  PlayerGrid();
+  ~PlayerGrid();
+
+  struct Entry {
+    Player*	player;
+    int		bin;		// team * cells + cell
+    float	pos[2];
+  };
+
+  void		addPlayer(Player* player);
+  int		getCellCoord(float coord) const;
+
+  std::vector<Entry>	entries;	// sorted by bin
+  std::vector<int>	binStart;	// the entries of bin b are [binStart[b], binStart[b+1])
+  int			size;		// cells per side
+  float			cellSize;
+  float			origin;		// x and y of the corner of cell 0
+  float			maxRadius;
+  bool			built;
+};
+
+
+#endif // BZF_PLAYER_GRID_H
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
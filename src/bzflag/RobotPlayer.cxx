@@ -20,12 +20,12 @@
 #include "World.h"
 #include "Intersect.h"
 #include "TargetingUtils.h"
+#include "PlayerGrid.h"
+#include "ShotGrid.h"
+#include "WorldPlayer.h"
 
 // ========== MY CODE (begin) ==========
 
-// for ServerLink and Control Panel
-#include "playing.h"
-
 // for decision tree
 #include "decisiontree/dectree.h"
 
@@ -37,9 +37,8 @@
 #define ALIGNMENT_WEIGHT 1
 #define PATH_WEIGHT 7
 
-// hash function: 2x + 3y
-#define MAX_HASH_VAL (int)(5 * 0.5f * BZDBCache::worldSize)
-// using a const float for MAX_HASH_VAL didn't work
+// how long a tank counts as under fire after a shot came near it, for planning urgency
+#define UNDER_FIRE_TIME 2.0f
 
 //std::vector<MyNode> RobotPlayer::teamPaths[CtfTeams];  // initialized to default MyNode constructor values
 //MyNode RobotPlayer::teamGoal[CtfTeams];                // initialized to default MyNode constructor values
@@ -56,6 +55,10 @@ std::vector<MyNode> RobotPlayer::capturePath[CtfTeams];  // initialized to defau
 //MyNode RobotPlayer::killGoal[CtfTeams];               // initialized to default MyNode constructor values
 //std::vector<MyNode> RobotPlayer::killPath[CtfTeams];  // initialized to default MyNode constructor values
 
+PathPlannerKind RobotPlayer::pathPlanner = ThetaPlanner;
+PathPlanners RobotPlayer::planners;
+HierarchicalPlanner RobotPlayer::hierarchicalPlanner;
+
 // ========== MY CODE (end) ==========
 
 
@@ -64,12 +67,19 @@ std::vector<BzfRegion*>* RobotPlayer::obstacleList = NULL;
 
 RobotPlayer::RobotPlayer(const PlayerId& _id, const char* _name, ServerLink* _server,
     const char* _motto = "") :
-    LocalPlayer(_id, _name, _motto), target(NULL), pathIndex(0), timerForShot(0.0f),
-      drivingForward(true) {
+    LocalPlayer(_id, _name, _motto), pathRequest(0), pathRequestPlanner(ThetaPlanner),
+      anytimeGoalIndex(-1), anytimePathCount(0),
+      underFireTimer(0.0f), fireRequested(false), dropRequested(false), target(NULL), pathIndex(0),
+      timerForShot(0.0f), drivingForward(true) {
   gettingSound = false;
   server = _server;
 }
 
+RobotPlayer::~RobotPlayer() {
+  PATHPLANNINGSERVICE.cancel(pathRequest);
+  PLANNINGSCHEDULER.cancel(&anytimePlanner);
+}
+
 // estimate a player's position at now+t, similar to dead reckoning
 void RobotPlayer::projectPosition(const Player *targ, const float t, float &x, float &y,
     float &z) const {
@@ -111,6 +121,7 @@ void RobotPlayer::projectPosition(const Player *targ, const float t, float &x, f
 // 1. estimate how long it will take shot to hit target
 // 2. calc position of target at that point of time
 // 3. jump to 1., using projected position, loop until result is stable
+// (the caller checks whether the position is inside a building)
 void RobotPlayer::getProjectedPosition(const Player *targ, float *projpos) const {
   double myx = getPosition()[0];
   double myy = getPosition()[1];
@@ -140,13 +151,6 @@ void RobotPlayer::getProjectedPosition(const Player *targ, float *projpos) const
   projpos[0] = tx;
   projpos[1] = ty;
   projpos[2] = tz;
-
-  // projected pos in building -> use current pos
-  if (World::getWorld()->inBuilding(projpos, 0.0f, BZDBCache::tankHeight)) {
-    projpos[0] = targ->getPosition()[0];
-    projpos[1] = targ->getPosition()[1];
-    projpos[2] = targ->getPosition()[2];
-  }
 }
 
 /* ========== ORIGINAL doUpdate ==========
@@ -358,6 +362,7 @@ void RobotPlayer::explodeTank() {
   LocalPlayer::explodeTank();
   target = NULL;
   path.clear();
+  fireRequested = dropRequested = false;
 }
 
 void RobotPlayer::restart(const float* pos, float _azimuth) {
@@ -366,7 +371,14 @@ void RobotPlayer::restart(const float* pos, float _azimuth) {
   path.clear();
   target = NULL;
   pathIndex = 0;
-
+  PATHPLANNINGSERVICE.cancel(pathRequest);
+  pathRequest = 0;
+  PLANNINGSCHEDULER.cancel(&anytimePlanner);
+  anytimePlanner.stop();
+  anytimeGoalIndex = -1;
+  underFireTimer = 0.0f;
+  perception = Perception();
+  fireRequested = dropRequested = false;
 }
 
 float RobotPlayer::getTargetPriority(const Player* _target) const {
@@ -394,6 +406,12 @@ float RobotPlayer::getTargetPriority(const Player* _target) const {
   return basePriority - 0.5f * hypotf(p2[0] - p1[0], p2[1] - p1[1]) / worldSize;
 }
 
+float RobotPlayer::getMaxTargetPriority(float distance) const {
+  // the most getTargetPriority() gives a player this far away
+  const float basePriority = obstacleList ? 4.0f : 3.0f;
+  return basePriority - 0.5f * distance / BZDBCache::worldSize;
+}
+
 void RobotPlayer::setObstacleList(std::vector<BzfRegion*>* _obstacleList) {
   obstacleList = _obstacleList;
   aicore::DecisionTrees::init();  // MY CODE
@@ -562,6 +580,8 @@ void RobotPlayer::setTarget(const Player* _target) {
 
 
 void RobotPlayer::doUpdateMotion(float dt) {
+  if (underFireTimer > 0.0f)
+    underFireTimer -= dt;
 
   aicore::DecisionTreeNode *node = aicore::DecisionTrees::doUpdateMotionDecisions[0].makeDecision(this, dt);
   (this->*(((aicore::ActionPtr*)node)->actFuncPtr))(dt);
@@ -581,42 +601,151 @@ void RobotPlayer::doUpdate(float dt) {
 }
 
 
+/* Looks at the frame's ShotGrid and PlayerGrid for what the decisions of this frame need: an
+ * incoming shot, the closest enemy, the teammates too close, and where to aim at the target.
+ * Every robot senses before any of them decides, so that they all see the same frame.
+ */
+void RobotPlayer::sense() {
+  Perception &seen = this->perception;
+  seen.shotComing = this->findIncomingShot(seen.shotAngle);
+  seen.enemyFound = this->findClosestEnemy(seen.enemyPos);
+  this->getSeparation(seen.separation);
+  seen.targetProjected = (this->target != NULL);
+  if (seen.targetProjected)
+    this->getProjectedPosition(this->target, seen.targetPos);
+}
+
+
+/* Sends what the decisions asked for.  Main thread only, after every robot has decided, so
+ * that none of them decided on a world another one had already changed.
+ */
+void RobotPlayer::applyActions() {
+  if (this->fireRequested) {
+    this->fireRequested = false;
+    if (this->fireShot()) {
+      // separate shot by 0.2 - 0.8 sec (experimental value)
+      this->timerForShot = float(bzfrand()) * 0.6f + 0.2f;
+    }
+  }
+  if (this->dropRequested) {
+    this->dropRequested = false;
+    this->server->sendDropFlag(this->getId(), this->getPosition());
+  }
+}
+
+
 // -------------------- path-finding helpers --------------------
 
-/* Uses A* search to find a path from the start node to the goal node.  ALSO smooths the path.
- * WARNING: will crash if the goal (or start?) node is inaccessible.
+/* Uses A* search to find a path from the start node to the goal node.
+ * Paths found by any robot are kept in the PathCache, which answers first.
+ * If there is no path, the path will only contain the goal node, so the tank heads straight for it.
+ * The BZDB variable robotPathPlanner picks the planner: "theta" (Lazy Theta*, the default) finds
+ * any-angle paths, which only have a node where the path turns.  "grid" (grid A*), "astar"
+ * (YAGSBPL A*), "bidir" (bidirectional A*, quick to give up on walled-in goals) and "jps" (Jump
+ * Point Search) find 8-connected paths of the same cost, which are smoothed afterwards.  "navmesh"
+ * searches the NavMesh of obstacle regions instead, and returns a path that is already pulled tight.
+ * "anytime" only applies to the tank's own detours (see checkLineOfSight()); here it is "grid".
  * @param myPath Writes the path to this vector of nodes.
  * @param start The node from which to start the A* search.
  * @param goal The A* search will try to find a path to this node.
  */
 void RobotPlayer::findPath(std::vector<MyNode> &myPath, MyNode start, MyNode goal) {
-  // set up the graph function container
-  int halfWorldSize = (int)(0.5f * BZDBCache::worldSize);
-  GraphFunctionContainer container(halfWorldSize);
-
-  // create the graph
-  GenericSearchGraphDescriptor<MyNode, double> graph;
-  graph.func_container = &container;
-  graph.hashTableSize = MAX_HASH_VAL + 1;
-  graph.SeedNode = start;
-  graph.TargetNode = goal;
-
-  // find the path
-  A_star_planner<MyNode,double> planner;
-  planner.init(graph);
-  planner.plan();
-  std::vector< std::vector<MyNode> > paths = planner.getPlannedPaths();
-
-  // reverse paths[0]
-  // paths[0] contains the path, but backwards
-  //   paths[0][0]       == goal node
-  //   paths[0].size()-1 == start node
-  //   paths[0].size()-2 == first node to go to
-  myPath.clear();
-  for (int i=paths[0].size()-1; i >=0; i--) {
-    myPath.push_back(paths[0][i]);
+  // another robot may have found (most of) this path already
+  if (PATHCACHE.find(start, goal, myPath)) {
+    myPath = this->smoothPath(myPath);
+    return;
+  }
+
+  const PathPlannerKind planner = pathPlanner;
+  if (planner == NavMeshPlanner && NAVMESH.isBuilt()) {
+    const float startPos[2] = {convertToGameCoord(start.x), convertToGameCoord(start.y)};
+    const float goalPos[2]  = {convertToGameCoord(goal.x),  convertToGameCoord(goal.y)};
+    std::vector<RegionPoint> corners;
+    if (NAVMESH.plan(startPos, goalPos, corners)) {
+      // keep the exact start and goal nodes; the corners in between are where the path turns
+      myPath.clear();
+      myPath.push_back(start);
+      for (int i=1; i<(int)corners.size()-1; i++)
+        myPath.push_back(MyNode(corners[i].get()[0], corners[i].get()[1]));
+      myPath.push_back(goal);
+      PATHCACHE.add(myPath, false, NAVMESH.getExpandCount());
+      return;
+    }
+  }
+
+  // the grid planners are shared by all robots and reused between searches
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+  SearchCounters counters;
+  const bool found = planners.plan(planner, grid, start, goal, myPath, counters);
+  const bool anyAngle = isAnyAnglePlanner(planner);
+  SEARCHSTATISTICS.record(getId(), getCallSign(), counters);
+  const int expandCount = counters.expanded;
+  if (!found) {
+    myPath.clear();
+    myPath.push_back(goal);
+    return;
+  }
+  PATHCACHE.add(myPath, !anyAngle, expandCount);
+  // smooth the path, unless the search already did
+  if (!anyAngle)
+    myPath = this->smoothPath(myPath);
+}
+
+
+/* Finds a path from the start node to the nearest of several goals, with a single A* search
+ * toward all of them (see GraphAStarPlanner::planToNearest()).
+ * @param myPath Writes the path to this vector of nodes, smoothed.  Left alone if no goal can be
+ *               reached.
+ * @param start The node from which to start the search.
+ * @param goals The nodes the search may end at.
+ * @return The index in goals of the goal the path leads to, -1 if none can be reached.
+ */
+int RobotPlayer::findNearestPath(std::vector<MyNode> &myPath, MyNode start, const std::vector<MyNode> &goals) {
+  std::vector<MyNode> nearestPath;
+  const int nearest = planners.graph.planToNearest(start, goals, nearestPath);
+  SEARCHSTATISTICS.record(getId(), getCallSign(), planners.graph.getCounters());
+  if (nearest < 0)
+    return -1;
+  PATHCACHE.add(nearestPath, true, planners.graph.getExpandCount());
+  myPath = this->smoothPath(nearestPath);
+  return nearest;
+}
+
+
+/* Finds a path for a role (guard flag, capture flags), which usually goes across the map.
+ * Role goals are team bases and team flags, so the path is usually read off their FlowField.
+ * Otherwise, long paths are planned on the HPA* abstract graph, and only contain the cluster
+ * entrances on the way.  The tank refines each segment when it gets there (see checkLineOfSight()).
+ * Short paths, or all paths if robotHierarchicalPaths is off, are planned with findPath().
+ * @param myPath Writes the path to this vector of nodes.
+ * @param start The node from which to start the search.
+ * @param goal The search will try to find a path to this node.
+ */
+void RobotPlayer::findRolePath(std::vector<MyNode> &myPath, MyNode start, MyNode goal) {
+  const bool flowFields = !BZDB.isSet("robotFlowFields") || BZDB.isTrue("robotFlowFields");
+  if (flowFields && FLOWFIELDS.findPath(start, goal, myPath)) {
+    myPath = this->smoothPath(myPath);
+    return;
+  }
+
+  const bool hierarchical = !BZDB.isSet("robotHierarchicalPaths") || BZDB.isTrue("robotHierarchicalPaths");
+  const int shortPath = 2 * STRAIGHT_COST * hierarchicalPlanner.getClusterSize();
+  if (!hierarchical || octileDistance(goal.x - start.x, goal.y - start.y) < shortPath) {
+    this->findPath(myPath, start, goal);
+    return;
   }
-  // smooth the path
+
+  if (!PATHCACHE.find(start, goal, myPath)) {
+    if (!hierarchicalPlanner.plan(start, goal, myPath)) {
+      myPath.clear();
+      myPath.push_back(goal);
+      return;
+    }
+    PATHCACHE.add(myPath, false, hierarchicalPlanner.getExpandCount());
+  }
+  // drop the waypoints that can be seen from an earlier one
   myPath = this->smoothPath(myPath);
 }
 
@@ -637,11 +766,7 @@ std::vector<MyNode> RobotPlayer::smoothPath(std::vector<MyNode> inputPath) {
   // start at 2 b/c there is already a connection btwn 0 and 1
   // stop at size-1 b/c last node must be added anyway, so no need to check
   for (int i=2; i<inputPath.size()-1; i++) {
-    MyNode fromNode = outputPath[outputPath.size()-1];
-    MyNode toNode = inputPath[i];
-    float fromPos[2] = {convertToGameCoord(fromNode.x), convertToGameCoord(fromNode.y)};
-    float toPos[2]   = {convertToGameCoord(toNode.x),   convertToGameCoord(toNode.y)};
-    if (this->obstructedLineOfSight(fromPos, toPos)) {
+    if (this->obstructedLineOfSight(outputPath[outputPath.size()-1], inputPath[i])) {
       outputPath.push_back(inputPath[i-1]);
     }
   }
@@ -651,15 +776,41 @@ std::vector<MyNode> RobotPlayer::smoothPath(std::vector<MyNode> inputPath) {
 
 
 /* Checks the line of sight between the given positions to see if any obstacles are in the way.
+ * Both positions are moved to their graph nodes, as for planning, and the nodes are checked with
+ * obstructedLineOfSight(MyNode, MyNode).
  * @param fromPos2D The position that we are checking the line-of-sight from.
  * @param toPos2D The position that we are looking toward.
  * @return True if the line of sight is obstructed, false otherwise
  */
 bool RobotPlayer::obstructedLineOfSight(const float *fromPos2D, const float *toPos2D) {
-  float fromPos[3] = {fromPos2D[0], fromPos2D[1], 0.0f};
-  float toPos[3]   = {toPos2D[0],   toPos2D[1],   0.0f};
+  return this->obstructedLineOfSight(MyNode(fromPos2D[0], fromPos2D[1]),
+                                     MyNode(toPos2D[0], toPos2D[1]));
+}
+
+
+/* Checks whether or not a tank can drive straight from one node to another.  Walks the line over
+ * the OccupancyGrid raster rather than casting a ray through the world, so it is a few word tests
+ * instead of a collision query per call.  The raster holds tank-sized clearance, so this is a bit
+ * stricter than the exact ray test, which suits driving; shots still use the exact test
+ * (ShotStrategy::getFirstBuilding()).
+ * @param fromNode The node that we are checking the line-of-sight from.
+ * @param toNode The node that we are looking toward.
+ * @return True if the line of sight is obstructed, false otherwise
+ */
+bool RobotPlayer::obstructedLineOfSight(const MyNode &fromNode, const MyNode &toNode) {
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+  if (grid.isBuilt())
+    return !grid.isLineOpen(fromNode.x, fromNode.y, toNode.x, toNode.y);
+
+  // no raster (no world yet): fall back to the exact ray test
+  float fromPos[3] = {convertToGameCoord(fromNode.x), convertToGameCoord(fromNode.y), 0.0f};
+  float toPos[3]   = {convertToGameCoord(toNode.x),   convertToGameCoord(toNode.y),   0.0f};
 
   float dist = hypotf(toPos[0]-fromPos[0], toPos[1]-fromPos[1]);
+  if (dist <= 0.0f)
+    return false;
   float direction[3] = {(toPos[0]-fromPos[0])/dist, (toPos[1]-fromPos[1])/dist, 0.0f};
   Ray myRay(fromPos, direction);
 
@@ -775,7 +926,7 @@ void RobotPlayer::setRoleGuardFlag(float dt) {
   // use A* search to find a path
   if (guardPath[myTeam].empty() || !(guardPath[myTeam].back() == guardGoal[myTeam])) {
     MyNode startNode(myPos[0], myPos[1]);
-    this->findPath(guardPath[myTeam], startNode, guardGoal[myTeam]);
+    this->findRolePath(guardPath[myTeam], startNode, guardGoal[myTeam]);
   }
 
   this->assignRole(guardGoal[myTeam], guardPath[myTeam]);
@@ -785,7 +936,8 @@ void RobotPlayer::setRoleGuardFlag(float dt) {
 /* Sets the goal and path for the capture-enemy-flags role.
  * Only one tank has this role.
  * If this tank doesn't have an enemy flag, find a path to the enemy flag that is closest to
- * this tank (rather than the center of mass, since only one tank is seeking the flag).
+ * this tank by path (rather than the center of mass, since only one tank is seeking the flag).
+ * The tank keeps going for that flag while it stays where the path ends.
  * Otherwise, return to base.
  * Note that if this tank has its own team flag, it will return to base.
  * Should work even if not capture-the-flag mode.
@@ -799,20 +951,36 @@ void RobotPlayer::setRoleCaptureFlags(float dt) {
   // if our team doesn't have an enemy flag (and enemy flags exist)
   std::vector<Flag> enemyFlags = this->findAllEnemyFlags();
   if (enemyFlags.size() && ((myFlag == Flags::Null) || (myFlag->flagTeam == NoTeam))) {
-    // find the enemy flag that is closest to this tank
-    Flag goalFlag = enemyFlags[0];
-    float goalDistance = hypotf(goalFlag.position[0] - myPos[0], goalFlag.position[1] - myPos[1]);
-    for (std::vector<Flag>::iterator i = enemyFlags.begin(); i<enemyFlags.end(); i++) {
-      Flag temp = *i;
-      float tempDistance = hypotf(temp.position[0] - myPos[0], temp.position[1] - myPos[1]);
-      if (tempDistance < goalDistance) {
-        goalFlag = temp;
-        goalDistance = tempDistance;
-      }
-    } // for
+    std::vector<MyNode> flagNodes;
+    for (std::vector<Flag>::iterator i = enemyFlags.begin(); i<enemyFlags.end(); i++)
+      flagNodes.push_back(MyNode(i->position[0], i->position[1]));
+
+    // keep going for the flag the path leads to, as long as it stays there
+    int goalIndex = -1;
+    for (int i=0; i<(int)flagNodes.size() && !capturePath[myTeam].empty(); i++)
+      if (capturePath[myTeam].back() == flagNodes[i])
+        goalIndex = i;
+
+    // otherwise, one search finds both the flag that is nearest by path and the path to it
+    if (goalIndex < 0) {
+      MyNode startNode(myPos[0], myPos[1]);
+      goalIndex = this->findNearestPath(capturePath[myTeam], startNode, flagNodes);
+    }
 
-    MyNode tempNode(goalFlag.position[0], goalFlag.position[1]);
-    RobotPlayer::captureGoal[myTeam] = tempNode;
+    // no flag can be reached: head for the one that is closest in a straight line
+    if (goalIndex < 0) {
+      goalIndex = 0;
+      float goalDistance = hypotf(enemyFlags[0].position[0] - myPos[0], enemyFlags[0].position[1] - myPos[1]);
+      for (int i=1; i<(int)enemyFlags.size(); i++) {
+        float tempDistance = hypotf(enemyFlags[i].position[0] - myPos[0], enemyFlags[i].position[1] - myPos[1]);
+        if (tempDistance < goalDistance) {
+          goalIndex = i;
+          goalDistance = tempDistance;
+        }
+      } // for
+    }
+
+    RobotPlayer::captureGoal[myTeam] = flagNodes[goalIndex];
   }
   // go back to base
   else {
@@ -825,7 +993,7 @@ void RobotPlayer::setRoleCaptureFlags(float dt) {
   // use A* search to find a path
   if (capturePath[myTeam].empty() || !(capturePath[myTeam].back() == captureGoal[myTeam])) {
     MyNode startNode(myPos[0], myPos[1]);
-    this->findPath(capturePath[myTeam], startNode, captureGoal[myTeam]);
+    this->findRolePath(capturePath[myTeam], startNode, captureGoal[myTeam]);
   }
 
   this->assignRole(captureGoal[myTeam], capturePath[myTeam]);
@@ -859,12 +1027,6 @@ void RobotPlayer::setRoleKillEnemies(float dt) {
   }  // for
   */
 
-  const char* targetname = target->getCallSign();
-  const char* tankname   = this->getCallSign();
-  char buffer[1234];
-  sprintf(buffer, "%s -> %s", tankname, targetname);
-  controlPanel->addMessage(buffer);
-
   const float *enemyPos = this->target->getPosition();
   MyNode tempNode(enemyPos[0], enemyPos[1]);
   this->myGoal = tempNode;
@@ -873,9 +1035,25 @@ void RobotPlayer::setRoleKillEnemies(float dt) {
   if (!(this->prevGoal == this->myGoal)) {
     this->prevGoal = this->myGoal;
     this->path.clear();
-    RegionPoint rp(convertToGameCoord(this->myGoal.x), convertToGameCoord(this->myGoal.y));
-    this->path.push_back(rp);
-    // tank will find it's own path to the goal when it calls checkLineOfSight()
+    this->pathIndex = 0;
+
+    // the chase planner repairs its previous search instead of starting over
+    const bool incremental = !BZDB.isSet("robotIncrementalChase") || BZDB.isTrue("robotIncrementalChase");
+    std::vector<MyNode> chasePath;
+    MyNode myNode(myPos[0], myPos[1]);
+    if (incremental && this->chasePlanner.plan(myNode, this->myGoal, chasePath)) {
+      chasePath = this->smoothPath(chasePath);
+      // don't insert the first node because it is the tank's current position
+      for (int i=1; i<chasePath.size(); i++) {
+        RegionPoint rp(convertToGameCoord(chasePath[i].x), convertToGameCoord(chasePath[i].y));
+        this->path.push_back(rp);
+      }
+    }
+    if (this->path.empty()) {
+      RegionPoint rp(convertToGameCoord(this->myGoal.x), convertToGameCoord(this->myGoal.y));
+      this->path.push_back(rp);
+      // tank will find it's own path to the goal when it calls checkLineOfSight()
+    }
   }
 }
 
@@ -936,51 +1114,56 @@ std::vector<Flag> RobotPlayer::findAllEnemyFlags() {
 
 // -------------------- doUpdateMotion --------------------
 
-/* Indicates whether or not a shot is coming near the tank.
+/* Indicates whether or not a shot is coming near the tank, as sense() found.
  * @param dt The time since the last frame.
  * @return True if a shot is coming near the tank, false otherwise.
  */
 bool RobotPlayer::shotComing(float dt) {
-  const float* position = this->getPosition();
-  const float  azimuth  = this->getAngle();
+  if (!this->perception.shotComing)
+    return false;
+  this->incomingShotAngle = this->perception.shotAngle;
+  this->underFireTimer = UNDER_FIRE_TIME;
+  return true;
+}
 
-  for (int t = 0; t <= World::getWorld()->getCurMaxPlayers(); t++) {
-    Player *p = 0;
-    if (t < World::getWorld()->getCurMaxPlayers())
-      p = World::getWorld()->getPlayer(t);
-    else
-      p = LocalPlayer::getMyTank();
-    if (!p || p->getId() == getId())
-      continue;
-    const int maxShots = p->getMaxShots();
-    for (int s = 0; s < maxShots; s++) {
-      ShotPath* shot = p->getShot(s);
-      if (!shot || shot->isExpired())
-        continue;
-      // ignore invisible bullets completely for now (even when visible)
-      if (shot->getFlag() == Flags::InvisibleBullet)
-        continue;
 
-      const float* shotPos = shot->getPosition();
-      if ((fabs(shotPos[2] - position[2]) > BZDBCache::tankHeight)
-          && (shot->getFlag() != Flags::GuidedMissile))
-        continue;
-      const float dist = TargetingUtils::getTargetDistance(position, shotPos);
-      if (dist < 150.0f) {
-        const float *shotVel = shot->getVelocity();
-        this->incomingShotAngle = atan2f(shotVel[1], shotVel[0]);
-        float shotUnitVec[2] = { cosf(this->incomingShotAngle), sinf(this->incomingShotAngle) };
+/* Finds a shot coming at the tank in the frame's ShotGrid.
+ * @param shotAngle Writes the direction the shot is traveling in to this float.
+ * @return True if a shot is coming near the tank, false otherwise.
+ */
+bool RobotPlayer::findIncomingShot(float &shotAngle) {
+  const float* position = this->getPosition();
 
-        float trueVec[2] =
-            { (position[0] - shotPos[0]) / dist, (position[1] - shotPos[1]) / dist };
-        float dotProd = trueVec[0] * shotUnitVec[0] + trueVec[1] * shotUnitVec[1];
+  // only the shots close enough to matter
+  std::vector<ShotGrid::Shot> shots;
+  SHOTGRID.findShotsNear(position, 150.0f, shots);
+  WorldPlayer *worldWeapons = World::getWorld()->getWorldWeapons();
+  for (unsigned int i = 0; i < shots.size(); i++) {
+    if (shots[i].owner == worldWeapons || shots[i].owner->getId() == getId())
+      continue;
+    ShotPath* shot = shots[i].path;
+    // ignore invisible bullets completely for now (even when visible)
+    if (shot->getFlag() == Flags::InvisibleBullet)
+      continue;
 
-        if (dotProd > 0.97f) {
-          return true;
-        }
-      }
-    }  // for s
-  }  // for t
+    const float* shotPos = shot->getPosition();
+    if ((fabs(shotPos[2] - position[2]) > BZDBCache::tankHeight)
+        && (shot->getFlag() != Flags::GuidedMissile))
+      continue;
+    const float dist = TargetingUtils::getTargetDistance(position, shotPos);
+    if (dist < 150.0f) {
+      const float *shotVel = shot->getVelocity();
+      shotAngle = atan2f(shotVel[1], shotVel[0]);
+      float shotUnitVec[2] = { cosf(shotAngle), sinf(shotAngle) };
+
+      float trueVec[2] =
+          { (position[0] - shotPos[0]) / dist, (position[1] - shotPos[1]) / dist };
+      float dotProd = trueVec[0] * shotUnitVec[0] + trueVec[1] * shotUnitVec[1];
+
+      if (dotProd > 0.97f)
+        return true;
+    }
+  }  // for i
   return false;
 }
 
@@ -1037,10 +1220,9 @@ void RobotPlayer::aimAtClosestEnemy(float dt) {
   const float  azimuth = this->getAngle();
   const float  tankAngVel = BZDB.eval(StateDatabase::BZDB_TANKANGVEL);
 
-  float enemyPos[3];
-  bool enemiesExist = this->findClosestEnemy(enemyPos);
-  if (!enemiesExist)
+  if (!this->perception.enemyFound)
     return;
+  const float *enemyPos = this->perception.enemyPos;
 
   float segmentAzimuth = atan2f(enemyPos[1] - myPos[1] , enemyPos[0] - myPos[0]);
   float azimuthDiff = segmentAzimuth - azimuth;
@@ -1076,9 +1258,9 @@ bool RobotPlayer::findClosestEnemy(float enemyPos[3]) {
   float minDist = 2 * BZDBCache::worldSize;
   Player* closestEnemy = 0;
 
+  // the remote players only: the local player doesn't apply here
   World* world = World::getWorld();
-  // start at i=1 b/c player 0 is the local player, which doesn't apply here
-  for (int i=1; i < world->getCurMaxPlayers(); i++) {
+  for (int i=0; i < world->getCurMaxPlayers(); i++) {
     Player* p = world->getPlayer(i);
     // if enemy exists
     if (p && p->getTeam() != this->getTeam()) {
@@ -1128,8 +1310,7 @@ void RobotPlayer::followPath(float dt) {
         pathIndex++;
     }
 
-    float separationV[3] = {0};
-    this->getSeparation(separationV);
+    const float *separationV = this->perception.separation;
 
     // v is a relative position, according to the original implementation
     float v[2];
@@ -1185,34 +1366,151 @@ void RobotPlayer::followPath(float dt) {
 
 /* If the line of sight from the tank's current position to the next node is blocked,
  * then use A* search to find a path to the next node, and insert it into the tank's path
+ * (in front of the next node).  This is also what refines the segments of HPA* role paths.
+ * The search runs on the PathPlanningService workers: the tank keeps heading for the next node
+ * until the path arrives, a frame or two later.  If robotPathPlanner is "anytime", the tank's own
+ * ARA* search is run instead, a slice at a time, by the PlanningScheduler (see refinePath()).
  */
 void RobotPlayer::checkLineOfSight() {
   if (path.empty()) {
     return;
   }
 
+  if (this->anytimeGoalIndex >= 0 && this->refinePath()) {
+    // keep following the path found so far
+    return;
+  }
+
   const float *fromPos = this->getPosition();
   const float *toPos   = path[pathIndex].get();
-  if (this->obstructedLineOfSight(fromPos, toPos)) {
+  MyNode toNode(toPos[0], toPos[1]);
+
+  if (this->pathRequest) {
     std::vector<MyNode> prePath;
+    SearchCounters counters;
+    PathPlanningService::Status status = PATHPLANNINGSERVICE.poll(this->pathRequest, prePath, &counters);
+    if (status == PathPlanningService::Pending) {
+      // keep following the old path
+      return;
+    }
+    this->pathRequest = 0;
+    if (status != PathPlanningService::Unknown)
+      SEARCHSTATISTICS.record(getId(), getCallSign(), counters);
+    // robotPathPlanner may have changed since: the path is what its own planner made
+    const bool anyAngle = isAnyAnglePlanner(this->pathRequestPlanner);
+    if (status == PathPlanningService::Found)
+      PATHCACHE.add(prePath, !anyAngle, counters.expanded);
+    // the path is only useful if the tank is still heading for the node it was planned to
+    if (status == PathPlanningService::Found && toNode == this->pathRequestGoal) {
+      this->insertPath(anyAngle ? prePath : this->smoothPath(prePath));
+      return;
+    }
+  }
+
+  if (this->obstructedLineOfSight(fromPos, toPos)) {
     MyNode fromNode(fromPos[0], fromPos[1]);
-    MyNode toNode  (toPos[0],   toPos[1]);
+    std::vector<MyNode> prePath;
+    if (PATHCACHE.find(fromNode, toNode, prePath)) {
+      this->insertPath(this->smoothPath(prePath));
+      return;
+    }
+    if (pathPlanner == AnytimePlanner) {
+      this->anytimePlanner.start(fromNode, toNode);
+      this->anytimeGoalIndex = pathIndex;
+      this->anytimePathCount = 0;
+      PLANNINGSCHEDULER.submit(&this->anytimePlanner, this->getPlanningUrgency());
+      return;
+    }
+    // a tank carrying a flag gets its path first
+    const int priority = (this->getFlag() != Flags::Null) ? 1 : 0;
+    this->pathRequest = PATHPLANNINGSERVICE.submit(fromNode, toNode, pathPlanner, priority);
+    this->pathRequestGoal = toNode;
+    this->pathRequestPlanner = pathPlanner;
+  }  // if obstructedLineOfSight
+}
 
-    this->findPath(prePath, fromNode, toNode);
-    if (prePath.size() > 2) {
-      // don't insert the first node because it is the tank's current position
-      // don't insert the last  node because it is already in the path
-      for (int i=prePath.size()-2; i>0; i--) {
-        MyNode node = prePath[i];
-        RegionPoint rp(convertToGameCoord(node.x), convertToGameCoord(node.y));
-        path.insert(path.begin(), rp);
+
+/* Inserts a path to the next node into the tank's path, in front of the next node.
+ * @param prePath The path, from the tank's position to the next node (inclusive).
+ */
+void RobotPlayer::insertPath(const std::vector<MyNode> &prePath) {
+  if (prePath.size() > 2) {
+    // don't insert the first node because it is the tank's current position
+    // don't insert the last  node because it is already in the path
+    for (int i=prePath.size()-2; i>0; i--) {
+      MyNode node = prePath[i];
+      RegionPoint rp(convertToGameCoord(node.x), convertToGameCoord(node.y));
+      path.insert(path.begin() + pathIndex, rp);
+    }
+  }  // if prePath.size > 2
+}
+
+
+/* Takes the paths the PlanningScheduler found for the tank's anytime search.  The first path is a
+ * rough one, and goes in the tank's path as soon as it is found, so the tank gets going; each
+ * better one then replaces whatever the tank has not driven yet of the last one.  The last one is
+ * a shortest path, and goes in the PathCache.
+ * @return True if the search is still going, false otherwise.
+ */
+bool RobotPlayer::refinePath() {
+  // the tank has got past the goal, or its path was replaced since the search started
+  const MyNode &goal = this->anytimePlanner.getGoal();
+  if (anytimeGoalIndex < pathIndex || anytimeGoalIndex >= (int)path.size() ||
+      !(MyNode(path[anytimeGoalIndex].get()[0], path[anytimeGoalIndex].get()[1]) == goal)) {
+    PLANNINGSCHEDULER.cancel(&this->anytimePlanner);
+    this->anytimePlanner.stop();
+    anytimeGoalIndex = -1;
+    return false;
+  }
+
+  const bool searching = this->anytimePlanner.isSearching();
+  if (searching)
+    PLANNINGSCHEDULER.submit(&this->anytimePlanner, this->getPlanningUrgency());
+
+  if (this->anytimePlanner.getPathCount() != anytimePathCount) {
+    anytimePathCount = this->anytimePlanner.getPathCount();
+    std::vector<MyNode> newPath;
+    this->anytimePlanner.getPath(newPath);
+    if (!searching)
+      PATHCACHE.add(newPath, true, this->anytimePlanner.getExpandCount());
+    newPath = this->smoothPath(newPath);
+
+    // the tank has moved on since the search started: join the new path at its node nearest the tank
+    const float *position = this->getPosition();
+    int nearest = 0;
+    float nearestDistance = 0.0f;
+    for (int i = 0; i < (int)newPath.size() - 1; i++) {
+      const float distance = hypotf(convertToGameCoord(newPath[i].x) - position[0],
+                                    convertToGameCoord(newPath[i].y) - position[1]);
+      if (i == 0 || distance < nearestDistance) {
+        nearest = i;
+        nearestDistance = distance;
       }
-    }  // if prePath.size > 2
-  }  // if obstructedLineOfSight
+    }
+    path.erase(path.begin() + pathIndex, path.begin() + anytimeGoalIndex);
+    const int oldSize = (int)path.size();
+    this->insertPath(std::vector<MyNode>(newPath.begin() + nearest, newPath.end()));
+    anytimeGoalIndex = pathIndex + ((int)path.size() - oldSize);
+  }
+
+  if (!searching)
+    anytimeGoalIndex = -1;
+  return searching;
 }
 
 
-/* Calculates the separation vector.
+/* How urgently the tank needs its path: carrying a flag, then under fire, then anything else.
+ */
+PlanningScheduler::Urgency RobotPlayer::getPlanningUrgency() const {
+  if (this->getFlag() != Flags::Null)
+    return PlanningScheduler::CarryingFlag;
+  if (this->underFireTimer > 0.0f)
+    return PlanningScheduler::UnderFire;
+  return PlanningScheduler::Idle;
+}
+
+
+/* Calculates the separation vector from the frame's PlayerGrid.
  * @param separationVel Writes the separation vector to this array.
  */
 void RobotPlayer::getSeparation(float separationV[3]) {
@@ -1220,29 +1518,20 @@ void RobotPlayer::getSeparation(float separationV[3]) {
   float sumCoordsNearby[2] = {0};
   int   numPlayersNearby   = 0;
 
-  World *world = World::getWorld();
   const float *myPos = this->getPosition();
-  Player *p = 0;
 
-  // sum up the coordinates of tanks within the separation threshold radius
+  // sum up the coordinates of teammates within the separation threshold radius
   // excludes self
-  for (int i=0; i < world->getCurMaxPlayers(); i++) {
-    // player 0 is reserved for the user, and getPlayer(0) will always be null
-    if (0 == i)
-      p = LocalPlayer::getMyTank();
-    else
-      p = world->getPlayer(i);
-    // if player is exists, is not self, and is on same team
-    if (p && p->getId() != this->getId() && p->getTeam() == this->getTeam()) {
-      const float *pos = p->getPosition();
-      float distance = hypotf(pos[0] - myPos[0], pos[1] - myPos[1]);
-      if (distance <= SEPARATION_THRESHOLD) {
-        sumCoordsNearby[0] += pos[0];
-        sumCoordsNearby[1] += pos[1];
-        numPlayersNearby++;
-      }
-    } // if
-  } // for
+  std::vector<Player*> nearby;
+  PLAYERGRID.findPlayersNear(myPos, SEPARATION_THRESHOLD, this->getTeam(), nearby);
+  for (unsigned int i = 0; i < nearby.size(); i++) {
+    if (nearby[i]->getId() != this->getId()) {
+      const float *pos = nearby[i]->getPosition();
+      sumCoordsNearby[0] += pos[0];
+      sumCoordsNearby[1] += pos[1];
+      numPlayersNearby++;
+    }
+  }
 
   // calculate the center of mass of tanks within the threshold radius, excluding self
   // calculate the vector away from this local center of mass
@@ -1292,14 +1581,20 @@ bool RobotPlayer::shotTimerElapsed(float dt) {
  */
 bool RobotPlayer::willBarelyMiss(float dt) {
   // if there is no target, then there is nothing to shoot
-  if (!this->target) {
+  if (!this->target || !this->perception.targetProjected) {
     return false;
   }
 
   const float shotRadius = BZDB.eval(StateDatabase::BZDB_SHOTRADIUS);
 
-  float p1[3];
-  getProjectedPosition(this->target, p1);
+  float p1[3] = { this->perception.targetPos[0], this->perception.targetPos[1],
+      this->perception.targetPos[2] };
+  // projected pos in building -> use current pos
+  if (World::getWorld()->inBuilding(p1, 0.0f, BZDBCache::tankHeight)) {
+    p1[0] = this->target->getPosition()[0];
+    p1[1] = this->target->getPosition()[1];
+    p1[2] = this->target->getPosition()[2];
+  }
   const float* p2 = getPosition();
   const float azimuth = getAngle();
 
@@ -1378,14 +1673,11 @@ void RobotPlayer::postponeShot(float dt) {
 }
 
 
-/* Shoot, and reset the timer for the next shot to a random amount.
+/* Shoot, once every robot has decided (see applyActions()).
  * @param dt The time since the last frame.
  */
 void RobotPlayer::shoot(float dt) {
-  if (this->fireShot()) {
-    // separate shot by 0.2 - 0.8 sec (experimental value)
-    this->timerForShot = float(bzfrand()) * 0.6f + 0.2f;
-  }
+  this->fireRequested = true;
 }
 
 
@@ -1421,12 +1713,12 @@ bool RobotPlayer::isSomeTeamFlag(float dt) {
 //}
 
 
-/* Drops the flag at the tank's present location.
+/* Drops the flag at the tank's location, once every robot has decided (see applyActions()).
  * @param dt The time since the last frame.
  */
 void RobotPlayer::dropFlag(float dt) {
   //controlPanel->addMessage("drop flag");
-  serverLink->sendDropFlag(this->getId(), this->getPosition());
+  this->dropRequested = true;
 }
 
 
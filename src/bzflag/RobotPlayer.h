@@ -16,6 +16,16 @@
 // for A* search
 #include "yagsbpl/GraphFunctionContainerUnified.h"
 #include "yagsbpl/A_star.h"
+#include "yagsbpl/PathPlanners.h"
+#include "yagsbpl/AnytimeAStar.h"
+#include "yagsbpl/HierarchicalPlanner.h"
+#include "yagsbpl/DStarLite.h"
+#include "yagsbpl/PathPlanningService.h"
+#include "yagsbpl/PlanningScheduler.h"
+#include "yagsbpl/PathCache.h"
+#include "yagsbpl/SearchStatistics.h"
+#include "yagsbpl/FlowField.h"
+#include "yagsbpl/NavMesh.h"
 
 
 #include "common.h"
@@ -34,15 +44,22 @@
 class RobotPlayer: public LocalPlayer {
 public:
   RobotPlayer(const PlayerId&, const char* name, ServerLink*, const char* _motto);
+  ~RobotPlayer();
 
   float getTargetPriority(const Player*) const;
+  float getMaxTargetPriority(float distance) const;
   const Player* getTarget() const;
   void setTarget(const Player*);
   static void setObstacleList(std::vector<BzfRegion*>*);
+  static void setPathPlanner(PathPlannerKind kind) { pathPlanner = kind; }  // once per frame
 
   void restart(const float* pos, float azimuth);
   void explodeTank();
 
+  void sense();
+  void applyActions();
+  ServerLink* getServer() const { return server; }  // the link the robot talks to the server on
+
 // ========== MY CODE (begin) ==========
   bool tankIsAlive(float dt);
   bool isGuardingFlag(float dt);
@@ -104,6 +121,33 @@ private:
   // TODO: do I need to initialize this in the constructor?
 
   MyNode prevGoal;
+  DStarLitePlanner chasePlanner;  // this tank's search toward its target, repaired as both move
+  unsigned int pathRequest;  // PathPlanningService ticket of the path to the next node, 0 if none
+  MyNode pathRequestGoal;  // the node pathRequest is a path to
+  PathPlannerKind pathRequestPlanner;  // the planner pathRequest was submitted with
+  AnytimeAStarPlanner anytimePlanner;  // this tank's search to the next node, run by the PlanningScheduler
+  int anytimeGoalIndex;  // where anytimePlanner's goal is in the tank's path, -1 if there is no search
+  int anytimePathCount;  // anytimePlanner's paths the tank has already taken
+  float underFireTimer;  // time left since a shot last came near the tank, 0 once it is over
+  bool fireRequested;  // the decisions asked for a shot, for applyActions()
+  bool dropRequested;  // the decisions asked to drop the flag, for applyActions()
+
+  // what sense() found in the frame's grids, for the decisions
+  struct Perception {
+    Perception() : shotComing(false), shotAngle(0.0f), enemyFound(false), targetProjected(false) {
+      enemyPos[0] = enemyPos[1] = enemyPos[2] = 0.0f;
+      separation[0] = separation[1] = separation[2] = 0.0f;
+      targetPos[0] = targetPos[1] = targetPos[2] = 0.0f;
+    }
+    bool shotComing;
+    float shotAngle;  // the direction the incoming shot is traveling in
+    bool enemyFound;
+    float enemyPos[3];  // the closest enemy's position
+    float separation[3];
+    bool targetProjected;
+    float targetPos[3];  // where to aim at the target
+  };
+  Perception perception;
 
   void assignRole(MyNode roleGoal, std::vector<MyNode> rolePath);
 
@@ -111,13 +155,23 @@ private:
   std::vector<Flag> findAllEnemyFlags();
 
 // ---------- path-finding helpers ----------
+  static PathPlannerKind pathPlanner;  // robotPathPlanner, looked up once per frame
+  static PathPlanners planners;  // shared by all robots, keep their nodes between searches
+  static HierarchicalPlanner hierarchicalPlanner;  // shared by all robots, built once per world
   void findPath(std::vector<MyNode> &myPath, MyNode start, MyNode goal);
+  void findRolePath(std::vector<MyNode> &myPath, MyNode start, MyNode goal);
+  int findNearestPath(std::vector<MyNode> &myPath, MyNode start, const std::vector<MyNode> &goals);
   std::vector<MyNode> smoothPath(std::vector<MyNode> inputPath);
   bool obstructedLineOfSight(const float *fromPos, const float *toPos);
+  bool obstructedLineOfSight(const MyNode &fromNode, const MyNode &toNode);
 
 // ---------- doUpdateMotion helpers ----------
+  bool findIncomingShot(float &shotAngle);
   bool findClosestEnemy(float enemyPos[3]);
   void checkLineOfSight();
+  void insertPath(const std::vector<MyNode> &prePath);
+  bool refinePath();
+  PlanningScheduler::Urgency getPlanningUrgency() const;
   void getSeparation(float v[3]);
 
 
@@ -591,6 +591,14 @@ int			ServerLink::read(uint16_t& code, uint16_t& len,
     if (tlen < int(len)) return -1;
   }
 
+  // an older server sends no flags with MsgAccept
+  if (code == MsgAccept && len > PlayerIdPLen) {
+    uint8_t flags;
+    nboUnpackUByte((char*)msg + PlayerIdPLen, flags);
+    if (flags & AcceptNewPlayer)
+      server_abilities |= HostsRobots;
+  }
+
 // FIXME -- packet recording
 if (packetStream) {
   long dt = (long)((TimeKeeper::getCurrent() - packetStartTime) * 10000.0f);
@@ -602,16 +610,14 @@ if (packetStream) {
   return 1;
 }
 
-void			ServerLink::sendEnter(PlayerType type,
+void*			ServerLink::packEnter(void* buf,
+						PlayerType type,
 						TeamColor team,
 						const char* name,
 						const char* motto,
-						const char* token)
+						const char* token) const
 {
-  if (state != Okay) return;
-  char msg[PlayerIdPLen + 4 + CallSignLen + MottoLen + TokenLen + VersionLen];
-  ::memset(msg, 0, sizeof(msg));
-  void* buf = msg;
+  // the caller zeroes the buffer
   buf = nboPackUShort(buf, uint16_t(type));
   buf = nboPackUShort(buf, uint16_t(team));
   ::memcpy(buf, name, ::strlen(name));
@@ -622,9 +628,45 @@ void			ServerLink::sendEnter(PlayerType type,
   buf = (void*)((char*)buf + TokenLen);
   ::memcpy(buf, getAppVersion(), ::strlen(getAppVersion()) + 1);
   buf = (void*)((char*)buf + VersionLen);
+  return buf;
+}
+
+void*			ServerLink::packRobotId(void* buf,
+						const PlayerId& player) const
+{
+  // the messages that carry no player id are the link's own player's,
+  // unless they end with a robot's
+  if (player != id)
+    buf = nboPackUByte(buf, player);
+  return buf;
+}
+
+void			ServerLink::sendEnter(PlayerType type,
+						TeamColor team,
+						const char* name,
+						const char* motto,
+						const char* token)
+{
+  if (state != Okay) return;
+  char msg[PlayerIdPLen + 4 + CallSignLen + MottoLen + TokenLen + VersionLen];
+  ::memset(msg, 0, sizeof(msg));
+  packEnter(msg, type, team, name, motto, token);
   send(MsgEnter, sizeof(msg), msg);
 }
 
+void			ServerLink::sendNewPlayer(int robot, TeamColor team,
+						  const char* name,
+						  const char* motto)
+{
+  if (state != Okay) return;
+  char msg[1 + PlayerIdPLen + 4 + CallSignLen + MottoLen + TokenLen + VersionLen];
+  ::memset(msg, 0, sizeof(msg));
+  void* buf = msg;
+  buf = nboPackUByte(buf, uint8_t(robot));
+  packEnter(buf, ComputerPlayer, team, name, motto, "");
+  send(MsgNewPlayer, sizeof(msg), msg);
+}
+
 bool ServerLink::readEnter (std::string& reason,
 			    uint16_t& code, uint16_t& rejcode)
 {
@@ -662,6 +704,53 @@ bool ServerLink::readEnter (std::string& reason,
   return true;
 }
 
+void			ServerLink::sendNegotiateFlags()
+{
+  char msg[MaxPacketLen];
+  FlagTypeMap::iterator i;
+  char *buf = msg;
+
+  /* Send MsgNegotiateFlags to the server with
+   * the abbreviations for all the flags we support.
+   */
+  for (i = FlagType::getFlagMap().begin();
+       i != FlagType::getFlagMap().end(); i++) {
+    buf = (char*) i->second->pack(buf);
+  }
+  send(MsgNegotiateFlags, buf - msg, msg);
+}
+
+void*			ServerLink::readSetVars(void* msg)
+{
+  uint16_t numVars;
+  uint8_t nameLen, valueLen;
+
+  char name[MaxPacketLen];
+  char value[MaxPacketLen];
+
+  msg = nboUnpackUShort(msg, numVars);
+  for (int i = 0; i < numVars; i++) {
+    msg = nboUnpackUByte(msg, nameLen);
+    msg = nboUnpackString(msg, name, nameLen);
+    name[nameLen] = '\0';
+
+    msg = nboUnpackUByte(msg, valueLen);
+    msg = nboUnpackString(msg, value, valueLen);
+    value[valueLen] = '\0';
+
+    if ((name[0] != '_') && (name[0] != '$')) {
+      logDebugMessage(1, "Server BZDB change blocked: '%s' = '%s'\n",
+		      name, value);
+    }
+    else {
+      BZDB.set(name, value);
+      BZDB.setPersistent(name, false);
+      BZDB.setPermission(name, StateDatabase::Locked);
+    }
+  }
+  return msg;
+}
+
 void			ServerLink::sendCaptureFlag(const PlayerId& capturer, TeamColor team)
 {
   char msg[PlayerIdPLen + 2];
@@ -689,12 +778,13 @@ void			ServerLink::sendDropFlag(const PlayerId& dropper, const float* position)
   send(MsgDropFlag, sizeof(msg), msg);
 }
 
-void			ServerLink::sendKilled(const PlayerId& killer,
+void			ServerLink::sendKilled(const PlayerId& victim,
+					       const PlayerId& killer,
 					       int reason, int shotId,
 					       const FlagType* flagType,
 					       int phydrv)
 {
-  char msg[PlayerIdPLen + 2 + 2 + FlagPackSize + 4];
+  char msg[PlayerIdPLen + 2 + 2 + FlagPackSize + 4 + PlayerIdPLen];
   void* buf = msg;
 
   buf = nboPackUByte(buf, killer);
@@ -705,6 +795,7 @@ void			ServerLink::sendKilled(const PlayerId& killer,
   if (reason == PhysicsDriverDeath) {
     buf = nboPackInt(buf, phydrv);
   }
+  buf = packRobotId(buf, victim);
 
   send(MsgKilled, (char*)buf - (char*)msg, msg);
 }
@@ -740,29 +831,44 @@ void			ServerLink::sendBeginShot(const FiringInfo& info)
   send(MsgShotBegin, sizeof(msg), msg);
 }
 
-void			ServerLink::sendEndShot(const PlayerId& source,
-							int shotId, int reason)
+void			ServerLink::sendEndShot(const PlayerId& player,
+						const PlayerId& source,
+						int shotId, int reason)
 {
-  char msg[PlayerIdPLen + 4];
+  char msg[PlayerIdPLen + 4 + PlayerIdPLen];
   void* buf = msg;
   buf = nboPackUByte(buf, source);
   buf = nboPackShort(buf, int16_t(shotId));
   buf = nboPackUShort(buf, uint16_t(reason));
-  send(MsgShotEnd, sizeof(msg), msg);
+  buf = packRobotId(buf, player);
+  send(MsgShotEnd, (char*)buf - (char*)msg, msg);
+}
+
+void			ServerLink::sendAlive(const PlayerId& player)
+{
+  char msg[PlayerIdPLen];
+  void* buf = msg;
+  buf = packRobotId(buf, player);
+  send(MsgAlive, (char*)buf - (char*)msg, msg);
 }
 
-void			ServerLink::sendAlive()
+void			ServerLink::sendExit(const PlayerId& player)
 {
-  send(MsgAlive, 0, NULL);
+  char msg[PlayerIdPLen];
+  void* buf = msg;
+  buf = packRobotId(buf, player);
+  send(MsgExit, (char*)buf - (char*)msg, msg);
 }
 
-void			ServerLink::sendTeleport(int from, int to)
+void			ServerLink::sendTeleport(const PlayerId& player,
+						 int from, int to)
 {
-  char msg[4];
+  char msg[4 + PlayerIdPLen];
   void* buf = msg;
   buf = nboPackUShort(buf, uint16_t(from));
   buf = nboPackUShort(buf, uint16_t(to));
-  send(MsgTeleport, sizeof(msg), msg);
+  buf = packRobotId(buf, player);
+  send(MsgTeleport, (char*)buf - (char*)msg, msg);
 }
 
 void			ServerLink::sendTransferFlag(const PlayerId& from, const PlayerId& to)
@@ -44,7 +44,8 @@ class ServerLink {
 			CanDoUDP = 1,
 			SendScripts = 2,
 			SendTextures = 4,
-			HasMessageLink = 8
+			HasMessageLink = 8,
+			HostsRobots = 16
     };
 
 			ServerLink(const Address& serverAddress,
@@ -56,6 +57,8 @@ class ServerLink {
     int			getSocket() const;	// file descriptor actually
     const PlayerId&	getId() const;
     const char*		getVersion() const;
+    // whether our robots can play over this link, see sendNewPlayer()
+    bool		canHostRobots() const;
 
     void		send(uint16_t code, uint16_t len, const void* msg);
     // if millisecondsToBlock < 0 then block forever
@@ -66,11 +69,23 @@ class ServerLink {
 				  const char* name, const char* motto, const char* token);
     bool		readEnter(std::string& reason,
 				  uint16_t& code, uint16_t& rejcode);
+    // tell the server the flags we know (MsgNegotiateFlags)
+    void		sendNegotiateFlags();
+    // take the server variables of a MsgSetVar into BZDB, returns the
+    // rest of the message
+    static void*	readSetVars(void* msg);
+    // join a robot that plays over this link, robot being our number for
+    // it: the server's MsgNewPlayer reply gives its player id
+    void		sendNewPlayer(int robot, TeamColor,
+				      const char* name, const char* motto);
+
+    // the first PlayerId says which local player a message is about:
+    // the link's own player or one of its robots
 
     void		sendCaptureFlag(const PlayerId& capturer, TeamColor);
     void		sendGrabFlag(const PlayerId& grabber, int flagIndex);
     void		sendDropFlag(const PlayerId& dropper, const float* position);
-    void		sendKilled(const PlayerId&, int reason,
+    void		sendKilled(const PlayerId&, const PlayerId& killer, int reason,
 				   int shotId, const FlagType* flag, int phydrv);
   // FIXME -- This is very ugly, but required to build bzadmin with gcc 2.9.5.
   //	  It should be changed to something cleaner.
@@ -78,9 +93,11 @@ class ServerLink {
     void		sendPlayerUpdate(Player*);
 #endif
     void		sendBeginShot(const FiringInfo&);
-    void		sendEndShot(const PlayerId&, int shotId, int reason);
-    void		sendAlive();
-    void		sendTeleport(int from, int to);
+    void		sendEndShot(const PlayerId&, const PlayerId& source,
+				    int shotId, int reason);
+    void		sendAlive(const PlayerId&);
+    void		sendExit(const PlayerId&);
+    void		sendTeleport(const PlayerId&, int from, int to);
     void		sendTransferFlag(const PlayerId&, const PlayerId&);
     void		sendNewRabbit();
     void		sendPaused(bool paused);
@@ -92,6 +109,12 @@ class ServerLink {
     void		enableOutboundUDP();
     void		confirmIncomingUDP();
 
+  private:
+    void*		packEnter(void* buf, PlayerType, TeamColor,
+				  const char* name, const char* motto,
+				  const char* token) const;
+    void*		packRobotId(void* buf, const PlayerId&) const;
+
   private:
     State		state;
     int			fd;
@@ -140,6 +163,11 @@ inline const char*	ServerLink::getVersion() const
   return version;
 }
 
+inline bool		ServerLink::canHostRobots() const
+{
+  return (server_abilities & HostsRobots) == HostsRobots;
+}
+
 #endif // BZF_SERVER_LINK_H
 
 // Local Variables: ***
@@ -0,0 +1,234 @@
+/* bzflag
+ * Copyright (c) 1993-2011 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+// interface header
+#include "ShotGrid.h"
+
+/* system implementation headers */
+#include <algorithm>
+#include <math.h>
+
+/* common implementation headers */
+#include "BZDBCache.h"
+
+/* local implementation headers */
+#include "LocalPlayer.h"
+#include "World.h"
+#include "WorldPlayer.h"
+
+// initialize the singleton
+template <>
+ShotGrid* Singleton<ShotGrid>::_instance = (ShotGrid*)0;
+
+// a side of the grid has at most this many cells
+static const int maxGridSize = 256;
+
+
+ShotGrid::ShotGrid() : size(0), cellSize(1.0f), origin(0.0f),
+		       maxStep(0.0f), frameTime(0.0f)
+{
+}
+
+ShotGrid::~ShotGrid()
+{
+}
+
+void			ShotGrid::clear()
+{
+  entries.clear();
+  cellStart.clear();
+  wide.clear();
+  tracked.clear();
+  previous.clear();
+  size = 0;
+  maxStep = 0.0f;
+}
+
+void			ShotGrid::build(float dt)
+{
+  World* world = World::getWorld();
+  if (!world) {
+    clear();
+    return;
+  }
+
+  // a few tank lengths a cell, so that a tank touches at most 4 of them
+  frameTime = dt;
+  cellSize = std::max(4.0f * BZDBCache::tankLength, 1.0f);
+  size = std::min(std::max((int)ceilf(BZDBCache::worldSize / cellSize), 1), maxGridSize);
+  cellSize = std::max(BZDBCache::worldSize / (float)size, cellSize);
+  origin = -0.5f * (float)size * cellSize;
+
+  previous.swap(tracked);
+  tracked.clear();
+  wide.clear();
+  maxStep = 0.0f;
+
+  // collect the shots, then sort them by cell
+  entries.clear();
+  addShots(LocalPlayer::getMyTank());
+  for (int i = 0; i < world->getCurMaxPlayers(); i++)
+    addShots(world->getPlayer(i));
+  addShots(world->getWorldWeapons());
+  std::sort(tracked.begin(), tracked.end());
+
+  std::vector<Entry> added;
+  added.swap(entries);
+  const int cellCount = size * size;
+  cellStart.assign(cellCount + 1, 0);
+  for (unsigned int i = 0; i < added.size(); i++)
+    cellStart[added[i].cell + 1]++;
+  for (int c = 0; c < cellCount; c++)
+    cellStart[c + 1] += cellStart[c];
+  entries.resize(added.size());
+  std::vector<int> next(cellStart.begin(), cellStart.end() - 1);
+  for (unsigned int i = 0; i < added.size(); i++) {
+    const int index = next[added[i].cell]++;
+    entries[index] = added[i];
+    if (added[i].wide)
+      wide.push_back(index);
+  }
+}
+
+void			ShotGrid::addShots(Player* player)
+{
+  if (!player)
+    return;
+  const int maxShots = player->getMaxShots();
+  for (int s = 0; s < maxShots; s++) {
+    ShotPath* shot = player->getShot(s);
+    if (!shot || shot->isExpired())
+      continue;
+
+    const float* pos = shot->getPosition();
+    const float* vel = shot->getVelocity();
+    const float step = hypotf(vel[0], vel[1]) * frameTime;
+
+    Tracked now;
+    now.owner = player;
+    now.slot = s;
+    now.shotId = shot->getShotId();
+    now.pos[0] = pos[0];
+    now.pos[1] = pos[1];
+    tracked.push_back(now);
+
+    // the shot came here in a straight line if it was this close last frame
+    std::vector<Tracked>::const_iterator before =
+      std::lower_bound(previous.begin(), previous.end(), now);
+    const bool seen = (before != previous.end() && before->owner == player &&
+		       before->slot == s && before->shotId == now.shotId);
+    const bool jumped = !seen ||
+      (hypotf(pos[0] - before->pos[0], pos[1] - before->pos[1]) > 2.0f * step + 1.0f);
+
+    const FlagType* flag = shot->getFlag();
+    Entry entry;
+    entry.owner = player;
+    entry.slot = s;
+    entry.pos[0] = pos[0];
+    entry.pos[1] = pos[1];
+    entry.cell = getCellCoord(pos[0]) + size * getCellCoord(pos[1]);
+    entry.wide = jumped || step > cellSize ||
+      flag == Flags::Laser || flag == Flags::Thief || flag == Flags::ShockWave;
+    if (!entry.wide && step > maxStep)
+      maxStep = step;
+    entries.push_back(entry);
+  }
+}
+
+int			ShotGrid::getCellCoord(float coord) const
+{
+  // shots outside the world go in the border cells
+  const int cell = (int)floorf((coord - origin) / cellSize);
+  return std::min(std::max(cell, 0), size - 1);
+}
+
+void			ShotGrid::getCellRange(float xMin, float yMin,
+					       float xMax, float yMax,
+					       int range[4]) const
+{
+  range[0] = getCellCoord(xMin);
+  range[1] = getCellCoord(yMin);
+  range[2] = getCellCoord(xMax);
+  range[3] = getCellCoord(yMax);
+}
+
+void			ShotGrid::findShotsNear(const float* pos, float radius,
+						std::vector<Shot>& shots) const
+{
+  shots.clear();
+  if (size == 0)
+    return;
+
+  // the shots may have moved a step since build()
+  const float reach = radius + maxStep;
+  int range[4];
+  getCellRange(pos[0] - reach, pos[1] - reach, pos[0] + reach, pos[1] + reach, range);
+  for (int y = range[1]; y <= range[3]; y++) {
+    for (int x = range[0]; x <= range[2]; x++) {
+      const int cell = x + size * y;
+      for (int i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+	const Entry& entry = entries[i];
+	if (fabsf(entry.pos[0] - pos[0]) > reach || fabsf(entry.pos[1] - pos[1]) > reach)
+	  continue;
+	Shot shot;
+	shot.owner = entry.owner;
+	shot.path = entry.owner->getShot(entry.slot);
+	if (shot.path && !shot.path->isExpired())
+	  shots.push_back(shot);
+      }
+    }
+  }
+}
+
+void			ShotGrid::findShooters(const BaseLocalPlayer* tank,
+					       std::vector<Player*>& shooters) const
+{
+  shooters.clear();
+  if (size == 0)
+    return;
+
+  // the box the tank swept last frame, grown by the distance a shot moves
+  const float (*bbox)[3] = tank->getLastMotionBBox();
+  const float reach = maxStep + 1.0f;
+  const float xMin = bbox[0][0] - reach, yMin = bbox[0][1] - reach;
+  const float xMax = bbox[1][0] + reach, yMax = bbox[1][1] + reach;
+  int range[4];
+  getCellRange(xMin, yMin, xMax, yMax, range);
+  for (int y = range[1]; y <= range[3]; y++) {
+    for (int x = range[0]; x <= range[2]; x++) {
+      const int cell = x + size * y;
+      for (int i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+	const Entry& entry = entries[i];
+	if (entry.wide || entry.pos[0] < xMin || entry.pos[0] > xMax ||
+	    entry.pos[1] < yMin || entry.pos[1] > yMax)
+	  continue;
+	if (std::find(shooters.begin(), shooters.end(), entry.owner) == shooters.end())
+	  shooters.push_back(entry.owner);
+      }
+    }
+  }
+
+  for (unsigned int i = 0; i < wide.size(); i++) {
+    Player* owner = entries[wide[i]].owner;
+    if (std::find(shooters.begin(), shooters.end(), owner) == shooters.end())
+      shooters.push_back(owner);
+  }
+}
+
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
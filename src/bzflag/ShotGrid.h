@@ -0,0 +1,138 @@
+/* bzflag
+ * Copyright (c) 1993-2011 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* ShotGrid:
+ *	A uniform grid of the live shots of the local player, the remote
+ *	players and the world weapons, built once per frame, so that the
+ *	hit checks and the threat checks only look at the shots near a tank.
+ *
+ *	The grid remembers each shot by its player and slot, and looks the
+ *	ShotPath up again when asked: shots fired or removed after build()
+ *	never leave it pointing at a deleted ShotPath.
+ *
+ *	A shot is found by its position at build() time, plus the largest
+ *	distance an ordinary shot moves in a frame.  The shots whose path
+ *	over the frame may be far from their position are "wide", and every
+ *	hit query gets them: lasers, thief and shock wave shots, shots seen
+ *	for the first time (a remote shot can arrive late and sweep from its
+ *	muzzle), and shots that jumped since the last frame (teleporters).
+ */
+
+#ifndef	BZF_SHOT_GRID_H
+#define	BZF_SHOT_GRID_H
+
+#include "common.h"
+
+/* system interface headers */
+#include <vector>
+
+/* common interface headers */
+#include "Singleton.h"
+
+/* local interface headers */
+#include "Player.h"
+#include "BaseLocalPlayer.h"
+#include "ShotPath.h"
+
+#define SHOTGRID (ShotGrid::instance())
+
+
+class ShotGrid : public Singleton<ShotGrid> {
+public:
+  struct Shot {
+    Player*	owner;
+    ShotPath*	path;
+  };
+
+  /** index the shots of the current world.  Call after the shots moved
+   * this frame, and before any query.
+   * @param dt The time since the last frame.
+   */
+  void		build(float dt);
+
+  /** forget every shot (e.g. when leaving the game)
+   */
+  void		clear();
+
+  /** find the live shots within a square around a position (the caller
+   * checks the exact distance)
+   * @param pos The position, only x and y are used.
+   * @param radius Half the side of the square.
+   * @param shots Gets the shots, cleared first.
+   */
+  void		findShotsNear(const float* pos, float radius,
+			      std::vector<Shot>& shots) const;
+
+  /** find the players (and the world weapons) with a shot that may have
+   * hit the tank during the last frame, i.e. the ones worth a checkHit()
+   * @param tank The tank, which must have moved this frame.
+   * @param shooters Gets the players, each once, cleared first.
+   */
+  void		findShooters(const BaseLocalPlayer* tank,
+			     std::vector<Player*>& shooters) const;
+
+  int		getShotCount() const { return (int)entries.size(); }
+  int		getWideShotCount() const { return (int)wide.size(); }
+
+protected:
+  friend class Singleton<ShotGrid>;
+
+private:
+  ShotGrid();
+  ~ShotGrid();
+
+  struct Entry {
+    Player*	owner;
+    int		slot;
+    int		cell;
+    float	pos[2];
+    bool	wide;
+  };
+
+  // where a shot was at the last build(), to tell the shots that jumped
+  struct Tracked {
+    const Player* owner;
+    int		slot;
+    unsigned int shotId;
+    float	pos[2];
+    bool operator<(const Tracked& t) const {
+      return (owner < t.owner) || (owner == t.owner && slot < t.slot);
+    }
+  };
+
+  void		addShots(Player* player);
+  int		getCellCoord(float coord) const;
+  void		getCellRange(float xMin, float yMin, float xMax, float yMax,
+			     int range[4]) const;
+
+  std::vector<Entry>	entries;	// sorted by cell
+  std::vector<int>	cellStart;	// the entries of cell c are [cellStart[c], cellStart[c+1])
+  std::vector<int>	wide;		// the indices of the wide entries
+  std::vector<Tracked>	tracked;	// this frame's shots, sorted
+  std::vector<Tracked>	previous;	// last frame's shots, sorted
+  int			size;		// cells per side
+  float			cellSize;
+  float			origin;		// x and y of the corner of cell 0
+  float			maxStep;	// farthest an indexed shot moves in a frame
+  float			frameTime;
+};
+
+
+#endif // BZF_SHOT_GRID_H
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
@@ -74,6 +74,7 @@
 #include "ActionBinding.h"
 #include "ServerStartMenu.h"
 #include "callbacks.h"
+#include "yagsbpl/PlannerBenchmark.h"
 #include "playing.h"
 #include "sound.h"
 #include "playing.h"
@@ -191,6 +192,7 @@ static void		usage()
 	" [-motd <motd-url>] [-nomotd]"
 	" [-multisample]"
 #ifdef ROBOT
+	" [-plannerbench <world> [queries] [seed] [worldSize]]"
 	" [-solo <num-robots>]"
 #endif
 	" [-team {red|green|blue|purple|rogue|observer}]"
@@ -859,6 +861,12 @@ int			main(int argc, char** argv)
   // use UDP? yes
   startupInfo.useUDPconnection=true;
 
+#ifdef ROBOT
+  // headless planner benchmark: no display, no server
+  if (argc > 1 && strcmp(argv[1], "-plannerbench") == 0)
+    return bail(runPlannerBenchmark(argc - 2, argv + 2));
+#endif
+
   // parse arguments
   parse(argc, argv);
 
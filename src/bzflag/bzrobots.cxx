@@ -0,0 +1,294 @@
+/* bzflag
+ * Copyright (c) 1993-2011 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* bzrobots:
+ *	A robot farm without a display, for load tests: joins a number of
+ *	robot tanks to a server and runs their AI at a fixed tick.
+ *
+ *	The farm joins as an observer first: that link downloads the world
+ *	and gets the game's messages (the server sends none of the game's
+ *	state to robots), see observer.cxx.  Then the robots join over that
+ *	same link, like the robots of the bzflag client, or on links of their
+ *	own when the server cannot take them over the observer's, see
+ *	robots.cxx.
+ */
+
+// common header
+#include "common.h"
+
+/* system implementation headers */
+#include <assert.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* common implementation headers */
+#include "Address.h"
+#include "BZDBCache.h"
+#include "BZDBLocal.h"
+#include "ErrorHandler.h"
+#include "GameTime.h"
+#include "StateDatabase.h"
+#include "TextUtils.h"
+#include "TimeKeeper.h"
+#include "bzfio.h"
+#include "bzsignal.h"
+#include "global.h"
+#include "version.h"
+
+/* local implementation headers */
+#include "World.h"
+#include "defaultBZDB.h"
+#include "observer.h"
+#include "robots.h"
+
+#ifndef ROBOT
+#  error "bzrobots needs the robots: configure with --enable-robots"
+#endif
+
+int			debugLevel = 0;
+
+static const char*	argv0;
+static const char*	motto = "bzrobots";
+
+
+static void		usage()
+{
+  printFatalError("usage: %s"
+	" [-callsign <prefix>]"
+	" [-d | -debug]"
+	" [-robots <count>]"
+	" [-team {red|green|blue|purple|rogue|auto}]"
+	" [-tick <updates-per-second>]"
+	" [-time <seconds>]"
+	" server[:port]\n\nExiting.", argv0);
+  exit(1);
+}
+
+static void		checkArgc(int& i, int argc, const char* option)
+{
+  if ((i+1) == argc) {
+    printFatalError("Missing argument for %s\n", option);
+    usage();
+  }
+  i++; // just skip the option argument string
+}
+
+static TeamColor	parseTeam(const char* name)
+{
+  if (strcmp(name, "auto") == 0 || strcmp(name, "automatic") == 0)
+    return AutomaticTeam;
+  if (strcmp(name, "red") == 0)
+    return RedTeam;
+  if (strcmp(name, "green") == 0)
+    return GreenTeam;
+  if (strcmp(name, "blue") == 0)
+    return BlueTeam;
+  if (strcmp(name, "purple") == 0)
+    return PurpleTeam;
+  if (strcmp(name, "rogue") == 0)
+    return RogueTeam;
+  return NoTeam;
+}
+
+static void		stopFarm(int sig)
+{
+  bzSignal(sig, SIG_PF(stopFarm));
+  quitGame();
+}
+
+//
+// the farm
+//
+
+static void		runRobots(float tickRate, double duration)
+{
+  const double period = 1.0 / tickRate;
+  int frames = 0, lateFrames = 0;
+  double workTime = 0.0, maxWorkTime = 0.0;
+
+  TimeKeeper::setTick();
+  const TimeKeeper start = TimeKeeper::getTick();
+  while (!isQuitting() && !hasServerError() && numRobots > 0 &&
+	 (duration <= 0.0 || TimeKeeper::getCurrent() - start < duration)) {
+    BZDBCache::update();
+
+    // set this step game time
+    GameTime::setStepTime();
+
+    // get delta time
+    TimeKeeper prevTime = TimeKeeper::getTick();
+    TimeKeeper::setTick();
+    const float dt = float(TimeKeeper::getTick() - prevTime);
+
+    // the game, as the server tells it
+    readServer();
+    updatePlayers(dt);
+
+    // the robots in it
+    updateRobots(dt, !isGameOver());
+    checkRobotEnvironment();
+    sendRobotUpdates();
+
+    updateFlags(dt);
+
+    // keep the tick: sleep what is left of the frame
+    const double work = TimeKeeper::getCurrent() - TimeKeeper::getTick();
+    frames++;
+    workTime += work;
+    if (work > maxWorkTime)
+      maxWorkTime = work;
+    if (work > period)
+      lateFrames++;
+    else
+      TimeKeeper::sleep(period - work);
+  }
+
+  if (frames > 0)
+    printf("%d robots, %d frames at %g Hz: %.2f ms per frame on average,"
+	   " %.2f ms at most, %d frames late\n", numRobots, frames, tickRate,
+	   1000.0 * workTime / frames, 1000.0 * maxWorkTime, lateFrames);
+}
+
+int			main(int argc, char** argv)
+{
+  argv0 = argv[0];
+
+  int robotCount = 1;
+  float tickRate = 30.0f;
+  double duration = 0.0;
+  const char* prefix = "bzrobot";
+  TeamColor team = AutomaticTeam;
+  const char* serverName = NULL;
+  int serverPort = ServerPort;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-callsign") == 0) {
+      checkArgc(i, argc, argv[i]);
+      prefix = argv[i];
+    }
+    else if (strcmp(argv[i], "-robots") == 0) {
+      checkArgc(i, argc, argv[i]);
+      robotCount = atoi(argv[i]);
+      if (robotCount < 1 || robotCount > MAX_ROBOTS) {
+	printFatalError("Invalid argument for %s, at most %d.", argv[i-1], MAX_ROBOTS);
+	usage();
+      }
+    }
+    else if (strcmp(argv[i], "-team") == 0) {
+      checkArgc(i, argc, argv[i]);
+      team = parseTeam(argv[i]);
+      if (team == NoTeam) {
+	printFatalError("Invalid argument for %s.", argv[i-1]);
+	usage();
+      }
+    }
+    else if (strcmp(argv[i], "-tick") == 0) {
+      checkArgc(i, argc, argv[i]);
+      tickRate = (float)atof(argv[i]);
+      if (tickRate <= 0.0f) {
+	printFatalError("Invalid argument for %s.", argv[i-1]);
+	usage();
+      }
+    }
+    else if (strcmp(argv[i], "-time") == 0) {
+      checkArgc(i, argc, argv[i]);
+      duration = atof(argv[i]);
+    }
+    else if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "-debug") == 0) {
+      debugLevel++;
+    }
+    else if (argv[i][0] != '-' && i == argc - 1) {
+      char* portNumber = strchr(argv[i], ':');
+      if (portNumber) {
+	*portNumber++ = '\0';
+	serverPort = atoi(portNumber);
+	if (serverPort < 1 || serverPort > 65535) {
+	  printFatalError("Bad port %s.", portNumber);
+	  usage();
+	}
+      }
+      serverName = argv[i];
+    }
+    else {
+      printFatalError("Unknown option %s.", argv[i]);
+      usage();
+    }
+  }
+  if (!serverName)
+    usage();
+
+#ifdef _WIN32
+  // startup winsock
+  static const int major = 2, minor = 2;
+  WSADATA wsaData;
+  if (WSAStartup(MAKEWORD(major, minor), &wsaData)) {
+    printFatalError("Failed to initialize winsock.  Terminating.\n");
+    return 1;
+  }
+#endif
+
+  // initialize global objects and classes
+  bzfsrand((unsigned int)time(0));
+
+  // set default DB entries
+  for (unsigned int gi = 0; gi < numGlobalDBItems; ++gi) {
+    assert(globalDBItems[gi].name != NULL);
+    if (globalDBItems[gi].value != NULL) {
+      BZDB.set(globalDBItems[gi].name, globalDBItems[gi].value);
+      BZDB.setDefault(globalDBItems[gi].name, globalDBItems[gi].value);
+    }
+    BZDB.setPersistent(globalDBItems[gi].name, globalDBItems[gi].persistent);
+    BZDB.setPermission(globalDBItems[gi].name, globalDBItems[gi].permission);
+  }
+  BZDBCache::init();
+  BZDBLOCAL.init();
+  Flags::init();
+  loadBZDBDefaults();
+
+  bzSignal(SIGINT, SIG_PF(stopFarm));
+  bzSignal(SIGTERM, SIG_PF(stopFarm));
+
+  int status = 1;
+  const Address serverAddress = Address::getHostAddress(serverName);
+  if (serverAddress.isAny()) {
+    printError(TextUtils::format("Server %s not found", serverName));
+  }
+  else if (joinGame(serverAddress, serverPort, prefix, motto)) {
+    if (BZDB.isTrue(StateDatabase::BZDB_DISABLEBOTS)) {
+      printError("Robots are prohibited on this server");
+    }
+    else if (joinGameRobots(serverAddress, serverPort, robotCount, prefix,
+			    motto, team) && numRobots > 0) {
+      buildRobotPlanningData();
+      runRobots(tickRate, duration);
+      status = hasServerError() ? 1 : 0;
+    }
+  }
+  leaveGame();
+
+#ifdef _WIN32
+  WSACleanup();
+#endif
+  return status;
+}
+
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
@@ -41,6 +41,10 @@
 #include "playing.h"
 #include "HUDRenderer.h"
 #include "HUDui.h"
+#include "yagsbpl/PlannerComparison.h"
+#include "yagsbpl/PathCache.h"
+#include "yagsbpl/PlanningScheduler.h"
+#include "yagsbpl/SearchStatistics.h"
 
 /** jump
  */
@@ -165,6 +169,66 @@ static std::string cmdIconify(const std::string&,
 
 /** mouse box size flags
  */
+static std::string cmdPathCache(const std::string&,
+				const CommandManager::ArgList& args, bool*)
+{
+  if (args.size() > 1 || (args.size() == 1 && args[0] != "reset"))
+    return "usage: pathcache [reset]";
+  if (args.size() == 1) {
+    PATHCACHE.resetStats();
+    return std::string();
+  }
+
+  const long lookups = PATHCACHE.getLookupCount();
+  const long hits = PATHCACHE.getHitCount();
+  const float hitRate = (lookups > 0) ? (100.0f * hits / lookups) : 0.0f;
+  controlPanel->addMessage(TextUtils::format("path cache: %d paths, %ld lookups, %ld hits (%.1f%%)",
+					     PATHCACHE.getEntryCount(), lookups, hits, hitRate));
+  controlPanel->addMessage(TextUtils::format("  %ld reversed, %ld sub-paths, %ld expansions saved",
+					     PATHCACHE.getReversedHitCount(),
+					     PATHCACHE.getSubPathHitCount(),
+					     PATHCACHE.getSavedExpansions()));
+  return std::string();
+}
+
+static std::string cmdPlanning(const std::string&,
+			       const CommandManager::ArgList& args, bool*)
+{
+  if (args.size() > 1 || (args.size() == 1 && args[0] != "reset"))
+    return "usage: planning [reset]";
+  if (args.size() == 1) {
+    PLANNINGSCHEDULER.resetStats();
+    return std::string();
+  }
+
+  const long frames = PLANNINGSCHEDULER.getFrameCount();
+  const double average = (frames > 0) ? (double)PLANNINGSCHEDULER.getTotalExpansions() / frames : 0.0;
+  controlPanel->addMessage(TextUtils::format("robot planning: %d/%d expansions last frame, %.1f average, %d max",
+					     PLANNINGSCHEDULER.getLastExpansions(),
+					     PLANNINGSCHEDULER.getLastBudget(), average,
+					     PLANNINGSCHEDULER.getMaxExpansions()));
+  controlPanel->addMessage(TextUtils::format("  %d searches waiting, %ld of %ld frames used the whole budget",
+					     PLANNINGSCHEDULER.getPendingCount(),
+					     PLANNINGSCHEDULER.getBusyFrameCount(), frames));
+  return std::string();
+}
+
+static std::string cmdSearchStats(const std::string&,
+				  const CommandManager::ArgList& args, bool*)
+{
+  if (args.size() > 1 || (args.size() == 1 && args[0] != "reset"))
+    return "usage: searchstats [reset]";
+  if (args.size() == 1) {
+    SEARCHSTATISTICS.reset();
+    return std::string();
+  }
+
+  std::vector<std::string> report = SEARCHSTATISTICS.report();
+  for (unsigned int i = 0; i < report.size(); i++)
+    controlPanel->addMessage(report[i]);
+  return std::string();
+}
+
 static std::string cmdMouseBox(const std::string&,
 			       const CommandManager::ArgList& args, bool*);
 
@@ -178,6 +242,17 @@ static std::string cmdMouseGrab(const std::string&,
 static std::string cmdToggleFS(const std::string&,
 			       const CommandManager::ArgList& args, bool*);
 
+/** compare the robot path planners on the current world
+ */
+static std::string cmdPathPlanners(const std::string&,
+				   const CommandManager::ArgList& args, bool*);
+static std::string cmdPathCache(const std::string&,
+				const CommandManager::ArgList& args, bool*);
+static std::string cmdPlanning(const std::string&,
+			       const CommandManager::ArgList& args, bool*);
+static std::string cmdSearchStats(const std::string&,
+				  const CommandManager::ArgList& args, bool*);
+
 
 const struct CommandListItem commandList[] = {
   { "fire",	&cmdFire,	"fire:  fire a shot" },
@@ -200,6 +275,10 @@ const struct CommandListItem commandList[] = {
   { "mousebox", &cmdMouseBox, "mousebox <size>:  change the mousebox size"},
   { "mousegrab", &cmdMouseGrab, "mousegrab: toggle exclusive mouse mode" },
   { "fullscreen", &cmdToggleFS, "fullscreen: toggle fullscreen mode" },
+  { "pathplanners", &cmdPathPlanners, "pathplanners [queries]:  compare the robot path planners on this world" },
+  { "pathcache", &cmdPathCache, "pathcache [reset]:  show the robot path cache hit rate and saved expansions" },
+  { "planning", &cmdPlanning, "planning [reset]:  show the robot planning budget used per frame" },
+  { "searchstats", &cmdSearchStats, "searchstats [reset]:  show histograms of the robot path search counters" },
   { "autopilot",&cmdAutoPilot,	"autopilot:  set/unset autopilot bot code" },
   { "radarZoom", &cmdRadarZoom, "radarZoom {in/out}: change maxRadar range"},
   { "viewZoom",  &cmdViewZoom,  "viewZoom {in/out/toggle}: change view angle"},
@@ -221,6 +300,26 @@ static std::string cmdToggleFS(const std::string&,
   return std::string();
 }
 
+static std::string cmdPathPlanners(const std::string&,
+				   const CommandManager::ArgList& args, bool*)
+{
+  if (args.size() > 1)
+    return "usage: pathplanners [queries]";
+  int queries = 100;
+  if (args.size() == 1) {
+    queries = atoi(args[0].c_str());
+    if (queries <= 0)
+      return "bad number";
+  }
+  if (!World::getWorld())
+    return "pathplanners: not in a game";
+
+  std::vector<std::string> report = comparePathPlanners(queries, 1);
+  for (unsigned int i = 0; i < report.size(); i++)
+    controlPanel->addMessage(report[i]);
+  return std::string();
+}
+
 static std::string cmdMouseBox(const std::string&,
 			       const CommandManager::ArgList& args, bool*)
 {
@@ -370,7 +469,7 @@ static std::string cmdRestart(const std::string&,
   LocalPlayer *myTank = LocalPlayer::getMyTank();
   if (myTank != NULL)
     if (!gameOver && !myTank->isSpawning() && (myTank->getTeam() != ObserverTeam) && !myTank->isAlive() && !myTank->isExploding()) {
-      serverLink->sendAlive();
+      serverLink->sendAlive(myTank->getId());
       myTank->setSpawning(true);
       CommandManager::ArgList zoomArgs;
       std::string resetArg = "reset";
@@ -0,0 +1,84 @@
+/* bzflag
+ * Copyright (c) 1993-2011 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* headless:
+ *	What bzrobots links in place of the sound, the force feedback, the
+ *	effects and the explosions of the bzflag client: the tanks and their
+ *	shots call them, and nobody is there to hear or see them.
+ */
+
+// common header
+#include "common.h"
+
+/* system implementation headers */
+#include <string>
+
+/* local implementation headers */
+#include "ForceFeedback.h"
+#include "effectsRenderer.h"
+#include "sound.h"
+
+
+//
+// sound
+//
+
+void			openSound(const char*) { }
+void			closeSound() { }
+bool			isSoundOpen() { return false; }
+void			moveSoundReceiver(float, float, float, float, int) { }
+void			speedSoundReceiver(float, float, float) { }
+void			playSound(int, const float[3], bool, bool) { }
+void			playWorldSound(int, const float[3], bool) { }
+void			playLocalSound(int) { }
+void			playLocalSound(std::string) { }
+void			setSoundVolume(int) { }
+int			getSoundVolume() { return 0; }
+void			updateSound() { }
+
+//
+// force feedback
+//
+
+void			ForceFeedback::death() { }
+void			ForceFeedback::solidMatterFriction() { }
+void			ForceFeedback::shotFired() { }
+void			ForceFeedback::laserFired() { }
+void			ForceFeedback::shockwaveFired() { }
+
+//
+// effects (landing and firing of the local tanks)
+//
+
+EffectsRenderer::EffectsRenderer() { }
+EffectsRenderer::~EffectsRenderer() { }
+void			EffectsRenderer::addLandEffect(const float*, const float*, float) { }
+void			EffectsRenderer::addShotEffect(const float*, const float*, float,
+						       const float*, int) { }
+
+//
+// explosions (declared in playing.h, which the shots include)
+//
+
+bool			addExplosion(const float*, float, float, bool) { return false; }
+void			addTankExplosion(const float*) { }
+void			addShotExplosion(const float*) { }
+void			addShotPuff(const float*, float, float) { }
+
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
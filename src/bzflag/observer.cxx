@@ -0,0 +1,662 @@
+/* bzflag
+ * Copyright (c) 1993-2011 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+// interface header
+#include "observer.h"
+
+/* system implementation headers */
+#include <string>
+
+/* common implementation headers */
+#include "CollisionManager.h"
+#include "ErrorHandler.h"
+#include "GameTime.h"
+#include "Protocol.h"
+#include "ShotUpdate.h"
+#include "StateDatabase.h"
+#include "Team.h"
+#include "TextUtils.h"
+#include "TimeKeeper.h"
+#include "bzfio.h"
+
+/* local implementation headers */
+#include "RemotePlayer.h"
+#include "Roster.h"
+#include "ServerLink.h"
+#include "ShotGrid.h"
+#include "World.h"
+#include "WorldBuilder.h"
+#include "robots.h"
+#include "yagsbpl/OccupancyGrid.h"
+
+// how long to wait for the server while joining, in seconds
+static const double	joinTimeout = 30.0;
+
+static ServerLink*	serverLink = NULL;
+static World*		world = NULL;
+static WorldBuilder*	worldBuilder = NULL;
+static std::string	worldDatabase;		// the world as it downloads
+static Team*		teams = NULL;
+static bool		entered = false;
+static bool		serverError = false;
+static bool		gameOver = false;
+static volatile bool	quitting = false;
+
+//
+// the players
+//
+
+static void		addPlayer(PlayerId id, void* msg)
+{
+  uint16_t team, type, wins, losses, tks;
+  char callsign[CallSignLen];
+  char motto[MottoLen];
+  msg = nboUnpackUShort(msg, type);
+  msg = nboUnpackUShort(msg, team);
+  msg = nboUnpackUShort(msg, wins);
+  msg = nboUnpackUShort(msg, losses);
+  msg = nboUnpackUShort(msg, tks);
+  msg = nboUnpackString(msg, callsign, CallSignLen);
+  msg = nboUnpackString(msg, motto, MottoLen);
+
+  const int i = id;
+  if (remotePlayers[i]) {
+    logDebugMessage(1, "ignored player %d, who is already here\n", i);
+    return;
+  }
+  if (i >= curMaxPlayers) {
+    curMaxPlayers = i + 1;
+    world->setCurMaxPlayers(curMaxPlayers);
+  }
+  if (PlayerType(type) == TankPlayer || PlayerType(type) == ComputerPlayer) {
+    remotePlayers[i] = new RemotePlayer(id, TeamColor(team), callsign, motto,
+					PlayerType(type));
+    remotePlayers[i]->changeScore(short(wins), short(losses), short(tks));
+  }
+
+  // the server picks the team of a robot that asked for any
+  setRobotTeam(id, TeamColor(team));
+}
+
+static void		removePlayer(PlayerId id)
+{
+  int playerIndex = lookupPlayerIndex(id);
+  if (playerIndex < 0)
+    return;
+
+  Player* player = remotePlayers[playerIndex];
+  for (int i = 0; i < numRobots; i++)
+    if (robots[i] && robots[i]->getTarget() == player)
+      robots[i]->setTarget(NULL);
+
+  delete remotePlayers[playerIndex];
+  remotePlayers[playerIndex] = NULL;
+  while ((playerIndex >= 0)
+	 && (playerIndex+1 == curMaxPlayers)
+	 && (remotePlayers[playerIndex] == NULL)) {
+    playerIndex--;
+    curMaxPlayers--;
+  }
+  world->setCurMaxPlayers(curMaxPlayers);
+}
+
+static void		setFlagLocalAndRemote(Player* tank, FlagType* ftype)
+{
+  tank->setFlag(ftype);
+  setRobotFlag(tank->getId(), ftype);
+}
+
+//
+// message handling
+//
+
+static void		handleServerMessage(uint16_t code, uint16_t len, void* msg)
+{
+  switch (code) {
+    case MsgSuperKill:
+      printError("Server forced a disconnect");
+      serverError = true;
+      break;
+
+    case MsgReject: {
+      uint16_t rejcode;
+      char buffer[MessageLen];
+      void* buf = nboUnpackUShort(msg, rejcode);
+      nboUnpackString(buf, buffer, MessageLen);
+      buffer[MessageLen - 1] = '\0';
+      printError(buffer);
+      serverError = true;
+      break;
+    }
+
+    case MsgNegotiateFlags:
+      if (len > 0) {
+	printError("The server has flags this client does not know");
+	serverError = true;
+	break;
+      }
+      serverLink->send(MsgWantSettings, 0, NULL);
+      break;
+
+    case MsgGameSettings:
+      delete worldBuilder;
+      worldBuilder = new WorldBuilder;
+      worldBuilder->unpackGameSettings(msg);
+      serverLink->send(MsgWantWHash, 0, NULL);
+      break;
+
+    case MsgWantWHash:
+      // without a world cache, download the world whatever its hash
+    case MsgGetWorld: {
+      uint32_t bytesLeft = 1;
+      if (code == MsgGetWorld) {
+	void* buf = nboUnpackUInt(msg, bytesLeft);
+	worldDatabase.append((const char*)buf, len - 4);
+      }
+      if (bytesLeft > 0) {
+	// ask for the next chunk
+	char message[MaxPacketLen];
+	nboPackUInt(message, (uint32_t)worldDatabase.size());
+	serverLink->send(MsgGetWorld, sizeof(uint32_t), message);
+	break;
+      }
+      if (!worldBuilder || !worldBuilder->unpack((void*)worldDatabase.data())) {
+	printError("Error unpacking world database");
+	serverError = true;
+	break;
+      }
+      world = worldBuilder->getWorld();
+      delete worldBuilder;
+      worldBuilder = NULL;
+      worldDatabase.clear();
+      break;
+    }
+
+    case MsgGameTime:
+      GameTime::unpack(msg);
+      GameTime::update();
+      break;
+
+    case MsgTimeUpdate: {
+      int32_t timeLeft;
+      nboUnpackInt(msg, timeLeft);
+      if (timeLeft == 0) {
+	gameOver = true;
+	explodeRobots();
+      }
+      break;
+    }
+
+    case MsgScoreOver:
+      gameOver = true;
+      explodeRobots();
+      break;
+
+    case MsgSetVar:
+      ServerLink::readSetVars(msg);
+      break;
+
+    case MsgAddPlayer: {
+      PlayerId id;
+      msg = nboUnpackUByte(msg, id);
+      if (id == serverLink->getId())
+	entered = true;
+      else
+	addPlayer(id, msg);
+      break;
+    }
+
+    case MsgNewPlayer: {
+      uint8_t robot;
+      PlayerId id;
+      msg = nboUnpackUByte(msg, robot);
+      msg = nboUnpackUByte(msg, id);
+      addRobot(robot, id);
+      break;
+    }
+
+    case MsgRobotMessage:
+      handleRobotMessage(len, msg);
+      break;
+
+    case MsgRemovePlayer: {
+      PlayerId id;
+      nboUnpackUByte(msg, id);
+      removeRobot(id);
+      removePlayer(id);
+      break;
+    }
+
+    case MsgFlagUpdate: {
+      uint16_t count;
+      uint16_t flagIndex;
+      msg = nboUnpackUShort(msg, count);
+      for (int i = 0; i < count; i++) {
+	msg = nboUnpackUShort(msg, flagIndex);
+	msg = world->getFlag(int(flagIndex)).unpack(msg);
+	world->initFlag(int(flagIndex));
+      }
+      break;
+    }
+
+    case MsgTeamUpdate: {
+      uint8_t numTeams;
+      uint16_t team;
+      msg = nboUnpackUByte(msg, numTeams);
+      for (int i = 0; i < numTeams; i++) {
+	msg = nboUnpackUShort(msg, team);
+	msg = teams[int(team)].unpack(msg);
+      }
+      break;
+    }
+
+    case MsgAlive: {
+      PlayerId id;
+      float pos[3], forward;
+      msg = nboUnpackUByte(msg, id);
+      msg = nboUnpackVector(msg, pos);
+      msg = nboUnpackFloat(msg, forward);
+      const int playerIndex = lookupPlayerIndex(id);
+      if (playerIndex < 0)
+	break;
+
+      restartRobot(id, pos, forward);
+      static const float zero[3] = { 0.0f, 0.0f, 0.0f };
+      Player* tank = remotePlayers[playerIndex];
+      tank->setStatus(PlayerState::Alive);
+      tank->move(pos, forward);
+      tank->setVelocity(zero);
+      tank->setAngularVelocity(0.0f);
+      tank->setDeadReckoning();
+      break;
+    }
+
+    case MsgKilled: {
+      PlayerId victim, killer;
+      FlagType* flagType;
+      int16_t shotId, reason;
+      msg = nboUnpackUByte(msg, victim);
+      msg = nboUnpackUByte(msg, killer);
+      msg = nboUnpackShort(msg, reason);
+      msg = nboUnpackShort(msg, shotId);
+      msg = FlagType::unpack(msg, flagType);
+      RobotPlayer* victimRobot = findRobot(victim);
+      RobotPlayer* killerRobot = findRobot(killer);
+      Player* victimPlayer = lookupPlayer(victim);
+      Player* killerPlayer = lookupPlayer(killer);
+
+      if (victimRobot) {
+	if (victimRobot->isAlive())
+	  blowUpRobot(victimRobot, GotKilledMsg, killer);
+      }
+      else if (victimPlayer) {
+	victimPlayer->setExplode(TimeKeeper::getTick());
+      }
+
+      // terminate the shot
+      if (killerRobot && shotId >= 0)
+	killerRobot->endShot(shotId, true);
+
+      // blow up robots on victim's team if shot was genocide
+      if (world->allowTeams())
+	genocideRobots(victimPlayer, killerPlayer, int(shotId));
+      break;
+    }
+
+    case MsgGrabFlag: {
+      PlayerId id;
+      uint16_t flagIndex;
+      msg = nboUnpackUByte(msg, id);
+      msg = nboUnpackUShort(msg, flagIndex);
+      msg = world->getFlag(int(flagIndex)).unpack(msg);
+      Player* tank = lookupPlayer(id);
+      if (tank)
+	setFlagLocalAndRemote(tank, world->getFlag(flagIndex).type);
+      break;
+    }
+
+    case MsgDropFlag: {
+      PlayerId id;
+      uint16_t flagIndex;
+      msg = nboUnpackUByte(msg, id);
+      msg = nboUnpackUShort(msg, flagIndex);
+      msg = world->getFlag(int(flagIndex)).unpack(msg);
+      Player* tank = lookupPlayer(id);
+      if (tank && tank->getFlag() != Flags::Null)
+	setFlagLocalAndRemote(tank, Flags::Null);
+      break;
+    }
+
+    case MsgCaptureFlag: {
+      PlayerId id;
+      uint16_t flagIndex, team;
+      msg = nboUnpackUByte(msg, id);
+      msg = nboUnpackUShort(msg, flagIndex);
+      msg = nboUnpackUShort(msg, team);
+      if (flagIndex >= world->getMaxFlags())
+	break;
+      const FlagType* capturedFlag = world->getFlag(int(flagIndex)).type;
+      if (capturedFlag == Flags::Null)
+	break;
+      Player* capturer = lookupPlayer(id);
+      if (capturer)
+	setFlagLocalAndRemote(capturer, Flags::Null);
+
+      // blow up the robots on the captured team
+      captureRobots(capturedFlag->flagTeam);
+      break;
+    }
+
+    case MsgTransferFlag: {
+      PlayerId fromId, toId;
+      uint16_t flagIndex;
+      msg = nboUnpackUByte(msg, fromId);
+      msg = nboUnpackUByte(msg, toId);
+      msg = nboUnpackUShort(msg, flagIndex);
+      msg = world->getFlag(int(flagIndex)).unpack(msg);
+      Player* fromTank = lookupPlayer(fromId);
+      Player* toTank = lookupPlayer(toId);
+      if (fromTank)
+	setFlagLocalAndRemote(fromTank, Flags::Null);
+      if (toTank)
+	setFlagLocalAndRemote(toTank, world->getFlag(flagIndex).type);
+      break;
+    }
+
+    case MsgNewRabbit: {
+      PlayerId id;
+      nboUnpackUByte(msg, id);
+      for (int i = 0; i < curMaxPlayers; i++) {
+	if (!remotePlayers[i])
+	  continue;
+	remotePlayers[i]->setHunted(false);
+	if (remotePlayers[i]->getTeam() != ObserverTeam)
+	  remotePlayers[i]->changeTeam(i == id ? RabbitTeam : HunterTeam);
+      }
+      setRobotRabbit(id);
+      break;
+    }
+
+    case MsgShotBegin: {
+      FiringInfo firingInfo;
+      msg = firingInfo.unpack(msg);
+      const int shooterid = firingInfo.shot.player;
+      if (shooterid == ServerPlayer) {
+	world->getWorldWeapons()->addShot(firingInfo);
+      }
+      else if (shooterid < curMaxPlayers && remotePlayers[shooterid] &&
+	       remotePlayers[shooterid]->getId() == shooterid) {
+	remotePlayers[shooterid]->addShot(firingInfo);
+      }
+      break;
+    }
+
+    case MsgShotEnd: {
+      PlayerId id;
+      int16_t shotId;
+      uint16_t reason;
+      msg = nboUnpackUByte(msg, id);
+      msg = nboUnpackShort(msg, shotId);
+      msg = nboUnpackUShort(msg, reason);
+      RobotPlayer* robot = findRobot(id);
+      if (robot) {
+	robot->endShot(int(shotId), false, reason == 0);
+      }
+      else {
+	Player* player = lookupPlayer(id);
+	if (player)
+	  player->endShot(int(shotId), false, reason == 0);
+      }
+      break;
+    }
+
+    case MsgTeleport: {
+      PlayerId id;
+      uint16_t from, to;
+      msg = nboUnpackUByte(msg, id);
+      msg = nboUnpackUShort(msg, from);
+      msg = nboUnpackUShort(msg, to);
+      Player* tank = lookupPlayer(id);
+      if (tank)
+	tank->setTeleport(TimeKeeper::getTick(), short(from), short(to));
+      break;
+    }
+
+    case MsgPlayerUpdate:
+    case MsgPlayerUpdateSmall: {
+      float timestamp;
+      PlayerId id;
+      int32_t order;
+      void *buf = msg;
+      buf = nboUnpackFloat(buf, timestamp);
+      buf = nboUnpackUByte(buf, id);
+      Player* tank = lookupPlayer(id);
+      if (!tank) break;
+      nboUnpackInt(buf, order); // peek! don't update the msg pointer
+      if (order <= tank->getOrder()) break;
+      const short oldStatus = tank->getStatus();
+      tank->unpack(msg, code);
+      const short newStatus = tank->getStatus();
+      if ((oldStatus & short(PlayerState::Exploding)) == 0 &&
+	  (newStatus & short(PlayerState::Exploding)) != 0) {
+	// exploding before the killed message: set the explosion now
+	tank->setStatus(newStatus | short(PlayerState::Alive));
+	tank->setExplode(TimeKeeper::getTick());
+      }
+      break;
+    }
+
+    case MsgGMUpdate: {
+      ShotUpdate shot;
+      msg = shot.unpack(msg);
+      Player* tank = lookupPlayer(shot.player);
+      if (!tank) break;
+      RemoteShotPath* shotPath = (RemoteShotPath*)tank->getShot(shot.id);
+      if (shotPath) shotPath->update(shot, code, msg);
+      break;
+    }
+
+      // just echo lag ping message
+    case MsgLagPing:
+      serverLink->send(MsgLagPing, 2, msg);
+      break;
+  }
+}
+
+static bool		haveWorld()
+{
+  return world != NULL;
+}
+
+static bool		haveEntered()
+{
+  return entered;
+}
+
+static bool		haveRobots()
+{
+  return getPendingRobots() == 0;
+}
+
+// handle the observer's messages until done() or an error
+static bool		waitForServer(bool (*done)())
+{
+  char msg[MaxPacketLen];
+  uint16_t code, len;
+  const TimeKeeper start = TimeKeeper::getCurrent();
+  while (!done() && !serverError && !quitting) {
+    const int e = serverLink->read(code, len, msg, 100);
+    if (e == 1) {
+      handleServerMessage(code, len, msg);
+    }
+    else if (e < 0) {
+      printError("Server communication error");
+      serverError = true;
+    }
+    else if (TimeKeeper::getCurrent() - start > joinTimeout) {
+      printError("The server did not answer");
+      serverError = true;
+    }
+  }
+  return done() && !serverError;
+}
+
+void			readServer()
+{
+  char msg[MaxPacketLen];
+  uint16_t code, len;
+  int e = 0;
+
+  while (!serverError && (e = serverLink->read(code, len, msg, 0)) == 1)
+    handleServerMessage(code, len, msg);
+  if (e == -2) {
+    printError("Server communication error");
+    serverError = true;
+    return;
+  }
+  readRobotLinks();
+}
+
+//
+// joining and leaving
+//
+
+bool			joinGame(const Address& serverAddress, int port,
+				 const char* callsign, const char* motto)
+{
+  serverLink = new ServerLink(serverAddress, port);
+  if (serverLink->getState() != ServerLink::Okay) {
+    printError(TextUtils::format("Could not connect to the server (%d): %s",
+				 (int)serverLink->getState(),
+				 serverLink->getRejectionMessage().c_str()));
+    return false;
+  }
+  ServerLink::setServer(serverLink);
+
+  // get the world
+  serverLink->sendNegotiateFlags();
+  if (!waitForServer(haveWorld))
+    return false;
+
+  World::setWorld(world);
+  teams = world->getTeams();
+  curMaxPlayers = 0;
+  remotePlayers = world->getPlayers();
+
+  // watch the game
+  serverLink->sendEnter(TankPlayer, ObserverTeam, callsign, motto, "");
+  return waitForServer(haveEntered);
+}
+
+bool			joinGameRobots(const Address& serverAddress, int port,
+				       int count, const char* prefix,
+				       const char* motto, TeamColor team)
+{
+  joinRobots(serverLink, serverAddress, port, count, prefix, motto, team);
+  return waitForServer(haveRobots);
+}
+
+void			leaveGame()
+{
+  removeRobots();
+  stopRobots();
+
+  if (serverLink)
+    serverLink->send(MsgExit, 0, NULL);
+  World::setWorld(NULL);
+  delete world;
+  world = NULL;
+  remotePlayers = NULL;
+  curMaxPlayers = 0;
+  ServerLink::setServer(NULL);
+  delete serverLink;
+  serverLink = NULL;
+}
+
+//
+// the frame
+//
+
+void			updatePlayers(float dt)
+{
+  // see if the world collision grid needs to be updated
+  const bool collisionReload = COLLISIONMGR.needReload();
+  world->checkCollisionManager();
+  if (collisionReload)
+    OCCUPANCYGRID.build();
+
+  // update the shots, and index them for the hit and threat checks
+  int i;
+  for (i = 0; i < curMaxPlayers; i++)
+    if (remotePlayers[i])
+      remotePlayers[i]->updateShots(dt);
+  world->getWorldWeapons()->updateShots(dt);
+  SHOTGRID.build(dt);
+
+  // do dead reckoning on remote players
+  for (i = 0; i < curMaxPlayers; i++)
+    if (remotePlayers[i])
+      remotePlayers[i]->doDeadReckoning();
+}
+
+void			updateFlags(float dt)
+{
+  // adjust properties based on flags (dimensions, cloaking, etc...)
+  int i;
+  for (i = 0; i < curMaxPlayers; i++)
+    if (remotePlayers[i])
+      remotePlayers[i]->updateTank(dt, false);
+
+  for (i = 0; i < world->getMaxFlags(); i++) {
+    Flag& flag = world->getFlag(i);
+    if (flag.status == FlagOnTank) {
+      // position flag on top of tank
+      Player* tank = lookupPlayer(flag.owner);
+      if (tank) {
+	const float* pos = tank->getPosition();
+	flag.position[0] = pos[0];
+	flag.position[1] = pos[1];
+	flag.position[2] = pos[2] + tank->getDimensions()[2];
+      }
+    }
+    world->updateFlag(i, dt);
+  }
+}
+
+void			quitGame()
+{
+  quitting = true;
+}
+
+bool			isQuitting()
+{
+  return quitting;
+}
+
+bool			isGameOver()
+{
+  return gameOver;
+}
+
+bool			hasServerError()
+{
+  return serverError;
+}
+
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
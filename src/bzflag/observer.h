@@ -0,0 +1,75 @@
+/* bzflag
+ * Copyright (c) 1993-2011 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* observer:
+ *	The game as bzrobots sees it, without a display: a link that joins
+ *	as an observer, downloads the world, and keeps the other players,
+ *	their shots and the flags up to date from the server's messages.
+ *	What the messages do to the robots is up to robots.cxx.
+ */
+
+#ifndef	BZF_OBSERVER_H
+#define	BZF_OBSERVER_H
+
+#include "common.h"
+
+/* common interface headers */
+#include "Address.h"
+#include "global.h"
+
+
+/** connect, download the world and enter it as an observer
+ */
+bool			joinGame(const Address& serverAddress, int port,
+				 const char* callsign, const char* motto);
+
+/** join the robots (see joinRobots()) and wait for the server to
+ * answer for them
+ */
+bool			joinGameRobots(const Address& serverAddress, int port,
+				       int count, const char* prefix,
+				       const char* motto, TeamColor team);
+
+/** handle the server's messages, the observer's and the robots'
+ */
+void			readServer();
+
+/** the frame's shots and dead reckoning, before the robots look at them
+ */
+void			updatePlayers(float dt);
+
+/** the flags and what they do to the tanks, after the robots moved
+ */
+void			updateFlags(float dt);
+
+/** stop waiting for the server (safe from a signal handler)
+ */
+void			quitGame();
+
+bool			isQuitting();
+bool			isGameOver();
+bool			hasServerError();
+
+/** the robots and the observer leave, and the world goes
+ */
+void			leaveGame();
+
+
+#endif // BZF_OBSERVER_H
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
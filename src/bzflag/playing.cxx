@@ -77,13 +77,16 @@
 #include "HUDRenderer.h"
 #include "MainMenu.h"
 #include "motd.h"
+#include "PlayerGrid.h"
 #include "RadarRenderer.h"
 #include "Roaming.h"
 #include "RobotPlayer.h"
+#include "robots.h"
 #include "Roster.h"
 #include "SceneBuilder.h"
 #include "ScoreboardRenderer.h"
 #include "sound.h"
+#include "ShotGrid.h"
 #include "ShotStats.h"
 #include "TrackMarks.h"
 #include "World.h"
@@ -152,16 +155,12 @@ double			lastObserverUpdateTime = -1;
 
 static void		setHuntTarget();
 static void		setTankFlags();
-static void*		handleMsgSetVars(void *msg);
 static void		handlePlayerMessage(uint16_t, uint16_t, void*);
 static void		handleFlagTransferred(Player* fromTank, Player* toTank, int flagIndex);
 static void		enteringServer(void *buf);
 static void		joinInternetGame2();
 static void		cleanWorldCache();
 static void		markOld(std::string &fileName);
-#ifdef ROBOT
-static void		setRobotTarget(RobotPlayer* robot);
-#endif
 static void		setFlagLocalAndRemote(Player* tank, FlagType* ftype);
 
 static ResourceGetter	*resourceDownloader = NULL;
@@ -199,7 +198,6 @@ static bool		gotBlowedUp(BaseLocalPlayer* tank,
 
 #ifdef ROBOT
 static void		handleMyTankKilled(int reason);
-static ServerLink*	robotServer[MAX_ROBOTS];
 #endif
 
 static double		userTimeEpochOffset;
@@ -534,9 +532,9 @@ static ServerLink*	lookupServer(const Player *_player)
   PlayerId id = _player->getId();
   if (myTank->getId() == id) return serverLink;
 #ifdef ROBOT
-  for (int i = 0; i < numRobots; i++)
-    if (robots[i] && robots[i]->getId() == id)
-      return robotServer[i];
+  RobotPlayer* robot = findRobot(id);
+  if (robot)
+    return robot->getServer();
 #endif
   return NULL;
 }
@@ -1347,12 +1345,7 @@ static Player*		addPlayer(PlayerId id, void* msg, int showMessage)
 
 #ifdef ROBOT
   if (PlayerType (type) == ComputerPlayer)
-    for (int j = 0; j < numRobots; j++)
-      if (robots[j] && !strncmp (robots[j]->getCallSign (), callsign,
-				 CallSignLen)) {
-	robots[j]->setTeam (TeamColor (team));
-	break;
-      }
+    setRobotTeam (id, TeamColor (team));
 #endif
 
   // show the message if we don't have the playerlist
@@ -1755,8 +1748,7 @@ static void handleNearFlag ( void *msg, uint16_t len )
        }
 }
 
-static void		handleServerMessage(bool human, uint16_t code,
-					    uint16_t len, void* msg)
+static void		handleServerMessage(uint16_t code, uint16_t len, void* msg)
 {
   std::vector<std::string> args;
   bool checkScores = false;
@@ -1857,6 +1849,23 @@ static void		handleServerMessage(bool human, uint16_t code,
     case MsgAccept:
       break;
 
+#ifdef ROBOT
+    case MsgNewPlayer: {
+      // the id of one of our robots, 0xff if the server refused it
+      uint8_t robot;
+      PlayerId id;
+      msg = nboUnpackUByte(msg, robot);
+      msg = nboUnpackUByte(msg, id);
+      addRobot(robot, id);
+      break;
+    }
+
+    case MsgRobotMessage:
+      // what the server says to one of our robots alone
+      handleRobotMessage(len, msg);
+      break;
+#endif
+
     case MsgReject: {
       void *buf;
       char buffer[MessageLen];
@@ -1947,9 +1956,7 @@ static void		handleServerMessage(bool human, uint16_t code,
 	controlPanel->addMessage("Time Expired");
 	hud->setAlert(0, "Time Expired", 10.0f, true);
 #ifdef ROBOT
-	for (int i = 0; i < numRobots; i++)
-	  if (robots[i])
-	    robots[i]->explodeTank();
+	explodeRobots();
 #endif
       } else if (timeLeft < 0) {
 	hud->setAlert(0, "Game Paused", 10.0f, true);
@@ -1990,9 +1997,7 @@ static void		handleServerMessage(bool human, uint16_t code,
       controlPanel->addMessage(msg2);
       hud->setAlert(0, msg2.c_str(), 10.0f, true);
 #ifdef ROBOT
-      for (int i = 0; i < numRobots; i++)
-	if (robots[i])
-	  robots[i]->explodeTank();
+      explodeRobots();
 #endif
       break;
     }
@@ -2022,6 +2027,9 @@ static void		handleServerMessage(bool human, uint16_t code,
     case MsgRemovePlayer: {
       PlayerId id;
       msg = nboUnpackUByte(msg, id);
+#ifdef ROBOT
+      removeRobot(id);
+#endif
       if (removePlayer (id)) {
 	checkScores = true;
       }
@@ -2075,13 +2083,7 @@ static void		handleServerMessage(bool human, uint16_t code,
 	  hud->setAltitudeTape(World::getWorld()->allowJumping());
 #ifdef ROBOT
 	} else if (tank->getPlayerType() == ComputerPlayer) {
-	  for (int r = 0; r < numRobots; r++) {
-	    if (robots[r] && robots[r]->getId() == playerIndex) {
-	      robots[r]->restart(pos,forward);
-	      setRobotTarget(robots[r]);
-	      break;
-	    }
-	  }
+	  restartRobot(tank->getId(), pos, forward);
 #endif
 	}
 
@@ -2255,7 +2257,7 @@ static void		handleServerMessage(bool human, uint16_t code,
       }
 
       // add message
-      if (human && victimPlayer) {
+      if (victimPlayer) {
 	std::string message(ColorStrings[WhiteColor]);
 	if (killerPlayer == victimPlayer) {
 	  message += "blew myself up";
@@ -2324,7 +2326,7 @@ static void		handleServerMessage(bool human, uint16_t code,
       {
 	// blow up if killer has genocide flag and i'm on same team as victim
 	// (and we're not rogues, unless in rabbit mode)
-	if (human && killerPlayer && victimPlayer && victimPlayer != myTank &&
+	if (killerPlayer && victimPlayer && victimPlayer != myTank &&
 	    (victimPlayer->getTeam() == myTank->getTeam()) &&
 	    (myTank->getTeam() != RogueTeam) && shotId >= 0) {
 	  // now see if shot was fired with a GenocideFlag
@@ -2336,17 +2338,9 @@ static void		handleServerMessage(bool human, uint16_t code,
 
 #ifdef ROBOT
 	// blow up robots on victim's team if shot was genocide
-	if (killerPlayer && victimPlayer && shotId >= 0) {
-	  const ShotPath* shot = killerPlayer->getShot(int(shotId));
-	  if (shot && shot->getFlag() == Flags::Genocide)
-	    for (int i = 0; i < numRobots; i++)
-	    if (robots[i] && victimPlayer != robots[i] &&
-		victimPlayer->getTeam() == robots[i]->getTeam() &&
-		robots[i]->getTeam() != RogueTeam)
-	      gotBlowedUp(robots[i], GenocideEffect, killerPlayer->getId());
-	}
-      }
+	genocideRobots(victimPlayer, killerPlayer, int(shotId));
 #endif
+      }
 
       checkScores = true;
       break;
@@ -2486,12 +2480,10 @@ static void		handleServerMessage(bool human, uint16_t code,
 	gotBlowedUp(myTank, GotCaptured, id);
       }
 
+#ifdef ROBOT
       //kill all my robots if they are on the captured team
-      for (int r = 0; r < numRobots; r++) {
-	if (robots[r] && robots[r]->getTeam() == capturedTeam) {
-	  gotBlowedUp(robots[r], GotCaptured, robots[r]->getId());
-	}
-      }
+      captureRobots(TeamColor(capturedTeam));
+#endif
 
 
       // everybody who's alive on capture team will be blowing up
@@ -2561,13 +2553,7 @@ static void		handleServerMessage(bool human, uint16_t code,
       }
 
 #ifdef ROBOT
-      for (int r = 0; r < numRobots; r++)
-	if (robots[r]) {
-	  if (robots[r]->getId() == id)
-	    robots[r]->changeTeam(RabbitTeam);
-	  else
-	    robots[r]->changeTeam(HunterTeam);
-	}
+      setRobotRabbit(id);
 #endif
       break;
     }
@@ -2606,21 +2592,19 @@ static void		handleServerMessage(bool human, uint16_t code,
 	World::getWorld()->getWorldWeapons()->addShot(firingInfo);
       }
 
-      if (human) {
-	const float* pos = firingInfo.shot.pos;
-	const bool importance = false;
-	const bool localSound = isViewTank(shooter);
-	if (firingInfo.flagType == Flags::ShockWave) {
-	  playSound(SFX_SHOCK, pos, importance, localSound);
-	} else if (firingInfo.flagType == Flags::Laser) {
-	  playSound(SFX_LASER, pos, importance, localSound);
-	} else if (firingInfo.flagType == Flags::GuidedMissile) {
-	  playSound(SFX_MISSILE, pos, importance, localSound);
-	} else if (firingInfo.flagType == Flags::Thief) {
-	  playSound(SFX_THIEF, pos, importance, localSound);
-	} else {
-	  playSound(SFX_FIRE, pos, importance, localSound);
-	}
+      const float* pos = firingInfo.shot.pos;
+      const bool importance = false;
+      const bool localSound = isViewTank(shooter);
+      if (firingInfo.flagType == Flags::ShockWave) {
+	playSound(SFX_SHOCK, pos, importance, localSound);
+      } else if (firingInfo.flagType == Flags::Laser) {
+	playSound(SFX_LASER, pos, importance, localSound);
+      } else if (firingInfo.flagType == Flags::GuidedMissile) {
+	playSound(SFX_MISSILE, pos, importance, localSound);
+      } else if (firingInfo.flagType == Flags::Thief) {
+	playSound(SFX_THIEF, pos, importance, localSound);
+      } else {
+	playSound(SFX_FIRE, pos, importance, localSound);
       }
       break;
     }
@@ -2712,7 +2696,7 @@ static void		handleServerMessage(bool human, uint16_t code,
     }
 
     case MsgSetVar: {
-      msg = handleMsgSetVars(msg);
+      msg = ServerLink::readSetVars(msg);
       break;
     }
 
@@ -3149,10 +3133,10 @@ static void		doMessages()
   uint16_t code, len;
   int e = 0;
 
-  // handle server messages
+  // handle server messages, the robots' too
   if (serverLink) {
     while (!serverError && (e = serverLink->read(code, len, msg, 0)) == 1)
-      handleServerMessage(true, code, len, msg);
+      handleServerMessage(code, len, msg);
     if (e == -2) {
       printError("Server communication error");
       serverError = true;
@@ -3161,12 +3145,7 @@ static void		doMessages()
   }
 
 #ifdef ROBOT
-  for (int i = 0; i < numRobots; i++) {
-    while (robotServer[i] && (e = robotServer[i]->read(code, len, msg, 0)) == 1)
-      ;
-    if (code == MsgKilled || code == MsgShotBegin || code == MsgShotEnd)
-      handleServerMessage(false, code, len, msg);
-  }
+  readRobotLinks();
 #endif
 }
 
@@ -3344,37 +3323,6 @@ static void		handleMyTankKilled(int reason)
 }
 #endif
 
-static void *handleMsgSetVars(void *msg)
-{
-  uint16_t numVars;
-  uint8_t nameLen, valueLen;
-
-  char name[MaxPacketLen];
-  char value[MaxPacketLen];
-
-  msg = nboUnpackUShort(msg, numVars);
-  for (int i = 0; i < numVars; i++) {
-    msg = nboUnpackUByte(msg, nameLen);
-    msg = nboUnpackString(msg, name, nameLen);
-    name[nameLen] = '\0';
-
-    msg = nboUnpackUByte(msg, valueLen);
-    msg = nboUnpackString(msg, value, valueLen);
-    value[valueLen] = '\0';
-
-    if ((name[0] != '_') && (name[0] != '$')) {
-      logDebugMessage(1, "Server BZDB change blocked: '%s' = '%s'\n",
-		      name, value);
-    }
-    else {
-      BZDB.set(name, value);
-      BZDB.setPersistent(name, false);
-      BZDB.setPermission(name, StateDatabase::Locked);
-    }
-  }
-  return msg;
-}
-
 void handleFlagDropped(Player* tank)
 {
   // skip it if player doesn't actually have a flag
@@ -3433,11 +3381,65 @@ static void	handleFlagTransferred( Player *fromTank, Player *toTank, int flagInd
   addMessage(toTank, message);
 }
 
+// the death effect, sound and explosion of a local tank, mine or a robot's
+static void		showTankExplosion(BaseLocalPlayer* tank,
+					  BlowedUpReason reason,
+					  PlayerId killer, FlagType* flagType)
+{
+  // todo hook this back up for 2.4.4. or later
+  TankDeathOverride *death = NULL;
+  EFFECTS.addDeathEffect(tank->getColor(), tank->getPosition(), tank->getAngle(),reason,tank, flagType);
+
+  tank->setDeathEffect(death);
+
+  if (isViewTank(tank)) {
+    if (reason == GotRunOver) {
+      playLocalSound(SFX_RUNOVER);
+    } else {
+      playLocalSound(SFX_DIE);
+    }
+    ForceFeedback::death();
+  } else {
+    const float* pos = tank->getPosition();
+    if (reason == GotRunOver) {
+      playWorldSound(SFX_RUNOVER, pos,
+		     getLocalPlayer(killer) == myTank);
+    } else {
+      playWorldSound(SFX_EXPLOSION, pos,
+		     getLocalPlayer(killer) == myTank);
+    }
+  }
+
+  if (tank != myTank &&(!death || death->ShowExplosion())) {
+    const float* pos = tank->getPosition();
+    float explodePos[3];
+    explodePos[0] = pos[0];
+    explodePos[1] = pos[1];
+    explodePos[2] = pos[2] + tank->getMuzzleHeight();
+    addTankExplosion(explodePos);
+  }
+}
+
+#ifdef ROBOT
+static void		showRobotExplosion(RobotPlayer* robot,
+					   BlowedUpReason reason,
+					   PlayerId killer, FlagType* flagType)
+{
+  showTankExplosion(robot, reason, killer, flagType);
+}
+#endif
+
 static bool		gotBlowedUp(BaseLocalPlayer* tank,
 				    BlowedUpReason reason,
 				    PlayerId killer,
 				    const ShotPath* hit, int phydrv)
 {
+#ifdef ROBOT
+  // the robots blow up as they do in bzrobots, showTankExplosion() aside
+  if (tank != myTank)
+    return blowUpRobot((RobotPlayer*)tank, reason, killer, hit, phydrv);
+#endif
+
   if (tank && (tank->getTeam() == ObserverTeam || !tank->isAlive()))
     return false;
 
@@ -3477,46 +3479,14 @@ static bool		gotBlowedUp(BaseLocalPlayer* tank,
   // don't die if we had the shield flag and we've been shot.
   if (reason != GotShot || flag != Flags::Shield) {
     // blow me up
-
-    // todo hook this back up for 2.4.4. or later
-    TankDeathOverride *death = NULL;
-    EFFECTS.addDeathEffect(tank->getColor(), tank->getPosition(), tank->getAngle(),reason,tank, flagType);
-
-    tank->setDeathEffect(death);
+    showTankExplosion(tank, reason, killer, flagType);
     tank->explodeTank();
 
-    if (isViewTank(tank)) {
-      if (reason == GotRunOver) {
-	playLocalSound(SFX_RUNOVER);
-      } else {
-	playLocalSound(SFX_DIE);
-      }
-      ForceFeedback::death();
-    } else {
-      const float* pos = tank->getPosition();
-      if (reason == GotRunOver) {
-	playWorldSound(SFX_RUNOVER, pos,
-		       getLocalPlayer(killer) == myTank);
-      } else {
-	playWorldSound(SFX_EXPLOSION, pos,
-		       getLocalPlayer(killer) == myTank);
-      }
-    }
-
-    if (tank != myTank &&(!death || death->ShowExplosion())) {
-      const float* pos = tank->getPosition();
-      float explodePos[3];
-      explodePos[0] = pos[0];
-      explodePos[1] = pos[1];
-      explodePos[2] = pos[2] + tank->getMuzzleHeight();
-      addTankExplosion(explodePos);
-    }
-
     // tell server I'm dead in case it doesn't already know
     if (reason == GotShot || reason == GotRunOver ||
 	reason == GenocideEffect || reason == SelfDestruct ||
 	reason == WaterDeath || reason == DeathTouch)
-      lookupServer(tank)->sendKilled(killer, reason, shotId, flagType, phydrv);
+      lookupServer(tank)->sendKilled(tank->getId(), killer, reason, shotId, flagType, phydrv);
   }
 
   // print reason if it's my tank
@@ -3675,14 +3645,14 @@ static void		checkEnvironment()
   const ShotPath* hit = NULL;
   float minTime = Infinity;
 
+  // only the players (and the server) with a shot near me can have hit me
   myTank->checkHit(myTank, hit, minTime);
   int i;
-  for (i = 0; i < curMaxPlayers; i++)
-    if (remotePlayers[i])
-      myTank->checkHit(remotePlayers[i], hit, minTime);
-
-  // Check Server Shots
-  myTank->checkHit( World::getWorld()->getWorldWeapons(), hit, minTime);
+  std::vector<Player*> shooters;
+  SHOTGRID.findShooters(myTank, shooters);
+  for (i = 0; i < (int)shooters.size(); i++)
+    if (shooters[i] != myTank)
+      myTank->checkHit(shooters[i], hit, minTime);
 
   // used later
   float waterLevel = World::getWorld()->getWaterLevel();
@@ -3693,7 +3663,7 @@ static void		checkEnvironment()
     // this is to ensure that we don't get shot again by the same shot
     // after dropping our shield flag.
     if (hit->isStoppedByHit())
-      serverLink->sendEndShot(hit->getPlayer(), hit->getShotId(), 1);
+      serverLink->sendEndShot(myTank->getId(), hit->getPlayer(), hit->getShotId(), 1);
 
     FlagType* killerFlag = hit->getFlag();
     bool stopShot;
@@ -4114,13 +4084,8 @@ static void		updateDaylight(double offset, SceneRenderer& renderer)
 static void		setFlagLocalAndRemote(Player* tank, FlagType* ftype) {
   tank->setFlag(ftype);
 #ifdef ROBOT
-  if (tank->getPlayerType() == ComputerPlayer) {
-	  for (int r = 0; r < numRobots; r++) {
-		  if (robots[r]->getId() == tank->getId()) {
-			  robots[r]->setFlag(ftype);
-		  }
-	  }
-  }
+  if (tank->getPlayerType() == ComputerPlayer)
+    setRobotFlag(tank->getId(), ftype);
 #endif
 }
 
@@ -4130,415 +4095,24 @@ static void		setFlagLocalAndRemote(Player* tank, FlagType* ftype) {
 // some robot stuff
 //
 
-static std::vector<BzfRegion*>	obstacleList;  // for robots
-
-static void		addObstacle(std::vector<BzfRegion*>& rgnList, const Obstacle& obstacle)
-{
-  float p[4][2];
-  const float* c = obstacle.getPosition();
-  const float tankRadius = BZDBCache::tankRadius;
-
-  if (BZDBCache::tankHeight < c[2])
-    return;
-
-  const float a = obstacle.getRotation();
-  const float w = obstacle.getWidth() + tankRadius;
-  const float h = obstacle.getBreadth() + tankRadius;
-  const float xx =  w * cosf(a);
-  const float xy =  w * sinf(a);
-  const float yx = -h * sinf(a);
-  const float yy =  h * cosf(a);
-  p[0][0] = c[0] - xx - yx;
-  p[0][1] = c[1] - xy - yy;
-  p[1][0] = c[0] + xx - yx;
-  p[1][1] = c[1] + xy - yy;
-  p[2][0] = c[0] + xx + yx;
-  p[2][1] = c[1] + xy + yy;
-  p[3][0] = c[0] - xx + yx;
-  p[3][1] = c[1] - xy + yy;
-
-  int numRegions = rgnList.size();
-  for (int k = 0; k < numRegions; k++) {
-    BzfRegion* region = rgnList[k];
-    int side[4];
-    if ((side[0] = region->classify(p[0], p[1])) == 1 ||
-	(side[1] = region->classify(p[1], p[2])) == 1 ||
-	(side[2] = region->classify(p[2], p[3])) == 1 ||
-	(side[3] = region->classify(p[3], p[0])) == 1)
-      continue;
-    if (side[0] == -1 && side[1] == -1 && side[2] == -1 && side[3] == -1) {
-      rgnList[k] = rgnList[numRegions-1];
-      rgnList[numRegions-1] = rgnList[rgnList.size()-1];
-      rgnList.pop_back();
-      numRegions--;
-      k--;
-      delete region;
-      continue;
-    }
-    for (int j = 0; j < 4; j++) {
-      if (side[j] == -1) continue;		// to inside
-      // split
-      const float* p1 = p[j];
-      const float* p2 = p[(j+1)&3];
-      BzfRegion* newRegion = region->orphanSplitRegion(p2, p1);
-      if (!newRegion) continue;		// no split
-      if (region != rgnList[k]) rgnList.push_back(region);
-      region = newRegion;
-    }
-    if (region != rgnList[k]) delete region;
-  }
-}
-
-static void		makeObstacleList()
-{
-  const float tankRadius = BZDBCache::tankRadius;
-  int i;
-  const int count = obstacleList.size();
-  for (i = 0; i < count; i++)
-    delete obstacleList[i];
-  obstacleList.clear();
-
-  // FIXME -- shouldn't hard code game area
-  float gameArea[4][2];
-  float worldSize = BZDBCache::worldSize;
-  gameArea[0][0] = -0.5f * worldSize + tankRadius;
-  gameArea[0][1] = -0.5f * worldSize + tankRadius;
-  gameArea[1][0] =  0.5f * worldSize - tankRadius;
-  gameArea[1][1] = -0.5f * worldSize + tankRadius;
-  gameArea[2][0] =  0.5f * worldSize - tankRadius;
-  gameArea[2][1] =  0.5f * worldSize - tankRadius;
-  gameArea[3][0] = -0.5f * worldSize + tankRadius;
-  gameArea[3][1] =  0.5f * worldSize - tankRadius;
-  obstacleList.push_back(new BzfRegion(4, gameArea));
-
-  const ObstacleList& boxes = OBSTACLEMGR.getBoxes();
-  const int numBoxes = boxes.size();
-  for (i = 0; i < numBoxes; i++) {
-    addObstacle(obstacleList, *boxes[i]);
-  }
-  const ObstacleList& pyramids = OBSTACLEMGR.getPyrs();
-  const int numPyramids = pyramids.size();
-  for (i = 0; i < numPyramids; i++) {
-    addObstacle(obstacleList, *pyramids[i]);
-  }
-  const ObstacleList& teleporters = OBSTACLEMGR.getTeles();
-  const int numTeleporters = teleporters.size();
-  for (i = 0; i < numTeleporters; i++) {
-    addObstacle(obstacleList, *teleporters[i]);
-  }
-  const ObstacleList& meshes = OBSTACLEMGR.getMeshes();
-  const int numMeshes = meshes.size();
-  for (i = 0; i < numMeshes; i++) {
-    addObstacle(obstacleList, *meshes[i]);
-  }
-  if (World::getWorld()->allowTeamFlags()) {
-    const ObstacleList& bases = OBSTACLEMGR.getBases();
-    const int numBases = bases.size();
-    for (i = 0; i < numBases; i++) {
-      const BaseBuilding* base = (const BaseBuilding*) bases[i];
-      if ((base->getHeight() != 0.0f) || (base->getPosition()[2] != 0.0f)) {
-	addObstacle(obstacleList, *base);
-      }
-    }
-  }
-}
-
-static void		setRobotTarget(RobotPlayer* robot)
-{
-  Player* bestTarget = NULL;
-  float bestPriority = 0.0f;
-  for (int j = 0; j < curMaxPlayers; j++)
-    if (remotePlayers[j] && remotePlayers[j]->getId() != robot->getId() &&
-	remotePlayers[j]->isAlive() && robot->validTeamTarget(remotePlayers[j])) {
-
-      if (remotePlayers[j]->isPhantomZoned() && !robot->isPhantomZoned())
-	continue;
-
-      if (World::getWorld()->allowTeamFlags() &&
-	  ((robot->getTeam() == RedTeam && remotePlayers[j]->getFlag() == Flags::RedTeam) ||
-	  (robot->getTeam() == GreenTeam && remotePlayers[j]->getFlag() == Flags::GreenTeam) ||
-	  (robot->getTeam() == BlueTeam && remotePlayers[j]->getFlag() == Flags::BlueTeam) ||
-	  (robot->getTeam() == PurpleTeam && remotePlayers[j]->getFlag() == Flags::PurpleTeam))) {
-	bestTarget = remotePlayers[j];
-	break;
-      }
-
-      const float priority = robot->getTargetPriority(remotePlayers[j]);
-      if (priority > bestPriority) {
-	bestTarget = remotePlayers[j];
-	bestPriority = priority;
-      }
-    }
-  if (myTank->isAlive() &&
-      ((robot->getTeam() == RogueTeam) ||  robot->validTeamTarget(myTank))) {
-    const float priority = robot->getTargetPriority(myTank);
-    if (priority > bestPriority) {
-      bestTarget = myTank;
-      bestPriority = priority;
-    }
-  }
-  robot->setTarget(bestTarget);
-}
-
-static void		updateRobots(float dt)
-{
-  static float newTargetTimeout = 1.0f;
-  static float clock = 0.0f;
-  bool pickTarget = false;
-  int i;
-
-  // see if we should look for new targets
-  clock += dt;
-  if (clock > newTargetTimeout) {
-    while (clock > newTargetTimeout) {
-      clock -= newTargetTimeout;
-    }
-    pickTarget = true;
-  }
-
-  // start dead robots
-  for (i = 0; i < numRobots; i++) {
-    if (!gameOver && robots[i]
-	&& !robots[i]->isAlive() && !robots[i]->isExploding() && pickTarget) {
-      robotServer[i]->sendAlive();
-    }
-  }
-
-  // retarget robots
-  for (i = 0; i < numRobots; i++) {
-    if (robots[i] && robots[i]->isAlive()
-	&& (pickTarget || !robots[i]->getTarget()
-	    || !robots[i]->getTarget()->isAlive())) {
-      setRobotTarget(robots[i]);
-    }
-  }
-
-  // do updates
-  for (i = 0; i < numRobots; i++)
-    if (robots[i]) {
-      robots[i]->update();
-    }
-}
-
-
-static void		checkEnvironment(RobotPlayer* tank)
-{
-  // skip this if i'm dead or paused
-  if (!tank->isAlive() || tank->isPaused()) return;
-
-  FlagType* flagd = tank->getFlag();
-  if (flagd->flagTeam != NoTeam) {
-    // have I captured a flag?
-    TeamColor base = world->whoseBase(tank->getPosition());
-    TeamColor team = tank->getTeam();
-    if ((base != NoTeam) &&
-	((flagd->flagTeam == team && base != team) ||
-	(flagd->flagTeam != team && base == team))) {
-#ifdef TRACE2
-	char buffer[128];
-	sprintf (buffer, "inside checkEnvironment for robot %d, captured flag %d",
-		tank->getId(), flagd->flagTeam);
-	controlPanel->addMessage(buffer);
-#endif
-      serverLink->sendCaptureFlag(tank->getId(), base);
-	}
-  }
-  else if (flagd == Flags::Null && (tank->getLocation() == LocalPlayer::OnGround ||
-				    tank->getLocation() == LocalPlayer::OnBuilding)) {
-    // Don't grab too fast
-    static TimeKeeper lastGrabSent;
-    if (TimeKeeper::getTick()-lastGrabSent > 0.2) {
-      // grab any and all flags i'm driving over
-      const float* tpos = tank->getPosition();
-      const float radius = tank->getRadius();
-      const float radius2 = (radius + BZDBCache::flagRadius) * (radius + BZDBCache::flagRadius);
-      for (int i = 0; i < numFlags; i++) {
-	if (world->getFlag(i).type == Flags::Null || world->getFlag(i).status != FlagOnGround)
-	  continue;
-	const float* fpos = world->getFlag(i).position;
-	if ((fabs(tpos[2] - fpos[2]) < 0.1f) && ((tpos[0] - fpos[0]) * (tpos[0] - fpos[0]) +
-						 (tpos[1] - fpos[1]) * (tpos[1] - fpos[1]) < radius2)) {
-#ifdef TRACE2
-	char buffer[128];
-	sprintf (buffer, "inside checkEnvironment for robot %d, grabbed flag %d", tank->getId(), i);
-	controlPanel->addMessage(buffer);
-#endif
-	  serverLink->sendGrabFlag(tank->getId(), i);
-	  lastGrabSent=TimeKeeper::getTick();
-	}
-      }
-    }
-  }
-
-  // see if i've been shot
-  const ShotPath* hit = NULL;
-  float minTime = Infinity;
-  tank->checkHit(myTank, hit, minTime);
-  int i;
-  for (i = 0; i < curMaxPlayers; i++) {
-    if (remotePlayers[i] && remotePlayers[i]->getId() != tank->getId()) {
-      tank->checkHit(remotePlayers[i], hit, minTime);
-    }
-  }
-
-  // Check Server Shots
-  tank->checkHit( World::getWorld()->getWorldWeapons(), hit, minTime);
-
-  float waterLevel = World::getWorld()->getWaterLevel();
-
-  if (hit) {
-    // i got shot!  terminate the shot that hit me and blow up.
-    // force shot to terminate locally immediately (no server round trip);
-    // this is to ensure that we don't get shot again by the same shot
-    // after dropping our shield flag.
-    if (hit->isStoppedByHit())
-      lookupServer(tank)->sendEndShot(hit->getPlayer(), hit->getShotId(), 1);
-
-    FlagType* killerFlag = hit->getFlag();
-    bool stopShot;
-
-    if (killerFlag == Flags::Thief) {
-      if (tank->getFlag() != Flags::Null) {
-	serverLink->sendTransferFlag(tank->getId(), hit->getPlayer());
-      }
-      stopShot = true;
-    }
-    else {
-      stopShot = gotBlowedUp(tank, GotShot, hit->getPlayer(), hit);
-    }
-
-    if (stopShot || hit->isStoppedByHit()) {
-      Player* hitter = lookupPlayer(hit->getPlayer());
-      if (hitter) hitter->endShot(hit->getShotId());
-    }
-  }
-  // if not dead yet, see if i'm sitting on death
-  else if (tank->getDeathPhysicsDriver() >= 0) {
-    gotBlowedUp(tank, DeathTouch, ServerPlayer, NULL,
-		tank->getDeathPhysicsDriver());
-  }
-  // if not dead yet, see if the robot dropped below the death level
-  else if ((waterLevel > 0.0f) && (tank->getPosition()[2] <= waterLevel)) {
-    gotBlowedUp(tank, WaterDeath, ServerPlayer);
-  }
-
-  // if not dead yet, see if i got run over by the steamroller
-  else {
-    bool dead = false;
-    const float* myPos = tank->getPosition();
-    const float myRadius = tank->getRadius();
-    if (((myTank->getFlag() == Flags::Steamroller) ||
-	 ((tank->getFlag() == Flags::Burrow) && myTank->isAlive() &&
-	  !myTank->isPhantomZoned()))
-	&& !myTank->isPaused()) {
-      const float* pos = myTank->getPosition();
-      if (pos[2] >= 0.0f) {
-	const float radius = myRadius +
-	  (BZDB.eval(StateDatabase::BZDB_SRRADIUSMULT) * myTank->getRadius());
-	const float distSquared =
-	  hypotf(hypotf(myPos[0] - pos[0],
-			myPos[1] - pos[1]), (myPos[2] - pos[2]) * 2.0f);
-	if (distSquared < radius) {
-	  gotBlowedUp(tank, GotRunOver, myTank->getId());
-	  dead = true;
-	}
-      }
-    }
-    for (i = 0; !dead && i < curMaxPlayers; i++) {
-      if (remotePlayers[i] && !remotePlayers[i]->isPaused() &&
-	  ((remotePlayers[i]->getFlag() == Flags::Steamroller) ||
-	   ((tank->getFlag() == Flags::Burrow) && remotePlayers[i]->isAlive() &&
-	    !remotePlayers[i]->isPhantomZoned()))) {
-	const float* pos = remotePlayers[i]->getPosition();
-	if (pos[2] < 0.0f) continue;
-	const float radius = myRadius +
-	  (BZDB.eval(StateDatabase::BZDB_SRRADIUSMULT) * remotePlayers[i]->getRadius());
-	const float distSquared =
-	  hypotf(hypotf(myPos[0] - pos[0],
-			myPos[1] - pos[1]), (myPos[2] - pos[2]) * 2.0f);
-	if (distSquared < radius) {
-	  gotBlowedUp(tank, GotRunOver, remotePlayers[i]->getId());
-	  dead = true;
-	}
-      }
-    }
-  }
-}
-
-static void		checkEnvironmentForRobots()
-{
-  for (int i = 0; i < numRobots; i++)
-    if (robots[i])
-      checkEnvironment(robots[i]);
-}
-
-static void		sendRobotUpdates()
-{
-  for (int i = 0; i < numRobots; i++)
-    if (robots[i] && robotServer[i] && robots[i]->isDeadReckoningWrong()) {
-      robotServer[i]->sendPlayerUpdate(robots[i]);
-    }
-}
-
 static void		addRobots()
 {
-  uint16_t code, len;
-  char msg[MaxPacketLen];
-  char callsign[CallSignLen];
-  int i, j;
+  numRobots = 0;
 
   // add solo robots only when the server allows them
   if (BZDB.isTrue(StateDatabase::BZDB_DISABLEBOTS)) {
-    numRobots = 0;
     if (numRobotTanks > 0)
       addMessage(NULL, "Solo robots are prohibited on this server.");
     return;
   }
 
-  for (i = 0, j = 0; i < numRobotTanks; i++) {
-    robotServer[j] = new ServerLink(serverNetworkAddress, startupInfo.serverPort);
-    if (!robotServer[j] || robotServer[j]->getState() != ServerLink::Okay) {
-      delete robotServer[j];
-      continue;
-    } else {
-      snprintf(callsign, CallSignLen, "%s%2.2d", myTank->getCallSign(), j);
-      robots[j] = new RobotPlayer(robotServer[j]->getId(), callsign,
-				  robotServer[j], myTank->getMotto());
-      robots[j]->setTeam(AutomaticTeam);
-      robotServer[j]->sendEnter(ComputerPlayer, robots[j]->getTeam(),
-				robots[j]->getCallSign(),
-				robots[j]->getMotto(), "");
-    }
-    j++;
-  }
-  numRobots = j;
-
-  for (j = 0; j < numRobots; j++) {
-    // wait for response
-    if (robotServer[j] && (robotServer[j]->read(code, len, msg, -1) < 0 || code != MsgAccept)) {
-      delete robots[j];
-      delete robotServer[j];
-      robots[j] = NULL;
-      robotServer[j] = NULL;
-    }
-  }
-
-  int k;
-  // packing
-  for (k = 0, j = 0; j < numRobots; j++) {
-    if (k != j) {
-      robotServer[k] = robotServer[j];
-      robots[k]      = robots[j];
-    }
-    if (robotServer[j])
-      k++;
-  }
-  numRobots = k;
+  setRobotExplosionCallback(showRobotExplosion);
+  joinRobots(serverLink, serverNetworkAddress, startupInfo.serverPort,
+	     numRobotTanks, myTank->getCallSign(), myTank->getMotto(),
+	     AutomaticTeam);
 
-  if (numRobots > 0) {
-    makeObstacleList();
-    RobotPlayer::setObstacleList(&obstacleList);
-  }
+  if (numRobotTanks > 0)
+    buildRobotPlanningData();
 }
 
 #endif
@@ -4800,23 +4374,6 @@ static void markOld(std::string &fileName)
 }
 
 
-static void sendFlagNegotiation()
-{
-  char msg[MaxPacketLen];
-  FlagTypeMap::iterator i;
-  char *buf = msg;
-
-  /* Send MsgNegotiateFlags to the server with
-   * the abbreviations for all the flags we support.
-   */
-  for (i = FlagType::getFlagMap().begin();
-       i != FlagType::getFlagMap().end(); i++) {
-    buf = (char*) i->second->pack(buf);
-  }
-  serverLink->send(MsgNegotiateFlags, buf - msg, msg);
-}
-
-
 #if defined(FIXME) && defined(ROBOT)
 static void saveRobotInfo(Playerid id, void *msg)
 {
@@ -4882,24 +4439,13 @@ void		leaveGame()
   */
 
 #if defined(ROBOT)
-  // shut down robot connections
-  int i;
-  for (i = 0; i < numRobots; i++) {
-    if (robots[i] && robotServer[i])
-      robotServer[i]->send(MsgExit, 0, NULL);
-    delete robots[i];
-    delete robotServer[i];
-    robots[i] = NULL;
-    robotServer[i] = NULL;
-  }
-  numRobots = 0;
-
-  const int count = obstacleList.size();
-  for (i = 0; i < count; i++)
-    delete obstacleList[i];
-  obstacleList.clear();
+  removeRobots();
+  stopRobots();
 #endif
 
+  SHOTGRID.clear();
+  PLAYERGRID.clear();
+
   // my tank goes away
   const bool sayGoodbye = (myTank != NULL);
   LocalPlayer::setMyTank(NULL);
@@ -5100,7 +4646,7 @@ static void joinInternetGame()
 
   HUDDialogStack::get()->setFailedMessage("Connection Established...");
 
-  sendFlagNegotiation();
+  serverLink->sendNegotiateFlags();
   joiningGame = true;
   scoreboard->huntReset();
   GameTime::reset();
@@ -6459,7 +6005,15 @@ static void		playingLoop()
 
     // see if the world collision grid needs to be updated
     if (world) {
+#ifdef ROBOT
+      const bool collisionReload = COLLISIONMGR.needReload();
+#endif
       world->checkCollisionManager();
+#ifdef ROBOT
+      // the robots' occupancy grid is rasterized from the same obstacles
+      if (collisionReload && numRobots > 0)
+	OCCUPANCYGRID.build();
+#endif
     }
 
     mainWindow->getWindow()->yieldCurrent();
@@ -6641,6 +6195,9 @@ static void		playingLoop()
       _world->getWorldWeapons()->updateShots(dt);
     }
 
+    // index the shots for this frame's hit and threat checks
+    SHOTGRID.build(dt);
+
     // update track marks  (before any tanks are moved)
     TrackMarks::update(dt);
 
@@ -6693,7 +6250,7 @@ static void		playingLoop()
 
 #ifdef ROBOT
     if (entered) {
-      updateRobots(dt);
+      updateRobots(dt, !gameOver);
     }
 #endif
 
@@ -6702,7 +6259,7 @@ static void		playingLoop()
 
 #ifdef ROBOT
     if (entered) {
-      checkEnvironmentForRobots();
+      checkRobotEnvironment();
     }
 #endif
 
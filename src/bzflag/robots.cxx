@@ -0,0 +1,810 @@
+/* bzflag
+ * Copyright (c) 1993-2011 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+// interface header
+#include "robots.h"
+
+// the robots only exist in robot builds
+#ifdef ROBOT
+
+/* system implementation headers */
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/* common implementation headers */
+#include "AnsiCodes.h"
+#include "BaseBuilding.h"
+#include "BZDBCache.h"
+#include "ErrorHandler.h"
+#include "ObstacleList.h"
+#include "ObstacleMgr.h"
+#include "StateDatabase.h"
+#include "TextUtils.h"
+#include "TimeKeeper.h"
+
+/* local implementation headers */
+#include "PlayerGrid.h"
+#include "Roster.h"
+#include "ShotGrid.h"
+#include "World.h"
+#include "yagsbpl/FlowField.h"
+#include "yagsbpl/NavMesh.h"
+#include "yagsbpl/OccupancyGrid.h"
+#include "yagsbpl/PathPlanningService.h"
+#include "yagsbpl/PlanningScheduler.h"
+
+
+// the open regions of the world, for the robots' region search
+static std::vector<BzfRegion*>	obstacleList;
+
+// the robots' own links, on a server that cannot take them over the caller's
+static ServerLink*	robotServer[MAX_ROBOTS];
+// the link the robots asked to join over, and what they join as
+static ServerLink*	robotLink = NULL;
+static std::string	robotPrefix;
+static std::string	robotMotto;
+static TeamColor	robotTeam = AutomaticTeam;
+// how many robots were asked for, how many the server has not answered
+// for yet, and since when
+static int		robotsAsked = 0;
+static int		robotReplies = 0;
+static TimeKeeper	robotRequestTime;
+// how long the server has to answer for the robots, in seconds
+static const double	robotReplyTimeout = 30.0;
+
+static RobotExplosionCallback	explosionCallback = NULL;
+
+static void		addObstacle(std::vector<BzfRegion*>& rgnList, const Obstacle& obstacle)
+{
+  float p[4][2];
+  const float* c = obstacle.getPosition();
+  const float tankRadius = BZDBCache::tankRadius;
+
+  if (BZDBCache::tankHeight < c[2])
+    return;
+
+  const float a = obstacle.getRotation();
+  const float w = obstacle.getWidth() + tankRadius;
+  const float h = obstacle.getBreadth() + tankRadius;
+  const float xx =  w * cosf(a);
+  const float xy =  w * sinf(a);
+  const float yx = -h * sinf(a);
+  const float yy =  h * cosf(a);
+  p[0][0] = c[0] - xx - yx;
+  p[0][1] = c[1] - xy - yy;
+  p[1][0] = c[0] + xx - yx;
+  p[1][1] = c[1] + xy - yy;
+  p[2][0] = c[0] + xx + yx;
+  p[2][1] = c[1] + xy + yy;
+  p[3][0] = c[0] - xx + yx;
+  p[3][1] = c[1] - xy + yy;
+
+  int numRegions = rgnList.size();
+  for (int k = 0; k < numRegions; k++) {
+    BzfRegion* region = rgnList[k];
+    int side[4];
+    if ((side[0] = region->classify(p[0], p[1])) == 1 ||
+	(side[1] = region->classify(p[1], p[2])) == 1 ||
+	(side[2] = region->classify(p[2], p[3])) == 1 ||
+	(side[3] = region->classify(p[3], p[0])) == 1)
+      continue;
+    if (side[0] == -1 && side[1] == -1 && side[2] == -1 && side[3] == -1) {
+      rgnList[k] = rgnList[numRegions-1];
+      rgnList[numRegions-1] = rgnList[rgnList.size()-1];
+      rgnList.pop_back();
+      numRegions--;
+      k--;
+      delete region;
+      continue;
+    }
+    for (int j = 0; j < 4; j++) {
+      if (side[j] == -1) continue;		// to inside
+      // split
+      const float* p1 = p[j];
+      const float* p2 = p[(j+1)&3];
+      BzfRegion* newRegion = region->orphanSplitRegion(p2, p1);
+      if (!newRegion) continue;		// no split
+      if (region != rgnList[k]) rgnList.push_back(region);
+      region = newRegion;
+    }
+    if (region != rgnList[k]) delete region;
+  }
+}
+
+static void		makeObstacleList()
+{
+  const float tankRadius = BZDBCache::tankRadius;
+  int i;
+  const int count = obstacleList.size();
+  for (i = 0; i < count; i++)
+    delete obstacleList[i];
+  obstacleList.clear();
+
+  // FIXME -- shouldn't hard code game area
+  float gameArea[4][2];
+  float worldSize = BZDBCache::worldSize;
+  gameArea[0][0] = -0.5f * worldSize + tankRadius;
+  gameArea[0][1] = -0.5f * worldSize + tankRadius;
+  gameArea[1][0] =  0.5f * worldSize - tankRadius;
+  gameArea[1][1] = -0.5f * worldSize + tankRadius;
+  gameArea[2][0] =  0.5f * worldSize - tankRadius;
+  gameArea[2][1] =  0.5f * worldSize - tankRadius;
+  gameArea[3][0] = -0.5f * worldSize + tankRadius;
+  gameArea[3][1] =  0.5f * worldSize - tankRadius;
+  obstacleList.push_back(new BzfRegion(4, gameArea));
+
+  const ObstacleList& boxes = OBSTACLEMGR.getBoxes();
+  const int numBoxes = boxes.size();
+  for (i = 0; i < numBoxes; i++) {
+    addObstacle(obstacleList, *boxes[i]);
+  }
+  const ObstacleList& pyramids = OBSTACLEMGR.getPyrs();
+  const int numPyramids = pyramids.size();
+  for (i = 0; i < numPyramids; i++) {
+    addObstacle(obstacleList, *pyramids[i]);
+  }
+  const ObstacleList& teleporters = OBSTACLEMGR.getTeles();
+  const int numTeleporters = teleporters.size();
+  for (i = 0; i < numTeleporters; i++) {
+    addObstacle(obstacleList, *teleporters[i]);
+  }
+  const ObstacleList& meshes = OBSTACLEMGR.getMeshes();
+  const int numMeshes = meshes.size();
+  for (i = 0; i < numMeshes; i++) {
+    addObstacle(obstacleList, *meshes[i]);
+  }
+  if (World::getWorld()->allowTeamFlags()) {
+    const ObstacleList& bases = OBSTACLEMGR.getBases();
+    const int numBases = bases.size();
+    for (i = 0; i < numBases; i++) {
+      const BaseBuilding* base = (const BaseBuilding*) bases[i];
+      if ((base->getHeight() != 0.0f) || (base->getPosition()[2] != 0.0f)) {
+	addObstacle(obstacleList, *base);
+      }
+    }
+  }
+}
+
+static bool		isRobotTarget(RobotPlayer* robot, const Player* player)
+{
+  LocalPlayer* myTank = LocalPlayer::getMyTank();
+  if (player == myTank)
+    return myTank->isAlive() &&
+      ((robot->getTeam() == RogueTeam) || robot->validTeamTarget(myTank));
+  return player->getId() != robot->getId() && player->isAlive() &&
+    robot->validTeamTarget(player) &&
+    (!player->isPhantomZoned() || robot->isPhantomZoned());
+}
+
+static Player*		findRobotTarget(RobotPlayer* robot)
+{
+  // go after whoever carries the robot's team flag
+  World* world = World::getWorld();
+  if (world->allowTeamFlags()) {
+    for (int i = 0; i < world->getMaxFlags(); i++) {
+      const Flag& flag = world->getFlag(i);
+      if (flag.status != FlagOnTank || flag.type->flagTeam != robot->getTeam())
+	continue;
+      Player* carrier = lookupPlayer(flag.owner);
+      if (carrier && isRobotTarget(robot, carrier))
+	return carrier;
+    }
+  }
+
+  // otherwise the best target, looking farther away only while a farther
+  // player could still have a higher priority
+  const float* pos = robot->getPosition();
+  const float span = PLAYERGRID.getWorldSpan();
+  std::vector<Player*> nearby;
+  Player* bestTarget = NULL;
+  float bestPriority = 0.0f;
+  float searched = -1.0f;
+  for (float radius = 0.125f * span; ; radius *= 2.0f) {
+    PLAYERGRID.findPlayersNear(pos, radius, NoTeam, nearby);
+    for (unsigned int j = 0; j < nearby.size(); j++) {
+      const float* p = nearby[j]->getPosition();
+      if (hypotf(p[0] - pos[0], p[1] - pos[1]) <= searched ||
+	  !isRobotTarget(robot, nearby[j]))
+	continue;
+      const float priority = robot->getTargetPriority(nearby[j]);
+      if (priority > bestPriority) {
+	bestTarget = nearby[j];
+	bestPriority = priority;
+      }
+    }
+    if (radius >= span || bestPriority >= robot->getMaxTargetPriority(radius))
+      break;
+    searched = radius;
+  }
+  return bestTarget;
+}
+
+void			setRobotTarget(RobotPlayer* robot)
+{
+  // a robot restarted by a server message comes before the frame's grid,
+  // and the next messages may remove players
+  const bool ownGrid = !PLAYERGRID.isBuilt();
+  if (ownGrid)
+    PLAYERGRID.build();
+  robot->setTarget(findRobotTarget(robot));
+  if (ownGrid)
+    PLAYERGRID.clear();
+}
+
+void			updateRobots(float dt, bool respawn)
+{
+  static float newTargetTimeout = 1.0f;
+  static float clock = 0.0f;
+  bool pickTarget = false;
+  int i;
+
+  // see if we should look for new targets
+  clock += dt;
+  if (clock > newTargetTimeout) {
+    while (clock > newTargetTimeout) {
+      clock -= newTargetTimeout;
+    }
+    pickTarget = true;
+  }
+
+  // index the players and look the planner up once for all the robots
+  PLAYERGRID.build();
+  RobotPlayer::setPathPlanner(getPathPlannerKind());
+
+  // start dead robots
+  for (i = 0; i < numRobots; i++) {
+    if (respawn && robots[i]
+	&& !robots[i]->isAlive() && !robots[i]->isExploding() && pickTarget) {
+      robots[i]->getServer()->sendAlive(robots[i]->getId());
+    }
+  }
+
+  // retarget robots
+  for (i = 0; i < numRobots; i++) {
+    if (robots[i] && robots[i]->isAlive()
+	&& (pickTarget || !robots[i]->getTarget()
+	    || !robots[i]->getTarget()->isAlive())) {
+      setRobotTarget(robots[i]);
+    }
+  }
+
+  // the robots look at the world before any of them changes it
+  for (i = 0; i < numRobots; i++)
+    if (robots[i] && robots[i]->isAlive()) {
+      robots[i]->sense();
+    }
+
+  // keep the flow fields toward the bases and team flags up to date
+  if (numRobots > 0)
+    FLOWFIELDS.update();
+
+  // do updates
+  for (i = 0; i < numRobots; i++)
+    if (robots[i]) {
+      robots[i]->update();
+    }
+
+  // then shoot and drop flags, once they all made up their minds
+  for (i = 0; i < numRobots; i++)
+    if (robots[i]) {
+      robots[i]->applyActions();
+    }
+
+  // carry on with the searches the robots are waiting for, within this frame's budget
+  if (numRobots > 0)
+    PLANNINGSCHEDULER.update();
+}
+
+void			sendRobotUpdates()
+{
+  for (int i = 0; i < numRobots; i++)
+    if (robots[i] && robots[i]->isDeadReckoningWrong()) {
+      robots[i]->getServer()->sendPlayerUpdate(robots[i]);
+    }
+}
+
+void			buildRobotPlanningData()
+{
+  makeObstacleList();
+  RobotPlayer::setObstacleList(&obstacleList);
+  NAVMESH.build(obstacleList, 0.5f * BZDBCache::tankRadius);
+  OCCUPANCYGRID.build();
+}
+
+void			stopRobots()
+{
+  const int count = obstacleList.size();
+  for (int i = 0; i < count; i++)
+    delete obstacleList[i];
+  obstacleList.clear();
+  PATHPLANNINGSERVICE.stop();
+  PLANNINGSCHEDULER.clear();
+  FLOWFIELDS.clear();
+  NAVMESH.clear();
+  OCCUPANCYGRID.clear();
+}
+
+//
+// the robots and their links
+//
+
+void			joinRobots(ServerLink* link,
+				   const Address& serverAddress, int port,
+				   int count, const char* prefix,
+				   const char* motto, TeamColor team)
+{
+  uint16_t code, len;
+  char msg[MaxPacketLen];
+  char callsign[CallSignLen];
+  int i;
+
+  robotLink = link;
+  robotPrefix = prefix;
+  robotMotto = motto;
+  robotTeam = team;
+  robotsAsked = count < MAX_ROBOTS ? count : MAX_ROBOTS;
+  robotReplies = 0;
+
+  if (link->canHostRobots()) {
+    // the robots play over the caller's link.  each comes in with the
+    // server's MsgNewPlayer reply, see addRobot()
+    for (i = 0; i < robotsAsked; i++) {
+      snprintf(callsign, CallSignLen, "%s%2.2d", prefix, i);
+      link->sendNewPlayer(i, team, callsign, motto);
+    }
+    robotReplies = robotsAsked;
+    robotRequestTime = TimeKeeper::getCurrent();
+    return;
+  }
+
+  // an older server: each robot joins on a link of its own
+  for (i = 0; i < robotsAsked && numRobots < MAX_ROBOTS; i++) {
+    ServerLink* ownLink = new ServerLink(serverAddress, port);
+    if (ownLink->getState() != ServerLink::Okay) {
+      delete ownLink;
+      continue;
+    }
+    snprintf(callsign, CallSignLen, "%s%2.2d", prefix, i);
+    robots[numRobots] = new RobotPlayer(ownLink->getId(), callsign,
+					ownLink, motto);
+    robots[numRobots]->setTeam(team);
+    robotServer[numRobots] = ownLink;
+    ownLink->sendEnter(ComputerPlayer, robots[numRobots]->getTeam(),
+		       robots[numRobots]->getCallSign(),
+		       robots[numRobots]->getMotto(), "");
+    numRobots++;
+  }
+
+  // wait for response, backwards as removeRobot() packs the later ones
+  for (i = numRobots - 1; i >= 0; i--)
+    if (robotServer[i]->read(code, len, msg,
+			     int(robotReplyTimeout * 1000.0)) <= 0 ||
+	code != MsgAccept)
+      removeRobot(robots[i]->getId());
+  if (numRobots < robotsAsked)
+    printError(TextUtils::format("Only %d of %d robots joined",
+				 numRobots, robotsAsked));
+}
+
+int			getPendingRobots()
+{
+  return robotReplies;
+}
+
+RobotPlayer*		findRobot(PlayerId id)
+{
+  for (int i = 0; i < numRobots; i++)
+    if (robots[i] && robots[i]->getId() == id)
+      return robots[i];
+  return NULL;
+}
+
+void			addRobot(int robot, PlayerId id)
+{
+  const bool asked = robot >= 0 && robot < robotsAsked;
+  if (asked && robotReplies > 0)
+    robotReplies--;
+  if (id == 0xff) {
+    printError(TextUtils::format("The server turned robot %s%2.2d away",
+				 robotPrefix.c_str(), robot));
+    return;
+  }
+  if (!robotLink)
+    return;
+  if (!asked || numRobots >= MAX_ROBOTS) {
+    // the server added it all the same: nobody would drive it
+    robotLink->sendExit(id);
+    return;
+  }
+
+  char callsign[CallSignLen];
+  snprintf(callsign, CallSignLen, "%s%2.2d", robotPrefix.c_str(), robot);
+  robots[numRobots] = new RobotPlayer(id, callsign, robotLink,
+				      robotMotto.c_str());
+  // for any team, the server picks it and MsgAddPlayer tells
+  robots[numRobots]->setTeam(robotTeam);
+  robotServer[numRobots] = NULL;
+  numRobots++;
+}
+
+void			removeRobot(PlayerId id)
+{
+  for (int i = 0; i < numRobots; i++)
+    if (robots[i] && robots[i]->getId() == id) {
+      delete robots[i];
+      delete robotServer[i];
+      // keep robots[] packed, so the slot is free for the next robot
+      for (int j = i + 1; j < numRobots; j++) {
+	robots[j - 1] = robots[j];
+	robotServer[j - 1] = robotServer[j];
+      }
+      numRobots--;
+      robots[numRobots] = NULL;
+      robotServer[numRobots] = NULL;
+      return;
+    }
+}
+
+void			removeRobots()
+{
+  // the robots on the caller's link leave with it, the others on their own
+  for (int i = 0; i < numRobots; i++) {
+    if (robotServer[i])
+      robotServer[i]->send(MsgExit, 0, NULL);
+    delete robots[i];
+    delete robotServer[i];
+    robots[i] = NULL;
+    robotServer[i] = NULL;
+  }
+  numRobots = 0;
+  robotReplies = 0;
+  robotLink = NULL;
+}
+
+void			handleRobotMessage(uint16_t len, void* msg)
+{
+  if (len < 3)
+    return;
+  PlayerId id;
+  uint16_t code;
+  msg = nboUnpackUByte(msg, id);
+  msg = nboUnpackUShort(msg, code);
+  len -= 3;
+  RobotPlayer* robot = findRobot(id);
+  if (!robot || len < 2)
+    return;
+
+  switch (code) {
+    case MsgReject: {
+      // the MsgRemovePlayer that follows takes the robot away
+      uint16_t rejcode;
+      char reason[MessageLen];
+      msg = nboUnpackUShort(msg, rejcode);
+      msg = nboUnpackString(msg, reason, MessageLen);
+      reason[MessageLen - 1] = '\0';
+      printError(TextUtils::format("Robot %s rejected: %s",
+				   robot->getCallSign(), reason));
+      break;
+    }
+
+    case MsgMessage: {
+      // a private message to the robot: its player reads it
+      if (len < 4)
+	break;
+      PlayerId src, dst;
+      uint8_t type;
+      msg = nboUnpackUByte(msg, src);
+      msg = nboUnpackUByte(msg, dst);
+      msg = nboUnpackUByte(msg, type);
+      if (MessageType(type) != ChatMessage && MessageType(type) != ActionMessage)
+	break;
+      ((char*)msg)[len - 4] = '\0';
+      Player* srcPlayer = lookupPlayer(src);
+      const std::string srcName = (src == ServerPlayer) ? "SERVER" :
+	(srcPlayer ? srcPlayer->getCallSign() : "(UNKNOWN)");
+      printError(TextUtils::format("[%s->%s] %s", srcName.c_str(),
+		 robot->getCallSign(),
+		 stripAnsiCodes(std::string((char*)msg)).c_str()));
+      break;
+    }
+  }
+}
+
+void			readRobotLinks()
+{
+  char msg[MaxPacketLen];
+  uint16_t code, len;
+  int e;
+
+  // the robots' own links carry nothing the caller's does not, but the
+  // lag pings and their own disconnection
+  for (int i = 0; i < numRobots; i++) {
+    ServerLink* link = robotServer[i];
+    if (!link)
+      continue;
+    while ((e = link->read(code, len, msg, 0)) == 1) {
+      if (code == MsgLagPing) {
+	link->send(MsgLagPing, 2, msg);
+      }
+      else if (code == MsgSuperKill) {
+	e = -2;
+	break;
+      }
+    }
+    if (e == -2) {
+      printError(TextUtils::format("Robot %s lost its link",
+				   robots[i]->getCallSign()));
+      removeRobot(robots[i]->getId());
+      i--;
+    }
+  }
+
+  if (robotReplies > 0 &&
+      TimeKeeper::getCurrent() - robotRequestTime > robotReplyTimeout) {
+    printError(TextUtils::format("The server did not answer for %d robots",
+				 robotReplies));
+    robotReplies = 0;
+  }
+}
+
+//
+// hits and deaths
+//
+
+void			setRobotExplosionCallback(RobotExplosionCallback cb)
+{
+  explosionCallback = cb;
+}
+
+bool			blowUpRobot(RobotPlayer* tank, BlowedUpReason reason,
+				    PlayerId killer, const ShotPath* hit,
+				    int phydrv)
+{
+  if (tank->getTeam() == ObserverTeam || !tank->isAlive())
+    return false;
+
+  int shotId = -1;
+  FlagType* flagType = Flags::Null;
+  if (hit) {
+    shotId = hit->getShotId();
+    flagType = hit->getFlag();
+  }
+
+  // you can't take it with you
+  const FlagType* flag = tank->getFlag();
+  if (flag != Flags::Null) {
+    tank->getServer()->sendDropFlag(tank->getId(), tank->getPosition());
+    tank->setFlag(Flags::Null);
+  }
+
+  // don't die if we had the shield flag and we've been shot
+  if (reason != GotShot || flag != Flags::Shield) {
+    if (explosionCallback)
+      explosionCallback(tank, reason, killer, flagType);
+    tank->explodeTank();
+
+    // tell server I'm dead in case it doesn't already know
+    if (reason == GotShot || reason == GotRunOver ||
+	reason == GenocideEffect || reason == SelfDestruct ||
+	reason == WaterDeath || reason == DeathTouch)
+      tank->getServer()->sendKilled(tank->getId(), killer, reason, shotId,
+				    flagType, phydrv);
+  }
+
+  // make sure shot is terminated locally, so that it can't hit the
+  // robot again if it had the shield flag
+  return (reason == GotShot && flag == Flags::Shield && shotId != -1);
+}
+
+static void		checkEnvironment(RobotPlayer* tank)
+{
+  // skip this if i'm dead or paused
+  if (!tank->isAlive() || tank->isPaused()) return;
+
+  World* world = World::getWorld();
+  FlagType* flagd = tank->getFlag();
+  if (flagd->flagTeam != NoTeam) {
+    // have I captured a flag?
+    TeamColor base = world->whoseBase(tank->getPosition());
+    TeamColor team = tank->getTeam();
+    if ((base != NoTeam) &&
+	((flagd->flagTeam == team && base != team) ||
+	 (flagd->flagTeam != team && base == team)))
+      tank->getServer()->sendCaptureFlag(tank->getId(), base);
+  }
+  else if (flagd == Flags::Null && (tank->getLocation() == LocalPlayer::OnGround ||
+				    tank->getLocation() == LocalPlayer::OnBuilding)) {
+    // Don't grab too fast
+    static TimeKeeper lastGrabSent;
+    if (TimeKeeper::getTick()-lastGrabSent > 0.2) {
+      // grab any and all flags i'm driving over
+      const float* tpos = tank->getPosition();
+      const float radius = tank->getRadius();
+      const float radius2 = (radius + BZDBCache::flagRadius) * (radius + BZDBCache::flagRadius);
+      for (int i = 0; i < world->getMaxFlags(); i++) {
+	if (world->getFlag(i).type == Flags::Null || world->getFlag(i).status != FlagOnGround)
+	  continue;
+	const float* fpos = world->getFlag(i).position;
+	if ((fabs(tpos[2] - fpos[2]) < 0.1f) && ((tpos[0] - fpos[0]) * (tpos[0] - fpos[0]) +
+						 (tpos[1] - fpos[1]) * (tpos[1] - fpos[1]) < radius2)) {
+	  tank->getServer()->sendGrabFlag(tank->getId(), i);
+	  lastGrabSent=TimeKeeper::getTick();
+	}
+      }
+    }
+  }
+
+  // see if i've been shot
+  const ShotPath* hit = NULL;
+  float minTime = Infinity;
+  // the client's tank's shots are checked even if it fired them after the
+  // grid was built
+  LocalPlayer* myTank = LocalPlayer::getMyTank();
+  if (myTank)
+    tank->checkHit(myTank, hit, minTime);
+  int i;
+  std::vector<Player*> shooters;
+  SHOTGRID.findShooters(tank, shooters);
+  for (i = 0; i < (int)shooters.size(); i++)
+    if (shooters[i] != myTank && shooters[i]->getId() != tank->getId())
+      tank->checkHit(shooters[i], hit, minTime);
+
+  const float waterLevel = world->getWaterLevel();
+
+  if (hit) {
+    // i got shot!  terminate the shot that hit me and blow up.
+    // force shot to terminate locally immediately (no server round trip);
+    // this is to ensure that we don't get shot again by the same shot
+    // after dropping our shield flag.
+    if (hit->isStoppedByHit())
+      tank->getServer()->sendEndShot(tank->getId(), hit->getPlayer(), hit->getShotId(), 1);
+
+    bool stopShot;
+    if (hit->getFlag() == Flags::Thief) {
+      if (tank->getFlag() != Flags::Null)
+	tank->getServer()->sendTransferFlag(tank->getId(), hit->getPlayer());
+      stopShot = true;
+    }
+    else {
+      stopShot = blowUpRobot(tank, GotShot, hit->getPlayer(), hit);
+    }
+
+    if (stopShot || hit->isStoppedByHit()) {
+      Player* hitter = lookupPlayer(hit->getPlayer());
+      if (hitter) hitter->endShot(hit->getShotId());
+    }
+  }
+  // if not dead yet, see if i'm sitting on death
+  else if (tank->getDeathPhysicsDriver() >= 0) {
+    blowUpRobot(tank, DeathTouch, ServerPlayer, NULL,
+		tank->getDeathPhysicsDriver());
+  }
+  // if not dead yet, see if the robot dropped below the death level
+  else if ((waterLevel > 0.0f) && (tank->getPosition()[2] <= waterLevel)) {
+    blowUpRobot(tank, WaterDeath, ServerPlayer);
+  }
+  // if not dead yet, see if i got run over by the steamroller: the
+  // players close enough to, whatever their size
+  else {
+    const float* myPos = tank->getPosition();
+    const float myRadius = tank->getRadius();
+    std::vector<Player*> nearby;
+    PLAYERGRID.findPlayersNear(myPos, myRadius +
+			       BZDB.eval(StateDatabase::BZDB_SRRADIUSMULT) *
+			       PLAYERGRID.getMaxRadius(), NoTeam, nearby);
+    for (i = 0; i < (int)nearby.size(); i++) {
+      Player* player = nearby[i];
+      if (!player->isPaused() &&
+	  ((player->getFlag() == Flags::Steamroller) ||
+	   ((tank->getFlag() == Flags::Burrow) && player->isAlive() &&
+	    !player->isPhantomZoned()))) {
+	const float* pos = player->getPosition();
+	if (pos[2] < 0.0f) continue;
+	const float radius = myRadius +
+	  (BZDB.eval(StateDatabase::BZDB_SRRADIUSMULT) * player->getRadius());
+	const float distSquared =
+	  hypotf(hypotf(myPos[0] - pos[0],
+			myPos[1] - pos[1]), (myPos[2] - pos[2]) * 2.0f);
+	if (distSquared < radius) {
+	  blowUpRobot(tank, GotRunOver, player->getId());
+	  break;
+	}
+      }
+    }
+  }
+}
+
+void			checkRobotEnvironment()
+{
+  for (int i = 0; i < numRobots; i++)
+    if (robots[i])
+      checkEnvironment(robots[i]);
+
+  // the server messages may remove the players before the next frame
+  PLAYERGRID.clear();
+}
+
+//
+// what the server's messages do to the robots
+//
+
+void			setRobotFlag(PlayerId id, FlagType* flag)
+{
+  RobotPlayer* robot = findRobot(id);
+  if (robot)
+    robot->setFlag(flag);
+}
+
+void			setRobotTeam(PlayerId id, TeamColor team)
+{
+  RobotPlayer* robot = findRobot(id);
+  if (robot)
+    robot->setTeam(team);
+}
+
+void			restartRobot(PlayerId id, const float* pos,
+				     float forward)
+{
+  RobotPlayer* robot = findRobot(id);
+  if (robot) {
+    robot->restart(pos, forward);
+    setRobotTarget(robot);
+  }
+}
+
+void			genocideRobots(Player* victim, Player* killer, int shotId)
+{
+  if (!killer || !victim || shotId < 0)
+    return;
+  const ShotPath* shot = killer->getShot(shotId);
+  if (!shot || shot->getFlag() != Flags::Genocide)
+    return;
+  for (int i = 0; i < numRobots; i++)
+    if (robots[i] && robots[i]->getId() != victim->getId() &&
+	victim->getTeam() == robots[i]->getTeam() &&
+	robots[i]->getTeam() != RogueTeam)
+      blowUpRobot(robots[i], GenocideEffect, killer->getId());
+}
+
+void			captureRobots(TeamColor team)
+{
+  for (int i = 0; i < numRobots; i++)
+    if (robots[i] && robots[i]->getTeam() == team)
+      blowUpRobot(robots[i], GotCaptured, robots[i]->getId());
+}
+
+void			setRobotRabbit(PlayerId id)
+{
+  for (int i = 0; i < numRobots; i++)
+    if (robots[i])
+      robots[i]->changeTeam(robots[i]->getId() == id ? RabbitTeam : HunterTeam);
+}
+
+void			explodeRobots()
+{
+  for (int i = 0; i < numRobots; i++)
+    if (robots[i])
+      robots[i]->explodeTank();
+}
+
+#endif // ROBOT
+
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
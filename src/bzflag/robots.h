@@ -0,0 +1,164 @@
+/* bzflag
+ * Copyright (c) 1993-2011 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* robots:
+ *	The robot tanks, robots[0] to robots[numRobots - 1]: what the bzflag
+ *	client and bzrobots have in common.  Joining them to the server,
+ *	driving them one frame at a time, their hits and deaths, and what
+ *	the server's messages do to them.  The caller reads the messages
+ *	and keeps the world and the other players.
+ */
+
+#ifndef	BZF_ROBOTS_H
+#define	BZF_ROBOTS_H
+
+#include "common.h"
+
+/* common interface headers */
+#include "Address.h"
+#include "Flag.h"
+
+/* local interface headers */
+#include "RobotPlayer.h"
+#include "ServerLink.h"
+#include "ShotPath.h"
+
+
+/** build the robots' obstacle regions, navigation mesh and occupancy
+ * grid for the current world
+ */
+void			buildRobotPlanningData();
+
+/** stop the robots' searches and threads, and forget the planning data
+ * (e.g. when leaving the game).  The robots themselves are the caller's.
+ */
+void			stopRobots();
+
+/** pick a robot's target now, e.g. when it restarts
+ */
+void			setRobotTarget(RobotPlayer* robot);
+
+/** one frame of the robots: restart the dead ones (unless respawn is
+ * false, e.g. when the game is over), pick their targets, let them sense,
+ * decide and move, then shoot and drop flags
+ */
+void			updateRobots(float dt, bool respawn);
+
+/** send the position of the robots that are off their dead reckoning
+ */
+void			sendRobotUpdates();
+
+/** join count robots, called prefix00, prefix01...: over link if the
+ * server can take them over it (they come in with its MsgNewPlayer
+ * replies, see addRobot()), else each on a link of its own to the same
+ * server, which this waits for
+ */
+void			joinRobots(ServerLink* link,
+				   const Address& serverAddress, int port,
+				   int count, const char* prefix,
+				   const char* motto, TeamColor team);
+
+/** how many robots the server has not answered for yet
+ */
+int			getPendingRobots();
+
+/** the robot with that player id, NULL if it is not one of ours
+ */
+RobotPlayer*		findRobot(PlayerId id);
+
+/** the server's MsgNewPlayer reply for robot number robot: its player
+ * id, 0xff if the server turned it away
+ */
+void			addRobot(int robot, PlayerId id);
+
+/** the robot left the game
+ */
+void			removeRobot(PlayerId id);
+
+/** all the robots leave the game
+ */
+void			removeRobots();
+
+/** a MsgRobotMessage: what the server says to one robot alone
+ */
+void			handleRobotMessage(uint16_t len, void* msg);
+
+/** read the robots' own links, if any, and give up on the MsgNewPlayer
+ * replies that take too long
+ */
+void			readRobotLinks();
+
+/** what a robot blowing up looks and sounds like.  The client shows it,
+ * bzrobots has nobody to show it to.
+ */
+typedef void		(*RobotExplosionCallback)(RobotPlayer* robot,
+						  BlowedUpReason reason,
+						  PlayerId killer,
+						  FlagType* flagType);
+void			setRobotExplosionCallback(RobotExplosionCallback);
+
+/** blow a robot up: it drops its flag and tells the server.  Returns
+ * true if the shot that hit it must end now, the shield saving it.
+ */
+bool			blowUpRobot(RobotPlayer* robot, BlowedUpReason reason,
+				    PlayerId killer, const ShotPath* hit = NULL,
+				    int phydrv = -1);
+
+/** the robots capture and grab the flags they drive over, and blow up
+ * from shots, deadly obstacles, the water and steamrollers
+ */
+void			checkRobotEnvironment();
+
+//
+// what the server's messages do to the robots
+//
+
+/** the robot grabbed, dropped or lost a flag (Flags::Null)
+ */
+void			setRobotFlag(PlayerId id, FlagType* flag);
+
+/** the team the server picked for the robot
+ */
+void			setRobotTeam(PlayerId id, TeamColor team);
+
+/** MsgAlive: the robot restarts there
+ */
+void			restartRobot(PlayerId id, const float* pos,
+				     float forward);
+
+/** MsgKilled: the robots on the victim's team blow up, if the shot was
+ * a genocide one
+ */
+void			genocideRobots(Player* victim, Player* killer, int shotId);
+
+/** MsgCaptureFlag: the robots on the captured team blow up
+ */
+void			captureRobots(TeamColor team);
+
+/** MsgNewRabbit: the rabbit is the player id, the robots hunt it
+ */
+void			setRobotRabbit(PlayerId id);
+
+/** the game is over: the robots blow up
+ */
+void			explodeRobots();
+
+
+#endif // BZF_ROBOTS_H
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
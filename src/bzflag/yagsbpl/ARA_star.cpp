@@ -0,0 +1,204 @@
+// ARA* - see ARA_star.h
+
+
+template <class NodeType, class CostType>
+void ARA_star_planner<NodeType,CostType>::init( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p )
+{
+	GenericPlannerInstance.init(*theEnv_p, heapMode);  // This initiates the graph, hash and heap of the generic planner
+	seed();
+}
+
+// -----------------------------
+
+template <class NodeType, class CostType>
+void ARA_star_planner<NodeType,CostType>::clearLastPlanAndInit( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p )
+{
+	if (!hash)
+	{
+		init(theEnv_p);
+		return;
+	}
+
+	// Clear the last search, but not the hash table: the nodes and their successor links are kept
+	GenericPlannerInstance.reinit(*theEnv_p);
+	seed();
+}
+
+// -----------------------------
+
+template <class NodeType, class CostType>
+void ARA_star_planner<NodeType,CostType>::seed(void)
+{
+	// Remapping for coding convenience
+	GraphDescriptor = GenericPlannerInstance.GraphDescriptor;
+	hash = GenericPlannerInstance.hash;
+	heap = GenericPlannerInstance.heap;
+
+	heap->clear();
+	incons.clear();
+	eps = initialEps;
+	iteration = 1;
+	finished = false;
+	expandcount = 0;
+	solutionCount = 0;
+	solutionCost = infinity;
+	solutionEps = 0.0;
+
+	startNode = initiate( hash->getNodeInHash( GraphDescriptor->SeedNode ) );
+	startNode->plannerVars.g = 0;
+	startNode->f = key( startNode );
+	heap->push( startNode );
+	goalNode = initiate( hash->getNodeInHash( GraphDescriptor->TargetNode ) );
+}
+
+// -----------------------------
+
+template <class NodeType, class CostType>
+SearchGraphNode< NodeType, CostType, ARA_star_variables<CostType> >*
+								ARA_star_planner<NodeType,CostType>::initiate( GraphNode_p np )
+{
+	np = hash->refresh( np );
+	if ( !np->initiated )
+	{
+		np->plannerVars.g = infinity;
+		np->plannerVars.closedIteration = 0;
+		np->plannerVars.inIncons = false;
+		np->came_from = NULL;
+		np->initiated = true; // Always set this when other variables have already been set
+	}
+	return (np);
+}
+
+// ==================================================================================
+
+template <class NodeType, class CostType>
+bool ARA_star_planner<NodeType,CostType>::plan( int maxExpansions )
+{
+	int expansions = 0;
+	while (!finished)
+	{
+		// ImprovePath: expand until nothing in the heap can lead to a cheaper path to the goal
+		if ( !heap->empty() && goalNode->plannerVars.g > heap->top()->f )
+		{
+			if (expansions >= maxExpansions)
+				return false;
+			expand( heap->pop() );
+			expansions++;
+			continue;
+		}
+
+		// This iteration is over
+		if ( goalNode->plannerVars.g == infinity )
+		{
+			finished = true; // The heap ran empty: there is no path
+			break;
+		}
+		if ( goalNode->plannerVars.g < solutionCost )
+		{
+			solutionCost = goalNode->plannerVars.g;
+			solutionCount++;
+		}
+		solutionEps = eps;
+		if (eps <= 1.0)
+		{
+			finished = true; // A shortest path
+			break;
+		}
+		nextIteration();
+	}
+	return true;
+}
+
+// -----------------------------
+
+template <class NodeType, class CostType>
+void ARA_star_planner<NodeType,CostType>::expand( GraphNode_p thisGraphNode )
+{
+	GraphNode_p thisNeighbourGraphNode;
+	CostType test_g_val;
+	int a;
+
+	thisGraphNode->plannerVars.closedIteration = iteration; // Put in closed list
+	expandcount++;
+
+	// Generate the neighbours if they are already not generated
+	if ( thisGraphNode->successors.empty() ) // Successors were not generated previously
+	{
+		GraphDescriptor->_getSuccessors( thisGraphNode->n , &neighbourBuffer , &transitionCostBuffer );
+		hash->initLinks( thisGraphNode->successors, neighbourBuffer.size() );
+		for (a=0; a<neighbourBuffer.size(); a++)
+			thisGraphNode->successors.set(a, hash->getNodeInHash(neighbourBuffer[a]), transitionCostBuffer[a]);
+	}
+
+	for (a=0; a<thisGraphNode->successors.size(); a++)
+	{
+		thisNeighbourGraphNode = initiate( thisGraphNode->successors.getLinkSearchGraphNode(a) );
+		test_g_val = thisGraphNode->plannerVars.g + thisGraphNode->successors.getLinkCost(a);
+		if ( test_g_val >= thisNeighbourGraphNode->plannerVars.g )
+			continue;
+
+		thisNeighbourGraphNode->plannerVars.g = test_g_val;
+		thisNeighbourGraphNode->came_from = thisGraphNode;
+		if ( thisNeighbourGraphNode->plannerVars.closedIteration != iteration )
+		{
+			thisNeighbourGraphNode->f = key( thisNeighbourGraphNode );
+			if ( thisNeighbourGraphNode->inHeap )
+				heap->update( thisNeighbourGraphNode );
+			else
+				heap->push( thisNeighbourGraphNode );
+		}
+		else if ( !thisNeighbourGraphNode->plannerVars.inIncons )
+		{
+			// Already expanded in this iteration: it waits for the next one
+			thisNeighbourGraphNode->plannerVars.inIncons = true;
+			incons.push_back( thisNeighbourGraphNode );
+		}
+	}
+}
+
+// -----------------------------
+
+template <class NodeType, class CostType>
+void ARA_star_planner<NodeType,CostType>::nextIteration(void)
+{
+	eps -= epsStep;
+	if (eps < 1.0)
+		eps = 1.0;
+	iteration++; // Empties the closed list
+
+	// The heap and INCONS make the new heap, keyed with the new factor
+	while ( !heap->empty() )
+		incons.push_back( heap->pop() );
+	if ( incons.empty() )
+		return;
+	int least = 0;
+	for (int a=0; a<incons.size(); a++)
+	{
+		incons[a]->plannerVars.inIncons = false;
+		incons[a]->f = key( incons[a] );
+		if ( incons[a]->f < incons[least]->f )
+			least = a;
+	}
+	// The least key goes in first: a bucket heap is based on its first key, and grows downwards
+	//   one whole array shift at a time
+	std::swap( incons[0], incons[least] );
+	for (int a=0; a<incons.size(); a++)
+		heap->push( incons[a] );
+	incons.clear();
+}
+
+// ==================================================================================
+
+template <class NodeType, class CostType>
+std::vector<NodeType> ARA_star_planner<NodeType,CostType>::getPlannedPath(void)
+{
+	std::vector<NodeType> ret;
+	if ( !pathFound() )
+		return (ret);
+
+	// The back pointers always form a tree: g only goes down, and with it the pointer
+	for (GraphNode_p thisGraphNode = goalNode; thisGraphNode; thisGraphNode = thisGraphNode->came_from)
+		ret.push_back( thisGraphNode->n );
+	std::reverse( ret.begin(), ret.end() );
+	return (ret);
+}
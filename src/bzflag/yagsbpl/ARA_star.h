@@ -0,0 +1,110 @@
+// ARA* (M. Likhachev, G. Gordon and S. Thrun, "ARA*: Anytime A* with Provable Bounds on
+//   Sub-Optimality", NIPS 2003), written against the YAGSBPL graph descriptor and containers (see
+//   yagsbpl_base.h). Not part of the YAGSBPL distribution.
+//
+// A_star_planner with 'subopEps' > 1 finds a path quickly, but then it is done: the path is only
+//   known to be within a factor 'subopEps' of the shortest one. ARA* starts with a large
+//   inflation factor, and once it has a path it lowers the factor and carries on from the same
+//   search tree instead of starting over:
+//   - A node whose g goes down after it was expanded in the current iteration is not put back in
+//     the heap (which would make the iteration an ordinary, slower, A*) but set aside in INCONS.
+//   - When an iteration ends, INCONS goes back in the heap, the keys are recomputed with the new
+//     factor, and the closed list is emptied (by bumping 'iteration').
+//   Every iteration ends with a path at most 'epsilon' times the shortest one, and the last one
+//   (epsilon 1) with a shortest one.
+//
+// 'plan' stops after a given number of expansions, and picks up where it left off next time, so
+//   the caller can spread the search over several frames and use each path as soon as it appears.
+// The graph is given by getSuccessors alone; isAccessible is not used. Keys are g + epsilon * h,
+//   rounded down. With epsilon > 1 they are not consistent (they go down along the way to the
+//   goal), so HEAP_MODE_BUCKET works but keeps growing its bucket array downwards: prefer the
+//   default HEAP_MODE_DARY.
+
+
+#ifndef __ARA_STAR_9B3E5F20C7D4_H_
+#define __ARA_STAR_9B3E5F20C7D4_H_
+
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "yagsbpl_base.h"
+
+template <class CostType>
+class ARA_star_variables
+{
+public:
+	CostType g;
+	int closedIteration; // Iteration in which the node was expanded: closed if it is the current one
+	bool inIncons; // Whether in the INCONS list or not
+};
+
+template <class NodeType, class CostType>
+class ARA_star_planner
+{
+public:
+	// typedef's for convenience:
+	typedef  ARA_star_variables<CostType>  PlannerSpecificVariables;
+	typedef  SearchGraphNode< NodeType, CostType, PlannerSpecificVariables >*  GraphNode_p;
+
+	// Instance of generic planner
+	GenericPlanner< NodeType, CostType, PlannerSpecificVariables > GenericPlannerInstance;
+	// Re-mapping of generic planner variables for ease of use (coding convenience)
+	GenericSearchGraphDescriptor<NodeType,CostType>* GraphDescriptor;
+	HashTableContainer<NodeType,CostType,PlannerSpecificVariables>* hash;
+	HeapContainer<NodeType,CostType,PlannerSpecificVariables>* heap;
+
+	// Member variables
+	double initialEps, epsStep; // Inflation factor of the first iteration, and how much less each next one uses
+	int heapMode; // HEAP_MODE_DARY or HEAP_MODE_BUCKET (integer costs only)
+	CostType infinity;
+	double eps; // Inflation factor of the current iteration
+	int iteration;
+	bool finished; // The last iteration is over, or there is no path
+	std::vector< GraphNode_p > incons; // Nodes whose g went down after they were expanded in this iteration
+	GraphNode_p startNode, goalNode;
+	std::vector< NodeType > neighbourBuffer; // Kept between searches so that 'plan' does not allocate
+	std::vector< CostType > transitionCostBuffer;
+	int expandcount; // Nodes expanded since the search was seeded, over all iterations
+	// The best path so far: found at the end of an iteration with inflation factor 'solutionEps'
+	int solutionCount; // Number of times a cheaper path was found
+	CostType solutionCost;
+	double solutionEps;
+
+	// Initializer and planner
+	ARA_star_planner()
+		{ GraphDescriptor = NULL; hash = NULL; heap = NULL; initialEps = 3.0; epsStep = 0.5; heapMode = HEAP_MODE_DARY;
+		  infinity = std::numeric_limits<CostType>::max(); eps = initialEps; iteration = 0; finished = true;
+		  startNode = NULL; goalNode = NULL; expandcount = 0; solutionCount = 0; solutionCost = infinity; solutionEps = 0.0; }
+	void setParams( double firstEps=3.0 , double eachEpsStep=0.5 , int heapMd=HEAP_MODE_DARY ) // call to this is optional.
+		{ initialEps = (firstEps < 1.0) ? 1.0 : firstEps; epsStep = eachEpsStep; heapMode = heapMd; }
+	// Starts over with an empty hash table, from theEnv.SeedNode (start) to theEnv.TargetNode (goal).
+	void init( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p );
+	// Clear the last search, but not the hash table (see A_star_planner::clearLastPlanAndInit).
+	void clearLastPlanAndInit( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p );
+	// Expands at most 'maxExpansions' nodes. Returns true once the search is finished: either the
+	//   last path is a shortest one, or there is no path. Calling it again then does nothing.
+	bool plan( int maxExpansions );
+
+	// Planner output access: ( can be called between calls to plan() )
+	bool pathFound(void) { return ( solutionCount > 0 ); }
+	CostType getPlannedPathCost(void) { return ( solutionCost ); }
+	double getPlannedPathEps(void) { return ( solutionEps ); } // The path costs at most this times the least cost
+	std::vector< NodeType > getPlannedPath(void); // From the start to the goal. Empty if there is none yet.
+
+private:
+	void seed(void);
+	GraphNode_p initiate( GraphNode_p np );
+	void expand( GraphNode_p np );
+	void nextIteration(void);
+	CostType key( GraphNode_p np )
+		{ return ( np->plannerVars.g + (CostType)(eps * GraphDescriptor->_getHeuristicsToTarget( np->n )) ); }
+};
+
+// ------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------
+// Since we use templates, the definitions need to be included in the header file as well.
+
+#include "ARA_star.cpp"
+
+#endif
@@ -31,7 +31,7 @@ void A_star_planner<NodeType,CostType>::init( GenericSearchGraphDescriptor<NodeT
 	GraphNode_p thisGraphNode;
 	
 	if (theEnv_p)
-		GenericPlannerInstance.init(*theEnv_p, heapKeyCount);  // This initiates the graph, hash and heap of the generic planner
+		GenericPlannerInstance.init(*theEnv_p, heapMode);  // This initiates the graph, hash and heap of the generic planner
 	
 	// Remapping for coding convenience
 	GraphDescriptor = GenericPlannerInstance.GraphDescriptor;
@@ -42,6 +42,9 @@ void A_star_planner<NodeType,CostType>::init( GenericSearchGraphDescriptor<NodeT
 	GraphDescriptor->init();
 	heap->clear();
 	bookmarkGraphNodes.clear();
+	seedInaccessible = false;
+	counters.reset();
+	hashCollisionBase = hash->collisions;
 
 	for (int a=0; a<GraphDescriptor->SeedNodes.size(); a++)
 	{
@@ -61,8 +64,9 @@ void A_star_planner<NodeType,CostType>::init( GenericSearchGraphDescriptor<NodeT
 			{
 //				printf("ERROR (A_star): At least one of the seed nodes is not accessible!" );
 //				exit(1);
-			  // show error in bzflag
-			  controlPanel->addMessage("ERROR (A_star): At least one of the seed nodes is not accessible!");
+				// Left to the caller to report: the planner may be running on another thread
+				seedInaccessible = true;
+				counters.inaccessibleSeeds++;
 			}
 			else
 				thisGraphNode->plannerVars.accessible = true;
@@ -72,7 +76,9 @@ void A_star_planner<NodeType,CostType>::init( GenericSearchGraphDescriptor<NodeT
 		
 		// Push in heap
 		heap->push( thisGraphNode );
+		counters.generated++;
 	}
+	counters.heapPeak = heap->size();
 }
 
 // -----------------------------
@@ -80,20 +86,16 @@ void A_star_planner<NodeType,CostType>::init( GenericSearchGraphDescriptor<NodeT
 template <class NodeType, class CostType>
 void A_star_planner<NodeType,CostType>::clearLastPlanAndInit( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p )
 {
-	// Set every node in hash to not expanded
-	if (hash->HashTable)
-		for (int a=0; a<hash->hashTableSize; a++)
-			for (int b=0; b<hash->HashTable[a].size(); b++)
-			{
-				hash->HashTable[a][b]->plannerVars.expanded = false;
-				hash->HashTable[a][b]->initiated = false;
-			}
-	
-	// Clear the last plan, but not the hash table
-	if (theEnv_p)
+	if (!hash)
+	{
 		init(theEnv_p);
-	else
-		init(GraphDescriptor);
+		return;
+	}
+	
+	// Clear the last plan, but not the hash table. The nodes (and their successor links) are kept;
+	//   the hash marks them as not initiated lazily, the first time this search reaches them.
+	GenericPlannerInstance.reinit( theEnv_p ? *theEnv_p : *GraphDescriptor );
+	init();
 }
 
 // ==================================================================================
@@ -103,28 +105,15 @@ void A_star_planner<NodeType,CostType>::plan(void)
 {
 	GraphNode_p thisGraphNode, thisNeighbourGraphNode;
 	CostType this_g_val, thisTransitionCost, test_g_val;
-	std::vector< NodeType > thisNeighbours;
-	std::vector< CostType > thisTransitionCosts;
+	std::vector< NodeType >& thisNeighbours = neighbourBuffer;
+	std::vector< CostType >& thisTransitionCosts = transitionCostBuffer;
 	int a;
+	double startTime = yagsbpl_wall_clock(), successorStartTime;
+	bool timeSuccessors;
 	
-	#if _YAGSBPL_A_STAR__VIEW_PROGRESS
-		float timediff = 0.0;
-		expandcount = 0;
-		startclock = clock();
-		startsecond = time(NULL);
-	#endif
 	while ( !heap->empty() )
 	{
-		#if _YAGSBPL_A_STAR__VIEW_PROGRESS
-			if (expandcount % ProgressShowInterval == 0)
-			{
-				if (timediff>=0.0)
-					timediff = ((float)(clock()-startclock)) / ((float)CLOCKS_PER_SEC);
-				printf("Number of states expanded: %d. Heap size: %d. Time elapsed: %f s.\n", 
-						expandcount, heap->size(), ((timediff>=0.0) ? timediff : difftime(time(NULL),startsecond)) );
-			}
-			expandcount++;
-		#endif
+		counters.expanded++;
 	
 		// Get the node with least f-value
 		thisGraphNode = heap->pop();
@@ -143,33 +132,28 @@ void A_star_planner<NodeType,CostType>::plan(void)
 		if ( GraphDescriptor->_stopSearch( thisGraphNode->n ) )
 		{
 			bookmarkGraphNodes.push_back(thisGraphNode);
-			#if _YAGSBPL_A_STAR__VIEW_PROGRESS
-				if (timediff>=0.0)
-					timediff = ((float)(clock()-startclock)) / ((float)CLOCKS_PER_SEC);
-				printf("Stopping search!! Number of states expanded: %d. Heap size: %d. Time elapsed: %f s.\n", 
-						expandcount, heap->size(), ((timediff>=0.0) ? timediff : difftime(time(NULL),startsecond)) );
-			#endif
-			return;
+			break;
 		}
 		// Check if we need to store the path leading to this node
 		if ( GraphDescriptor->_storePath( thisGraphNode->n ) )
-		{
 			bookmarkGraphNodes.push_back(thisGraphNode);
-			#if _YAGSBPL_A_STAR__VIEW_PROGRESS
-				if (timediff>=0.0)
-					timediff = ((float)(clock()-startclock)) / ((float)CLOCKS_PER_SEC);
-				printf("Stored a path!! Number of states expanded: %d. Heap size: %d. Time elapsed: %f s.\n", 
-						expandcount, heap->size(), ((timediff>=0.0) ? timediff : difftime(time(NULL),startsecond)) );
-			#endif
-		}
 		
 		// Generate the neighbours if they are already not generated
 		thisNeighbours.clear();
 		thisTransitionCosts.clear();
 		if ( thisGraphNode->successors.empty() ) // Successors were not generated previously
 		{
+			timeSuccessors = counters.timeNextSuccessorCall();
+			if (timeSuccessors)
+				successorStartTime = yagsbpl_wall_clock();
 			GraphDescriptor->_getSuccessors( thisGraphNode->n , &thisNeighbours , &thisTransitionCosts );
-			thisGraphNode->successors.init( thisNeighbours.size() );
+			if (timeSuccessors)
+			{
+				counters.timedSuccessorSeconds += yagsbpl_wall_clock() - successorStartTime;
+				counters.timedSuccessorCalls++;
+			}
+			counters.successorCalls++;
+			hash->initLinks( thisGraphNode->successors, thisNeighbours.size() );
 			for (a=0; a<thisNeighbours.size(); a++)
 				thisGraphNode->successors.set(a, hash->getNodeInHash(thisNeighbours[a]), thisTransitionCosts[a]);
 		}
@@ -178,7 +162,7 @@ void A_star_planner<NodeType,CostType>::plan(void)
 		this_g_val = thisGraphNode->plannerVars.g;
 		for (a=0; a<thisGraphNode->successors.size(); a++)
 		{
-			thisNeighbourGraphNode = thisGraphNode->successors.getLinkSearchGraphNode(a);
+			thisNeighbourGraphNode = hash->refresh( thisGraphNode->successors.getLinkSearchGraphNode(a) );
 			thisTransitionCost = thisGraphNode->successors.getLinkCost(a);
 			
 			// An uninitiated neighbour node - definitely g & f values not set either.
@@ -196,6 +180,9 @@ void A_star_planner<NodeType,CostType>::plan(void)
 					
 					// Put in open list and continue to next neighbour
 					heap->push( thisNeighbourGraphNode );
+					counters.generated++;
+					if (heap->size() > counters.heapPeak)
+						counters.heapPeak = heap->size();
 				}
 				thisNeighbourGraphNode->initiated = true; // Always set this when other variables have already been set
 				#if _YAGSBPL_A_STAR__HANDLE_EVENTS
@@ -225,9 +212,8 @@ void A_star_planner<NodeType,CostType>::plan(void)
 				thisNeighbourGraphNode->came_from = thisGraphNode;
 				thisNeighbourGraphNode->plannerVars.seedLineage = thisGraphNode->plannerVars.seedLineage;
 				
-				// Since thisNeighbourGraphNode->f is changed, re-arrange it in heap
-				heap->remove( thisNeighbourGraphNode );
-				heap->push( thisNeighbourGraphNode );
+				// Since thisNeighbourGraphNode->f has decreased, move it up in the heap
+				heap->update( thisNeighbourGraphNode );
 				#if _YAGSBPL_A_STAR__HANDLE_EVENTS
 					if (event_SuccUpdated_g)
 						event_SuccUpdated_g(thisGraphNode->n, thisNeighbourGraphNode->n, thisTransitionCost, 
@@ -241,6 +227,10 @@ void A_star_planner<NodeType,CostType>::plan(void)
 			}
 		}
 	}
+	
+	counters.planSeconds = yagsbpl_wall_clock() - startTime;
+	counters.estimateSuccessorSeconds();
+	counters.hashCollisions = (int)(hash->collisions - hashCollisionBase);
 }
 
 // ==================================================================================
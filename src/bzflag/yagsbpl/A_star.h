@@ -36,7 +36,6 @@
 #include <ctime>
 #include "yagsbpl_base.h"
 
-#define _YAGSBPL_A_STAR__VIEW_PROGRESS 1
 #define _YAGSBPL_A_STAR__HANDLE_EVENTS 1
 
 template <class CostType>
@@ -66,9 +65,11 @@ public:
 	
 	// Member variables
 	double subopEps;
-	int heapKeyCount;
-	int ProgressShowInterval;
+	int heapMode; // HEAP_MODE_DARY or HEAP_MODE_BUCKET (integer costs only)
 	std::vector< GraphNode_p > bookmarkGraphNodes;
+	std::vector< NodeType > neighbourBuffer; // Kept between searches so that 'plan' does not allocate
+	std::vector< CostType > transitionCostBuffer;
+	bool seedInaccessible; // Set by 'init' if one of the seed nodes is not accessible
 	
 	// Optional event handlers - Pointers to function that get called when an event take place
 	#if _YAGSBPL_A_STAR__HANDLE_EVENTS
@@ -82,15 +83,15 @@ public:
 	
 	// Initializer and planner
 	A_star_planner()
-		{ subopEps = 1.0; heapKeyCount = 20; ProgressShowInterval = 10000; 
+		{ GraphDescriptor = NULL; hash = NULL; heap = NULL; subopEps = 1.0; heapMode = HEAP_MODE_DARY; seedInaccessible = false; hashCollisionBase = 0;
 		  event_NodeExpanded_g=NULL; event_NodeExpanded_nm=NULL; event_SuccUpdated_g=NULL; event_SuccUpdated_nm=NULL; }
-	void setParams( double eps=1.0 , int heapKeyCt=20 , int progressDispInterval=10000 ) // call to this is optional.
-		{ subopEps = eps; heapKeyCount = heapKeyCt; ProgressShowInterval = progressDispInterval; }
+	void setParams( double eps=1.0 , int heapMd=HEAP_MODE_DARY ) // call to this is optional.
+		{ subopEps = eps; heapMode = heapMd; }
 	void init( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p=NULL );
 	void init( GenericSearchGraphDescriptor<NodeType,CostType> theEnv ) { init( &theEnv); } // for version compatability
 	void plan(void);
-	// Clear the last plan, but not the hash table.
-	
+	// Clear the last plan, but not the hash table. This is O(1): a planner kept alive between
+	//   searches on the same graph reuses its nodes and successor links.
 	void clearLastPlanAndInit( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p=NULL );
 	
 	// Planner output access: ( to be called after plan(), and before destruction of planner )
@@ -100,12 +101,10 @@ public:
 	std::vector< CostType > getPlannedPathCosts(void);
 	A_star_variables<CostType> getNodeInfo(NodeType n);
 	
-	// Other variables for querying progress of planning process from other functions
-	#if  _YAGSBPL_A_STAR__VIEW_PROGRESS
-		clock_t  startclock;
-		time_t startsecond;
-		int expandcount;
-	#endif
+	// What the last search did, from 'init' to the end of 'plan'. Replaces the old printf progress
+	//   reports: the caller decides what to do with them.
+	SearchCounters counters;
+	long hashCollisionBase; // hash->collisions when the search started
 };
 
 // ------------------------------------------------------------------------------
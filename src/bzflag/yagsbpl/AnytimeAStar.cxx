@@ -0,0 +1,132 @@
+/* AnytimeAStar.cxx
+ *
+ * See AnytimeAStar.h
+ */
+
+// interface header
+#include "AnytimeAStar.h"
+
+/* system implementation headers */
+#include <algorithm>
+#include <cstdlib>
+
+// common implementation headers
+#include "TimeKeeper.h"
+
+
+// the clock is only read every so many expansions
+static const int expansionsPerClockCheck = 64;
+
+
+AnytimeAStarPlanner::AnytimeAStarPlanner(double _initialEpsilon, double _epsilonStep) :
+  container(NULL), planner(NULL), initialEpsilon(_initialEpsilon), epsilonStep(_epsilonStep),
+  hashTableSize(0), gridVersion(0), searchStarted(false), searching(false) {
+}
+
+
+AnytimeAStarPlanner::~AnytimeAStarPlanner() {
+  clear();
+}
+
+
+void AnytimeAStarPlanner::clear() {
+  delete planner;
+  planner = NULL;
+  delete container;
+  container = NULL;
+  searchStarted = false;
+  searching = false;
+}
+
+
+void AnytimeAStarPlanner::rebuild(const OccupancyGrid &grid) {
+  delete planner;
+  delete container;
+
+  container = new GraphFunctionContainer((int)(0.5f * BZDBCache::worldSize), grid);
+  // getHashBin() is abs(2x + 3y), so this covers every node of the grid
+  const int maxAbsCoord = std::max(abs(grid.getMinCoord()), abs(grid.getMaxCoord()));
+  hashTableSize = 5 * maxAbsCoord + 1;
+
+  // the hash table and the heap are created by the first search
+  planner = new ARA_star_planner<MyNode,int>;
+  // inflated keys drop as the search closes in on the goal, which a bucket heap handles badly
+  planner->setParams(initialEpsilon, epsilonStep, HEAP_MODE_DARY);
+  gridVersion = grid.getVersion();
+  searchStarted = false;
+}
+
+
+void AnytimeAStarPlanner::start(const MyNode &start, const MyNode &goal) {
+  startNode = start;
+  goalNode = goal;
+  searchStarted = false;
+  searching = true;
+}
+
+
+bool AnytimeAStarPlanner::prepare() {
+  if (!searching)
+    return false;
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+
+  // a new world invalidates the search tree: start over with the same start and goal
+  if (!planner || gridVersion != grid.getVersion())
+    rebuild(grid);
+  if (!searchStarted) {
+    // the hash bins only cover the grid, and both ends go in the hash table
+    if (startNode.x < grid.getMinCoord() || startNode.x > grid.getMaxCoord() ||
+        startNode.y < grid.getMinCoord() || startNode.y > grid.getMaxCoord() ||
+        goalNode.x < grid.getMinCoord() || goalNode.x > grid.getMaxCoord() ||
+        goalNode.y < grid.getMinCoord() || goalNode.y > grid.getMaxCoord()) {
+      searching = false;
+      return false;
+    }
+    GenericSearchGraphDescriptor<MyNode, int> graph;
+    graph.func_container = container;
+    graph.hashTableSize = hashTableSize;
+    graph.SeedNode = startNode;
+    graph.TargetNode = goalNode;
+    planner->clearLastPlanAndInit(&graph);
+    searchStarted = true;
+  }
+  return true;
+}
+
+
+bool AnytimeAStarPlanner::improve(double budget) {
+  if (!prepare())
+    return false;
+
+  const int solutions = planner->solutionCount;
+  const TimeKeeper startTime = TimeKeeper::getCurrent();
+  while (!planner->plan(expansionsPerClockCheck)) {
+    if (TimeKeeper::getCurrent() - startTime >= budget)
+      break;
+  }
+  if (planner->finished)
+    searching = false;
+  return planner->solutionCount != solutions;
+}
+
+
+int AnytimeAStarPlanner::expand(int maxExpansions) {
+  if (maxExpansions <= 0 || !prepare())
+    return 0;
+
+  const int expanded = planner->expandcount;
+  if (planner->plan(maxExpansions))
+    searching = false;
+  return planner->expandcount - expanded;
+}
+
+
+bool AnytimeAStarPlanner::getPath(std::vector<MyNode> &path) {
+  path.clear();
+  if (!hasPath())
+    return false;
+  path = planner->getPlannedPath();
+  return true;
+}
@@ -0,0 +1,111 @@
+/* AnytimeAStar.h
+ *
+ * The YAGSBPL ARA* planner over GraphFunctionContainer, run a little at a time.
+ *
+ * A tank that needs a long path should not stall the frame while it is found, and does not need
+ * the shortest one right away.  start() seeds a search with a high inflation factor, and each
+ * call to improve() carries it on for at most a given time (or expand(), for at most a given
+ * number of expansions, see PlanningScheduler).  The first path (at most
+ * getEpsilon() times the shortest one) usually shows up within a few calls; later calls lower
+ * the factor and keep improving the path, on the same search tree, until it is a shortest one.
+ * The tank can drive along each path as soon as it shows up.
+ *
+ * Each tank needs its own planner, since the search goes on between frames.  The nodes are kept
+ * between searches, like GraphAStarPlanner does, until the world changes.
+ */
+
+#ifndef ANYTIMEASTAR_H_
+#define ANYTIMEASTAR_H_
+
+/* system interface headers */
+#include <vector>
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+#include "ARA_star.h"
+
+
+class AnytimeAStarPlanner {
+public:
+  /* Constructor
+   * @param initialEpsilon Inflation factor of the first path.
+   * @param epsilonStep How much lower the factor is for each next path.
+   */
+  AnytimeAStarPlanner(double initialEpsilon = 3.0, double epsilonStep = 0.5);
+  ~AnytimeAStarPlanner();
+
+  /* Starts a new search.  Nothing is expanded until improve() or expand() is called.
+   * @param start The node from which to start the search.
+   * @param goal The search will try to find a path to this node.
+   */
+  void start(const MyNode &start, const MyNode &goal);
+
+  /* Carries on with the search.
+   * @param budget How long to search for, in seconds.  The search stops a little after the
+   *               budget runs out, or when it is done.
+   * @return True if a better path was found, false otherwise.
+   */
+  bool improve(double budget);
+
+  /* Carries on with the search, for at most a given number of expansions.
+   * @param maxExpansions How many nodes to expand at most.
+   * @return The number of nodes expanded.
+   */
+  int expand(int maxExpansions);
+
+  /* Indicates whether or not there is a search, and it is still improving its path.
+   */
+  bool isSearching() const { return searching; }
+
+  /* Indicates whether or not a path has been found.
+   */
+  bool hasPath() const { return planner && searchStarted && planner->pathFound(); }
+
+  /* The number of paths found since start().  Goes up by one for every better path.
+   */
+  int getPathCount() const { return hasPath() ? planner->solutionCount : 0; }
+
+  /* Gets the best path found so far.
+   * @param path Writes the path here, from start to goal (inclusive).  Cleared if there is none.
+   * @return True if there is a path, false otherwise.
+   */
+  bool getPath(std::vector<MyNode> &path);
+
+  /* The path costs at most this many times the least cost (1 for a shortest path).
+   */
+  double getEpsilon() const { return hasPath() ? planner->getPlannedPathEps() : 0.0; }
+
+  const MyNode &getStart() const { return startNode; }
+  const MyNode &getGoal() const { return goalNode; }
+
+  /* The number of nodes expanded since start(), over all calls to improve() and expand().
+   */
+  int getExpandCount() const { return planner ? planner->expandcount : 0; }
+
+  /* Stops searching.  The nodes are kept for the next search.
+   */
+  void stop() { searching = false; }
+
+  /* Throws away the planner and its nodes, and stops searching.
+   */
+  void clear();
+
+private:
+  AnytimeAStarPlanner(const AnytimeAStarPlanner&);
+  AnytimeAStarPlanner& operator=(const AnytimeAStarPlanner&);
+
+  void rebuild(const OccupancyGrid &grid);
+  bool prepare();  // seeds the search if need be; false if there is nothing to search
+
+  GraphFunctionContainer *container;
+  ARA_star_planner<MyNode,int> *planner;
+  double initialEpsilon, epsilonStep;
+  int hashTableSize;
+  unsigned int gridVersion;  // OccupancyGrid version the planner was built for
+  MyNode startNode, goalNode;
+  bool searchStarted;  // the planner was seeded with startNode and goalNode
+  bool searching;
+};
+
+
+#endif /* ANYTIMEASTAR_H_ */
@@ -0,0 +1,84 @@
+/* BidirectionalAStar.cxx
+ *
+ * See BidirectionalAStar.h
+ */
+
+// interface header
+#include "BidirectionalAStar.h"
+
+/* system implementation headers */
+#include <algorithm>
+#include <cstdlib>
+
+
+BidirectionalAStarPlanner::BidirectionalAStarPlanner() :
+  container(NULL), planner(NULL), hashTableSize(0), gridVersion(0), expandCount(0) {
+}
+
+
+BidirectionalAStarPlanner::~BidirectionalAStarPlanner() {
+  clear();
+}
+
+
+void BidirectionalAStarPlanner::clear() {
+  delete planner;
+  planner = NULL;
+  delete container;
+  container = NULL;
+}
+
+
+void BidirectionalAStarPlanner::rebuild(const OccupancyGrid &grid) {
+  clear();
+
+  container = new GraphFunctionContainer((int)(0.5f * BZDBCache::worldSize), grid);
+  // getHashBin() is abs(2x + 3y), so this covers every node of the grid
+  const int maxAbsCoord = std::max(abs(grid.getMinCoord()), abs(grid.getMaxCoord()));
+  hashTableSize = 5 * maxAbsCoord + 1;
+
+  // the hash tables and the heaps are created by the first search
+  planner = new Bidirectional_A_star_planner<MyNode,int>;
+  planner->setParams(HEAP_MODE_BUCKET);  // integer octile costs
+  gridVersion = grid.getVersion();
+}
+
+
+bool BidirectionalAStarPlanner::plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path) {
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+  return plan(grid, start, goal, path);
+}
+
+
+bool BidirectionalAStarPlanner::plan(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal,
+                                     std::vector<MyNode> &path) {
+  path.clear();
+  expandCount = 0;
+  // snapshots keep the version of the grid they were taken from
+  if (!planner || gridVersion != grid.getVersion())
+    rebuild(grid);
+
+  // the hash bins only cover the grid, and both ends go in the hash tables
+  if (start.x < grid.getMinCoord() || start.x > grid.getMaxCoord() ||
+      start.y < grid.getMinCoord() || start.y > grid.getMaxCoord() ||
+      goal.x < grid.getMinCoord() || goal.x > grid.getMaxCoord() ||
+      goal.y < grid.getMinCoord() || goal.y > grid.getMaxCoord())
+    return false;
+
+  // re-seed the planner, keeping the nodes of the earlier searches
+  GenericSearchGraphDescriptor<MyNode, int> graph;
+  graph.func_container = container;
+  graph.hashTableSize = hashTableSize;
+  graph.SeedNode = start;
+  graph.TargetNode = goal;
+  planner->clearLastPlanAndInit(&graph);
+  planner->plan();
+  expandCount = planner->expandcount;
+
+  if (!planner->pathFound())
+    return false;
+  path = planner->getPlannedPath();
+  return true;
+}
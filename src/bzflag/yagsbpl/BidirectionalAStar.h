@@ -0,0 +1,66 @@
+/* BidirectionalAStar.h
+ *
+ * The YAGSBPL bidirectional A* planner over GraphFunctionContainer, kept alive between searches
+ * like GraphAStarPlanner.
+ *
+ * A forward search from the start and a backward search from the goal (over the container's
+ * getPredecessors()) meet in the middle.  On an open map that expands about as many nodes as plain
+ * A*, but when the goal is walled in (a flag dropped in a closed courtyard, a spot on top of a
+ * building that snapped to a pocket of open cells) plain A* expands every cell it can reach before
+ * giving up, while the backward search runs out of cells as soon as it has filled the pocket.
+ * The paths are shortest paths, of the same cost as the ones GridAStarPlanner finds.
+ */
+
+#ifndef BIDIRECTIONALASTAR_H_
+#define BIDIRECTIONALASTAR_H_
+
+/* system interface headers */
+#include <vector>
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+#include "Bidirectional_A_star.h"
+
+
+class BidirectionalAStarPlanner {
+public:
+  BidirectionalAStarPlanner();
+  ~BidirectionalAStarPlanner();
+
+  /* Finds a shortest path from the start node to the goal node.
+   * @param start The node from which to start the search.
+   * @param goal The search will try to find a path to this node.
+   * @param path Writes the path here, from start to goal (inclusive).  Cleared if there is no path.
+   * @return True if a path was found, false otherwise.
+   */
+  bool plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* Same as above, on the given grid instead of the shared OccupancyGrid.  The grid is only read,
+   * so planners that do not share state can search the same grid from several threads.
+   * @param grid The raster to search, already built (e.g. an OccupancyGrid::snapshot()).
+   */
+  bool plan(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* The number of nodes expanded by the last call to plan(), in both directions.
+   */
+  int getExpandCount() const { return expandCount; }
+
+  /* Throws away the planner and its nodes.  The next call to plan() rebuilds them.
+   */
+  void clear();
+
+private:
+  BidirectionalAStarPlanner(const BidirectionalAStarPlanner&);
+  BidirectionalAStarPlanner& operator=(const BidirectionalAStarPlanner&);
+
+  void rebuild(const OccupancyGrid &grid);
+
+  GraphFunctionContainer *container;
+  Bidirectional_A_star_planner<MyNode,int> *planner;
+  int hashTableSize;
+  unsigned int gridVersion;  // OccupancyGrid version the planner was built for
+  int expandCount;
+};
+
+
+#endif /* BIDIRECTIONALASTAR_H_ */
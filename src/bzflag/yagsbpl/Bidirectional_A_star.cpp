@@ -0,0 +1,197 @@
+// Bidirectional A* - see Bidirectional_A_star.h
+
+
+template <class NodeType, class CostType>
+void Bidirectional_A_star_planner<NodeType,CostType>::init( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p )
+{
+	// The backward search seeds at the goal and heads for the start
+	GenericSearchGraphDescriptor<NodeType,CostType> backwardEnv = *theEnv_p;
+	backwardEnv.SeedNodes.clear();
+	backwardEnv.SeedNode = theEnv_p->TargetNode;
+	backwardEnv.TargetNode = theEnv_p->SeedNode;
+
+	// This initiates the graph, hash and heap of the generic planners
+	GenericPlannerInstance[0].init(*theEnv_p, heapMode);
+	GenericPlannerInstance[1].init(backwardEnv, heapMode);
+	seed();
+}
+
+// -----------------------------
+
+template <class NodeType, class CostType>
+void Bidirectional_A_star_planner<NodeType,CostType>::clearLastPlanAndInit( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p )
+{
+	if (!hash[0])
+	{
+		init(theEnv_p);
+		return;
+	}
+
+	// Clear the last plan, but not the hash tables: the nodes, their links and their twins are kept
+	GenericSearchGraphDescriptor<NodeType,CostType> backwardEnv = *theEnv_p;
+	backwardEnv.SeedNodes.clear();
+	backwardEnv.SeedNode = theEnv_p->TargetNode;
+	backwardEnv.TargetNode = theEnv_p->SeedNode;
+
+	GenericPlannerInstance[0].reinit(*theEnv_p);
+	GenericPlannerInstance[1].reinit(backwardEnv);
+	seed();
+}
+
+// -----------------------------
+
+template <class NodeType, class CostType>
+void Bidirectional_A_star_planner<NodeType,CostType>::seed(void)
+{
+	GraphNode_p thisGraphNode;
+
+	// Remapping for coding convenience
+	GraphDescriptor = GenericPlannerInstance[0].GraphDescriptor;
+	for (int dir=0; dir<2; dir++)
+	{
+		hash[dir] = GenericPlannerInstance[dir].hash;
+		heap[dir] = GenericPlannerInstance[dir].heap;
+		heap[dir]->clear();
+	}
+	bestCost = infinity;
+	meetNode[0] = meetNode[1] = NULL;
+
+	// Only one seed per direction: the path is put together from the two seeds' trees
+	for (int dir=0; dir<2; dir++)
+	{
+		thisGraphNode = hash[dir]->getNodeInHash( GenericPlannerInstance[dir].GraphDescriptor->SeedNode );
+		thisGraphNode->plannerVars.g = 0;
+		thisGraphNode->plannerVars.expanded = false;
+		thisGraphNode->came_from = NULL;
+		thisGraphNode->f = heuristics( thisGraphNode->n, dir );
+		thisGraphNode->initiated = true; // Always set this when other variables have already been set
+		heap[dir]->push( thisGraphNode );
+	}
+
+	// The start may be the goal
+	GraphNode_p startTwin = getTwin( heap[0]->top(), 0 );
+	if ( startTwin->initiated )
+	{
+		bestCost = 0;
+		meetNode[0] = heap[0]->top();
+		meetNode[1] = startTwin;
+	}
+}
+
+// -----------------------------
+
+template <class NodeType, class CostType>
+SearchGraphNode< NodeType, CostType, Bidirectional_A_star_variables<NodeType,CostType> >*
+						Bidirectional_A_star_planner<NodeType,CostType>::getTwin( GraphNode_p np , int dir )
+{
+	if ( !np->plannerVars.twin )
+	{
+		// Creates the node in the other table if that search has not seen it yet
+		GraphNode_p twin = hash[1-dir]->getNodeInHash( np->n );
+		np->plannerVars.twin = twin;
+		twin->plannerVars.twin = np;
+		return (twin);
+	}
+	return ( hash[1-dir]->refresh( np->plannerVars.twin ) );
+}
+
+// ==================================================================================
+
+template <class NodeType, class CostType>
+void Bidirectional_A_star_planner<NodeType,CostType>::plan(void)
+{
+	expandcount = 0;
+	expandcountDir[0] = expandcountDir[1] = 0;
+
+	while ( !heap[0]->empty() && !heap[1]->empty() )
+	{
+		// Nothing left in either heap can lead to a cheaper path than the best one found
+		if ( heap[0]->top()->f >= bestCost || heap[1]->top()->f >= bestCost )
+			break;
+		expand( (heap[0]->size() <= heap[1]->size()) ? 0 : 1 );
+	}
+	expandcount = expandcountDir[0] + expandcountDir[1];
+}
+
+// -----------------------------
+
+template <class NodeType, class CostType>
+void Bidirectional_A_star_planner<NodeType,CostType>::expand( int dir )
+{
+	GraphNode_p thisGraphNode, thisNeighbourGraphNode, twin;
+	CostType test_g_val;
+	int a;
+
+	// Get the node with least f-value
+	thisGraphNode = heap[dir]->pop();
+	thisGraphNode->plannerVars.expanded = true; // Put in closed list
+	expandcountDir[dir]++;
+
+	// Forward along the successors, backward along the predecessors
+	NodeLinks<NodeType,CostType,PlannerSpecificVariables>& links =
+							(dir == 0) ? thisGraphNode->successors : thisGraphNode->predecessors;
+	if ( links.empty() ) // Links were not generated previously
+	{
+		if (dir == 0)
+			GraphDescriptor->_getSuccessors( thisGraphNode->n , &neighbourBuffer , &transitionCostBuffer );
+		else
+			GraphDescriptor->_getPredecessors( thisGraphNode->n , &neighbourBuffer , &transitionCostBuffer );
+		hash[dir]->initLinks( links, neighbourBuffer.size() );
+		for (a=0; a<neighbourBuffer.size(); a++)
+			links.set(a, hash[dir]->getNodeInHash(neighbourBuffer[a]), transitionCostBuffer[a]);
+	}
+
+	for (a=0; a<links.size(); a++)
+	{
+		thisNeighbourGraphNode = hash[dir]->refresh( links.getLinkSearchGraphNode(a) );
+		test_g_val = thisGraphNode->plannerVars.g + links.getLinkCost(a);
+
+		if ( !thisNeighbourGraphNode->initiated )
+		{
+			thisNeighbourGraphNode->plannerVars.expanded = false;
+			thisNeighbourGraphNode->plannerVars.g = test_g_val;
+			thisNeighbourGraphNode->came_from = thisGraphNode;
+			thisNeighbourGraphNode->f = test_g_val + heuristics( thisNeighbourGraphNode->n, dir );
+			thisNeighbourGraphNode->initiated = true; // Always set this when other variables have already been set
+			heap[dir]->push( thisNeighbourGraphNode );
+		}
+		else if ( !thisNeighbourGraphNode->plannerVars.expanded && test_g_val < thisNeighbourGraphNode->plannerVars.g )
+		{
+			thisNeighbourGraphNode->plannerVars.g = test_g_val;
+			thisNeighbourGraphNode->f = test_g_val + heuristics( thisNeighbourGraphNode->n, dir );
+			thisNeighbourGraphNode->came_from = thisGraphNode;
+			// Since thisNeighbourGraphNode->f has decreased, move it up in the heap
+			heap[dir]->update( thisNeighbourGraphNode );
+		}
+		else
+			continue;
+
+		// The other search has been here too: that makes a path from the start to the goal
+		twin = getTwin( thisNeighbourGraphNode, dir );
+		if ( twin->initiated && test_g_val + twin->plannerVars.g < bestCost )
+		{
+			bestCost = test_g_val + twin->plannerVars.g;
+			meetNode[dir] = thisNeighbourGraphNode;
+			meetNode[1-dir] = twin;
+		}
+	}
+}
+
+// ==================================================================================
+
+template <class NodeType, class CostType>
+std::vector<NodeType> Bidirectional_A_star_planner<NodeType,CostType>::getPlannedPath(void)
+{
+	std::vector<NodeType> ret;
+	if ( !pathFound() )
+		return (ret);
+
+	// From the meeting node back to the start, turned around...
+	for (GraphNode_p thisGraphNode = meetNode[0]; thisGraphNode; thisGraphNode = thisGraphNode->came_from)
+		ret.push_back( thisGraphNode->n );
+	std::reverse( ret.begin(), ret.end() );
+	// ...then on from the meeting node to the goal
+	for (GraphNode_p thisGraphNode = meetNode[1]->came_from; thisGraphNode; thisGraphNode = thisGraphNode->came_from)
+		ret.push_back( thisGraphNode->n );
+	return (ret);
+}
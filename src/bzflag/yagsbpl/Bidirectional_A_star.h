@@ -0,0 +1,108 @@
+// Bidirectional A*, written against the YAGSBPL graph descriptor and containers (see
+//   yagsbpl_base.h). Not part of the YAGSBPL distribution.
+//
+// One A* runs forward from 'SeedNode' (the start) over getSuccessors, toward 'TargetNode'; another
+//   runs backward from 'TargetNode' (the goal) over getPredecessors, toward 'SeedNode'. Each has its
+//   own hash table and heap, since a node can only be in one heap at a time. A node keeps a pointer
+//   to the same node in the other table ('twin'), so meeting the other search costs no hash lookup
+//   once the two tables have both seen the node.
+//
+// Every time one search reaches a node the other search has reached too, the two g-values give a
+//   path; the cheapest one so far is kept ('bestCost'). Each heap's least f is a lower bound on the
+//   cost of any path not found yet (such a path has to leave that search's closed set through a
+//   node in its heap), so the search stops as soon as either least f reaches 'bestCost'. With a
+//   consistent heuristic the path is then a shortest one. If either heap runs empty first, there
+//   is no path: every node that side can reach has been expanded without meeting the other side.
+//   That is what makes it cheap to find out that a goal is walled in: the backward search
+//   runs out after expanding the goal's pocket, while a forward A* expands everything it can reach.
+//
+// The side with the smaller heap is expanded next (Pohl's cardinality criterion), so the search
+//   grows from whichever end is more enclosed.
+// The graph is given by getSuccessors and getPredecessors alone; isAccessible is not used. The
+//   descriptor's getHeuristics is used toward the goal in the forward search and toward the start
+//   in the backward search, so it must be consistent both ways (e.g. symmetric). There is no
+//   sub-optimality factor: the stopping rule needs admissible f-values.
+
+
+#ifndef __BIDIRECTIONAL_A_STAR_4E8B1D7C2A95_H_
+#define __BIDIRECTIONAL_A_STAR_4E8B1D7C2A95_H_
+
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "yagsbpl_base.h"
+
+template <class NodeType, class CostType>
+class Bidirectional_A_star_variables
+{
+public:
+	CostType g; // Cost from this search's seed
+	bool expanded; // Whether in closed list or not
+	// The same node in the other search's hash table. Set the first time it is needed, and kept
+	//   with the node between searches.
+	SearchGraphNode< NodeType, CostType, Bidirectional_A_star_variables<NodeType,CostType> >* twin;
+	Bidirectional_A_star_variables() { twin = NULL; }
+};
+
+template <class NodeType, class CostType>
+class Bidirectional_A_star_planner
+{
+public:
+	// typedef's for convenience:
+	typedef  Bidirectional_A_star_variables<NodeType,CostType>  PlannerSpecificVariables;
+	typedef  SearchGraphNode< NodeType, CostType, PlannerSpecificVariables >*  GraphNode_p;
+	typedef  HashTableContainer< NodeType, CostType, PlannerSpecificVariables >  Hash;
+	typedef  HeapContainer< NodeType, CostType, PlannerSpecificVariables >  Heap;
+
+	// One instance of the generic planner per direction: [0] forward, [1] backward
+	GenericPlanner< NodeType, CostType, PlannerSpecificVariables > GenericPlannerInstance[2];
+	// Re-mapping of generic planner variables for ease of use (coding convenience)
+	GenericSearchGraphDescriptor<NodeType,CostType>* GraphDescriptor; // The forward one
+	Hash* hash[2];
+	Heap* heap[2];
+
+	// Member variables
+	int heapMode; // HEAP_MODE_DARY or HEAP_MODE_BUCKET (integer costs only)
+	CostType infinity;
+	CostType bestCost; // Cost of the best path found so far, 'infinity' if none
+	GraphNode_p meetNode[2]; // Where the best path found so far crosses over, in each table
+	std::vector< NodeType > neighbourBuffer; // Kept between searches so that 'plan' does not allocate
+	std::vector< CostType > transitionCostBuffer;
+	int expandcount; // Nodes expanded by the last call to 'plan', both directions together
+	int expandcountDir[2];
+
+	// Initializer and planner
+	Bidirectional_A_star_planner()
+		{ GraphDescriptor = NULL; hash[0] = hash[1] = NULL; heap[0] = heap[1] = NULL; heapMode = HEAP_MODE_DARY;
+		  infinity = std::numeric_limits<CostType>::max(); bestCost = infinity; meetNode[0] = meetNode[1] = NULL;
+		  expandcount = 0; expandcountDir[0] = expandcountDir[1] = 0; }
+	void setParams( int heapMd=HEAP_MODE_DARY ) // call to this is optional.
+		{ heapMode = heapMd; }
+	// Starts over with empty hash tables.
+	void init( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p );
+	// Clear the last plan, but not the hash tables (see A_star_planner::clearLastPlanAndInit).
+	void clearLastPlanAndInit( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p );
+	void plan(void);
+
+	// Planner output access: ( to be called after plan() )
+	bool pathFound(void) { return ( bestCost != infinity ); }
+	CostType getPlannedPathCost(void) { return ( bestCost ); }
+	std::vector< NodeType > getPlannedPath(void); // From the start to the goal. Empty if there is none.
+
+private:
+	void seed(void);
+	GraphNode_p getTwin( GraphNode_p np , int dir );
+	void expand( int dir );
+	CostType heuristics( NodeType& n , int dir )
+		{ return ( dir == 0 ? GraphDescriptor->_getHeuristics( n, GraphDescriptor->TargetNode )
+		                    : GraphDescriptor->_getHeuristics( n, GraphDescriptor->SeedNode ) ); }
+};
+
+// ------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------
+// Since we use templates, the definitions need to be included in the header file as well.
+
+#include "Bidirectional_A_star.cpp"
+
+#endif
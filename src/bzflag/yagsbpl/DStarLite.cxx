@@ -0,0 +1,98 @@
+/* DStarLite.cxx
+ *
+ * See DStarLite.h
+ */
+
+// interface header
+#include "DStarLite.h"
+
+/* system implementation headers */
+#include <algorithm>
+#include <cstdlib>
+
+
+DStarLitePlanner::DStarLitePlanner(int _maxGoalDrift) :
+  container(NULL), planner(NULL), maxGoalDrift(_maxGoalDrift), gridVersion(0), expandCount(0) {
+}
+
+
+DStarLitePlanner::~DStarLitePlanner() {
+  clear();
+}
+
+
+void DStarLitePlanner::clear() {
+  delete planner;
+  planner = NULL;
+  delete container;
+  container = NULL;
+}
+
+
+void DStarLitePlanner::rebuild(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal) {
+  clear();
+
+  container = new GraphFunctionContainer((int)(0.5f * BZDBCache::worldSize));
+  GenericSearchGraphDescriptor<MyNode, int> graph;
+  graph.func_container = container;
+  // getHashBin() is abs(2x + 3y), so this covers every node of the grid
+  graph.hashTableSize = 5 * std::max(abs(grid.getMinCoord()), abs(grid.getMaxCoord())) + 1;
+  graph.SeedNode = start;
+  graph.TargetNode = goal;
+
+  planner = new D_star_lite_planner<MyNode,int>;
+  planner->init(&graph);
+  gridVersion = grid.getVersion();
+}
+
+
+bool DStarLitePlanner::plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path) {
+  path.clear();
+  expandCount = 0;
+
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+
+  // the hash bins only cover the grid
+  if (start.x < grid.getMinCoord() || start.x > grid.getMaxCoord() ||
+      start.y < grid.getMinCoord() || start.y > grid.getMaxCoord() ||
+      goal.x < grid.getMinCoord() || goal.x > grid.getMaxCoord() ||
+      goal.y < grid.getMinCoord() || goal.y > grid.getMaxCoord())
+    return false;
+
+  // the edge costs come from the grid, so a new grid needs a new tree
+  std::vector<MyNode> tail;
+  if (!planner || gridVersion != grid.getVersion()) {
+    rebuild(grid, start, goal);
+    root = goal;
+  } else {
+    planner->moveStart(start);
+    // keep the root if the goal is still close to it, and much closer to it than to the tank
+    const int drift = octileDistance(goal.x - root.x, goal.y - root.y);
+    if (drift > maxGoalDrift || 4 * drift > octileDistance(goal.x - start.x, goal.y - start.y) ||
+        !walkStraight(grid, root, goal, tail)) {
+      tail.clear();
+      planner->moveGoal(goal);
+      root = goal;
+    }
+  }
+  planner->plan();
+  expandCount = planner->expandcount;
+  path = planner->getPlannedPath();
+
+  if (path.empty() && !tail.empty()) {
+    // the tank cannot reach the old root, but the goal may still be reachable
+    tail.clear();
+    planner->moveGoal(goal);
+    root = goal;
+    planner->plan();
+    expandCount += planner->expandcount;
+    path = planner->getPlannedPath();
+  }
+  if (path.empty())
+    return false;
+
+  path.insert(path.end(), tail.begin(), tail.end());
+  return true;
+}
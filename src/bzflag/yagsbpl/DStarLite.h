@@ -0,0 +1,77 @@
+/* DStarLite.h
+ *
+ * Incremental replanning toward a moving goal, with the YAGSBPL D* Lite planner over
+ * GraphFunctionContainer.
+ *
+ * A tank chasing an enemy used to throw its path away and run a new A* search every time the
+ * enemy moved into another cell.  Consecutive searches differ only by a cell or two at each end,
+ * so most of that work was repeated.  This class keeps one D* Lite search tree per tank: when the
+ * tank or its goal has moved since the last call, plan() only repairs the part of the tree the
+ * move invalidated.  The first call (and the first call after the world changes) is a full search.
+ *
+ * The goal is the root of the tree, so the tank moving is cheap (the tree stays valid), but the
+ * goal moving means re-rooting it, which costs about as much as a new search.  So small goal moves
+ * are not followed right away: as long as the goal stays within maxGoalDrift of the root and can be
+ * reached from it in a straight line, the path goes to the root and then straight to the goal.
+ * Such a path is at most 2 * maxGoalDrift longer than the shortest one.  With maxGoalDrift 0 every
+ * path is a shortest path, of the same cost as the ones GridAStarPlanner finds.
+ *
+ * See: S. Koenig and M. Likhachev, "D* Lite", AAAI 2002.
+ */
+
+#ifndef DSTARLITE_H_
+#define DSTARLITE_H_
+
+/* system interface headers */
+#include <vector>
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+#include "D_star_lite.h"
+
+
+class DStarLitePlanner {
+public:
+  /* Constructor
+   * @param maxGoalDrift How far the goal may move before the tree is re-rooted, in
+   *                     STRAIGHT_COST/DIAGONAL_COST units.
+   */
+  DStarLitePlanner(int maxGoalDrift = 4 * STRAIGHT_COST);
+  ~DStarLitePlanner();
+
+  /* Finds a shortest path from the start node to the goal node, reusing the previous search.
+   * @param start The node from which to start the search, usually where the tank is now.
+   * @param goal The search will try to find a path to this node.
+   * @param path Writes the path here, from start to goal (inclusive).  Cleared if there is no path.
+   * @return True if a path was found, false otherwise.
+   */
+  bool plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* The number of nodes expanded by the last call to plan().  0 if the tree was still valid.
+   */
+  int getExpandCount() const { return expandCount; }
+
+  /* The number of nodes in the search tree.
+   */
+  int getNodeCount() const { return planner ? planner->hash->nodeCount() : 0; }
+
+  /* Throws away the search tree.  The next call to plan() starts from scratch.
+   */
+  void clear();
+
+private:
+  DStarLitePlanner(const DStarLitePlanner&);
+  DStarLitePlanner& operator=(const DStarLitePlanner&);
+
+  void rebuild(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal);
+
+  GraphFunctionContainer *container;
+  D_star_lite_planner<MyNode,int> *planner;
+  MyNode root;               // the goal the tree is rooted at
+  int maxGoalDrift;
+  unsigned int gridVersion;  // OccupancyGrid version the search tree was built for
+  int expandCount;
+};
+
+
+#endif /* DSTARLITE_H_ */
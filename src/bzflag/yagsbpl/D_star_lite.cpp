@@ -0,0 +1,255 @@
+// D* Lite - see D_star_lite.h
+
+
+template <class NodeType, class CostType>
+void D_star_lite_planner<NodeType,CostType>::init( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p )
+{
+	// The lexicographic keys need the tie-breaking of the d-ary heap
+	GenericPlannerInstance.init(*theEnv_p, HEAP_MODE_DARY);  // This initiates the graph, hash and heap of the generic planner
+
+	// Remapping for coding convenience
+	GraphDescriptor = GenericPlannerInstance.GraphDescriptor;
+	hash = GenericPlannerInstance.hash;
+	heap = GenericPlannerInstance.heap;
+
+	GraphDescriptor->init();
+	heap->clear();
+	km = 0;
+	expandcount = 0;
+
+	startNode = getNode( GraphDescriptor->SeedNode );
+	goalNode = getNode( GraphDescriptor->TargetNode );
+	goalNode->plannerVars.rhs = 0;
+	updateVertex( goalNode );
+}
+
+// -----------------------------
+
+template <class NodeType, class CostType>
+void D_star_lite_planner<NodeType,CostType>::moveStart( NodeType n )
+{
+	GraphNode_p newStart = getNode(n);
+	if (newStart == startNode)
+		return;
+
+	// Every key in the heap is now off by at most this much; the keys are fixed lazily in 'plan'
+	km += GraphDescriptor->_getHeuristics( startNode->n, newStart->n );
+	startNode = newStart;
+	GraphDescriptor->SeedNode = n;
+}
+
+template <class NodeType, class CostType>
+void D_star_lite_planner<NodeType,CostType>::moveGoal( NodeType n )
+{
+	GraphNode_p oldGoal = goalNode;
+	goalNode = getNode(n);
+	if (goalNode == oldGoal)
+		return;
+	GraphDescriptor->TargetNode = n;
+
+	// Only the rhs of the two goals change: re-root the tree, and let 'plan' propagate the rest
+	goalNode->plannerVars.rhs = 0;
+	goalNode->came_from = NULL;
+	updateVertex( goalNode );
+	oldGoal->plannerVars.rhs = lookahead( oldGoal, &(oldGoal->came_from) );
+	updateVertex( oldGoal );
+}
+
+// ==================================================================================
+
+template <class NodeType, class CostType>
+void D_star_lite_planner<NodeType,CostType>::plan(void)
+{
+	GraphNode_p thisGraphNode, thisNeighbourGraphNode;
+	CostType k1, k2, startK1, startK2, oldG, viaThis;
+	int a;
+
+	expandcount = 0;
+	while ( !heap->empty() )
+	{
+		// Stop once the start is consistent and nothing left in the heap can improve it
+		calculateKey( startNode, startK1, startK2 );
+		thisGraphNode = heap->top();
+		if ( !keyLess(thisGraphNode->f, thisGraphNode->f2, startK1, startK2) &&
+				startNode->plannerVars.rhs <= startNode->plannerVars.g )
+			break;
+
+		calculateKey( thisGraphNode, k1, k2 );
+		if ( keyLess(thisGraphNode->f, thisGraphNode->f2, k1, k2) )
+		{
+			// Key was computed before the start moved - re-file it
+			thisGraphNode->f = k1;
+			thisGraphNode->f2 = k2;
+			heap->update( thisGraphNode );
+			continue;
+		}
+
+		expandcount++;
+		heap->remove( thisGraphNode );
+		generatePredecessors( thisGraphNode );
+
+		if ( thisGraphNode->plannerVars.g > thisGraphNode->plannerVars.rhs )
+		{
+			// Overconsistent: g goes down to rhs, which may lower the rhs of the predecessors
+			thisGraphNode->plannerVars.g = thisGraphNode->plannerVars.rhs;
+			for (a=0; a<thisGraphNode->predecessors.size(); a++)
+			{
+				thisNeighbourGraphNode = initiate( thisGraphNode->predecessors.getLinkSearchGraphNode(a) );
+				if ( thisNeighbourGraphNode == goalNode )
+					continue;
+				viaThis = thisGraphNode->predecessors.getLinkCost(a) + thisGraphNode->plannerVars.g;
+				if ( viaThis < thisNeighbourGraphNode->plannerVars.rhs )
+				{
+					thisNeighbourGraphNode->plannerVars.rhs = viaThis;
+					thisNeighbourGraphNode->came_from = thisGraphNode;
+					updateVertex( thisNeighbourGraphNode );
+				}
+			}
+		}
+		else
+		{
+			// Underconsistent: g goes up to infinity, and the predecessors that relied on it look again
+			oldG = thisGraphNode->plannerVars.g;
+			thisGraphNode->plannerVars.g = infinity;
+			for (a=0; a<thisGraphNode->predecessors.size(); a++)
+			{
+				thisNeighbourGraphNode = initiate( thisGraphNode->predecessors.getLinkSearchGraphNode(a) );
+				if ( thisNeighbourGraphNode == goalNode )
+					continue;
+				if ( thisNeighbourGraphNode->plannerVars.rhs == thisGraphNode->predecessors.getLinkCost(a) + oldG )
+				{
+					thisNeighbourGraphNode->plannerVars.rhs =
+						lookahead( thisNeighbourGraphNode, &(thisNeighbourGraphNode->came_from) );
+					updateVertex( thisNeighbourGraphNode );
+				}
+			}
+			updateVertex( thisGraphNode );
+		}
+	}
+}
+
+// ==================================================================================
+
+template <class NodeType, class CostType>
+std::vector<NodeType> D_star_lite_planner<NodeType,CostType>::getPlannedPath(void)
+{
+	std::vector<NodeType> ret;
+	if ( !pathFound() )
+		return (ret);
+
+	// Walk down the tree, always moving to the successor with the least cost-to-goal.
+	//   The number of nodes in the hash bounds the length of a path without cycles.
+	GraphNode_p thisGraphNode = startNode;
+	int maxLength = hash->nodeCount();
+	ret.push_back( thisGraphNode->n );
+	while ( thisGraphNode != goalNode )
+	{
+		GraphNode_p next = NULL;
+		if ( lookahead(thisGraphNode, &next) == infinity || (int)ret.size() > maxLength )
+		{
+			ret.clear();
+			return (ret);
+		}
+		thisGraphNode = next;
+		ret.push_back( thisGraphNode->n );
+	}
+	return (ret);
+}
+
+// ==================================================================================
+
+template <class NodeType, class CostType>
+SearchGraphNode< NodeType, CostType, D_star_lite_variables<CostType> >*
+								D_star_lite_planner<NodeType,CostType>::getNode( NodeType n )
+{
+	return ( initiate( hash->getNodeInHash(n) ) );
+}
+
+template <class NodeType, class CostType>
+SearchGraphNode< NodeType, CostType, D_star_lite_variables<CostType> >*
+								D_star_lite_planner<NodeType,CostType>::initiate( GraphNode_p np )
+{
+	// The planner never starts a new search generation, so this only happens once per node
+	np = hash->refresh( np );
+	if ( !np->initiated )
+	{
+		np->plannerVars.g = infinity;
+		np->plannerVars.rhs = infinity;
+		np->came_from = NULL;
+		np->initiated = true; // Always set this when other variables have already been set
+	}
+	return (np);
+}
+
+template <class NodeType, class CostType>
+void D_star_lite_planner<NodeType,CostType>::generateSuccessors( GraphNode_p np )
+{
+	if ( !np->successors.empty() ) // Successors were generated previously
+		return;
+	GraphDescriptor->_getSuccessors( np->n , &neighbourBuffer , &transitionCostBuffer );
+	hash->initLinks( np->successors, neighbourBuffer.size() );
+	for (int a=0; a<neighbourBuffer.size(); a++)
+		np->successors.set(a, hash->getNodeInHash(neighbourBuffer[a]), transitionCostBuffer[a]);
+}
+
+template <class NodeType, class CostType>
+void D_star_lite_planner<NodeType,CostType>::generatePredecessors( GraphNode_p np )
+{
+	if ( !np->predecessors.empty() ) // Predecessors were generated previously
+		return;
+	GraphDescriptor->_getPredecessors( np->n , &neighbourBuffer , &transitionCostBuffer );
+	hash->initLinks( np->predecessors, neighbourBuffer.size() );
+	for (int a=0; a<neighbourBuffer.size(); a++)
+		np->predecessors.set(a, hash->getNodeInHash(neighbourBuffer[a]), transitionCostBuffer[a]);
+}
+
+template <class NodeType, class CostType>
+CostType D_star_lite_planner<NodeType,CostType>::lookahead( GraphNode_p np , GraphNode_p* best_p )
+{
+	CostType best = infinity, thisCost;
+	GraphNode_p thisNeighbourGraphNode;
+	if (best_p)
+		*best_p = NULL;
+
+	generateSuccessors( np );
+	for (int a=0; a<np->successors.size(); a++)
+	{
+		thisNeighbourGraphNode = initiate( np->successors.getLinkSearchGraphNode(a) );
+		if ( thisNeighbourGraphNode->plannerVars.g == infinity )
+			continue;
+		thisCost = np->successors.getLinkCost(a) + thisNeighbourGraphNode->plannerVars.g;
+		if ( thisCost < best )
+		{
+			best = thisCost;
+			if (best_p)
+				*best_p = thisNeighbourGraphNode;
+		}
+	}
+	return (best);
+}
+
+template <class NodeType, class CostType>
+void D_star_lite_planner<NodeType,CostType>::calculateKey( GraphNode_p np , CostType& k1 , CostType& k2 )
+{
+	k2 = (np->plannerVars.g < np->plannerVars.rhs) ? np->plannerVars.g : np->plannerVars.rhs;
+	if ( k2 == infinity )
+		k1 = infinity;
+	else
+		k1 = k2 + GraphDescriptor->_getHeuristics( startNode->n, np->n ) + km;
+}
+
+template <class NodeType, class CostType>
+void D_star_lite_planner<NodeType,CostType>::updateVertex( GraphNode_p np )
+{
+	if ( np->plannerVars.g != np->plannerVars.rhs )
+	{
+		calculateKey( np, np->f, np->f2 );
+		if ( np->inHeap )
+			heap->update( np );
+		else
+			heap->push( np );
+	}
+	else if ( np->inHeap )
+		heap->remove( np );
+}
+
@@ -0,0 +1,93 @@
+// D* Lite (S. Koenig and M. Likhachev, "D* Lite", AAAI 2002), written against the YAGSBPL
+//   graph descriptor and containers (see yagsbpl_base.h). Not part of the YAGSBPL distribution.
+//
+// The search runs backward, from 'TargetNode' (the goal) toward 'SeedNode' (the start), and is kept
+//   between calls to 'plan'. Every node holds g (the cost to the goal found so far) and rhs (the
+//   one-step lookahead of g); only the nodes whose g and rhs disagree are in the heap. After the
+//   start or the goal moves, 'plan' repairs just the part of the tree that the move made wrong:
+//   - 'moveStart': the heuristics are measured to the start, so moving it only shifts every key by
+//     the same amount. That shift is accumulated in 'km' instead of re-keying the heap.
+//   - 'moveGoal': the goal is the root of the tree. The new goal gets rhs 0, the old goal gets the
+//     rhs of an ordinary node, and the changes propagate from there like edge cost changes do.
+//
+// The descriptor must provide getPredecessors as well as getSuccessors. Edge costs are assumed
+//   not to change while the planner is alive; make a new one (or call 'init') when they do.
+// Keys are compared lexicographically, using SearchGraphNode::f and f2, so the heap is always a
+//   d-ary heap (HEAP_MODE_BUCKET ignores f2).
+
+
+#ifndef __D_STAR_LITE_6C1D03A9E4B2_H_
+#define __D_STAR_LITE_6C1D03A9E4B2_H_
+
+
+#include <vector>
+#include <limits>
+#include "yagsbpl_base.h"
+
+template <class CostType>
+class D_star_lite_variables
+{
+public:
+	CostType g; // Cost to the goal found so far
+	CostType rhs; // min over the successors of (transition cost + g), 0 for the goal
+};
+
+template <class NodeType, class CostType>
+class D_star_lite_planner
+{
+public:
+	// typedef's for convenience:
+	typedef  D_star_lite_variables<CostType>  PlannerSpecificVariables;
+	typedef  SearchGraphNode< NodeType, CostType, PlannerSpecificVariables >*  GraphNode_p;
+
+	// Instance of generic planner
+	GenericPlanner< NodeType, CostType, PlannerSpecificVariables > GenericPlannerInstance;
+	// Re-mapping of generic planner variables for ease of use (coding convenience)
+	GenericSearchGraphDescriptor<NodeType,CostType>* GraphDescriptor;
+	HashTableContainer<NodeType,CostType,PlannerSpecificVariables>* hash;
+	HeapContainer<NodeType,CostType,PlannerSpecificVariables>* heap;
+
+	// Member variables
+	CostType infinity; // g and rhs of the nodes that cannot reach the goal (yet)
+	CostType km; // Key modifier: sum of the heuristics between the successive starts
+	GraphNode_p startNode, goalNode;
+	std::vector< NodeType > neighbourBuffer; // Kept between searches so that link generation does not allocate
+	std::vector< CostType > transitionCostBuffer;
+	int expandcount; // Nodes expanded by the last call to 'plan'
+
+	// Initializer and planner
+	D_star_lite_planner()
+		{ GraphDescriptor = NULL; hash = NULL; heap = NULL; infinity = std::numeric_limits<CostType>::max();
+		  km = 0; startNode = NULL; goalNode = NULL; expandcount = 0; }
+	// Throws away the search tree and starts over from theEnv.SeedNode (start) and theEnv.TargetNode (goal).
+	void init( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p );
+	void moveStart( NodeType n );
+	void moveGoal( NodeType n );
+	void plan(void); // Brings the tree up to date for the current start and goal
+
+	// Planner output access: ( to be called after plan() )
+	bool pathFound(void) { return ( startNode && startNode->plannerVars.rhs != infinity ); }
+	CostType getPlannedPathCost(void) { return ( startNode->plannerVars.rhs ); }
+	std::vector< NodeType > getPlannedPath(void); // From the start to the goal. Empty if there is none.
+
+private:
+	GraphNode_p getNode( NodeType n );
+	GraphNode_p initiate( GraphNode_p np );
+	void generateSuccessors( GraphNode_p np );
+	void generatePredecessors( GraphNode_p np );
+	// rhs of a node other than the goal, and the successor it comes from
+	CostType lookahead( GraphNode_p np , GraphNode_p* best_p=NULL );
+	void calculateKey( GraphNode_p np , CostType& k1 , CostType& k2 );
+	void updateVertex( GraphNode_p np );
+	bool keyLess( CostType a1 , CostType a2 , CostType b1 , CostType b2 )
+		{ return ( a1 < b1 || (a1 == b1 && a2 < b2) ); }
+};
+
+// ------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------
+// Since we use templates, the definitions need to be included in the header file as well.
+
+#include "D_star_lite.cpp"
+
+#endif
+
@@ -0,0 +1,337 @@
+/* FlowField.cxx
+ *
+ * See FlowField.h
+ */
+
+// interface header
+#include "FlowField.h"
+
+/* system implementation headers */
+#include <limits>
+#include <utility>
+
+// common implementation headers
+#include "global.h"
+#include "Flag.h"
+
+// local implementation headers
+#include "World.h"
+
+// initialize the singleton
+template <>
+FlowFields* Singleton<FlowFields>::_instance = (FlowFields*)0;
+
+// the opposite of step k is step 7-k
+const int FlowField::stepX[8] = { -1,  0,  1, -1, 1, -1, 0, 1 };
+const int FlowField::stepY[8] = { -1, -1, -1,  0, 0,  1, 1, 1 };
+const unsigned int FlowField::infinity = std::numeric_limits<unsigned int>::max();
+
+// a tank this close to the middle of its base is at the base (see RobotPlayer::isAtTeamBase())
+static const float baseRadius = 10.0f;
+
+// a flag field is used for goals up to this far from its own goal
+static const int maxGoalDrift = 4 * STRAIGHT_COST;
+
+
+FlowField::FlowField(bool _movable) :
+  movable(_movable), version(0), expandCount(0), minCoord(0), size(0), queued(0) {
+}
+
+
+void FlowField::reset(const OccupancyGrid &grid) {
+  minCoord = grid.getMinCoord();
+  size = (unsigned int)(grid.getMaxCoord() - grid.getMinCoord() + 1);
+  codes.assign((size * size + 1) / 2, (unsigned char)(UNREACHABLE | (UNREACHABLE << 4)));
+  dist.assign(size * size, infinity);
+  for (int i = 0; i <= DIAGONAL_COST; i++)
+    buckets[i].clear();
+  queued = 0;
+}
+
+
+void FlowField::push(int cell, unsigned int d) {
+  dist[cell] = d;
+  buckets[d % (DIAGONAL_COST + 1)].push_back(cell);
+  queued++;
+}
+
+
+void FlowField::build(const OccupancyGrid &grid, const MyNode &_goal,
+                      const std::vector<MyNode> &sources) {
+  reset(grid);
+  goal = _goal;
+  version = grid.getVersion();
+  expandCount = 0;
+
+  const int goalCell = getCell(goal.x, goal.y);
+  if (goalCell < 0)
+    return;
+  setCode(goalCell, SOURCE);
+  push(goalCell, 0);
+  for (unsigned int i = 0; i < sources.size(); i++) {
+    const int cell = getCell(sources[i].x, sources[i].y);
+    if (cell < 0 || dist[cell] == 0)
+      continue;
+    setCode(cell, SOURCE);
+    push(cell, 0);
+  }
+  search(grid);
+
+  // only a field that moves needs its distances again
+  if (!movable)
+    std::vector<unsigned int>().swap(dist);
+}
+
+
+void FlowField::moveGoal(const OccupancyGrid &grid, const MyNode &newGoal) {
+  if (newGoal.x == goal.x && newGoal.y == goal.y && version == grid.getVersion())
+    return;
+  const int newCell = getCell(newGoal.x, newGoal.y);
+  if (!movable || version != grid.getVersion() || newCell < 0 || dist[newCell] == infinity) {
+    build(grid, newGoal, std::vector<MyNode>());
+    return;
+  }
+
+  // the old path from the new goal to the old one, backwards, is a path from the old goal to the
+  // new one: every cell can still get to the new goal through the old one, at this extra cost
+  const unsigned int offset = dist[newCell];
+  std::vector< std::pair<int,int> > oldPath;  // (cell, old step)
+  MyNode node = newGoal;
+  int cell = newCell;
+  while (getCode(cell) != SOURCE) {
+    const int code = getCode(cell);
+    oldPath.push_back(std::make_pair(cell, code));
+    node.x += stepX[code];
+    node.y += stepY[code];
+    cell = getCell(node.x, node.y);
+  }
+  oldPath.push_back(std::make_pair(cell, (int)SOURCE));
+  for (unsigned int i = 0; i < dist.size(); i++)
+    if (dist[i] != infinity)
+      dist[i] += offset;
+  goal = newGoal;
+  expandCount = 0;
+  setCode(newCell, SOURCE);
+  push(newCell, 0);
+  for (unsigned int i = 1; i < oldPath.size(); i++) {
+    // turn the old step from cell i-1 to cell i around; the cells along the way are closer than
+    // the bound, so they are searched from too, once the search gets that far
+    const int pathCell = oldPath[i].first;
+    setCode(pathCell, 7 - oldPath[i - 1].second);
+    seeds.push_back(std::make_pair(offset - (dist[pathCell] - offset), pathCell));
+  }
+
+  // those are upper bounds: search again from the new goal, only where it finds a shorter way
+  search(grid);
+}
+
+
+void FlowField::search(const OccupancyGrid &grid) {
+  // Dial's algorithm: expand the cells in order of distance, one bucket per distance
+  unsigned int nextSeed = 0;
+  for (unsigned int d = 0; queued > 0 || nextSeed < seeds.size(); d++) {
+    // the ring only holds distances up to d+DIAGONAL_COST, so the seeds wait for their turn
+    if (queued == 0 && seeds[nextSeed].first > d)
+      d = seeds[nextSeed].first;
+    for (; nextSeed < seeds.size() && seeds[nextSeed].first == d; nextSeed++)
+      if (d < dist[seeds[nextSeed].second])
+        push(seeds[nextSeed].second, d);
+
+    std::vector<int> &bucket = buckets[d % (DIAGONAL_COST + 1)];
+    // relaxing never adds to the current bucket, as every step costs more than 0
+    for (unsigned int i = 0; i < bucket.size(); i++) {
+      const int cell = bucket[i];
+      queued--;
+      if (dist[cell] != d)
+        continue;  // found a shorter way after it was queued
+
+      // cells next to the goal can only step onto it if it is accessible
+      const int x = (int)(cell % size) + minCoord;
+      const int y = (int)(cell / size) + minCoord;
+      if (!grid.isAccessible(x, y))
+        continue;
+      expandCount++;
+
+      for (int k = 0; k < 8; k++) {
+        const int from = getCell(x + stepX[k], y + stepY[k]);
+        if (from < 0)
+          continue;
+        const unsigned int viaThis = d + ((stepX[k] && stepY[k]) ? DIAGONAL_COST : STRAIGHT_COST);
+        if (viaThis < dist[from]) {
+          setCode(from, 7 - k);
+          push(from, viaThis);
+        }
+      }
+    }
+    bucket.clear();
+  }
+  seeds.clear();
+}
+
+
+bool FlowField::getPath(const OccupancyGrid &grid, const MyNode &start,
+                        std::vector<MyNode> &path) const {
+  path.clear();
+  const int startCell = getCell(start.x, start.y);
+  if (!isBuilt() || startCell < 0 || getCode(startCell) == UNREACHABLE)
+    return false;
+
+  MyNode node = start;
+  path.push_back(node);
+  while (getStep(node, node))
+    path.push_back(node);
+
+  // a base is reached anywhere near its middle, and the middle is in sight from there
+  if ((node.x != goal.x || node.y != goal.y) && !walkStraight(grid, node, goal, path)) {
+    path.clear();
+    return false;
+  }
+  return true;
+}
+
+
+// ------------------------------------------------------------------------------
+
+
+FlowFields::FlowFields() : gridVersion(0), nextSlot(0) {
+}
+
+
+FlowFields::~FlowFields() {
+  clear();
+}
+
+
+void FlowFields::clear() {
+  for (unsigned int i = 0; i < fields.size(); i++)
+    delete fields[i].field;
+  fields.clear();
+  gridVersion = 0;
+  nextSlot = 0;
+}
+
+
+void FlowFields::rebuildSlots() {
+  World *world = World::getWorld();
+  clear();
+  for (int team = RedTeam; team <= PurpleTeam; team++) {
+    if (!world->getBase(team, 0))
+      continue;
+    Slot slot = { team, -1, NULL };
+    fields.push_back(slot);
+  }
+  // a flag may become a team flag later, so every flag gets a slot; fields are made when needed
+  if (world->allowTeamFlags()) {
+    for (int i = 0; i < world->getMaxFlags(); i++) {
+      Slot slot = { NoTeam, i, NULL };
+      fields.push_back(slot);
+    }
+  }
+}
+
+
+bool FlowFields::getGoal(const Slot &slot, MyNode &goal) const {
+  World *world = World::getWorld();
+  if (slot.flagIndex < 0) {
+    const float *basePos = world->getBase(slot.team, 0);
+    if (!basePos)
+      return false;
+    goal = MyNode(basePos[0], basePos[1]);
+    return true;
+  }
+  const Flag &flag = world->getFlag(slot.flagIndex);
+  if (flag.type->flagTeam == NoTeam)
+    return false;
+  // same goal node as the guard and capture roles compute
+  goal = MyNode(flag.position[0], flag.position[1]);
+  return true;
+}
+
+
+void FlowFields::getBaseSources(const OccupancyGrid &grid, const MyNode &goal,
+                                std::vector<MyNode> &sources) const {
+  const int radius = convertToGraphCoord(baseRadius);
+  std::vector<MyNode> walk;
+  for (int i = -radius; i <= radius; i++) {
+    for (int j = -radius; j <= radius; j++) {
+      if (i * i + j * j > radius * radius || !grid.isAccessible(goal.x + i, goal.y + j))
+        continue;
+      MyNode node;
+      node.x = goal.x + i;
+      node.y = goal.y + j;
+      walk.clear();
+      if (walkStraight(grid, node, goal, walk))
+        sources.push_back(node);
+    }
+  }
+}
+
+
+void FlowFields::update() {
+  if (!World::getWorld())
+    return;
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+  if (!grid.isBuilt())
+    return;
+  if (grid.getVersion() != gridVersion) {
+    rebuildSlots();
+    gridVersion = grid.getVersion();
+  }
+
+  // one field per call, going round the slots so that a busy flag does not starve the others
+  const int count = (int)fields.size();
+  for (int n = 0; n < count; n++) {
+    const int i = (nextSlot + n) % count;
+    Slot &slot = fields[i];
+    MyNode goal;
+    if (!getGoal(slot, goal))
+      continue;
+    if (!slot.field)
+      slot.field = new FlowField(slot.flagIndex >= 0);
+
+    FlowField &field = *slot.field;
+    if (!field.isBuilt() || field.getVersion() != gridVersion) {
+      std::vector<MyNode> sources;
+      if (!field.isMovable())
+        getBaseSources(grid, goal, sources);
+      field.build(grid, goal, sources);
+    } else if (field.getGoal().x != goal.x || field.getGoal().y != goal.y) {
+      field.moveGoal(grid, goal);
+    } else {
+      continue;
+    }
+    nextSlot = (i + 1) % count;
+    return;
+  }
+}
+
+
+bool FlowFields::findPath(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path) {
+  const OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt() || grid.getVersion() != gridVersion)
+    return false;
+
+  // the field leading to the goal itself, or else to the nearest goal within maxGoalDrift
+  const FlowField *best = NULL;
+  int bestDrift = maxGoalDrift + 1;
+  for (unsigned int i = 0; i < fields.size(); i++) {
+    const FlowField *field = fields[i].field;
+    if (!field || !field->isBuilt() || field->getVersion() != gridVersion)
+      continue;
+    const MyNode &fieldGoal = field->getGoal();
+    const int drift = octileDistance(goal.x - fieldGoal.x, goal.y - fieldGoal.y);
+    if (drift < bestDrift && (drift == 0 || field->isMovable())) {
+      best = field;
+      bestDrift = drift;
+    }
+  }
+  if (!best || !best->getPath(grid, start, path))
+    return false;
+  if (bestDrift > 0 && !walkStraight(grid, best->getGoal(), goal, path)) {
+    path.clear();
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,195 @@
+/* FlowField.h
+ *
+ * Precomputed directions toward the goals that every robot on a team keeps going back to.
+ *
+ * The guard and capture roles mostly drive to a team base or to a team flag.  Instead of one
+ * search per robot per goal, a FlowField runs a single Dijkstra search backward from the goal
+ * over the whole OccupancyGrid and remembers, for every cell, which of its 8 neighbours is the
+ * next step on a shortest path to the goal.  Any robot then gets its next step with one lookup,
+ * and its whole path by following the steps.
+ *
+ * Directions are stored as 4-bit codes, two cells per byte, so a field takes an eighth of the
+ * memory a distance per cell would.  A field may start from several cells at once (a base is
+ * reached anywhere near its middle), and only fields that can move (flags) keep their distances,
+ * which lets moveGoal() repair the field instead of searching again.
+ *
+ * FlowFields keeps one field per team base and per team flag up to date with the world.
+ */
+
+#ifndef FLOWFIELD_H_
+#define FLOWFIELD_H_
+
+#include "common.h"
+
+/* system interface headers */
+#include <utility>
+#include <vector>
+
+/* common interface headers */
+#include "Singleton.h"
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+
+#define FLOWFIELDS (FlowFields::instance())
+
+
+class FlowField {
+public:
+  /* Constructor.  The field is empty until build() is called.
+   * @param movable True if the goal can move later (see moveGoal()).
+   */
+  FlowField(bool movable);
+
+  /* Searches the whole grid backward from the sources.
+   * @param grid The raster to search, already built.
+   * @param goal The node paths should end at.  Always one of the sources.
+   * @param sources Other nodes that count as reaching the goal (may be empty).
+   */
+  void build(const OccupancyGrid &grid, const MyNode &goal, const std::vector<MyNode> &sources);
+
+  /* Moves the single-source goal of a movable field.  The old distances, plus the cost of getting
+   * from the old goal to the new one, are valid upper bounds for the new distances, so only the
+   * cells that the new goal brings closer are searched again.  Rebuilds from scratch if the field
+   * cannot be repaired.
+   * @param grid The raster the field was built on.
+   * @param goal The new goal.
+   */
+  void moveGoal(const OccupancyGrid &grid, const MyNode &goal);
+
+  /* Follows the field from a node to the goal.
+   * @param grid The raster the field was built on.
+   * @param start The node to start from.
+   * @param path Writes the path here, from start to goal (inclusive), one node per cell.
+   * @return False if the goal cannot be reached from the start, true otherwise.
+   */
+  bool getPath(const OccupancyGrid &grid, const MyNode &start, std::vector<MyNode> &path) const;
+
+  /* The next step toward the goal.
+   * @param node A node.
+   * @param next Writes the neighbour to move to here.
+   * @return False if the node is a source, or if the goal cannot be reached from it.
+   */
+  inline bool getStep(const MyNode &node, MyNode &next) const {
+    const int cell = getCell(node.x, node.y);
+    if (cell < 0)
+      return false;
+    const int code = getCode(cell);
+    if (code >= SOURCE)
+      return false;
+    next.x = node.x + stepX[code];
+    next.y = node.y + stepY[code];
+    return true;
+  }
+
+  bool isBuilt() const { return version != 0; }
+  bool isMovable() const { return movable; }
+  const MyNode &getGoal() const { return goal; }
+
+  // version of the OccupancyGrid the field was built on, 0 if it was never built
+  unsigned int getVersion() const { return version; }
+
+  // nodes expanded by the last build() or moveGoal()
+  int getExpandCount() const { return expandCount; }
+
+private:
+  // codes 0..7 index stepX/stepY, the other two mark the sources and the unreachable cells
+  enum { SOURCE = 8, UNREACHABLE = 15 };
+  static const int stepX[8], stepY[8];
+  static const unsigned int infinity;
+
+  inline int getCell(int x, int y) const {
+    const unsigned int col = (unsigned int)(x - minCoord);
+    const unsigned int row = (unsigned int)(y - minCoord);
+    if (col >= size || row >= size)
+      return -1;
+    return (int)(row * size + col);
+  }
+  inline int getCode(int cell) const {
+    return (codes[cell >> 1] >> ((cell & 1) << 2)) & 15;
+  }
+  inline void setCode(int cell, int code) {
+    unsigned char &pair = codes[cell >> 1];
+    const int shift = (cell & 1) << 2;
+    pair = (unsigned char)((pair & ~(15 << shift)) | (code << shift));
+  }
+
+  void reset(const OccupancyGrid &grid);
+  void push(int cell, unsigned int dist);
+  void search(const OccupancyGrid &grid);
+
+  bool movable;
+  MyNode goal;
+  unsigned int version;
+  int expandCount;
+
+  // the bounds of the grid, in graph coordinates, and the number of cells along each side
+  int minCoord;
+  unsigned int size;
+
+  // two direction codes per byte, the even cell in the low nibble
+  std::vector<unsigned char> codes;
+
+  // distances to the goal, kept between searches by movable fields only
+  std::vector<unsigned int> dist;
+
+  // Dial's bucket queue: costs are integers and no edge costs more than DIAGONAL_COST, so a ring
+  // of DIAGONAL_COST+1 buckets holds every distance still to be expanded
+  std::vector<int> buckets[DIAGONAL_COST + 1];
+  unsigned int queued;
+
+  // (distance, cell) to queue when the search reaches that distance, by increasing distance
+  std::vector< std::pair<unsigned int,int> > seeds;
+};
+
+
+class FlowFields : public Singleton<FlowFields> {
+public:
+  /* Keeps the fields in step with the world: builds the fields of the team bases and team flags
+   * after the OccupancyGrid changes, and repairs the field of a flag that moved.  Builds or
+   * repairs at most one field per call, so call it once per frame.
+   */
+  void update();
+
+  /* Follows the field of a base or flag from a node.
+   * @param start The node to start from.
+   * @param goal The goal node, as the robots compute it from the base or flag position.
+   *             Goals close to that of a field (a flag that has moved a little since the field was
+   *             last repaired) are joined to the field's goal with a straight line, which must be open.
+   * @param path Writes the path here, from start to goal (inclusive), one node per cell.
+   * @return True if a field leads from start to goal, false otherwise.
+   */
+  bool findPath(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* Throws away every field.  Called when leaving the game.
+   */
+  void clear();
+
+  int getFieldCount() const { return (int)fields.size(); }
+
+protected:
+  friend class Singleton<FlowFields>;
+
+private:
+  FlowFields();
+  ~FlowFields();
+
+  // a team base, or the team flag with the given index
+  struct Slot {
+    int team;
+    int flagIndex;  // -1 for a base
+    FlowField *field;
+  };
+
+  void rebuildSlots();
+  bool getGoal(const Slot &slot, MyNode &goal) const;
+  // the accessible nodes near the middle of a base, from which the middle is in sight
+  void getBaseSources(const OccupancyGrid &grid, const MyNode &goal, std::vector<MyNode> &sources) const;
+
+  std::vector<Slot> fields;
+  unsigned int gridVersion;
+  int nextSlot;  // round-robin position of update()
+};
+
+
+#endif /* FLOWFIELD_H_ */
@@ -0,0 +1,162 @@
+/* GraphAStar.cxx
+ *
+ * See GraphAStar.h
+ */
+
+// interface header
+#include "GraphAStar.h"
+
+/* system implementation headers */
+#include <algorithm>
+#include <cstdlib>
+
+
+/* -----------------------------------------------
+ * GraphFunctionContainer, with an optional set of goals.  When it has one, the search stops at
+ * any of them, and the heuristic is the octile distance to the nearest: the least of consistent
+ * heuristics is consistent, so the first goal expanded is the nearest by path.
+ */
+class GoalSetFunctionContainer : public GraphFunctionContainer {
+public:
+  GoalSetFunctionContainer(int halfWorldSize, const OccupancyGrid &_grid) :
+    GraphFunctionContainer(halfWorldSize, _grid), goals(NULL) {}
+
+  /* @param _goals The goals to search toward, or NULL to go back to the TargetNode alone.
+   *               Must stay valid until the next call.
+   */
+  void setGoals(const std::vector<MyNode> *_goals) { goals = _goals; }
+
+  int getHeuristics(MyNode& n1, MyNode& n2) {
+    if (!goals)
+      return GraphFunctionContainer::getHeuristics(n1, n2);
+    int nearest = -1;
+    for (unsigned int i = 0; i < goals->size(); i++) {
+      const int h = octileDistance((*goals)[i].x - n1.x, (*goals)[i].y - n1.y);
+      if (nearest < 0 || h < nearest)
+        nearest = h;
+    }
+    return nearest;
+  }
+
+  bool stopSearch(MyNode& n) {
+    if (!goals)
+      return func_redefined = false;
+    for (unsigned int i = 0; i < goals->size(); i++)
+      if (n == (*goals)[i])
+        return true;
+    return false;
+  }
+
+private:
+  const std::vector<MyNode> *goals;
+};
+
+
+GraphAStarPlanner::GraphAStarPlanner() :
+  container(NULL), planner(NULL), hashTableSize(0), gridVersion(0) {
+}
+
+
+GraphAStarPlanner::~GraphAStarPlanner() {
+  clear();
+}
+
+
+void GraphAStarPlanner::clear() {
+  delete planner;
+  planner = NULL;
+  delete container;
+  container = NULL;
+}
+
+
+void GraphAStarPlanner::rebuild(const OccupancyGrid &grid) {
+  clear();
+
+  container = new GoalSetFunctionContainer((int)(0.5f * BZDBCache::worldSize), grid);
+  // getHashBin() is abs(2x + 3y), so this covers every node of the grid
+  const int maxAbsCoord = std::max(abs(grid.getMinCoord()), abs(grid.getMaxCoord()));
+  hashTableSize = 5 * maxAbsCoord + 1;
+
+  // the hash table and the heap are created by the first search
+  planner = new A_star_planner<MyNode,int>;
+  planner->setParams(1.0, HEAP_MODE_BUCKET);  // integer octile costs
+  gridVersion = grid.getVersion();
+}
+
+
+bool GraphAStarPlanner::plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path) {
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+  return plan(grid, start, goal, path);
+}
+
+
+bool GraphAStarPlanner::plan(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal,
+                             std::vector<MyNode> &path) {
+  // snapshots keep the version of the grid they were taken from
+  if (!planner || gridVersion != grid.getVersion())
+    rebuild(grid);
+  container->setGoals(NULL);
+  return search(grid, start, goal, path);
+}
+
+
+int GraphAStarPlanner::planToNearest(const MyNode &start, const std::vector<MyNode> &goals,
+                                     std::vector<MyNode> &path) {
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+  return planToNearest(grid, start, goals, path);
+}
+
+
+int GraphAStarPlanner::planToNearest(const OccupancyGrid &grid, const MyNode &start,
+                                     const std::vector<MyNode> &goals, std::vector<MyNode> &path) {
+  path.clear();
+  counters.reset();
+  if (goals.empty())
+    return -1;
+  if (!planner || gridVersion != grid.getVersion())
+    rebuild(grid);
+  container->setGoals(&goals);
+  const bool found = search(grid, start, goals[0], path);
+  container->setGoals(NULL);
+  if (!found)
+    return -1;
+  for (unsigned int i = 0; i < goals.size(); i++)
+    if (path.back() == goals[i])
+      return (int)i;
+  return -1;
+}
+
+
+bool GraphAStarPlanner::search(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal,
+                               std::vector<MyNode> &path) {
+  path.clear();
+  counters.reset();
+
+  // the hash bins only cover the grid
+  if (start.x < grid.getMinCoord() || start.x > grid.getMaxCoord() ||
+      start.y < grid.getMinCoord() || start.y > grid.getMaxCoord())
+    return false;
+
+  // re-seed the planner, keeping the nodes of the earlier searches
+  GenericSearchGraphDescriptor<MyNode, int> graph;
+  graph.func_container = container;
+  graph.hashTableSize = hashTableSize;
+  graph.SeedNode = start;
+  graph.TargetNode = goal;
+  planner->clearLastPlanAndInit(&graph);
+  planner->plan();
+  counters = planner->counters;
+
+  std::vector< std::vector<MyNode> > paths = planner->getPlannedPaths();
+  if (paths.empty())
+    return false;
+
+  // paths[0] goes from the goal back to the start
+  path.assign(paths[0].rbegin(), paths[0].rend());
+  return true;
+}
@@ -0,0 +1,94 @@
+/* GraphAStar.h
+ *
+ * The YAGSBPL A* planner over GraphFunctionContainer, kept alive between searches.
+ *
+ * Building the planner (hash table, heap, graph descriptor) and creating every node and its
+ * successor links is most of the cost of a short search.  This class builds them once per
+ * OccupancyGrid version and then only re-seeds the planner with clearLastPlanAndInit(), so
+ * repeated searches on the same world reuse the nodes already created and do not allocate.
+ * The nodes come from the hash table's arenas and are all freed together when the world changes.
+ *
+ * planToNearest() searches toward several goals at once, and stops at the first one it reaches:
+ * the nearest by path, which around walls is often not the nearest in a straight line.
+ */
+
+#ifndef GRAPHASTAR_H_
+#define GRAPHASTAR_H_
+
+/* system interface headers */
+#include <vector>
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+#include "A_star.h"
+
+
+class GoalSetFunctionContainer;
+
+class GraphAStarPlanner {
+public:
+  GraphAStarPlanner();
+  ~GraphAStarPlanner();
+
+  /* Finds a shortest path from the start node to the goal node.
+   * @param start The node from which to start the search.
+   * @param goal The search will try to find a path to this node.
+   * @param path Writes the path here, from start to goal (inclusive).  Cleared if there is no path.
+   * @return True if a path was found, false otherwise.
+   */
+  bool plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* Same as above, on the given grid instead of the shared OccupancyGrid.  The grid is only read,
+   * so planners that do not share state can search the same grid from several threads.
+   * @param grid The raster to search, already built (e.g. an OccupancyGrid::snapshot()).
+   */
+  bool plan(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* Finds a shortest path from the start node to whichever of the goals is nearest, in one search.
+   * @param start The node from which to start the search.
+   * @param goals The search stops at the first of these nodes it expands.
+   * @param path Writes the path here, from start to that goal (inclusive).  Cleared if no goal
+   *             can be reached.
+   * @return The index in goals of the goal reached, -1 if none was.
+   */
+  int planToNearest(const MyNode &start, const std::vector<MyNode> &goals, std::vector<MyNode> &path);
+
+  /* Same as above, on the given grid instead of the shared OccupancyGrid.
+   * @param grid The raster to search, already built (e.g. an OccupancyGrid::snapshot()).
+   */
+  int planToNearest(const OccupancyGrid &grid, const MyNode &start, const std::vector<MyNode> &goals,
+                    std::vector<MyNode> &path);
+
+  /* The number of nodes expanded by the last call to plan().
+   */
+  int getExpandCount() const { return counters.expanded; }
+
+  /* What the last call to plan() did: expansions, heap peak, hash collisions, timings...
+   */
+  const SearchCounters &getCounters() const { return counters; }
+
+  /* The number of nodes in the hash table, i.e. created by all searches since the last rebuild.
+   */
+  int getNodeCount() const { return planner ? planner->hash->nodeCount() : 0; }
+
+  /* Throws away the planner and its nodes.  The next call to plan() rebuilds them.
+   */
+  void clear();
+
+private:
+  GraphAStarPlanner(const GraphAStarPlanner&);
+  GraphAStarPlanner& operator=(const GraphAStarPlanner&);
+
+  void rebuild(const OccupancyGrid &grid);
+  // runs the search on the goals the container was given, leaves the path in path
+  bool search(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  GoalSetFunctionContainer *container;
+  A_star_planner<MyNode,int> *planner;
+  int hashTableSize;
+  unsigned int gridVersion;  // OccupancyGrid version the planner was built for
+  SearchCounters counters;
+};
+
+
+#endif /* GRAPHASTAR_H_ */
@@ -7,6 +7,7 @@
  *
  * NOTE 1: isAccessible() is commented out
  * I decided to check whether or not a node is accessible in getSuccessors() instead.
+ * Accessibility comes from the precomputed OccupancyGrid, so this is just a few bit tests.
  *
  * NOTE 2:
  * I tried to split this code into a source and header file, but when I did,
@@ -22,6 +23,7 @@
 #include "BZDBCache.h"
 #include "World.h"
 #include "yagsbpl_base.h"
+#include "OccupancyGrid.h"
 
 #include "playing.h"
 
@@ -29,6 +31,25 @@
 #define ACCESSIBILITY_THRESHOLD (0.5f * BZDBCache::tankRadius)
 #define INVALID -9999
 
+// Integer octile costs: moving straight costs 10, moving diagonally costs 14 (~10*sqrt(2)).
+// Keeping the costs integral lets A* use the bucket queue (HEAP_MODE_BUCKET) as its open list.
+#define STRAIGHT_COST 10
+#define DIAGONAL_COST 14
+
+/* Octile distance: the cost of the cheapest 8-connected path between two nodes when nothing is
+ * in the way.
+ * @param dx The difference between the nodes' x-coordinates, in graph coordinates.
+ * @param dy The difference between the nodes' y-coordinates, in graph coordinates.
+ * @return The cost, in STRAIGHT_COST/DIAGONAL_COST units.
+ */
+inline int octileDistance(int dx, int dy) {
+  dx = abs(dx);
+  dy = abs(dy);
+  if (dx < dy)
+    return DIAGONAL_COST * dx + STRAIGHT_COST * (dy - dx);
+  return DIAGONAL_COST * dy + STRAIGHT_COST * (dx - dy);
+}
+
 /* Converts from the game's coordinate system to the graph's coordinate system.
  * @param gameCoord A coordinate in the game's coordinate system.
  * @return A coordinate in the graph's coordinate system.
@@ -87,14 +108,10 @@ public:
    * @param y A node's y-coordinate in graph coordinates.
    */
   static bool isAccessible(int x, int y) {
-    float gamePos[3] = {convertToGameCoord(x), convertToGameCoord(y), 0.0f};
-    int posBound = convertToGraphCoord( ((int)( 0.5f * BZDBCache::worldSize)) );
-    int negBound = convertToGraphCoord( ((int)(-0.5f * BZDBCache::worldSize)) );
-
-    if (x < negBound || y < negBound || x > posBound || y > posBound)
-      return false;
-
-    return (World::getWorld()->inBuilding(gamePos, ACCESSIBILITY_THRESHOLD, BZDBCache::tankHeight) == NULL);
+    OccupancyGrid &grid = OCCUPANCYGRID;
+    if (!grid.isBuilt())
+      grid.build();
+    return grid.isAccessible(x, y);
   }
 
   /* Searches for accessible nodes within a given radius.
@@ -132,15 +149,49 @@ public:
 };
 
 
+/* Walks from one node to another in a straight 8-connected line: diagonally first, then straight.
+ * The cost of the walk is the octile distance between the nodes.
+ * @param grid The raster to check the nodes against.
+ * @param from The node to start at (not included in the walk).
+ * @param to The node to walk to.
+ * @param cells Appends the nodes of the walk here.
+ * @return False if a node on the way is blocked, true otherwise.
+ */
+inline bool walkStraight(const OccupancyGrid &grid, MyNode from, const MyNode &to,
+                         std::vector<MyNode> &cells) {
+  while (from.x != to.x || from.y != to.y) {
+    from.x += (to.x > from.x) - (to.x < from.x);
+    from.y += (to.y > from.y) - (to.y < from.y);
+    if (!grid.isAccessible(from.x, from.y))
+      return false;
+    cells.push_back(from);
+  }
+  return true;
+}
+
+
 /* -----------------------------------------------
  * Implements (some of) the virtual functions in the SearchGraphDescriptorFunctionContainer template.
  */
-class GraphFunctionContainer : public SearchGraphDescriptorFunctionContainer<MyNode, double> {
+class GraphFunctionContainer : public SearchGraphDescriptorFunctionContainer<MyNode, int> {
 public:
   /* Constructor
    * @param halfWorldSize Half of the total width or length of the game level.
    */
-  GraphFunctionContainer(int halfWorldSize) {
+  GraphFunctionContainer(int halfWorldSize) : grid(OCCUPANCYGRID) {
+    xmin = -1 * halfWorldSize;
+    ymin = -1 * halfWorldSize;
+    xmax = halfWorldSize;
+    ymax = halfWorldSize;
+    if (!OCCUPANCYGRID.isBuilt())
+      OCCUPANCYGRID.build();
+  }
+
+  /* Constructor.  Uses the given grid instead of the shared OccupancyGrid.
+   * @param halfWorldSize Half of the total width or length of the game level.
+   * @param _grid The raster to use, already built.  Must outlive the container.
+   */
+  GraphFunctionContainer(int halfWorldSize, const OccupancyGrid &_grid) : grid(_grid) {
     xmin = -1 * halfWorldSize;
     ymin = -1 * halfWorldSize;
     xmax = halfWorldSize;
@@ -174,7 +225,7 @@ public:
    * @param s A vector of nodes which can be reached from node n.
    * @param c A vector of costs for traveling to the corresponding nodes in vector s.
    */
-  void getSuccessors(MyNode& n, std::vector<MyNode>* s, std::vector<double>* c) {
+  void getSuccessors(MyNode& n, std::vector<MyNode>* s, std::vector<int>* c) {
     MyNode connectedNode;
     s->clear();
     c->clear();
@@ -184,33 +235,65 @@ public:
           continue;
         }
 
-        float gamePos[3] = {convertToGameCoord(n.x + i), convertToGameCoord(n.y + j), 0.0f};
-        if (gamePos[0] < xmin || gamePos[1] < ymin || gamePos[0] > xmax || gamePos[1] > ymax)
+        // the grid also treats everything outside the level as blocked
+        if (!grid.isAccessible(n.x + i, n.y + j))
           continue;
-        if (World::getWorld()->inBuilding(gamePos, ACCESSIBILITY_THRESHOLD, BZDBCache::tankHeight))
+
+        connectedNode.x = n.x + i;
+        connectedNode.y = n.y + j;
+        s->push_back(connectedNode);
+        c->push_back((i && j) ? DIAGONAL_COST : STRAIGHT_COST);
+      }
+    }
+  }
+
+  /* For a given node, defines which nodes can move to it and the corresponding costs.
+   * Moving is allowed onto any accessible node, so these are all the neighbours inside the
+   * grid (even blocked ones: a tank touching a building can still drive away from it).
+   * @param n The node we want to reach.
+   * @param s A vector of nodes from which node n can be reached.
+   * @param c A vector of costs for traveling from the corresponding nodes in vector s.
+   */
+  void getPredecessors(MyNode& n, std::vector<MyNode>* s, std::vector<int>* c) {
+    MyNode connectedNode;
+    s->clear();
+    c->clear();
+    if (!grid.isAccessible(n.x, n.y))
+      return;
+    for (int i=-1; i<=1; i++) {
+      for (int j=-1; j<=1; j++) {
+        if (i==0 && j==0) {
           continue;
+        }
 
         connectedNode.x = n.x + i;
         connectedNode.y = n.y + j;
+        if (connectedNode.x < grid.getMinCoord() || connectedNode.x > grid.getMaxCoord() ||
+            connectedNode.y < grid.getMinCoord() || connectedNode.y > grid.getMaxCoord())
+          continue;
         s->push_back(connectedNode);
-        c->push_back(sqrt((double)(i*i+j*j)));
+        c->push_back((i && j) ? DIAGONAL_COST : STRAIGHT_COST);
       }
     }
   }
 
   /* Heuristic function that estimates the cost between two nodes.
+   * Octile distance: the exact cost on an open 8-connected grid, so it is consistent.
    * @param n1 A node.
    * @param n2 Another node.
    * @return The estimated cost.
    */
-  double getHeuristics(MyNode& n1, MyNode& n2) {
-    return hypot(n2.x - n1.x, n2.y - n1.y);
+  int getHeuristics(MyNode& n1, MyNode& n2) {
+    return octileDistance(n2.x - n1.x, n2.y - n1.y);
   }
 
 private:
   // The bounds of the game level, in game coordinates.
   int xmin, xmax, ymin, ymax;
 
+  // The rasterized game level, shared by all robots.
+  const OccupancyGrid &grid;
+
 };
 
 
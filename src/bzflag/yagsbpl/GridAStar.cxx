@@ -0,0 +1,104 @@
+/* GridAStar.cxx
+ *
+ * See GridAStar.h
+ */
+
+// interface header
+#include "GridAStar.h"
+
+/* system implementation headers */
+#include <algorithm>
+
+
+// the 8 neighbours of a node, and what it costs to move there
+static const int neighbourDx[8]   = {-1, -1, -1,  0,  0,  1,  1,  1};
+static const int neighbourDy[8]   = {-1,  0,  1, -1,  1, -1,  0,  1};
+static const int neighbourCost[8] = {DIAGONAL_COST, STRAIGHT_COST, DIAGONAL_COST,
+                                     STRAIGHT_COST,                STRAIGHT_COST,
+                                     DIAGONAL_COST, STRAIGHT_COST, DIAGONAL_COST};
+
+
+GridAStarPlanner::GridAStarPlanner() : expandCount(0) {
+}
+
+
+bool GridAStarPlanner::plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path) {
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+  return plan(grid, start, goal, path);
+}
+
+
+bool GridAStarPlanner::plan(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal,
+                            std::vector<MyNode> &path) {
+  path.clear();
+  expandCount = 0;
+  store.reset(grid);
+
+  if (!store.contains(start.x, start.y) || !store.contains(goal.x, goal.y))
+    return false;
+
+  // index offsets of the 8 neighbours, in the same order as neighbourDx/neighbourDy
+  const int size = store.getSize();
+  int neighbourOffset[8];
+  for (int k = 0; k < 8; k++)
+    neighbourOffset[k] = neighbourDx[k] * size + neighbourDy[k];
+
+  const int startIndex = store.getIndex(start.x, start.y);
+  const int goalIndex  = store.getIndex(goal.x, goal.y);
+
+  // the start node is always allowed, even if the tank is touching a building
+  store.visit(startIndex);
+  store[startIndex].g = 0;
+  store[startIndex].f = octileDistance(goal.x - start.x, goal.y - start.y);
+  store.pushOrDecrease(startIndex);
+
+  while (!store.openEmpty()) {
+    const int current = store.popMin();
+    expandCount++;
+
+    if (current == goalIndex) {
+      // walk back to the start, then flip it around
+      for (int i = goalIndex; i >= 0; i = store[i].parent) {
+        MyNode node;
+        node.x = store.getX(i);
+        node.y = store.getY(i);
+        path.push_back(node);
+      }
+      std::reverse(path.begin(), path.end());
+      return true;
+    }
+
+    store.close(current);
+    const int cx = store.getX(current);
+    const int cy = store.getY(current);
+    const int currentG = store[current].g;
+
+    for (int k = 0; k < 8; k++) {
+      const int nx = cx + neighbourDx[k];
+      const int ny = cy + neighbourDy[k];
+      // the grid and the store cover the same cells, so this is also the bounds check
+      if (!grid.isAccessible(nx, ny))
+        continue;
+
+      const int next = current + neighbourOffset[k];
+      if (!store.isVisited(next))
+        store.visit(next);
+      else if (store.isClosed(next))
+        continue;
+
+      const int g = currentG + neighbourCost[k];
+      GridNode &node = store[next];
+      if (g >= node.g)
+        continue;
+      node.g = g;
+      node.f = g + octileDistance(goal.x - nx, goal.y - ny);
+      node.parent = current;
+      store.pushOrDecrease(next);
+    }
+  }
+
+  // no path
+  return false;
+}
@@ -0,0 +1,50 @@
+/* GridAStar.h
+ *
+ * A* search specialized for the OccupancyGrid tile graph.
+ *
+ * Same graph as GraphFunctionContainer (8-connected, integer octile costs, octile heuristic),
+ * but the nodes live in a dense GridNodeStore instead of a HashTableContainer, and successors
+ * are generated on the fly with bit tests.  The store is kept between searches, so a search
+ * does not allocate anything once the store has been sized for the current world.
+ */
+
+#ifndef GRIDASTAR_H_
+#define GRIDASTAR_H_
+
+/* system interface headers */
+#include <vector>
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+#include "GridNodeStore.h"
+
+
+class GridAStarPlanner {
+public:
+  GridAStarPlanner();
+
+  /* Finds a shortest path from the start node to the goal node.
+   * @param start The node from which to start the search.
+   * @param goal The search will try to find a path to this node.
+   * @param path Writes the path here, from start to goal (inclusive).  Cleared if there is no path.
+   * @return True if a path was found, false otherwise.
+   */
+  bool plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* Same as above, on the given grid instead of the shared OccupancyGrid.  The grid is only read,
+   * so planners that do not share state can search the same grid from several threads.
+   * @param grid The raster to search, already built (e.g. an OccupancyGrid::snapshot()).
+   */
+  bool plan(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* The number of nodes expanded by the last call to plan().
+   */
+  int getExpandCount() const { return expandCount; }
+
+private:
+  GridNodeStore store;
+  int expandCount;
+};
+
+
+#endif /* GRIDASTAR_H_ */
@@ -0,0 +1,181 @@
+/* GridNodeStore.h
+ *
+ * Dense node storage for searches over the OccupancyGrid tile graph.
+ *
+ * Instead of a hash table of heap-allocated SearchGraphNodes (each with its own successor and
+ * predecessor vectors), every cell of the grid has a small POD node in one flat array, indexed
+ * by (x - min) * size + (y - min).  Successors are implicit (the 8 neighbouring cells), so
+ * nothing is allocated during a search.
+ *
+ * Nodes are stamped with the generation of the search that last touched them.  Starting a new
+ * search just bumps the generation, so resetting the store between searches is O(1).
+ */
+
+#ifndef GRIDNODESTORE_H_
+#define GRIDNODESTORE_H_
+
+#include "common.h"
+
+/* system interface headers */
+#include <vector>
+
+/* local interface headers */
+#include "OccupancyGrid.h"
+
+
+/* -----------------------------------------------
+ * A search node for one cell of the grid.
+ */
+struct GridNode {
+  int g;          // cost from the start
+  int f;          // g + heuristic, used to order the open list
+  int parent;     // index of the node we came from, -1 for the start node
+  int heapIndex;  // position in the open list, -1 if not in it
+  unsigned int state;  // (generation << 2) | GRIDNODE_OPEN | GRIDNODE_CLOSED
+};
+
+#define GRIDNODE_OPEN   1
+#define GRIDNODE_CLOSED 2
+
+
+/* -----------------------------------------------
+ * One GridNode per cell of the OccupancyGrid, plus the open list.
+ */
+class GridNodeStore {
+public:
+  GridNodeStore() : minCoord(0), size(0), generation(0) {}
+
+  /* Starts a new search: every node becomes "not visited" without touching the array.
+   * Re-allocates only if the grid bounds changed since the last search.
+   */
+  void reset(const OccupancyGrid &grid) {
+    const unsigned int newSize = (unsigned int)(grid.getMaxCoord() - grid.getMinCoord() + 1);
+    if (newSize != size || grid.getMinCoord() != minCoord) {
+      minCoord = grid.getMinCoord();
+      size = newSize;
+      nodes.assign(size * size, GridNode());
+      generation = 0;
+    }
+    generation++;
+    // the generation is stored above the two state bits; on wrap-around, wipe the stamps
+    if (generation >= (1u << 30)) {
+      for (unsigned int i = 0; i < nodes.size(); i++)
+        nodes[i].state = 0;
+      generation = 1;
+    }
+    open.clear();
+  }
+
+  /* Converts between graph coordinates and node indices.
+   */
+  inline bool contains(int x, int y) const {
+    return ((unsigned int)(x - minCoord) < size) && ((unsigned int)(y - minCoord) < size);
+  }
+  inline int getIndex(int x, int y) const { return (x - minCoord) * (int)size + (y - minCoord); }
+  inline int getX(int index) const { return index / (int)size + minCoord; }
+  inline int getY(int index) const { return index % (int)size + minCoord; }
+  inline int getSize() const { return (int)size; }
+
+  /* Node state for the current search.
+   */
+  inline GridNode& operator[](int index) { return nodes[index]; }
+  inline bool isVisited(int index) const { return (nodes[index].state >> 2) == generation; }
+  inline bool isOpen(int index) const { return isVisited(index) && (nodes[index].state & GRIDNODE_OPEN); }
+  inline bool isClosed(int index) const { return isVisited(index) && (nodes[index].state & GRIDNODE_CLOSED); }
+
+  /* Marks a node as visited by the current search, with no parent and infinite cost.
+   */
+  inline void visit(int index) {
+    GridNode &n = nodes[index];
+    n.g = 0x7fffffff;
+    n.f = 0x7fffffff;
+    n.parent = -1;
+    n.heapIndex = -1;
+    n.state = generation << 2;
+  }
+
+  inline void close(int index) { nodes[index].state = (generation << 2) | GRIDNODE_CLOSED; }
+
+  // ---------- open list: 4-ary heap of node indices on f (ties go to the larger g) ----------
+
+  bool openEmpty() const { return open.empty(); }
+  int openSize() const { return (int)open.size(); }
+
+  /* Puts a visited node in the open list, or moves it up if its f-value decreased.
+   */
+  void pushOrDecrease(int index) {
+    GridNode &n = nodes[index];
+    if (n.state & GRIDNODE_OPEN) {
+      siftUp(n.heapIndex);
+      return;
+    }
+    n.state = (generation << 2) | GRIDNODE_OPEN;
+    open.push_back(index);
+    siftUp((int)open.size() - 1);
+  }
+
+  /* Removes and returns the open node with the smallest f-value.
+   */
+  int popMin() {
+    const int ret = open[0];
+    open[0] = open.back();
+    open.pop_back();
+    if (!open.empty())
+      siftDown(0);
+    nodes[ret].heapIndex = -1;
+    nodes[ret].state = generation << 2;
+    return ret;
+  }
+
+private:
+  inline bool before(int a, int b) const {
+    const GridNode &na = nodes[a];
+    const GridNode &nb = nodes[b];
+    return (na.f < nb.f) || (na.f == nb.f && na.g > nb.g);
+  }
+
+  void siftUp(int pos) {
+    const int item = open[pos];
+    while (pos > 0) {
+      const int parent = (pos - 1) >> 2;
+      if (!before(item, open[parent]))
+        break;
+      open[pos] = open[parent];
+      nodes[open[pos]].heapIndex = pos;
+      pos = parent;
+    }
+    open[pos] = item;
+    nodes[item].heapIndex = pos;
+  }
+
+  void siftDown(int pos) {
+    const int item = open[pos];
+    const int count = (int)open.size();
+    while (true) {
+      const int first = (pos << 2) + 1;
+      if (first >= count)
+        break;
+      const int last = (first + 4 < count) ? first + 4 : count;
+      int best = first;
+      for (int c = first + 1; c < last; c++)
+        if (before(open[c], open[best]))
+          best = c;
+      if (!before(open[best], item))
+        break;
+      open[pos] = open[best];
+      nodes[open[pos]].heapIndex = pos;
+      pos = best;
+    }
+    open[pos] = item;
+    nodes[item].heapIndex = pos;
+  }
+
+  int minCoord;
+  unsigned int size;
+  unsigned int generation;
+  std::vector<GridNode> nodes;
+  std::vector<int> open;
+};
+
+
+#endif /* GRIDNODESTORE_H_ */
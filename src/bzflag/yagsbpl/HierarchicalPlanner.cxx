@@ -0,0 +1,489 @@
+/* HierarchicalPlanner.cxx
+ *
+ * See HierarchicalPlanner.h
+ */
+
+// interface header
+#include "HierarchicalPlanner.h"
+
+/* system implementation headers */
+#include <algorithm>
+#include <functional>
+
+
+// the 8 neighbours of a cell, and what it costs to move there
+static const int neighbourDx[8]   = {-1, -1, -1,  0,  0,  1,  1,  1};
+static const int neighbourDy[8]   = {-1,  0,  1, -1,  1, -1,  0,  1};
+static const int neighbourCost[8] = {DIAGONAL_COST, STRAIGHT_COST, DIAGONAL_COST,
+                                     STRAIGHT_COST,                STRAIGHT_COST,
+                                     DIAGONAL_COST, STRAIGHT_COST, DIAGONAL_COST};
+
+// open stretches of border at least this long get an entrance at each end instead of one
+#define WIDE_ENTRANCE 6
+
+
+HierarchicalPlanner::HierarchicalPlanner(int clusterSize_) :
+  clusterSize(clusterSize_ < 2 ? 2 : clusterSize_), minCoord(0), size(0), clustersPerSide(0),
+  gridVersion(0), built(false), entranceCount(0), wordsPerRow(0), searchStamp(0),
+  expandCount(0), rebuiltClusterCount(0) {
+}
+
+
+int HierarchicalPlanner::getClusterIndex(int x, int y) const {
+  return ((y - minCoord) / clusterSize) * clustersPerSide + (x - minCoord) / clusterSize;
+}
+
+
+void HierarchicalPlanner::update() {
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+  if (!grid.isBuilt()) {
+    built = false;
+    return;
+  }
+  if (built && gridVersion == grid.getVersion())
+    return;
+
+  const int newSize = grid.getMaxCoord() - grid.getMinCoord() + 1;
+  if (built && grid.getMinCoord() == minCoord && newSize == size)
+    repair(grid);
+  else
+    build(grid);
+  gridVersion = grid.getVersion();
+}
+
+
+void HierarchicalPlanner::build(const OccupancyGrid &grid) {
+  minCoord = grid.getMinCoord();
+  size = grid.getMaxCoord() - minCoord + 1;
+  clustersPerSide = (size + clusterSize - 1) / clusterSize;
+  const int clusterCount = clustersPerSide * clustersPerSide;
+
+  clusters.assign(clusterCount, Cluster());
+  for (int i = 0; i < clusterCount; i++) {
+    Cluster &c = clusters[i];
+    c.x0 = minCoord + (i % clustersPerSide) * clusterSize;
+    c.y0 = minCoord + (i / clustersPerSide) * clusterSize;
+    c.x1 = std::min(c.x0 + clusterSize, minCoord + size) - 1;
+    c.y1 = std::min(c.y0 + clusterSize, minCoord + size) - 1;
+  }
+
+  verticalBorders.assign(clusterCount, std::vector<Transition>());
+  horizontalBorders.assign(clusterCount, std::vector<Transition>());
+  for (int i = 0; i < clusterCount; i++) {
+    scanBorder(grid, i, true);
+    scanBorder(grid, i, false);
+  }
+  linkEntrances();
+  for (int i = 0; i < clusterCount; i++)
+    computeCosts(grid, i);
+
+  rebuiltClusterCount = clusterCount;
+  snapshot(grid);
+  built = true;
+}
+
+
+void HierarchicalPlanner::repair(const OccupancyGrid &grid) {
+  // find the clusters with at least one cell that changed
+  std::vector<char> dirty(clusters.size(), 0);
+  bool anyDirty = false;
+  for (int row = 0; row < size; row++) {
+    const uint64_t *newRow = grid.getRow(minCoord + row);
+    const uint64_t *oldRow = &raster[row * wordsPerRow];
+    for (unsigned int w = 0; w < wordsPerRow; w++) {
+      uint64_t changed = newRow[w] ^ oldRow[w];
+      while (changed) {
+        int bit = 0;
+        while (!((changed >> bit) & 1))
+          bit++;
+        changed &= changed - 1;
+        const int col = (int)(w * 64) + bit;
+        if (col < size) {
+          dirty[getClusterIndex(minCoord + col, minCoord + row)] = 1;
+          anyDirty = true;
+        }
+      }
+    }
+  }
+  if (!anyDirty)
+    return;
+
+  // rescan every border of a dirty cluster; the entrances of its neighbours move too
+  std::vector<char> recompute(clusters.size(), 0);
+  for (int i = 0; i < (int)clusters.size(); i++) {
+    if (!dirty[i])
+      continue;
+    const int cx = i % clustersPerSide;
+    const int cy = i / clustersPerSide;
+    scanBorder(grid, i, true);
+    scanBorder(grid, i, false);
+    recompute[i] = 1;
+    if (cx > 0) {
+      scanBorder(grid, i - 1, true);
+      recompute[i - 1] = 1;
+    }
+    if (cy > 0) {
+      scanBorder(grid, i - clustersPerSide, false);
+      recompute[i - clustersPerSide] = 1;
+    }
+    if (cx < clustersPerSide - 1)
+      recompute[i + 1] = 1;
+    if (cy < clustersPerSide - 1)
+      recompute[i + clustersPerSide] = 1;
+  }
+  linkEntrances();
+
+  rebuiltClusterCount = 0;
+  for (int i = 0; i < (int)clusters.size(); i++) {
+    if (recompute[i]) {
+      computeCosts(grid, i);
+      rebuiltClusterCount++;
+    }
+  }
+  snapshot(grid);
+}
+
+
+void HierarchicalPlanner::snapshot(const OccupancyGrid &grid) {
+  wordsPerRow = grid.getWordsPerRow();
+  raster.resize(size * wordsPerRow);
+  for (int row = 0; row < size; row++)
+    std::copy(grid.getRow(minCoord + row), grid.getRow(minCoord + row) + wordsPerRow,
+              &raster[row * wordsPerRow]);
+}
+
+
+/* Finds the transitions across the right border (vertical) or the top border of a cluster.
+ */
+void HierarchicalPlanner::scanBorder(const OccupancyGrid &grid, int cluster, bool vertical) {
+  std::vector<Transition> &border = vertical ? verticalBorders[cluster] : horizontalBorders[cluster];
+  border.clear();
+  const Cluster &c = clusters[cluster];
+  if ((vertical && c.x1 >= minCoord + size - 1) || (!vertical && c.y1 >= minCoord + size - 1))
+    return;
+
+  const int first = vertical ? c.y0 : c.x0;
+  const int last  = vertical ? c.y1 : c.x1;
+  bool inRun = false;
+  int runStart = 0;
+  for (int i = first; i <= last + 1; i++) {
+    bool open = false;
+    if (i <= last) {
+      if (vertical)
+        open = grid.isAccessible(c.x1, i) && grid.isAccessible(c.x1 + 1, i);
+      else
+        open = grid.isAccessible(i, c.y1) && grid.isAccessible(i, c.y1 + 1);
+    }
+    if (open) {
+      if (!inRun)
+        runStart = i;
+      inRun = true;
+      continue;
+    }
+    if (!inRun)
+      continue;
+
+    // the run [runStart, i - 1] is open on both sides
+    int positions[2];
+    int count = 0;
+    if (i - runStart < WIDE_ENTRANCE) {
+      positions[count++] = (runStart + i - 1) / 2;
+    } else {
+      positions[count++] = runStart;
+      positions[count++] = i - 1;
+    }
+    for (int k = 0; k < count; k++) {
+      Transition t;
+      t.insideX  = vertical ? c.x1 : positions[k];
+      t.insideY  = vertical ? positions[k] : c.y1;
+      t.outsideX = vertical ? c.x1 + 1 : positions[k];
+      t.outsideY = vertical ? positions[k] : c.y1 + 1;
+      border.push_back(t);
+    }
+    inRun = false;
+  }
+}
+
+
+/* Rebuilds every cluster's entrance list from the borders.
+ * The lists only depend on the borders of their cluster, so clusters whose borders did not
+ * change get the exact same list back, and their precomputed costs stay valid.
+ */
+void HierarchicalPlanner::linkEntrances() {
+  entranceCount = 0;
+  for (int i = 0; i < (int)clusters.size(); i++) {
+    Cluster &c = clusters[i];
+    const int cx = i % clustersPerSide;
+    const int cy = i / clustersPerSide;
+    c.entrances.clear();
+
+    Entrance e;
+    c.firstEntrance[LeftBorder] = (int)c.entrances.size();
+    if (cx > 0) {
+      const std::vector<Transition> &border = verticalBorders[i - 1];
+      for (unsigned int k = 0; k < border.size(); k++) {
+        e.x = border[k].outsideX;
+        e.y = border[k].outsideY;
+        e.otherCluster = i - 1;
+        c.entrances.push_back(e);
+      }
+    }
+    c.firstEntrance[RightBorder] = (int)c.entrances.size();
+    for (unsigned int k = 0; k < verticalBorders[i].size(); k++) {
+      e.x = verticalBorders[i][k].insideX;
+      e.y = verticalBorders[i][k].insideY;
+      e.otherCluster = i + 1;
+      c.entrances.push_back(e);
+    }
+    c.firstEntrance[BottomBorder] = (int)c.entrances.size();
+    if (cy > 0) {
+      const std::vector<Transition> &border = horizontalBorders[i - clustersPerSide];
+      for (unsigned int k = 0; k < border.size(); k++) {
+        e.x = border[k].outsideX;
+        e.y = border[k].outsideY;
+        e.otherCluster = i - clustersPerSide;
+        c.entrances.push_back(e);
+      }
+    }
+    c.firstEntrance[TopBorder] = (int)c.entrances.size();
+    for (unsigned int k = 0; k < horizontalBorders[i].size(); k++) {
+      e.x = horizontalBorders[i][k].insideX;
+      e.y = horizontalBorders[i][k].insideY;
+      e.otherCluster = i + clustersPerSide;
+      c.entrances.push_back(e);
+    }
+
+    c.firstNode = entranceCount;
+    entranceCount += (int)c.entrances.size();
+  }
+
+  nodeCluster.resize(entranceCount);
+  for (int i = 0; i < (int)clusters.size(); i++)
+    std::fill(nodeCluster.begin() + clusters[i].firstNode,
+              nodeCluster.begin() + clusters[i].firstNode + clusters[i].entrances.size(), i);
+
+  // the k-th entrance on one side of a border faces the k-th entrance on the other side
+  for (int i = 0; i < (int)clusters.size(); i++) {
+    Cluster &c = clusters[i];
+    for (int k = 0; k < (int)c.entrances.size(); k++) {
+      Entrance &e = c.entrances[k];
+      const Cluster &other = clusters[e.otherCluster];
+      if (k < c.firstEntrance[RightBorder])
+        e.otherEntrance = other.firstEntrance[RightBorder] + (k - c.firstEntrance[LeftBorder]);
+      else if (k < c.firstEntrance[BottomBorder])
+        e.otherEntrance = other.firstEntrance[LeftBorder] + (k - c.firstEntrance[RightBorder]);
+      else if (k < c.firstEntrance[TopBorder])
+        e.otherEntrance = other.firstEntrance[TopBorder] + (k - c.firstEntrance[BottomBorder]);
+      else
+        e.otherEntrance = other.firstEntrance[BottomBorder] + (k - c.firstEntrance[TopBorder]);
+    }
+  }
+}
+
+
+void HierarchicalPlanner::computeCosts(const OccupancyGrid &grid, int cluster) {
+  Cluster &c = clusters[cluster];
+  const int n = (int)c.entrances.size();
+  c.costs.assign(n * n, -1);
+  for (int i = 0; i < n; i++) {
+    searchCluster(grid, c, c.entrances[i].x, c.entrances[i].y);
+    c.costs[i * n + i] = 0;
+    // costs are symmetric, so only the entrances after i need a value from this search
+    for (int j = i + 1; j < n; j++) {
+      const int cost = getLocalCost(c, c.entrances[j].x, c.entrances[j].y);
+      c.costs[i * n + j] = cost;
+      c.costs[j * n + i] = cost;
+    }
+  }
+}
+
+
+void HierarchicalPlanner::searchCluster(const OccupancyGrid &grid, const Cluster &c, int x, int y) {
+  const int width  = c.x1 - c.x0 + 1;
+  const int height = c.y1 - c.y0 + 1;
+  localCost.assign(width * height, -1);
+  localOpen.clear();
+
+  // the search may start on a blocked cell (a tank touching a building)
+  const int startIndex = (y - c.y0) * width + (x - c.x0);
+  localCost[startIndex] = 0;
+  localOpen.push_back(std::make_pair(0, startIndex));
+
+  while (!localOpen.empty()) {
+    std::pop_heap(localOpen.begin(), localOpen.end(), std::greater< std::pair<int,int> >());
+    const int cost = localOpen.back().first;
+    const int index = localOpen.back().second;
+    localOpen.pop_back();
+    if (cost > localCost[index])
+      continue;  // stale entry
+
+    const int cx = c.x0 + index % width;
+    const int cy = c.y0 + index / width;
+    for (int k = 0; k < 8; k++) {
+      const int nx = cx + neighbourDx[k];
+      const int ny = cy + neighbourDy[k];
+      if (nx < c.x0 || nx > c.x1 || ny < c.y0 || ny > c.y1 || !grid.isAccessible(nx, ny))
+        continue;
+      const int next = (ny - c.y0) * width + (nx - c.x0);
+      const int nextCost = cost + neighbourCost[k];
+      if (localCost[next] >= 0 && localCost[next] <= nextCost)
+        continue;
+      localCost[next] = nextCost;
+      localOpen.push_back(std::make_pair(nextCost, next));
+      std::push_heap(localOpen.begin(), localOpen.end(), std::greater< std::pair<int,int> >());
+    }
+  }
+}
+
+
+void HierarchicalPlanner::getNodeCell(int node, int &x, int &y) const {
+  if (node >= entranceCount)
+    return;  // the start or the goal
+  const Cluster &c = clusters[nodeCluster[node]];
+  x = c.entrances[node - c.firstNode].x;
+  y = c.entrances[node - c.firstNode].y;
+}
+
+
+int HierarchicalPlanner::getLocalCost(const Cluster &c, int x, int y) const {
+  return localCost[(y - c.y0) * (c.x1 - c.x0 + 1) + (x - c.x0)];
+}
+
+
+bool HierarchicalPlanner::plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &waypoints) {
+  waypoints.clear();
+  expandCount = 0;
+
+  update();
+  if (!built)
+    return false;
+  const int maxCoord = minCoord + size - 1;
+  if (start.x < minCoord || start.x > maxCoord || start.y < minCoord || start.y > maxCoord ||
+      goal.x < minCoord || goal.x > maxCoord || goal.y < minCoord || goal.y > maxCoord)
+    return false;
+
+  const OccupancyGrid &grid = OCCUPANCYGRID;
+  // like the other planners, only the start may be on a blocked cell
+  if (!grid.isAccessible(goal.x, goal.y) && (goal.x != start.x || goal.y != start.y))
+    return false;
+  const int startClusterIndex = getClusterIndex(start.x, start.y);
+  const int goalClusterIndex  = getClusterIndex(goal.x, goal.y);
+  const Cluster &startCluster = clusters[startClusterIndex];
+  const Cluster &goalCluster  = clusters[goalClusterIndex];
+
+  // connect the start and the goal to the entrances of their clusters
+  searchCluster(grid, startCluster, start.x, start.y);
+  startCost.resize(startCluster.entrances.size());
+  for (unsigned int i = 0; i < startCluster.entrances.size(); i++)
+    startCost[i] = getLocalCost(startCluster, startCluster.entrances[i].x, startCluster.entrances[i].y);
+  const int directCost = (startClusterIndex == goalClusterIndex) ? getLocalCost(startCluster, goal.x, goal.y) : -1;
+
+  searchCluster(grid, goalCluster, goal.x, goal.y);
+  goalCost.resize(goalCluster.entrances.size());
+  for (unsigned int i = 0; i < goalCluster.entrances.size(); i++)
+    goalCost[i] = getLocalCost(goalCluster, goalCluster.entrances[i].x, goalCluster.entrances[i].y);
+
+  // A* over the entrances, plus a node for the start and one for the goal
+  const int startNode = entranceCount;
+  const int goalNode  = entranceCount + 1;
+  if ((int)nodeStamp.size() < entranceCount + 2) {
+    nodeG.resize(entranceCount + 2);
+    nodeParent.resize(entranceCount + 2);
+    nodeStamp.resize(entranceCount + 2, 0);
+  }
+  if (++searchStamp == 0) {
+    std::fill(nodeStamp.begin(), nodeStamp.end(), 0);
+    searchStamp = 1;
+  }
+  open.clear();
+
+  nodeStamp[startNode] = searchStamp;
+  nodeG[startNode] = 0;
+  nodeParent[startNode] = -1;
+  open.push_back(std::make_pair(octileDistance(goal.x - start.x, goal.y - start.y), startNode));
+
+  bool found = false;
+  while (!open.empty()) {
+    std::pop_heap(open.begin(), open.end(), std::greater< std::pair<int,int> >());
+    const int f = open.back().first;
+    const int node = open.back().second;
+    open.pop_back();
+
+    if (node == goalNode) {
+      found = true;
+      break;
+    }
+    const int g = nodeG[node];
+    const int clusterIndex = (node == startNode) ? startClusterIndex : nodeCluster[node];
+    const Cluster *c = &clusters[clusterIndex];
+    const int local = (node == startNode) ? -1 : node - c->firstNode;
+    const int x = (node == startNode) ? start.x : c->entrances[local].x;
+    const int y = (node == startNode) ? start.y : c->entrances[local].y;
+    if (f > g + octileDistance(goal.x - x, goal.y - y))
+      continue;  // stale entry
+    expandCount++;
+
+    const int n = (int)c->entrances.size();
+    for (int k = -2; k < n; k++) {
+      int next, cost;
+      if (k == -2) {
+        // to the goal
+        if (node == startNode)
+          cost = directCost;
+        else if (clusterIndex == goalClusterIndex)
+          cost = goalCost[local];
+        else
+          cost = -1;
+        next = goalNode;
+      } else if (k == -1) {
+        // across the border
+        if (node == startNode)
+          continue;
+        const Entrance &e = c->entrances[local];
+        next = clusters[e.otherCluster].firstNode + e.otherEntrance;
+        cost = STRAIGHT_COST;
+      } else {
+        // to another entrance of the same cluster
+        if (k == local)
+          continue;
+        cost = (node == startNode) ? startCost[k] : c->costs[local * n + k];
+        next = c->firstNode + k;
+      }
+      if (cost < 0)
+        continue;
+
+      const int nextG = g + cost;
+      if (nodeStamp[next] == searchStamp && nodeG[next] <= nextG)
+        continue;
+      nodeStamp[next] = searchStamp;
+      nodeG[next] = nextG;
+      nodeParent[next] = node;
+
+      int nx = goal.x, ny = goal.y;
+      getNodeCell(next, nx, ny);
+      open.push_back(std::make_pair(nextG + octileDistance(goal.x - nx, goal.y - ny), next));
+      std::push_heap(open.begin(), open.end(), std::greater< std::pair<int,int> >());
+    }
+  }
+
+  if (!found)
+    return false;
+
+  // walk back from the goal; entrances facing each other are both kept, they are one cell apart
+  for (int node = goalNode; node >= 0; node = nodeParent[node]) {
+    MyNode waypoint;
+    if (node == goalNode) {
+      waypoint = goal;
+    } else if (node == startNode) {
+      waypoint = start;
+    } else {
+      getNodeCell(node, waypoint.x, waypoint.y);
+    }
+    if (waypoints.empty() || !(waypoints.back() == waypoint))
+      waypoints.push_back(waypoint);
+  }
+  std::reverse(waypoints.begin(), waypoints.end());
+  return true;
+}
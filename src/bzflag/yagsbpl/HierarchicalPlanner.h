@@ -0,0 +1,141 @@
+/* HierarchicalPlanner.h
+ *
+ * Hierarchical path-finding (HPA*) over the OccupancyGrid tile graph.
+ *
+ * The grid is cut into square clusters.  Wherever two neighbouring clusters share an open
+ * stretch of border, one or two "entrances" are placed on it, and the cost of driving between
+ * every pair of entrances of a cluster (without leaving the cluster) is precomputed.  A long
+ * query then only searches this small abstract graph: the start and goal are connected to the
+ * entrances of their own clusters, and A* runs over the entrances.
+ *
+ * The result is a list of waypoints (start, entrances, goal) rather than a cell-by-cell path.
+ * Consecutive waypoints are in the same cluster, so each segment can be refined with a short
+ * local search right before the tank drives it (RobotPlayer::checkLineOfSight() already does
+ * that whenever the straight line to the next waypoint is blocked).
+ *
+ * The abstraction is built once per world.  When the OccupancyGrid is rebuilt with the same
+ * bounds, only the clusters whose cells changed (and their neighbours) are recomputed.
+ * Paths are near-optimal: they are only allowed to cross cluster borders at entrances.
+ *
+ * See: A. Botea, M. Mueller and J. Schaeffer, "Near Optimal Hierarchical Path-Finding", 2004.
+ */
+
+#ifndef HIERARCHICALPLANNER_H_
+#define HIERARCHICALPLANNER_H_
+
+#include "common.h"
+
+/* system interface headers */
+#include <vector>
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+
+
+class HierarchicalPlanner {
+public:
+  /* Constructor
+   * @param clusterSize The width of a cluster, in cells.
+   */
+  HierarchicalPlanner(int clusterSize = 16);
+
+  /* Finds a path from the start node to the goal node on the abstract graph.
+   * @param start The node from which to start the search.
+   * @param goal The search will try to find a path to this node.
+   * @param waypoints Writes the waypoints here, from start to goal (inclusive).  Two consecutive
+   *                  waypoints are always in the same cluster.  Cleared if there is no path.
+   * @return True if a path was found, false otherwise.
+   */
+  bool plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &waypoints);
+
+  /* Brings the abstraction up to date with the OccupancyGrid: builds it the first time, and
+   * repairs the clusters that changed after the grid was rebuilt.  plan() calls this.
+   */
+  void update();
+
+  int getClusterSize() const { return clusterSize; }
+
+  /* The number of entrances, i.e. nodes of the abstract graph.
+   */
+  int getEntranceCount() const { return entranceCount; }
+
+  /* The number of abstract nodes expanded by the last call to plan().
+   */
+  int getExpandCount() const { return expandCount; }
+
+  /* The number of clusters recomputed by the last update that changed anything.
+   */
+  int getRebuiltClusterCount() const { return rebuiltClusterCount; }
+
+private:
+  // two cells facing each other across a cluster border, both open
+  struct Transition {
+    int insideX, insideY;    // in the cluster with the lower index
+    int outsideX, outsideY;  // in the cluster with the higher index
+  };
+
+  // an entrance cell of a cluster, linked to the entrance facing it in the neighbouring cluster
+  struct Entrance {
+    int x, y;
+    int otherCluster;
+    int otherEntrance;  // index in the other cluster's entrance list
+  };
+
+  enum BorderSide { LeftBorder = 0, RightBorder, BottomBorder, TopBorder };
+
+  struct Cluster {
+    int x0, y0, x1, y1;          // bounds, in graph coordinates (inclusive)
+    int firstEntrance[4];        // where each border's entrances start in 'entrances'
+    std::vector<Entrance> entrances;
+    std::vector<int> costs;      // entrances.size() squared, -1 if unreachable inside the cluster
+    int firstNode;               // id of entrances[0] in the abstract search
+  };
+
+  void build(const OccupancyGrid &grid);
+  void repair(const OccupancyGrid &grid);
+  void snapshot(const OccupancyGrid &grid);
+
+  int getClusterIndex(int x, int y) const;
+  void scanBorder(const OccupancyGrid &grid, int cluster, bool vertical);
+  void linkEntrances();
+  void computeCosts(const OccupancyGrid &grid, int cluster);
+
+  /* Dijkstra from (x, y), without leaving the cluster.  Fills 'localCost'.
+   */
+  void searchCluster(const OccupancyGrid &grid, const Cluster &c, int x, int y);
+  int getLocalCost(const Cluster &c, int x, int y) const;
+  /* The cell of an entrance, given its id in the abstract search.
+   */
+  void getNodeCell(int node, int &x, int &y) const;
+
+  int clusterSize;
+  int minCoord, size;         // grid bounds the abstraction was built for
+  int clustersPerSide;
+  unsigned int gridVersion;   // OccupancyGrid version the abstraction reflects
+  bool built;
+
+  std::vector<Cluster> clusters;
+  // transitions across the right border of each cluster, and across its top border
+  std::vector< std::vector<Transition> > verticalBorders, horizontalBorders;
+  int entranceCount;
+  std::vector<int> nodeCluster;  // cluster of each entrance, by id in the abstract search
+
+  // copy of the raster the abstraction was built from, to find what changed
+  std::vector<uint64_t> raster;
+  unsigned int wordsPerRow;
+
+  // scratch space, kept between queries
+  std::vector<int> localCost;
+  std::vector< std::pair<int,int> > localOpen;
+  std::vector<int> startCost, goalCost;
+  std::vector<int> nodeG, nodeParent;
+  std::vector<unsigned int> nodeStamp;
+  unsigned int searchStamp;
+  std::vector< std::pair<int,int> > open;
+
+  int expandCount;
+  int rebuiltClusterCount;
+};
+
+
+#endif /* HIERARCHICALPLANNER_H_ */
@@ -0,0 +1,192 @@
+/* JumpPointSearch.cxx
+ *
+ * See JumpPointSearch.h
+ */
+
+// interface header
+#include "JumpPointSearch.h"
+
+/* system implementation headers */
+#include <algorithm>
+
+
+// all 8 directions, used for the start node
+static const int allDx[8] = {-1, -1, -1,  0,  0,  1,  1,  1};
+static const int allDy[8] = {-1,  0,  1, -1,  1, -1,  0,  1};
+
+
+static inline int sign(int v) {
+  return (v > 0) - (v < 0);
+}
+
+
+JumpPointSearchPlanner::JumpPointSearchPlanner() : grid(NULL), goalX(0), goalY(0), expandCount(0) {
+}
+
+
+bool JumpPointSearchPlanner::jump(int x, int y, int dx, int dy, int &jx, int &jy) const {
+  const OccupancyGrid &g = *grid;
+  while (true) {
+    x += dx;
+    y += dy;
+    if (!g.isAccessible(x, y))
+      return false;
+    if (x == goalX && y == goalY)
+      break;
+
+    if (dx && dy) {
+      // forced neighbours: an obstacle beside us hides a cell that is only reachable through here
+      if ((g.isAccessible(x - dx, y + dy) && !g.isAccessible(x - dx, y)) ||
+          (g.isAccessible(x + dx, y - dy) && !g.isAccessible(x, y - dy)))
+        break;
+      // a diagonal cell is also a jump point if one of its straight scans finds one
+      int sx, sy;
+      if (jump(x, y, dx, 0, sx, sy) || jump(x, y, 0, dy, sx, sy))
+        break;
+    } else if (dx) {
+      if ((g.isAccessible(x + dx, y + 1) && !g.isAccessible(x, y + 1)) ||
+          (g.isAccessible(x + dx, y - 1) && !g.isAccessible(x, y - 1)))
+        break;
+    } else {
+      if ((g.isAccessible(x + 1, y + dy) && !g.isAccessible(x + 1, y)) ||
+          (g.isAccessible(x - 1, y + dy) && !g.isAccessible(x - 1, y)))
+        break;
+    }
+  }
+  jx = x;
+  jy = y;
+  return true;
+}
+
+
+bool JumpPointSearchPlanner::plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path) {
+  OccupancyGrid &occupancy = OCCUPANCYGRID;
+  if (!occupancy.isBuilt())
+    occupancy.build();
+  return plan(occupancy, start, goal, path);
+}
+
+
+bool JumpPointSearchPlanner::plan(const OccupancyGrid &occupancy, const MyNode &start, const MyNode &goal,
+                                  std::vector<MyNode> &path) {
+  path.clear();
+  expandCount = 0;
+  grid = &occupancy;
+  store.reset(occupancy);
+
+  if (!store.contains(start.x, start.y) || !store.contains(goal.x, goal.y))
+    return false;
+  goalX = goal.x;
+  goalY = goal.y;
+
+  const int startIndex = store.getIndex(start.x, start.y);
+  const int goalIndex  = store.getIndex(goal.x, goal.y);
+
+  // the start node is always allowed, even if the tank is touching a building
+  store.visit(startIndex);
+  store[startIndex].g = 0;
+  store[startIndex].f = octileDistance(goal.x - start.x, goal.y - start.y);
+  store.pushOrDecrease(startIndex);
+
+  int dirX[8], dirY[8];
+  while (!store.openEmpty()) {
+    const int current = store.popMin();
+    expandCount++;
+
+    if (current == goalIndex) {
+      // walk back through the jump points, filling in the cells between them
+      for (int i = goalIndex; i >= 0; i = store[i].parent) {
+        const int x = store.getX(i);
+        const int y = store.getY(i);
+        const int parent = store[i].parent;
+        if (parent < 0) {
+          path.push_back(MyNode());
+          path.back().x = x;
+          path.back().y = y;
+          break;
+        }
+        const int px = store.getX(parent);
+        const int py = store.getY(parent);
+        const int sx = sign(px - x);
+        const int sy = sign(py - y);
+        for (int cx = x, cy = y; cx != px || cy != py; cx += sx, cy += sy) {
+          path.push_back(MyNode());
+          path.back().x = cx;
+          path.back().y = cy;
+        }
+      }
+      std::reverse(path.begin(), path.end());
+      return true;
+    }
+
+    store.close(current);
+    const int cx = store.getX(current);
+    const int cy = store.getY(current);
+    const int currentG = store[current].g;
+
+    // pick the directions worth scanning, given where we came from
+    int dirCount = 0;
+    const int parent = store[current].parent;
+    if (parent < 0) {
+      for (int k = 0; k < 8; k++) {
+        dirX[dirCount] = allDx[k];
+        dirY[dirCount++] = allDy[k];
+      }
+    } else {
+      const int dx = sign(cx - store.getX(parent));
+      const int dy = sign(cy - store.getY(parent));
+      if (dx && dy) {
+        dirX[dirCount] = 0;   dirY[dirCount++] = dy;
+        dirX[dirCount] = dx;  dirY[dirCount++] = 0;
+        dirX[dirCount] = dx;  dirY[dirCount++] = dy;
+        if (!occupancy.isAccessible(cx - dx, cy)) {
+          dirX[dirCount] = -dx;  dirY[dirCount++] = dy;
+        }
+        if (!occupancy.isAccessible(cx, cy - dy)) {
+          dirX[dirCount] = dx;  dirY[dirCount++] = -dy;
+        }
+      } else if (dx) {
+        dirX[dirCount] = dx;  dirY[dirCount++] = 0;
+        if (!occupancy.isAccessible(cx, cy + 1)) {
+          dirX[dirCount] = dx;  dirY[dirCount++] = 1;
+        }
+        if (!occupancy.isAccessible(cx, cy - 1)) {
+          dirX[dirCount] = dx;  dirY[dirCount++] = -1;
+        }
+      } else {
+        dirX[dirCount] = 0;  dirY[dirCount++] = dy;
+        if (!occupancy.isAccessible(cx + 1, cy)) {
+          dirX[dirCount] = 1;  dirY[dirCount++] = dy;
+        }
+        if (!occupancy.isAccessible(cx - 1, cy)) {
+          dirX[dirCount] = -1;  dirY[dirCount++] = dy;
+        }
+      }
+    }
+
+    for (int k = 0; k < dirCount; k++) {
+      int jx, jy;
+      if (!jump(cx, cy, dirX[k], dirY[k], jx, jy))
+        continue;
+
+      const int next = store.getIndex(jx, jy);
+      if (!store.isVisited(next))
+        store.visit(next);
+      else if (store.isClosed(next))
+        continue;
+
+      // jump points lie on a straight or diagonal line from the current node
+      const int g = currentG + octileDistance(jx - cx, jy - cy);
+      GridNode &node = store[next];
+      if (g >= node.g)
+        continue;
+      node.g = g;
+      node.f = g + octileDistance(goal.x - jx, goal.y - jy);
+      node.parent = current;
+      store.pushOrDecrease(next);
+    }
+  }
+
+  // no path
+  return false;
+}
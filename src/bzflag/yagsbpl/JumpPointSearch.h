@@ -0,0 +1,62 @@
+/* JumpPointSearch.h
+ *
+ * Jump Point Search over the OccupancyGrid tile graph.
+ *
+ * Same graph as GridAStarPlanner (8-connected, integer octile costs, diagonal moves allowed
+ * whenever the destination cell is open), so it finds paths of the same cost.  Instead of
+ * pushing all 8 neighbours, a node only looks in the directions that can lead to a shorter path
+ * than one through its parent, and each direction is scanned until a "jump point" (the goal, or a
+ * cell next to an obstacle corner) is found.  Only jump points go into the open list, which
+ * cuts the number of expansions by a large factor on open maps.
+ *
+ * See: D. Harabor and A. Grastien, "Online Graph Pruning for Pathfinding on Grid Maps", AAAI 2011.
+ */
+
+#ifndef JUMPPOINTSEARCH_H_
+#define JUMPPOINTSEARCH_H_
+
+/* system interface headers */
+#include <vector>
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+#include "GridNodeStore.h"
+
+
+class JumpPointSearchPlanner {
+public:
+  JumpPointSearchPlanner();
+
+  /* Finds a shortest path from the start node to the goal node.
+   * @param start The node from which to start the search.
+   * @param goal The search will try to find a path to this node.
+   * @param path Writes the path here, from start to goal (inclusive), one node per cell like
+   *             GridAStarPlanner.  Cleared if there is no path.
+   * @return True if a path was found, false otherwise.
+   */
+  bool plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* Same as above, on the given grid instead of the shared OccupancyGrid.  The grid is only read,
+   * so planners that do not share state can search the same grid from several threads.
+   * @param grid The raster to search, already built (e.g. an OccupancyGrid::snapshot()).
+   */
+  bool plan(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* The number of jump points expanded by the last call to plan().
+   */
+  int getExpandCount() const { return expandCount; }
+
+private:
+  /* Scans from (x, y) in direction (dx, dy).
+   * @return True if a jump point was found, which is then written to (jx, jy).
+   */
+  bool jump(int x, int y, int dx, int dy, int &jx, int &jy) const;
+
+  const OccupancyGrid *grid;  // valid during plan()
+  int goalX, goalY;
+  GridNodeStore store;
+  int expandCount;
+};
+
+
+#endif /* JUMPPOINTSEARCH_H_ */
@@ -0,0 +1,318 @@
+/* NavMesh.cxx
+ *
+ * See NavMesh.h
+ */
+
+// interface header
+#include "NavMesh.h"
+
+/* system implementation headers */
+#include <map>
+#include <queue>
+#include <utility>
+
+// initialize the singleton
+template <>
+NavMesh* Singleton<NavMesh>::_instance = (NavMesh*)0;
+
+
+/* Twice the signed area of the triangle (a, b, c): positive if c is to the right of a->b.
+ */
+static inline float triArea2(const float a[2], const float b[2], const float c[2]) {
+  return (c[0] - a[0]) * (b[1] - a[1]) - (b[0] - a[0]) * (c[1] - a[1]);
+}
+
+
+static inline bool samePoint(const float a[2], const float b[2]) {
+  const float dx = a[0] - b[0];
+  const float dy = a[1] - b[1];
+  return dx * dx + dy * dy < 1.0e-6f;
+}
+
+
+/* The point of the segment (p1, p2) where the line from a toward b crosses it, or the nearest end
+ * of the segment if the line misses.  Same idea as RobotPlayer::getRegionExitPoint().
+ */
+static void crossingPoint(const float p1[2], const float p2[2], const float a[2], const float b[2],
+                          float mid[2]) {
+  const float d[2] = { p2[0] - p1[0], p2[1] - p1[1] };
+  const float e[2] = { b[0] - a[0], b[1] - a[1] };
+  const float denom = d[0] * e[1] - d[1] * e[0];
+  float t = 0.5f;
+  if (fabsf(denom) > 1.0e-6f) {
+    t = ((a[0] - p1[0]) * e[1] - (a[1] - p1[1]) * e[0]) / denom;
+    if (t < 0.0f)
+      t = 0.0f;
+    else if (t > 1.0f)
+      t = 1.0f;
+  }
+  mid[0] = p1[0] + t * d[0];
+  mid[1] = p1[1] + t * d[1];
+}
+
+
+NavMesh::NavMesh() : searchId(0), portalCount(0), expandCount(0), margin(0.0f) {
+}
+
+
+NavMesh::~NavMesh() {
+}
+
+
+void NavMesh::clear() {
+  polygons.clear();
+  nodes.clear();
+  portalCount = 0;
+}
+
+
+void NavMesh::build(const std::vector<BzfRegion*> &regions, float _margin) {
+  clear();
+  margin = _margin;
+
+  std::map<const BzfRegion*, int> index;
+  for (unsigned int i = 0; i < regions.size(); i++)
+    index[regions[i]] = (int)i;
+
+  polygons.resize(regions.size());
+  for (unsigned int i = 0; i < regions.size(); i++) {
+    const BzfRegion *region = regions[i];
+    Polygon &polygon = polygons[i];
+    const int numSides = region->getNumSides();
+    polygon.center[0] = polygon.center[1] = 0.0f;
+    for (int j = 0; j < numSides; j++) {
+      const float *p = region->getCorner(j).get();
+      polygon.corners.push_back(RegionPoint(p[0], p[1]));
+      polygon.center[0] += p[0] / numSides;
+      polygon.center[1] += p[1] / numSides;
+
+      // the neighbour shares the whole edge: splitting a region splits its neighbours' edges too
+      std::map<const BzfRegion*, int>::const_iterator it = index.find(region->getNeighbor(j));
+      polygon.neighbors.push_back(it == index.end() ? -1 : it->second);
+      if (it != index.end())
+        portalCount++;
+    }
+  }
+  portalCount /= 2;
+
+  nodes.resize(polygons.size());
+  for (unsigned int i = 0; i < nodes.size(); i++)
+    nodes[i].searchId = 0;
+  searchId = 0;
+}
+
+
+bool NavMesh::isInside(const Polygon &polygon, const float p[2]) const {
+  // convex: inside if on the same side of every edge
+  const int numSides = (int)polygon.corners.size();
+  bool right = false, left = false;
+  for (int i = 0; i < numSides; i++) {
+    const float area = triArea2(polygon.corners[i].get(), polygon.corners[(i + 1) % numSides].get(), p);
+    if (area > 0.0f)
+      right = true;
+    else if (area < 0.0f)
+      left = true;
+    if (right && left)
+      return false;
+  }
+  return true;
+}
+
+
+int NavMesh::findPolygon(const float p[2], float nearest[2]) const {
+  nearest[0] = p[0];
+  nearest[1] = p[1];
+  for (unsigned int i = 0; i < polygons.size(); i++)
+    if (isInside(polygons[i], p))
+      return (int)i;
+
+  // inside an obstacle: take the nearest point on the edge of any polygon
+  int best = -1;
+  float bestDistance = 0.0f;
+  for (unsigned int i = 0; i < polygons.size(); i++) {
+    const Polygon &polygon = polygons[i];
+    const int numSides = (int)polygon.corners.size();
+    for (int j = 0; j < numSides; j++) {
+      const float *a = polygon.corners[j].get();
+      const float *b = polygon.corners[(j + 1) % numSides].get();
+      const float d[2] = { b[0] - a[0], b[1] - a[1] };
+      const float length2 = d[0] * d[0] + d[1] * d[1];
+      float t = (length2 > 0.0f) ? ((p[0] - a[0]) * d[0] + (p[1] - a[1]) * d[1]) / length2 : 0.0f;
+      t = (t < 0.0f) ? 0.0f : ((t > 1.0f) ? 1.0f : t);
+      const float q[2] = { a[0] + t * d[0], a[1] + t * d[1] };
+      const float distance = hypotf(q[0] - p[0], q[1] - p[1]);
+      if (best < 0 || distance < bestDistance) {
+        best = (int)i;
+        bestDistance = distance;
+        nearest[0] = q[0];
+        nearest[1] = q[1];
+      }
+    }
+  }
+  return best;
+}
+
+
+void NavMesh::getPortal(int polygon, int edge, float left[2], float right[2]) const {
+  const Polygon &from = polygons[polygon];
+  const int numSides = (int)from.corners.size();
+  const float *a = from.corners[edge].get();
+  const float *b = from.corners[(edge + 1) % numSides].get();
+
+  // left and right as seen when leaving the polygon through the edge, whatever the winding
+  const float mid[2] = { 0.5f * (a[0] + b[0]), 0.5f * (a[1] + b[1]) };
+  if (triArea2(from.center, mid, a) < 0.0f) {
+    const float *t = a;
+    a = b;
+    b = t;
+  }
+  // now a is on the right, b on the left; pull both in by the margin
+  const float length = hypotf(b[0] - a[0], b[1] - a[1]);
+  const float t = (length > 2.0f * margin) ? margin / length : 0.5f;
+  right[0] = a[0] + t * (b[0] - a[0]);
+  right[1] = a[1] + t * (b[1] - a[1]);
+  left[0]  = b[0] + t * (a[0] - b[0]);
+  left[1]  = b[1] + t * (a[1] - b[1]);
+}
+
+
+bool NavMesh::plan(const float startPoint[2], const float goalPoint[2], std::vector<RegionPoint> &path) {
+  path.clear();
+  expandCount = 0;
+  float start[2], goal[2];
+  const int startPolygon = findPolygon(startPoint, start);
+  const int goalPolygon  = findPolygon(goalPoint, goal);
+  if (startPolygon < 0 || goalPolygon < 0)
+    return false;
+
+  // A* over the polygons.  Each polygon is entered at one point of the portal, the one on the
+  // way from the previous point to the goal, and g is measured through those points.
+  searchId++;
+  typedef std::pair<float, int> QueueItem;  // (-f, polygon), so the queue pops the least f
+  std::priority_queue<QueueItem> open;
+  SearchNode &first = nodes[startPolygon];
+  first.searchId = searchId;
+  first.closed = false;
+  first.g = 0.0f;
+  first.point[0] = start[0];
+  first.point[1] = start[1];
+  first.parent = -1;
+  first.parentEdge = -1;
+  open.push(QueueItem(-hypotf(goal[0] - start[0], goal[1] - start[1]), startPolygon));
+
+  bool found = false;
+  while (!open.empty()) {
+    const int current = open.top().second;
+    open.pop();
+    SearchNode &node = nodes[current];
+    if (node.closed)
+      continue;  // already expanded with a lower f
+    node.closed = true;
+    expandCount++;
+    if (current == goalPolygon) {
+      found = true;
+      break;
+    }
+
+    const Polygon &polygon = polygons[current];
+    const int numSides = (int)polygon.corners.size();
+    for (int edge = 0; edge < numSides; edge++) {
+      const int next = polygon.neighbors[edge];
+      if (next < 0)
+        continue;
+      float left[2], right[2], entry[2];
+      getPortal(current, edge, left, right);
+      crossingPoint(right, left, node.point, goal, entry);
+      const float g = node.g + hypotf(entry[0] - node.point[0], entry[1] - node.point[1]);
+
+      SearchNode &neighbor = nodes[next];
+      if (neighbor.searchId == searchId && (neighbor.closed || neighbor.g <= g))
+        continue;
+      neighbor.searchId = searchId;
+      neighbor.closed = false;
+      neighbor.g = g;
+      neighbor.point[0] = entry[0];
+      neighbor.point[1] = entry[1];
+      neighbor.parent = current;
+      neighbor.parentEdge = edge;
+      open.push(QueueItem(-(g + hypotf(goal[0] - entry[0], goal[1] - entry[1])), next));
+    }
+  }
+  if (!found)
+    return false;
+
+  // collect the portals from the start to the goal, as (left, right) pairs
+  std::vector<int> corridor;
+  for (int p = goalPolygon; nodes[p].parent >= 0; p = nodes[p].parent)
+    corridor.push_back(p);
+  std::vector<float> portals;
+  portals.reserve(4 * (corridor.size() + 2));
+  portals.push_back(start[0]); portals.push_back(start[1]);
+  portals.push_back(start[0]); portals.push_back(start[1]);
+  for (int i = (int)corridor.size() - 1; i >= 0; i--) {
+    const SearchNode &node = nodes[corridor[i]];
+    float left[2], right[2];
+    getPortal(node.parent, node.parentEdge, left, right);
+    portals.push_back(left[0]);  portals.push_back(left[1]);
+    portals.push_back(right[0]); portals.push_back(right[1]);
+  }
+  portals.push_back(goal[0]); portals.push_back(goal[1]);
+  portals.push_back(goal[0]); portals.push_back(goal[1]);
+
+  stringPull(portals, path);
+  return true;
+}
+
+
+void NavMesh::stringPull(const std::vector<float> &portals, std::vector<RegionPoint> &path) const {
+  // the funnel: the apex is the last corner of the path, the two sides the tightest portal ends
+  // seen since; when a side would cross the other, that other side's end becomes a corner
+  const int count = (int)portals.size() / 4;
+  const float *apex  = &portals[0];
+  const float *left  = &portals[0];
+  const float *right = &portals[2];
+  int apexIndex = 0, leftIndex = 0, rightIndex = 0;
+  path.push_back(RegionPoint(apex[0], apex[1]));
+
+  for (int i = 1; i < count; i++) {
+    const float *newLeft  = &portals[4 * i];
+    const float *newRight = &portals[4 * i + 2];
+
+    // tighten the right side
+    if (triArea2(apex, right, newRight) <= 0.0f) {
+      if (samePoint(apex, right) || triArea2(apex, left, newRight) > 0.0f) {
+        right = newRight;
+        rightIndex = i;
+      } else {
+        // the right side crossed the left one: the left end is a corner, restart from there
+        apex = left;
+        apexIndex = leftIndex;
+        path.push_back(RegionPoint(apex[0], apex[1]));
+        left = right = apex;
+        leftIndex = rightIndex = apexIndex;
+        i = apexIndex;
+        continue;
+      }
+    }
+
+    // tighten the left side
+    if (triArea2(apex, left, newLeft) >= 0.0f) {
+      if (samePoint(apex, left) || triArea2(apex, right, newLeft) < 0.0f) {
+        left = newLeft;
+        leftIndex = i;
+      } else {
+        apex = right;
+        apexIndex = rightIndex;
+        path.push_back(RegionPoint(apex[0], apex[1]));
+        left = right = apex;
+        leftIndex = rightIndex = apexIndex;
+        i = apexIndex;
+        continue;
+      }
+    }
+  }
+
+  const float *goal = &portals[4 * (count - 1)];
+  if (!samePoint(path.back().get(), goal))
+    path.push_back(RegionPoint(goal[0], goal[1]));
+}
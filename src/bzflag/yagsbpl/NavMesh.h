@@ -0,0 +1,103 @@
+/* NavMesh.h
+ *
+ * A navigation mesh over the convex free-space regions that makeObstacleList() cuts the level into.
+ *
+ * makeObstacleList() splits the play area around every box, pyramid, teleporter, mesh and base
+ * (each grown by the tank radius), so every BzfRegion is a convex polygon that a tank can drive
+ * anywhere inside of, and two neighbouring regions share a whole edge: a portal.  A query runs
+ * A* over the regions (a few hundred, instead of the tens of thousands of cells of the
+ * OccupancyGrid), then pulls the path tight through the portals it crosses with the funnel
+ * algorithm.  The result only has a point where the path bends around a corner.
+ *
+ * The regions are copied when the mesh is built, so the mesh stays valid after the obstacle list
+ * is freed.  Portal ends are pulled in by a margin, so that tanks do not scrape the corners.
+ *
+ * See: M. Mononen, "Simple Stupid Funnel Algorithm", 2010.
+ */
+
+#ifndef NAVMESH_H_
+#define NAVMESH_H_
+
+#include "common.h"
+
+/* system interface headers */
+#include <vector>
+
+/* common interface headers */
+#include "Singleton.h"
+
+/* local interface headers */
+#include "Region.h"
+
+#define NAVMESH (NavMesh::instance())
+
+
+class NavMesh : public Singleton<NavMesh> {
+public:
+  /* Builds the mesh from a region decomposition.
+   * @param regions The regions, with their neighbours set along shared edges.
+   * @param margin How far to keep paths from the ends of every portal.
+   */
+  void build(const std::vector<BzfRegion*> &regions, float margin);
+
+  /* Throws away the mesh.
+   */
+  void clear();
+
+  bool isBuilt() const { return !polygons.empty(); }
+
+  /* Finds a path between two points.  Points outside every region (inside a grown obstacle) are
+   * moved to the nearest point of the nearest region first.
+   * @param start The point to start from.
+   * @param goal The point to go to.
+   * @param path Writes the path here, from start to goal (inclusive).  Cleared if there is none.
+   * @return True if a path was found, false otherwise.
+   */
+  bool plan(const float start[2], const float goal[2], std::vector<RegionPoint> &path);
+
+  int getPolygonCount() const { return (int)polygons.size(); }
+  int getPortalCount() const { return portalCount; }
+
+  /* The number of polygons expanded by the last call to plan().
+   */
+  int getExpandCount() const { return expandCount; }
+
+protected:
+  friend class Singleton<NavMesh>;
+
+private:
+  NavMesh();
+  ~NavMesh();
+
+  struct Polygon {
+    std::vector<RegionPoint> corners;
+    // the polygon across edge i (from corner i to corner i+1), -1 for a wall
+    std::vector<int> neighbors;
+    float center[2];
+  };
+
+  // per-polygon search state, reset by bumping the search id
+  struct SearchNode {
+    int searchId;
+    bool closed;
+    float g;
+    float point[2];  // where the path enters the polygon
+    int parent;
+    int parentEdge;  // the edge of the parent polygon that leads here
+  };
+
+  int findPolygon(const float p[2], float nearest[2]) const;
+  bool isInside(const Polygon &polygon, const float p[2]) const;
+  void getPortal(int polygon, int edge, float left[2], float right[2]) const;
+  void stringPull(const std::vector<float> &portals, std::vector<RegionPoint> &path) const;
+
+  std::vector<Polygon> polygons;
+  std::vector<SearchNode> nodes;
+  int searchId;
+  int portalCount;
+  int expandCount;
+  float margin;
+};
+
+
+#endif /* NAVMESH_H_ */
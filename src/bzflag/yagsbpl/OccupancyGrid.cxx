@@ -0,0 +1,209 @@
+/* OccupancyGrid.cxx
+ *
+ * See OccupancyGrid.h
+ */
+
+// interface header
+#include "OccupancyGrid.h"
+
+// common implementation headers
+#include "BZDBCache.h"
+
+// local implementation headers
+#include "World.h"
+#include "GraphFunctionContainerUnified.h"
+
+// initialize the singleton
+template <>
+OccupancyGrid* Singleton<OccupancyGrid>::_instance = (OccupancyGrid*)0;
+
+
+OccupancyGrid::OccupancyGrid() :
+  minCoord(0), maxCoord(-1), size(0), wordsPerRow(0), built(false), version(0) {
+}
+
+
+OccupancyGrid::OccupancyGrid(const OccupancyGrid &other) : Singleton<OccupancyGrid>(),
+  minCoord(other.minCoord), maxCoord(other.maxCoord), size(other.size),
+  wordsPerRow(other.wordsPerRow), cells(other.cells), columns(other.columns), built(other.built),
+  version(other.version) {
+}
+
+
+OccupancyGrid::~OccupancyGrid() {
+}
+
+
+OccupancyGrid *OccupancyGrid::snapshot() const {
+  return new OccupancyGrid(*this);
+}
+
+
+void OccupancyGrid::clear() {
+  cells.clear();
+  columns.clear();
+  minCoord = 0;
+  maxCoord = -1;
+  size = 0;
+  wordsPerRow = 0;
+  built = false;
+}
+
+
+void OccupancyGrid::build() {
+  World *world = World::getWorld();
+  if (!world) {
+    clear();
+    return;
+  }
+
+  // same bounds that MyNode::isAccessible() used to check
+  const int halfWorldSize = (int)(0.5f * BZDBCache::worldSize);
+  minCoord = convertToGraphCoord((float)(-halfWorldSize));
+  maxCoord = convertToGraphCoord((float)halfWorldSize);
+  size = (unsigned int)(maxCoord - minCoord + 1);
+  wordsPerRow = (size + 63) / 64;
+
+  // start with every cell open, then mark the blocked ones
+  cells.assign(size * wordsPerRow, 0);
+
+  float gamePos[3] = {0.0f, 0.0f, 0.0f};
+  for (unsigned int row = 0; row < size; row++) {
+    uint64_t *rowCells = &cells[row * wordsPerRow];
+    gamePos[1] = convertToGameCoord(minCoord + (int)row);
+    for (unsigned int col = 0; col < size; col++) {
+      gamePos[0] = convertToGameCoord(minCoord + (int)col);
+      if (world->inBuilding(gamePos, ACCESSIBILITY_THRESHOLD, BZDBCache::tankHeight))
+        rowCells[col >> 6] |= ((uint64_t)1) << (col & 63);
+    }
+    // the padding bits at the end of the row are outside the level
+    for (unsigned int col = size; col < wordsPerRow * 64; col++)
+      rowCells[col >> 6] |= ((uint64_t)1) << (col & 63);
+  }
+
+  // the same raster turned on its side, so that steep lines can be checked 64 cells at a time too
+  columns.assign(size * wordsPerRow, 0);
+  for (unsigned int col = 0; col < size; col++) {
+    uint64_t *colCells = &columns[col * wordsPerRow];
+    for (unsigned int row = 0; row < wordsPerRow * 64; row++)
+      if (row >= size || ((cells[row * wordsPerRow + (col >> 6)] >> (col & 63)) & 1))
+        colCells[row >> 6] |= ((uint64_t)1) << (row & 63);
+  }
+
+  built = true;
+  version++;
+}
+
+
+/* Checks the cells first..last (inclusive, as offsets from the start of the line) of a line of
+ * the raster: mask off the cells outside the run in the end words, and OR the rest together.
+ */
+static inline bool isRunOpen(const uint64_t *words, unsigned int first, unsigned int last) {
+  const unsigned int firstWord = first >> 6;
+  const unsigned int lastWord = last >> 6;
+  const uint64_t firstMask = ~((uint64_t)0) << (first & 63);
+  const uint64_t lastMask = ~((uint64_t)0) >> (63 - (last & 63));
+  if (firstWord == lastWord)
+    return (words[firstWord] & firstMask & lastMask) == 0;
+  uint64_t blocked = (words[firstWord] & firstMask) | (words[lastWord] & lastMask);
+  for (unsigned int w = firstWord + 1; w < lastWord; w++)
+    blocked |= words[w];
+  return blocked == 0;
+}
+
+
+bool OccupancyGrid::isShallowLineOpen(const std::vector<uint64_t> &raster,
+                                      int u0, int v0, int u1, int v1) const {
+  // u is the longer axis, along the lines of the raster; v picks the line.  The cells Bresenham
+  // visits on one line are a contiguous run, so check a run at a time.  From error e, the step
+  // that moves to the next line is the first one that takes the error below 0, step e/dv + 1;
+  // after the first line the error is in [du-dv, du), so that is either du/dv or du/dv + 1.
+  const int du = abs(u1 - u0);
+  const int dv = abs(v1 - v0);
+  const int su = (u1 > u0) ? 1 : -1;
+  const int lineStep = (v1 > v0) ? (int)wordsPerRow : -(int)wordsPerRow;
+  const uint64_t *line = &raster[(unsigned int)(v0 - minCoord) * wordsPerRow];
+  // offsets from the start of the line
+  int u = u0 - minCoord;
+  const int uEnd = u1 - minCoord;
+  int runStart = u + su;  // the start cell itself is not checked
+  int remaining = du;
+
+  if (dv == 0)
+    return isRunOpen(line, su > 0 ? runStart : uEnd, su > 0 ? uEnd : runStart);
+
+  const int stepsPerLine = du / dv;
+  int error = du / 2;
+  int steps = error / dv + 1;
+  while (steps <= remaining) {
+    // steps-1 more cells on this line, then one on the next
+    const int runEnd = u + (steps - 1) * su;
+    if ((runEnd - runStart) * su >= 0 &&
+        !isRunOpen(line, su > 0 ? runStart : runEnd, su > 0 ? runEnd : runStart))
+      return false;
+    u += steps * su;
+    line += lineStep;
+    error += du - steps * dv;
+    remaining -= steps;
+    runStart = u;
+    steps = (error < stepsPerLine * dv) ? stepsPerLine : stepsPerLine + 1;
+  }
+  // the rest of the line is on this row
+  if (remaining == 0)
+    return isRunOpen(line, u, u);
+  return isRunOpen(line, su > 0 ? runStart : uEnd, su > 0 ? uEnd : runStart);
+}
+
+
+bool OccupancyGrid::isLineOpen(int x0, int y0, int x1, int y1) const {
+  if (x0 == x1 && y0 == y1)
+    return true;
+  // the line ends at (x1, y1), and the runs it covers stay inside the box of the two ends
+  if (!isAccessible(x1, y1))
+    return false;
+  const unsigned int col = (unsigned int)(x0 - minCoord);
+  const unsigned int row = (unsigned int)(y0 - minCoord);
+  if (col >= size || row >= size)
+    return isLineOpenByCell(x0, y0, x1, y1);
+
+  if (abs(x1 - x0) >= abs(y1 - y0))
+    return isShallowLineOpen(cells, x0, y0, x1, y1);
+  else
+    return isShallowLineOpen(columns, y0, x0, y1, x1);
+}
+
+
+bool OccupancyGrid::isLineOpenByCell(int x0, int y0, int x1, int y1) const {
+  const int dx = abs(x1 - x0);
+  const int dy = abs(y1 - y0);
+  const int sx = (x1 > x0) ? 1 : -1;
+  const int sy = (y1 > y0) ? 1 : -1;
+
+  // step along the longer axis, and along the shorter one whenever the error builds up
+  if (dx >= dy) {
+    int error = dx / 2;
+    for (int i = 0; i < dx; i++) {
+      x0 += sx;
+      error -= dy;
+      if (error < 0) {
+        y0 += sy;
+        error += dx;
+      }
+      if (!isAccessible(x0, y0))
+        return false;
+    }
+  } else {
+    int error = dy / 2;
+    for (int i = 0; i < dy; i++) {
+      y0 += sy;
+      error -= dx;
+      if (error < 0) {
+        x0 += sx;
+        error += dy;
+      }
+      if (!isAccessible(x0, y0))
+        return false;
+    }
+  }
+  return true;
+}
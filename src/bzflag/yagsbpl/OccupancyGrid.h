@@ -0,0 +1,127 @@
+/* OccupancyGrid.h
+ *
+ * A bit-packed raster of the game level at the resolution of the A* tile graph.
+ *
+ * The world is rasterized once when the robots join, and again whenever the collision
+ * manager is reloaded.  Each cell stores whether a tank centered on that node would be
+ * inside a building (same ACCESSIBILITY_THRESHOLD test that MyNode::isAccessible() used
+ * to do on the fly), so the graph can answer accessibility queries with a bit test
+ * instead of a World::inBuilding() call per neighbour.
+ *
+ * Cells are stored row by row (one row per graph y-coordinate), 64 cells per word.
+ * A set bit means the cell is blocked.  Anything outside the grid is blocked.  A second copy
+ * is stored column by column, so that line-of-sight checks can test 64 cells at a time in
+ * either direction.
+ */
+
+#ifndef OCCUPANCYGRID_H_
+#define OCCUPANCYGRID_H_
+
+#include "common.h"
+
+/* system interface headers */
+#include <vector>
+
+/* common interface headers */
+#include "Singleton.h"
+
+#define OCCUPANCYGRID (OccupancyGrid::instance())
+
+
+class OccupancyGrid : public Singleton<OccupancyGrid> {
+public:
+  /* Rasterizes the current world.  Does nothing if there is no world yet.
+   */
+  void build();
+
+  /* Throws away the raster.  The next call to build() starts from scratch.
+   */
+  void clear();
+
+  /* Indicates whether or not the raster reflects the current world.
+   */
+  bool isBuilt() const { return built; }
+
+  /* Incremented every time the raster is rebuilt.  Anything derived from the raster
+   * (cached paths, distance fields, ...) can compare against this to know when it is stale.
+   */
+  unsigned int getVersion() const { return version; }
+
+  /* The bounds of the raster, in graph coordinates (inclusive).
+   */
+  int getMinCoord() const { return minCoord; }
+  int getMaxCoord() const { return maxCoord; }
+
+  /* Checks whether or not a node is accessible.
+   * @param x A node's x-coordinate in graph coordinates.
+   * @param y A node's y-coordinate in graph coordinates.
+   * @return True if the node is inside the level and not blocked, false otherwise.
+   */
+  inline bool isAccessible(int x, int y) const {
+    // negative offsets wrap around to huge unsigned values, so one compare covers both bounds
+    const unsigned int col = (unsigned int)(x - minCoord);
+    const unsigned int row = (unsigned int)(y - minCoord);
+    if (col >= size || row >= size)
+      return false;
+    return ((cells[row * wordsPerRow + (col >> 6)] >> (col & 63)) & 1) == 0;
+  }
+
+  /* Checks whether or not a tank can drive in a straight line between two nodes.  Covers the
+   * same cells as Bresenham (one cell per step along the longer axis), but tests the cells the
+   * line covers on each row (or column, for steep lines) with a few word masks.
+   * @param x0 The x-coordinate of the node to start from, in graph coordinates.
+   * @param y0 The y-coordinate of the node to start from.  The start node itself is not checked.
+   * @param x1 The x-coordinate of the node to go to, in graph coordinates.
+   * @param y1 The y-coordinate of the node to go to.
+   * @return True if every cell on the line is accessible, false otherwise.
+   */
+  bool isLineOpen(int x0, int y0, int x1, int y1) const;
+
+  /* Raw access to the raster, for code that works on 64 cells at a time.
+   * Bit (x - getMinCoord()) of a row is set if that cell is blocked.
+   * @param y A row's y-coordinate in graph coordinates, between getMinCoord() and getMaxCoord().
+   * @return The getWordsPerRow() words of the row.
+   */
+  inline const uint64_t *getRow(int y) const { return &cells[(unsigned int)(y - minCoord) * wordsPerRow]; }
+  unsigned int getWordsPerRow() const { return wordsPerRow; }
+
+  /* Copies the raster, for planners running on other threads: the copy never changes, while
+   * this one is rebuilt on the main thread whenever the world changes.  The copy has the same
+   * version as this one.  The caller owns the copy, and must not call build() or clear() on it.
+   */
+  OccupancyGrid *snapshot() const;
+
+  ~OccupancyGrid();
+
+protected:
+  friend class Singleton<OccupancyGrid>;
+
+private:
+  OccupancyGrid();
+  OccupancyGrid(const OccupancyGrid &other);
+  OccupancyGrid& operator=(const OccupancyGrid&);
+
+  /* isLineOpen() for a line at most 45 degrees off the lines of the raster, one run per line.
+   * u is the coordinate along the lines, v picks the line.
+   */
+  bool isShallowLineOpen(const std::vector<uint64_t> &raster, int u0, int v0, int u1, int v1) const;
+
+  /* isLineOpen() one cell at a time, for lines that start outside the level.
+   */
+  bool isLineOpenByCell(int x0, int y0, int x1, int y1) const;
+
+  // the bounds of the raster, in graph coordinates
+  int minCoord, maxCoord;
+  // number of cells along each side, and number of 64-bit words per row
+  unsigned int size, wordsPerRow;
+  // one bit per cell, set if blocked
+  std::vector<uint64_t> cells;
+  // the same bits by column: bit (y - minCoord) of column x
+  std::vector<uint64_t> columns;
+
+  bool built;
+  unsigned int version;
+};
+
+
+#endif /* OCCUPANCYGRID_H_ */
@@ -0,0 +1,152 @@
+/* PathCache.cxx
+ *
+ * See PathCache.h
+ */
+
+// interface header
+#include "PathCache.h"
+
+/* system implementation headers */
+#include <algorithm>
+
+// common implementation headers
+#include "StateDatabase.h"
+
+// initialize the singleton
+template <>
+PathCache* Singleton<PathCache>::_instance = (PathCache*)0;
+
+
+PathCache::PathCache() :
+  quantum(4), minCoord(0), gridVersion(0) {
+  resetStats();
+}
+
+
+PathCache::~PathCache() {
+}
+
+
+void PathCache::resetStats() {
+  lookups = 0;
+  hits = 0;
+  reversedHits = 0;
+  subPathHits = 0;
+  savedExpansions = 0;
+}
+
+
+void PathCache::clear() {
+  entries.clear();
+}
+
+
+void PathCache::checkVersion() {
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+  if (grid.getVersion() != gridVersion) {
+    entries.clear();
+    gridVersion = grid.getVersion();
+    minCoord = grid.getMinCoord();
+  }
+}
+
+
+int PathCache::getBucket(const MyNode &node) const {
+  // offset by the grid bounds so that the division rounds the same way everywhere
+  return ((node.x - minCoord) / quantum) * 65536 + (node.y - minCoord) / quantum;
+}
+
+
+int PathCache::findInBucket(const Entry &entry, int bucket, int index) {
+  // the nodes of a bucket are in path order: the first one after the index, or the one before
+  typedef std::vector< std::pair<int,int> >::const_iterator Iterator;
+  const Iterator begin =
+    std::lower_bound(entry.buckets.begin(), entry.buckets.end(), std::make_pair(bucket, -1));
+  const Iterator after = std::upper_bound(begin, entry.buckets.end(), std::make_pair(bucket, index));
+  int nearest = -1;
+  if (after != entry.buckets.end() && after->first == bucket)
+    nearest = after->second;
+  if (after != begin) {
+    const int before = (after - 1)->second;
+    if (nearest < 0 || index - before <= nearest - index)
+      nearest = before;
+  }
+  return nearest;
+}
+
+
+bool PathCache::find(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path) {
+  checkVersion();
+  lookups++;
+
+  const OccupancyGrid &grid = OCCUPANCYGRID;
+  const int startBucket = getBucket(start);
+  const int goalBucket  = getBucket(goal);
+  if (startBucket == goalBucket)
+    return false;
+
+  for (std::list<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+    const Entry &entry = *it;
+    // a path can go through a bucket more than once: take the part between the nearest
+    // passes, so that it does not go on past the start or the goal and come back
+    int last = findInBucket(entry, goalBucket, 0);
+    if (last < 0)
+      continue;
+    const int first = findInBucket(entry, startBucket, last);
+    if (first < 0)
+      continue;
+    last = findInBucket(entry, goalBucket, first);
+
+    // start -> path[first] ... path[last] -> goal
+    path.clear();
+    path.push_back(start);
+    if (!walkStraight(grid, start, entry.path[first], path))
+      continue;
+    const int step = (first < last) ? 1 : -1;
+    for (int i = first + step; i != last + step; i += step)
+      path.push_back(entry.path[i]);
+    if (!walkStraight(grid, entry.path[last], goal, path))
+      continue;
+
+    hits++;
+    if (step < 0)
+      reversedHits++;
+    const int length = (int)entry.path.size() - 1;
+    const int used = abs(last - first);
+    if (used < length)
+      subPathHits++;
+    savedExpansions += (long)entry.expandCount * used / length;
+
+    // most recently used first
+    entries.splice(entries.begin(), entries, it);
+    return true;
+  }
+
+  path.clear();
+  return false;
+}
+
+
+void PathCache::add(const std::vector<MyNode> &path, bool dense, int expandCount) {
+  checkVersion();
+  const int capacity = BZDB.isSet("robotPathCacheSize") ? BZDB.evalInt("robotPathCacheSize") : 64;
+  if (capacity <= 0 || path.size() < 2)
+    return;
+
+  entries.push_front(Entry());
+  Entry &entry = entries.front();
+  entry.path = path;
+  entry.expandCount = expandCount;
+  const int last = (int)path.size() - 1;
+  for (int i = 0; i <= last; i++) {
+    // only the ends of a list of waypoints are on the path for sure
+    if (dense || i == 0 || i == last)
+      entry.buckets.push_back(std::make_pair(getBucket(path[i]), i));
+  }
+  std::sort(entry.buckets.begin(), entry.buckets.end());
+
+  while ((int)entries.size() > capacity)
+    entries.pop_back();
+}
@@ -0,0 +1,103 @@
+/* PathCache.h
+ *
+ * Paths recently found by any of the local robots, shared by all of them.
+ *
+ * Robots on the same team keep asking for paths between the same places (base to enemy flag and
+ * back, around the same buildings), and the per-role guardPath/capturePath only remember one path
+ * per role.  The cache keeps the most recently used paths (robotPathCacheSize, 64 by default) and
+ * answers a query with a path it already has when the query's start and goal both fall in cells
+ * of the same coarse bucket (quantum x quantum nodes) as nodes of that path:
+ *  - the whole path, if they match its two ends;
+ *  - the path backwards, if they match its ends the other way around;
+ *  - the part of the path in between, for cell-by-cell paths (a piece of a shortest path is a
+ *    shortest path too).
+ * The start and goal are joined to the cached path with straight lines, which must be open.
+ * Paths are not always shortest, but are at most a couple of buckets longer.
+ *
+ * Everything is thrown away when the OccupancyGrid version changes.  Main thread only.
+ */
+
+#ifndef PATHCACHE_H_
+#define PATHCACHE_H_
+
+#include "common.h"
+
+/* system interface headers */
+#include <list>
+#include <utility>
+#include <vector>
+
+/* common interface headers */
+#include "Singleton.h"
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+
+#define PATHCACHE (PathCache::instance())
+
+
+class PathCache : public Singleton<PathCache> {
+public:
+  /* Looks for a cached path between the given nodes.
+   * @param start The node the path must start from.
+   * @param goal The node the path must go to.
+   * @param path Writes the path here, from start to goal (inclusive), if one was found.
+   * @return True if the cache had a path, false otherwise.
+   */
+  bool find(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* Remembers a path, as the most recently used one.
+   * @param path The path, from start to goal.
+   * @param dense True if the path has a node for every cell (A*), false if it is a list of
+   *              waypoints (HPA*).  Only the ends of a list of waypoints can be matched.
+   * @param expandCount The number of nodes the search that found the path expanded.
+   */
+  void add(const std::vector<MyNode> &path, bool dense, int expandCount);
+
+  /* Throws away every path.
+   */
+  void clear();
+
+  int getEntryCount() const { return (int)entries.size(); }
+  long getLookupCount() const { return lookups; }
+  long getHitCount() const { return hits; }
+  long getReversedHitCount() const { return reversedHits; }
+  long getSubPathHitCount() const { return subPathHits; }
+
+  /* The expansions that the searches answered from the cache would have cost, estimated from the
+   * searches that found the cached paths.
+   */
+  long getSavedExpansions() const { return savedExpansions; }
+
+  void resetStats();
+
+protected:
+  friend class Singleton<PathCache>;
+
+private:
+  PathCache();
+  ~PathCache();
+
+  struct Entry {
+    std::vector<MyNode> path;
+    int expandCount;
+    // (bucket, index in path) of the nodes that can be matched, sorted
+    std::vector< std::pair<int,int> > buckets;
+  };
+
+  int getBucket(const MyNode &node) const;
+  // the node of the path in the given bucket nearest to the given index, -1 if there is none
+  static int findInBucket(const Entry &entry, int bucket, int index);
+  void checkVersion();
+
+  std::list<Entry> entries;  // most recently used first
+  int quantum;
+  int minCoord;
+  unsigned int gridVersion;
+
+  long lookups, hits, reversedHits, subPathHits;
+  long savedExpansions;
+};
+
+
+#endif /* PATHCACHE_H_ */
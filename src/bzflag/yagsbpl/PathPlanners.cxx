@@ -0,0 +1,68 @@
+/* PathPlanners.cxx
+ *
+ * See PathPlanners.h
+ */
+
+// interface header
+#include "PathPlanners.h"
+
+// system implementation headers
+#include <string>
+
+// common implementation headers
+#include "StateDatabase.h"
+
+
+PathPlannerKind getPathPlannerKind() {
+  if (!BZDB.isSet("robotPathPlanner"))
+    return ThetaPlanner;
+  const std::string planner = BZDB.get("robotPathPlanner");
+  if (planner == "theta")
+    return ThetaPlanner;
+  if (planner == "astar")
+    return GraphPlanner;
+  if (planner == "bidir")
+    return BidirectionalPlanner;
+  if (planner == "jps")
+    return JpsPlanner;
+  if (planner == "navmesh")
+    return NavMeshPlanner;
+  if (planner == "anytime")
+    return AnytimePlanner;
+  return GridPlanner;
+}
+
+
+bool PathPlanners::plan(PathPlannerKind kind, const OccupancyGrid &occupancy, const MyNode &start,
+                        const MyNode &goal, std::vector<MyNode> &path, SearchCounters &counters) {
+  // only the yagsbpl A* counts more than its expansions, and times itself
+  if (kind == GraphPlanner) {
+    const bool found = graph.plan(occupancy, start, goal, path);
+    counters = graph.getCounters();
+    return found;
+  }
+
+  counters.reset();
+  const double startTime = yagsbpl_wall_clock();
+  bool found;
+  switch (kind) {
+    case ThetaPlanner:
+      found = theta.plan(occupancy, start, goal, path);
+      counters.expanded = theta.getExpandCount();
+      break;
+    case BidirectionalPlanner:
+      found = bidirectional.plan(occupancy, start, goal, path);
+      counters.expanded = bidirectional.getExpandCount();
+      break;
+    case JpsPlanner:
+      found = jps.plan(occupancy, start, goal, path);
+      counters.expanded = jps.getExpandCount();
+      break;
+    default:
+      found = grid.plan(occupancy, start, goal, path);
+      counters.expanded = grid.getExpandCount();
+      break;
+  }
+  counters.planSeconds = yagsbpl_wall_clock() - startTime;
+  return found;
+}
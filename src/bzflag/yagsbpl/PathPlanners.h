@@ -0,0 +1,76 @@
+/* PathPlanners.h
+ *
+ * The grid planners a robot path search can be made with, and the one robotPathPlanner picks.
+ *
+ * RobotPlayer::findPath(), each PathPlanningService worker and the planner comparison keep their
+ * own PathPlanners, and search with plan(): the planners are told apart in this one place.  The
+ * kind is looked up with getPathPlannerKind(), once per frame by the robots, and a search keeps
+ * the kind it was asked with.
+ */
+
+#ifndef PATHPLANNERS_H_
+#define PATHPLANNERS_H_
+
+#include "common.h"
+
+/* system interface headers */
+#include <vector>
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+#include "GridAStar.h"
+#include "GraphAStar.h"
+#include "BidirectionalAStar.h"
+#include "JumpPointSearch.h"
+#include "ThetaStar.h"
+
+
+enum PathPlannerKind {
+  ThetaPlanner,          // "theta": Lazy Theta*, any-angle paths (the default)
+  GridPlanner,           // "grid": grid A*
+  GraphPlanner,          // "astar": YAGSBPL A*
+  BidirectionalPlanner,  // "bidir": bidirectional A*
+  JpsPlanner,            // "jps": Jump Point Search
+  NavMeshPlanner,        // "navmesh": the NavMesh where it answers, grid A* otherwise
+  AnytimePlanner         // "anytime": ARA* for the tank's own detours, grid A* otherwise
+};
+
+
+/* The planner picked with the BZDB variable robotPathPlanner: ThetaPlanner if it is not set,
+ * GridPlanner if it is not known.  Reads BZDB: main thread only.
+ */
+PathPlannerKind getPathPlannerKind();
+
+
+/* Whether the planner's paths only have a node where they turn, and must not be smoothed.
+ */
+inline bool isAnyAnglePlanner(PathPlannerKind kind) { return kind == ThetaPlanner; }
+
+
+class PathPlanners {
+public:
+  /* Finds a path with the planner of the given kind; the kinds without a grid planner of their
+   * own (navmesh, anytime) use grid A*.
+   * @param kind The planner.
+   * @param grid The raster to search, already built.
+   * @param start The node from which to start the search.
+   * @param goal The search will try to find a path to this node.
+   * @param path Writes the path here, from start to goal (inclusive).  Only the turning points
+   *             for the any-angle planners, every cell for the others.
+   * @param counters Writes the counters of the search here.  Only the "astar" planner fills them
+   *                 all; the others set the expansions and the time.
+   * @return True if a path was found, false otherwise.
+   */
+  bool plan(PathPlannerKind kind, const OccupancyGrid &grid, const MyNode &start, const MyNode &goal,
+            std::vector<MyNode> &path, SearchCounters &counters);
+
+  // each keeps its nodes between searches
+  GridAStarPlanner grid;
+  GraphAStarPlanner graph;
+  BidirectionalAStarPlanner bidirectional;
+  JumpPointSearchPlanner jps;
+  ThetaStarPlanner theta;
+};
+
+
+#endif /* PATHPLANNERS_H_ */
@@ -0,0 +1,297 @@
+/* PathPlanningService.cxx
+ *
+ * See PathPlanningService.h
+ */
+
+// interface header
+#include "PathPlanningService.h"
+
+// common implementation headers
+#include "StateDatabase.h"
+
+// initialize the singleton
+template <>
+PathPlanningService* Singleton<PathPlanningService>::_instance = (PathPlanningService*)0;
+
+// more workers than this would only fight over the same few robots' requests
+static const int maxWorkers = 8;
+
+
+PathPlanningService::PathPlanningService() :
+  snapshot(NULL), nextTicket(1), stopping(false), inlineWorker(NULL) {
+#if defined(HAVE_PTHREADS)
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&wakeUp, NULL);
+#elif defined(_WIN32)
+  InitializeCriticalSection(&mutex);
+  wakeUp = CreateSemaphore(NULL, 0, 0x7fffffff, NULL);
+#endif
+}
+
+
+PathPlanningService::~PathPlanningService() {
+  stop();
+  delete inlineWorker;
+#if defined(HAVE_PTHREADS)
+  pthread_cond_destroy(&wakeUp);
+  pthread_mutex_destroy(&mutex);
+#elif defined(_WIN32)
+  CloseHandle(wakeUp);
+  DeleteCriticalSection(&mutex);
+#endif
+}
+
+
+void PathPlanningService::lock() {
+#if defined(HAVE_PTHREADS)
+  pthread_mutex_lock(&mutex);
+#elif defined(_WIN32)
+  EnterCriticalSection(&mutex);
+#endif
+}
+
+
+void PathPlanningService::unlock() {
+#if defined(HAVE_PTHREADS)
+  pthread_mutex_unlock(&mutex);
+#elif defined(_WIN32)
+  LeaveCriticalSection(&mutex);
+#endif
+}
+
+
+void PathPlanningService::startWorkers() {
+  int count = BZDB.isSet("robotPlanningThreads") ? BZDB.evalInt("robotPlanningThreads") : 2;
+  if (count > maxWorkers)
+    count = maxWorkers;
+
+#if defined(HAVE_PTHREADS) || defined(_WIN32)
+  for (int i = 0; i < count; i++) {
+    Worker *worker = new Worker;
+    worker->service = this;
+#if defined(HAVE_PTHREADS)
+    const bool started = (pthread_create(&worker->thread, NULL, runWorker, worker) == 0);
+#else
+    worker->thread = CreateThread(NULL, 0, runWorker, worker, 0, NULL);
+    const bool started = (worker->thread != NULL);
+#endif
+    if (!started) {
+      // run with the workers we have, or on the main thread if there are none
+      delete worker;
+      break;
+    }
+    workers.push_back(worker);
+  }
+#endif
+}
+
+
+PathPlanningService::GridSnapshot *PathPlanningService::getSnapshot() {
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+
+  lock();
+  if (!snapshot || snapshot->grid->getVersion() != grid.getVersion()) {
+    // requests still using the old snapshot keep it alive until they are done
+    if (snapshot)
+      releaseSnapshot(snapshot);
+    snapshot = new GridSnapshot;
+    snapshot->grid = grid.snapshot();
+    snapshot->users = 1;  // the service's own reference, for the next requests
+  }
+  snapshot->users++;
+  GridSnapshot *current = snapshot;
+  unlock();
+  return current;
+}
+
+
+void PathPlanningService::releaseSnapshot(GridSnapshot *released) {
+  if (--released->users > 0)
+    return;
+  delete released->grid;
+  delete released;
+}
+
+
+unsigned int PathPlanningService::submit(const MyNode &start, const MyNode &goal, PathPlannerKind planner,
+                                         int priority) {
+  if (workers.empty())
+    startWorkers();
+
+  const unsigned int ticket = nextTicket++;
+  if (nextTicket == 0)
+    nextTicket = 1;
+
+  if (workers.empty()) {
+    // no threads: plan right now, on the shared grid
+    if (!inlineWorker)
+      inlineWorker = new Worker;
+    OccupancyGrid &grid = OCCUPANCYGRID;
+    if (!grid.isBuilt())
+      grid.build();
+    Result &result = results[ticket];
+    result.found = inlineWorker->planners.plan(planner, grid, start, goal, result.path, result.counters);
+    result.done = true;
+    return ticket;
+  }
+
+  Request request;
+  request.ticket = ticket;
+  request.start = start;
+  request.goal = goal;
+  request.priority = priority;
+  request.planner = planner;
+  request.snapshot = getSnapshot();
+
+  lock();
+  Result &result = results[ticket];
+  result.done = false;
+  result.found = false;
+  result.counters.reset();
+  queue.push_back(request);
+#if defined(HAVE_PTHREADS)
+  pthread_cond_signal(&wakeUp);
+#endif
+  unlock();
+#if !defined(HAVE_PTHREADS) && defined(_WIN32)
+  ReleaseSemaphore(wakeUp, 1, NULL);
+#endif
+  return ticket;
+}
+
+
+PathPlanningService::Status PathPlanningService::poll(unsigned int ticket, std::vector<MyNode> &path,
+                                                     SearchCounters *counters) {
+  lock();
+  std::map<unsigned int, Result>::iterator it = results.find(ticket);
+  Status status = Unknown;
+  if (it != results.end()) {
+    if (!it->second.done) {
+      status = Pending;
+    } else {
+      status = it->second.found ? Found : NotFound;
+      path.swap(it->second.path);
+      if (counters)
+        *counters = it->second.counters;
+      results.erase(it);
+    }
+  }
+  unlock();
+  return status;
+}
+
+
+void PathPlanningService::cancel(unsigned int ticket) {
+  if (!ticket)
+    return;
+  lock();
+  results.erase(ticket);
+  for (size_t i = 0; i < queue.size(); i++) {
+    if (queue[i].ticket == ticket) {
+      releaseSnapshot(queue[i].snapshot);
+      queue.erase(queue.begin() + i);
+      break;
+    }
+  }
+  unlock();
+}
+
+
+void PathPlanningService::stop() {
+  lock();
+  stopping = true;
+  for (size_t i = 0; i < queue.size(); i++)
+    releaseSnapshot(queue[i].snapshot);
+  queue.clear();
+  results.clear();
+#if defined(HAVE_PTHREADS)
+  pthread_cond_broadcast(&wakeUp);
+#endif
+  unlock();
+
+  // searches in progress finish, find their result gone, and the workers exit
+#if !defined(HAVE_PTHREADS) && defined(_WIN32)
+  if (!workers.empty())
+    ReleaseSemaphore(wakeUp, (LONG)workers.size(), NULL);
+#endif
+  for (size_t i = 0; i < workers.size(); i++) {
+#if defined(HAVE_PTHREADS)
+    pthread_join(workers[i]->thread, NULL);
+#elif defined(_WIN32)
+    WaitForSingleObject(workers[i]->thread, INFINITE);
+    CloseHandle(workers[i]->thread);
+#endif
+    delete workers[i];
+  }
+  workers.clear();
+
+  lock();
+  stopping = false;
+  if (snapshot)
+    releaseSnapshot(snapshot);
+  snapshot = NULL;
+  unlock();
+}
+
+
+#if defined(HAVE_PTHREADS)
+void *PathPlanningService::runWorker(void *worker) {
+  ((Worker*)worker)->service->work(*(Worker*)worker);
+  return NULL;
+}
+#elif defined(_WIN32)
+DWORD WINAPI PathPlanningService::runWorker(void *worker) {
+  ((Worker*)worker)->service->work(*(Worker*)worker);
+  return 0;
+}
+#endif
+
+
+void PathPlanningService::work(Worker &worker) {
+  std::vector<MyNode> path;
+  SearchCounters counters;
+  while (true) {
+#if !defined(HAVE_PTHREADS) && defined(_WIN32)
+    WaitForSingleObject(wakeUp, INFINITE);
+#endif
+    lock();
+#if defined(HAVE_PTHREADS)
+    while (!stopping && queue.empty())
+      pthread_cond_wait(&wakeUp, &mutex);
+#endif
+    if (stopping) {
+      unlock();
+      return;
+    }
+    if (queue.empty()) {
+      // the request this wake-up was for has been cancelled
+      unlock();
+      continue;
+    }
+
+    // highest priority first, oldest first among equals
+    size_t next = 0;
+    for (size_t i = 1; i < queue.size(); i++)
+      if (queue[i].priority > queue[next].priority)
+        next = i;
+    const Request request = queue[next];
+    queue.erase(queue.begin() + next);
+    unlock();
+
+    const bool found = worker.planners.plan(request.planner, *request.snapshot->grid, request.start,
+                                            request.goal, path, counters);
+
+    lock();
+    std::map<unsigned int, Result>::iterator it = results.find(request.ticket);
+    if (it != results.end()) {
+      it->second.done = true;
+      it->second.found = found;
+      it->second.counters = counters;
+      it->second.path.swap(path);
+    }
+    releaseSnapshot(request.snapshot);
+    unlock();
+  }
+}
@@ -0,0 +1,156 @@
+/* PathPlanningService.h
+ *
+ * Runs the robots' path searches on a small pool of worker threads.
+ *
+ * A robot submits a (start, goal, priority) request and gets a ticket back right away, then polls
+ * the ticket once per frame and keeps following its old path until the new one is ready.  So a
+ * long search no longer stalls the frame it was asked for in.
+ *
+ * The workers never touch the shared OccupancyGrid, which the main thread rebuilds whenever the
+ * world changes: every request carries a read-only OccupancyGrid::snapshot() of the grid it was
+ * submitted against.  Each worker owns its own planners, so no search state is shared either.
+ * Requests with a higher priority are planned first; equal priorities are planned in order.
+ *
+ * robotPlanningThreads sets the number of workers (2 by default).  With 0, or without thread
+ * support, submit() plans right away on the calling thread and the result is ready at once.
+ */
+
+#ifndef PATHPLANNINGSERVICE_H_
+#define PATHPLANNINGSERVICE_H_
+
+#include "common.h"
+
+/* system interface headers */
+#include <map>
+#include <vector>
+#if defined(HAVE_PTHREADS)
+#  include <pthread.h>
+#elif defined(_WIN32)
+#  include <windows.h>
+#endif
+
+/* common interface headers */
+#include "Singleton.h"
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+#include "PathPlanners.h"
+
+#define PATHPLANNINGSERVICE (PathPlanningService::instance())
+
+
+class PathPlanningService : public Singleton<PathPlanningService> {
+public:
+  enum Status {
+    Pending,   // still queued or being planned
+    Found,     // done, the path was written
+    NotFound,  // done, there is no path
+    Unknown    // no such ticket: never submitted, cancelled, or already collected
+  };
+
+  /* Queues a search on the current OccupancyGrid.  Must be called from the main thread.
+   * @param start The node from which to start the search.
+   * @param goal The search will try to find a path to this node.
+   * @param planner The planner to search with (see PathPlanners::plan()).
+   * @param priority Requests with a higher priority are planned first.
+   * @return The ticket to poll for the result.  Never 0.
+   */
+  unsigned int submit(const MyNode &start, const MyNode &goal, PathPlannerKind planner, int priority);
+
+  /* Checks on a request.  Once it returns Found or NotFound, the ticket is forgotten.
+   * @param ticket A ticket returned by submit().
+   * @param path Writes the path here, from start to goal (inclusive), if the status is Found.
+   *             Only the turning points for the any-angle planners, every cell for the others.
+   * @param counters If not NULL, writes the counters of the search here, once done.
+   * @return The status of the request.
+   */
+  Status poll(unsigned int ticket, std::vector<MyNode> &path, SearchCounters *counters = NULL);
+
+  /* Forgets a request.  Its result is thrown away if it is being planned right now.
+   * @param ticket A ticket returned by submit(), or 0.
+   */
+  void cancel(unsigned int ticket);
+
+  /* Throws away every request and stops the workers (they are started again by the next
+   * submit()).  Called when leaving the game.
+   */
+  void stop();
+
+  /* The number of worker threads running, 0 if searches run on the main thread.
+   */
+  int getWorkerCount() const { return (int)workers.size(); }
+
+protected:
+  friend class Singleton<PathPlanningService>;
+
+private:
+  PathPlanningService();
+  ~PathPlanningService();
+
+  // a read-only copy of the grid, deleted when the last request using it is done
+  struct GridSnapshot {
+    OccupancyGrid *grid;
+    int users;
+  };
+
+  struct Request {
+    unsigned int ticket;
+    MyNode start, goal;
+    int priority;
+    PathPlannerKind planner;
+    GridSnapshot *snapshot;
+  };
+
+  struct Result {
+    bool done;
+    bool found;
+    SearchCounters counters;
+    std::vector<MyNode> path;
+  };
+
+  // each worker has its own planners, so searches on different workers share nothing
+  struct Worker {
+    PathPlanningService *service;
+    PathPlanners planners;
+#if defined(HAVE_PTHREADS)
+    pthread_t thread;
+#elif defined(_WIN32)
+    HANDLE thread;
+#endif
+  };
+
+#if defined(HAVE_PTHREADS)
+  static void *runWorker(void *worker);
+#elif defined(_WIN32)
+  static DWORD WINAPI runWorker(void *worker);
+#endif
+  void work(Worker &worker);
+
+  void startWorkers();
+  GridSnapshot *getSnapshot();
+  void releaseSnapshot(GridSnapshot *snapshot);  // call with the lock held
+
+  void lock();
+  void unlock();
+
+  std::vector<Request> queue;
+  std::map<unsigned int, Result> results;
+  std::vector<Worker*> workers;
+  GridSnapshot *snapshot;  // snapshot of the current grid, for new requests
+  unsigned int nextTicket;
+  bool stopping;
+
+  // planners for the main thread, when there are no workers
+  Worker *inlineWorker;
+
+#if defined(HAVE_PTHREADS)
+  pthread_mutex_t mutex;
+  pthread_cond_t wakeUp;  // signalled when a request is queued, or when stopping
+#elif defined(_WIN32)
+  CRITICAL_SECTION mutex;
+  HANDLE wakeUp;          // semaphore, released once per queued request, and once per worker to stop
+#endif
+};
+
+
+#endif /* PATHPLANNINGSERVICE_H_ */
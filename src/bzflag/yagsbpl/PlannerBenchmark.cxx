@@ -0,0 +1,281 @@
+/* PlannerBenchmark.cxx
+ *
+ * See PlannerBenchmark.h
+ */
+
+#include "common.h"
+
+// interface header
+#include "PlannerBenchmark.h"
+
+// the robots' planning data only exists in robot builds
+#ifdef ROBOT
+
+// system implementation headers
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// common implementation headers
+#include "BZDBCache.h"
+#include "DirectoryNames.h"
+#include "StateDatabase.h"
+#include "TextUtils.h"
+#include "md5.h"
+
+// local implementation headers
+#include "World.h"
+#include "WorldBuilder.h"
+#include "OccupancyGrid.h"
+#include "NavMesh.h"
+#include "PlannerComparison.h"
+#include "robots.h"
+
+
+/* Reads a whole file.
+ * @return False if it cannot be read, or is empty.
+ */
+static bool readFile(const std::string &path, std::vector<char> &data) {
+  std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+  if (!in)
+    return false;
+  in.seekg(0, std::ios::end);
+  const std::streamoff size = in.tellg();
+  if (size <= 0)
+    return false;
+  in.seekg(0);
+  data.resize((size_t)size);
+  in.read(&data[0], size);
+  return !in.fail();
+}
+
+
+/* Whether the name is the hex digest of a world, as the server hands it out: 32 hex digits,
+ * after an optional 'p' (permanent) or 't' (temporary).
+ */
+static bool isHexDigest(const std::string &name) {
+  std::string digits = name;
+  if (digits.size() == 33 && (digits[0] == 'p' || digits[0] == 't'))
+    digits = digits.substr(1);
+  if (digits.size() != 32)
+    return false;
+  for (unsigned int i = 0; i < digits.size(); i++)
+    if (!isxdigit(digits[i]))
+      return false;
+  return true;
+}
+
+
+/* The size of the world a .bzw map describes: twice the "size" of its world block.
+ * @return The size, or a negative value if the map does not set it.
+ */
+static float readMapWorldSize(const std::string &map) {
+  std::ifstream in(map.c_str());
+  std::string line;
+  bool inWorld = false;
+  while (std::getline(in, line)) {
+    const std::string::size_type comment = line.find('#');
+    if (comment != std::string::npos)
+      line.erase(comment);
+    const std::vector<std::string> words = TextUtils::tokenize(TextUtils::tolower(line), " \t\r");
+    if (words.empty())
+      continue;
+    if (!inWorld)
+      inWorld = (words[0] == "world");
+    else if (words[0] == "end")
+      inWorld = false;
+    else if (words[0] == "size" && words.size() > 1)
+      return 2.0f * (float)atof(words[1].c_str());
+  }
+  return -1.0f;
+}
+
+
+/* Runs bzfs with the arguments, without a shell in between, and waits for it.
+ * @return False if it cannot be run, or does not exit with 0.
+ */
+static bool runBzfs(const char *const *args) {
+#ifdef _WIN32
+  // the arguments are joined into one command line: quote them, and refuse any quote inside
+  std::vector<std::string> quoted;
+  for (int i = 0; args[i]; i++) {
+    if (strchr(args[i], '"')) {
+      fprintf(stderr, "plannerbench: cannot pass %s to bzfs\n", args[i]);
+      return false;
+    }
+    quoted.push_back(std::string("\"") + args[i] + "\"");
+  }
+  std::vector<const char *> argv;
+  for (unsigned int i = 0; i < quoted.size(); i++)
+    argv.push_back(quoted[i].c_str());
+  argv.push_back(NULL);
+  return _spawnvp(_P_WAIT, "bzfs", &argv[0]) == 0;
+#else
+  fflush(stdout);
+  const pid_t pid = fork();
+  if (pid < 0)
+    return false;
+  if (pid == 0) {
+    execvp("bzfs", (char *const *)args);
+    _exit(127);
+  }
+  int status;
+  while (waitpid(pid, &status, 0) < 0)
+    if (errno != EINTR)
+      return false;
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+
+/* Turns a .bzw map into a world cache file with bzfs, which parses the maps.
+ * @param cachePath Gets the path of the cache file.
+ */
+static bool makeWorldCache(const std::string &map, std::string &cachePath) {
+  cachePath = getCacheDirName() + "plannerbench.bwc";
+  remove(cachePath.c_str());
+  const char *const args[] = { "bzfs", "-world", map.c_str(), "-cacheout", cachePath.c_str(), NULL };
+  if (!runBzfs(args))
+    return false;
+  std::ifstream cache(cachePath.c_str());
+  return cache.good();
+}
+
+
+/* Prints a time, in milliseconds.
+ */
+static std::string formatMilliseconds(double seconds) {
+  return TextUtils::format("%8.3f", 1000.0 * seconds);
+}
+
+
+int runPlannerBenchmark(int argc, char **argv) {
+  if (argc < 1 || argc > 4) {
+    fprintf(stderr, "usage: bzflag -plannerbench {<file.bwc> | <hexDigest> | <map.bzw>}"
+            " [queries] [seed] [worldSize]\n");
+    return 1;
+  }
+  const std::string worldName = argv[0];
+  const int queries = (argc > 1) ? atoi(argv[1]) : 1000;
+  const unsigned int seed = (argc > 2) ? (unsigned int)strtoul(argv[2], NULL, 10) : 1;
+  float worldSize = (argc > 3) ? (float)atof(argv[3]) : -1.0f;
+  if (queries <= 0) {
+    fprintf(stderr, "plannerbench: bad number of queries: %s\n", argv[1]);
+    return 1;
+  }
+
+  // find the world cache
+  std::vector<std::string> cachePaths;
+  std::string digest;
+  const std::string lowerName = TextUtils::tolower(worldName);
+  if (lowerName.size() > 4 && lowerName.substr(lowerName.size() - 4) == ".bzw") {
+    if (worldSize <= 0.0f)
+      worldSize = readMapWorldSize(worldName);
+    std::string cachePath;
+    if (!makeWorldCache(worldName, cachePath)) {
+      fprintf(stderr, "plannerbench: bzfs could not make a world cache of %s\n", worldName.c_str());
+      return 1;
+    }
+    cachePaths.push_back(cachePath);
+  } else if (isHexDigest(worldName)) {
+    // the client names its cache files after the digest, prefix included
+    if (worldName.size() == 33) {
+      digest = worldName.substr(1);
+      cachePaths.push_back(getCacheDirName() + worldName + ".bwc");
+    } else {
+      digest = worldName;
+      cachePaths.push_back(getCacheDirName() + "p" + worldName + ".bwc");
+      cachePaths.push_back(getCacheDirName() + "t" + worldName + ".bwc");
+    }
+  } else {
+    cachePaths.push_back(worldName);
+  }
+
+  std::vector<char> worldData;
+  unsigned int found = 0;
+  while (found < cachePaths.size() && !readFile(cachePaths[found], worldData))
+    found++;
+  if (found == cachePaths.size()) {
+    fprintf(stderr, "plannerbench: cannot read the world cache %s\n", cachePaths[0].c_str());
+    return 1;
+  }
+  if (!digest.empty()) {
+    MD5 md5;
+    md5.update((unsigned char *)&worldData[0], (unsigned int)worldData.size());
+    md5.finalize();
+    if (md5.hexdigest() != TextUtils::tolower(digest)) {
+      fprintf(stderr, "plannerbench: %s does not match its md5\n", cachePaths[found].c_str());
+      return 1;
+    }
+  }
+
+  // the server sends the size with the game settings, not with the world
+  if (worldSize > 0.0f)
+    BZDB.set(StateDatabase::BZDB_WORLDSIZE, TextUtils::format("%f", worldSize));
+
+  WorldBuilder *worldBuilder = new WorldBuilder;
+  if (!worldBuilder->unpack(&worldData[0])) {
+    delete worldBuilder;
+    fprintf(stderr, "plannerbench: error unpacking %s\n", cachePaths[found].c_str());
+    return 1;
+  }
+  World *world = worldBuilder->getWorld();
+  delete worldBuilder;
+  World::setWorld(world);
+  world->checkCollisionManager();
+  buildRobotPlanningData();
+
+  const OccupancyGrid &grid = OCCUPANCYGRID;
+  int openCells = 0;
+  for (int x = grid.getMinCoord(); x <= grid.getMaxCoord(); x++)
+    for (int y = grid.getMinCoord(); y <= grid.getMaxCoord(); y++)
+      if (grid.isAccessible(x, y))
+        openCells++;
+  const int span = grid.getMaxCoord() - grid.getMinCoord() + 1;
+
+  std::vector<MyNode> starts, goals;
+  pickPlannerQueries(queries, seed, starts, goals);
+  printf("world %s: size %.0f, %dx%d grid, %.1f%% open, navmesh %d polygons\n", cachePaths[found].c_str(),
+         BZDBCache::worldSize, span, span, span ? 100.0 * openCells / ((double)span * span) : 0.0,
+         NAVMESH.getPolygonCount());
+  printf("%d queries, seed %u\n\n", (int)goals.size(), seed);
+  if (goals.empty()) {
+    fprintf(stderr, "plannerbench: no open cells to plan between\n");
+  } else {
+    std::vector<PlannerStats> stats;
+    runPathPlanners(starts, goals, stats);
+
+    // times in ms, path length in world units, over the paths found
+    printf("%-10s %10s %8s %8s %8s %8s %8s %9s %10s %9s %9s\n", "planner", "expanded/q", "p50", "p90", "p99", "max",
+           "length", "found", "mismatches", "nodes", "memory KB");
+    for (unsigned int i = 0; i < stats.size(); i++) {
+      const PlannerStats &s = stats[i];
+      const double length = s.found ? (double)s.cost * SCALE / (STRAIGHT_COST * s.found) : 0.0;
+      printf("%-10s %10ld %s %s %s %s %8.1f %4d/%-4d %10d %9s %9s\n", s.name.c_str(),
+             s.expanded / (long)goals.size(), formatMilliseconds(s.getPercentile(0.5)).c_str(),
+             formatMilliseconds(s.getPercentile(0.9)).c_str(), formatMilliseconds(s.getPercentile(0.99)).c_str(),
+             formatMilliseconds(s.getPercentile(1.0)).c_str(), length, s.found, (int)goals.size(), s.costMismatches,
+             (s.nodes >= 0) ? TextUtils::format("%d", s.nodes).c_str() : "-",
+             (s.memoryGrowth >= 0) ? TextUtils::format("%ld", s.memoryGrowth).c_str() : "-");
+    }
+  }
+
+  NAVMESH.clear();
+  OCCUPANCYGRID.clear();
+  World::setWorld(NULL);
+  delete world;
+  return goals.empty() ? 1 : 0;
+}
+
+#endif /* ROBOT */
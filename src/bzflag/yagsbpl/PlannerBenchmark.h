@@ -0,0 +1,34 @@
+/* PlannerBenchmark.h
+ *
+ * A headless benchmark of the robot path planners on a real map, to catch planner regressions
+ * before a map is deployed:
+ *
+ *   bzflag -plannerbench <world> [queries] [seed] [worldSize]
+ *
+ * loads the world without opening a display, picks reproducible start/goal pairs among the open
+ * cells, runs every planner of PlannerComparison.h over them, and prints the expansions, the wall
+ * time percentiles, the path length and the memory of each planner.
+ *
+ * The world is one of
+ *  - a world cache file (.bwc), like the ones the client keeps in its cache directory;
+ *  - the hex digest of a cached world (with or without its 'p'/'t' prefix), looked up in the cache
+ *    directory and checked against its md5;
+ *  - a .bzw map, turned into a cache file by "bzfs -world <map> -cacheout <file>", which is why
+ *    bzfs has to be on the path for those.
+ * Cache files do not hold the size of the world: it comes from the worldSize argument if given,
+ * else from the world block of a .bzw map, else from the default _worldSize.
+ */
+
+#ifndef PLANNERBENCHMARK_H_
+#define PLANNERBENCHMARK_H_
+
+
+/* Runs the benchmark and prints the results on stdout.
+ * @param argc The number of arguments after "-plannerbench".
+ * @param argv The arguments after "-plannerbench": the world, then the optional ones.
+ * @return The exit code: 0 if the world was loaded and the planners ran, 1 otherwise.
+ */
+int runPlannerBenchmark(int argc, char **argv);
+
+
+#endif /* PLANNERBENCHMARK_H_ */
@@ -0,0 +1,309 @@
+/* PlannerComparison.cxx
+ *
+ * See PlannerComparison.h
+ */
+
+// interface header
+#include "PlannerComparison.h"
+
+// system implementation headers
+#include <algorithm>
+#ifndef _WIN32
+#  include <sys/time.h>
+#  include <sys/resource.h>
+#endif
+
+// common implementation headers
+#include "TextUtils.h"
+#include "TimeKeeper.h"
+
+// local implementation headers
+#include "PathPlanners.h"
+#include "StaticAStar.h"
+#include "AnytimeAStar.h"
+#include "HierarchicalPlanner.h"
+#include "NavMesh.h"
+
+
+/* Octile cost of a path that moves one cell at a time.
+ */
+static int pathCost(const std::vector<MyNode> &path) {
+  int cost = 0;
+  for (unsigned int i = 1; i < path.size(); i++)
+    cost += octileDistance(path[i].x - path[i-1].x, path[i].y - path[i-1].y);
+  return cost;
+}
+
+
+/* Length of a path through the given nodes, in the same units as pathCost().
+ */
+static int anyAngleCost(const std::vector<MyNode> &path) {
+  float length = 0.0f;
+  for (unsigned int i = 1; i < path.size(); i++)
+    length += hypotf((float)(path[i].x - path[i-1].x), (float)(path[i].y - path[i-1].y));
+  return (int)(STRAIGHT_COST * length + 0.5f);
+}
+
+
+/* Length of a path through the given points, in the same units as pathCost().
+ */
+static int pointPathCost(const std::vector<RegionPoint> &points) {
+  float length = 0.0f;
+  for (unsigned int i = 1; i < points.size(); i++)
+    length += hypotf(points[i].get()[0] - points[i-1].get()[0], points[i].get()[1] - points[i-1].get()[1]);
+  return (int)(STRAIGHT_COST * length / SCALE + 0.5f);
+}
+
+
+/* Small deterministic generator, so the queries do not depend on (or disturb) rand().
+ */
+static unsigned int nextRandom(unsigned int &state) {
+  state = state * 1103515245u + 12345u;
+  return (state >> 16) & 0x7fff;
+}
+
+
+/* Peak resident set size of the process so far, in KB; -1 where it cannot be told.
+ */
+static long peakMemory() {
+#ifndef _WIN32
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;  // in bytes there
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+  return -1;
+}
+
+
+double PlannerStats::getPercentile(double fraction) const {
+  if (seconds.empty())
+    return 0.0;
+  std::vector<double> sorted(seconds);
+  std::sort(sorted.begin(), sorted.end());
+  int i = (int)(fraction * (sorted.size() - 1) + 0.5);
+  if (i < 0)
+    i = 0;
+  else if (i >= (int)sorted.size())
+    i = (int)sorted.size() - 1;
+  return sorted[i];
+}
+
+
+double PlannerStats::getTotalSeconds() const {
+  double total = 0.0;
+  for (unsigned int i = 0; i < seconds.size(); i++)
+    total += seconds[i];
+  return total;
+}
+
+
+void pickPlannerQueries(int queries, unsigned int seed, std::vector<MyNode> &starts, std::vector<MyNode> &goals) {
+  starts.clear();
+  goals.clear();
+  const OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    return;
+
+  // pick start and goal nodes among the open cells
+  const int span = grid.getMaxCoord() - grid.getMinCoord() + 1;
+  unsigned int state = seed;
+  for (int attempts = 0; (int)goals.size() < queries && attempts < 100 * queries; attempts++) {
+    MyNode node;
+    node.x = grid.getMinCoord() + (int)(nextRandom(state) % span);
+    node.y = grid.getMinCoord() + (int)(nextRandom(state) % span);
+    if (!grid.isAccessible(node.x, node.y))
+      continue;
+    if (starts.size() == goals.size())
+      starts.push_back(node);
+    else
+      goals.push_back(node);
+  }
+  starts.resize(goals.size());
+}
+
+
+// the planners, in report order
+enum PlannerIndex {
+  GridAStarIndex,
+  GraphAStarIndex,
+  StaticAStarIndex,
+  BidirectionalIndex,
+  AnytimeIndex,
+  JumpPointIndex,
+  ThetaStarIndex,
+  HierarchicalIndex,
+  NavMeshIndex,
+  PlannerCount
+};
+
+static const char *plannerNames[PlannerCount] = {"grid A*", "yagsbpl A*", "static A*", "bidir A*", "ARA*", "JPS",
+                                                  "Theta*", "HPA*", "navmesh"};
+
+// the kind of each for PathPlanners::plan(); only read for the planners it runs
+static const PathPlannerKind plannerKinds[PlannerCount] = {GridPlanner, GraphPlanner, GridPlanner,
+                                                           BidirectionalPlanner, GridPlanner, JpsPlanner,
+                                                           ThetaPlanner, GridPlanner, GridPlanner};
+
+
+/* Plans one query with one planner.  Only the planning itself is timed.
+ * @param cost Gets the cost of the path found (see PlannerStats::cost).
+ * @return True if a path was found.
+ */
+static bool runPlanner(int planner, const MyNode &start, const MyNode &goal, PlannerStats &stats, int &cost) {
+  // keep the planners around, like RobotPlayer does, so that warm-up costs are not counted
+  static PathPlanners planners;
+  static StaticAStarPlanner staticAStar;
+  static AnytimeAStarPlanner anytime;
+  static HierarchicalPlanner hierarchical;
+  static std::vector<MyNode> path, segment;
+  static std::vector<RegionPoint> corners;
+
+  // the abstract graph is only built once per grid, and is not part of the query
+  if (planner == HierarchicalIndex)
+    hierarchical.update();
+
+  bool found = false;
+  int expanded = 0;
+  TimeKeeper startTime = TimeKeeper::getCurrent();
+  switch (planner) {
+    case GridAStarIndex:
+    case GraphAStarIndex:
+    case BidirectionalIndex:
+    case JumpPointIndex:
+    case ThetaStarIndex: {
+      // the same searches as the robots'
+      SearchCounters counters;
+      found = planners.plan(plannerKinds[planner], OCCUPANCYGRID, start, goal, path, counters);
+      expanded = counters.expanded;
+      if (planner == GraphAStarIndex)
+        stats.nodes = planners.graph.getNodeCount();
+      break;
+    }
+    case StaticAStarIndex:
+      found = staticAStar.plan(start, goal, path);
+      expanded = staticAStar.getExpandCount();
+      stats.nodes = staticAStar.getNodeCount();
+      break;
+    case AnytimeIndex:
+      // all the way down to a shortest path, in one go
+      anytime.start(start, goal);
+      while (anytime.isSearching())
+        anytime.improve(1.0);
+      expanded = anytime.getExpandCount();
+      found = anytime.getPath(path);
+      break;
+    case HierarchicalIndex:
+      found = hierarchical.plan(start, goal, path);
+      expanded = hierarchical.getExpandCount();
+      break;
+    case NavMeshIndex: {
+      const float startPos[2] = {convertToGameCoord(start.x), convertToGameCoord(start.y)};
+      const float goalPos[2]  = {convertToGameCoord(goal.x),  convertToGameCoord(goal.y)};
+      found = NAVMESH.plan(startPos, goalPos, corners);
+      expanded = NAVMESH.getExpandCount();
+      break;
+    }
+  }
+  stats.seconds.push_back(TimeKeeper::getCurrent() - startTime);
+  stats.expanded += expanded;
+
+  cost = -1;
+  if (!found)
+    return false;
+  switch (planner) {
+    case ThetaStarIndex:
+      cost = anyAngleCost(path);
+      break;
+    case HierarchicalIndex:
+      // the waypoints are not a full path; refine every segment (untimed) to get the cost
+      cost = 0;
+      for (unsigned int i = 1; i < path.size(); i++) {
+        planners.grid.plan(path[i-1], path[i], segment);
+        cost += pathCost(segment);
+      }
+      break;
+    case NavMeshIndex:
+      cost = pointPathCost(corners);
+      break;
+    default:
+      cost = pathCost(path);
+      break;
+  }
+  return true;
+}
+
+
+void runPathPlanners(const std::vector<MyNode> &starts, const std::vector<MyNode> &goals,
+                     std::vector<PlannerStats> &stats) {
+  const int planners = NAVMESH.isBuilt() ? PlannerCount : PlannerCount - 1;
+  stats.assign(planners, PlannerStats());
+
+  // grid A* goes first: its costs are the reference
+  std::vector<int> expectedCosts(goals.size(), -1);
+  for (int p = 0; p < planners; p++) {
+    PlannerStats &plannerStats = stats[p];
+    plannerStats.name = plannerNames[p];
+    plannerStats.seconds.reserve(goals.size());
+    // the any-angle paths are shorter, so they are only expected to be found when grid A* finds one
+    const bool anyAngle = (p == ThetaStarIndex || p == NavMeshIndex);
+
+    const long memoryBefore = peakMemory();
+    for (unsigned int q = 0; q < goals.size(); q++) {
+      int cost;
+      const bool found = runPlanner(p, starts[q], goals[q], plannerStats, cost);
+      if (found) {
+        plannerStats.found++;
+        plannerStats.cost += cost;
+      }
+      if (p == GridAStarIndex)
+        expectedCosts[q] = cost;
+      else if (anyAngle ? (found != (expectedCosts[q] >= 0)) : (cost != expectedCosts[q]))
+        plannerStats.costMismatches++;
+    }
+    const long memoryAfter = peakMemory();
+    if (memoryBefore >= 0 && memoryAfter >= 0)
+      plannerStats.memoryGrowth = memoryAfter - memoryBefore;
+  }
+}
+
+
+std::vector<std::string> comparePathPlanners(int queries, unsigned int seed) {
+  std::vector<std::string> report;
+
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+  if (!grid.isBuilt() || queries <= 0) {
+    report.push_back("pathplanners: no world to plan in");
+    return report;
+  }
+
+  std::vector<MyNode> starts, goals;
+  pickPlannerQueries(queries, seed, starts, goals);
+  if (goals.empty()) {
+    report.push_back("pathplanners: no open cells to plan between");
+    return report;
+  }
+  std::vector<PlannerStats> stats;
+  runPathPlanners(starts, goals, stats);
+
+  const int count = (int)goals.size();
+  const int span = grid.getMaxCoord() - grid.getMinCoord() + 1;
+  report.push_back(TextUtils::format("path planners, %d queries on a %dx%d grid:", count, span, span));
+  const long referenceCost = stats[GridAStarIndex].cost;
+  for (unsigned int i = 0; i < stats.size(); i++) {
+    const double extraCost = referenceCost ? 100.0 * (stats[i].cost - referenceCost) / referenceCost : 0.0;
+    report.push_back(TextUtils::format("  %-10s %8ld expanded/query %9.1f us/query  %d/%d found  %d cost mismatches (%+.1f%%)",
+                                       stats[i].name.c_str(), stats[i].expanded / count,
+                                       1.0e6 * stats[i].getTotalSeconds() / count,
+                                       stats[i].found, count, stats[i].costMismatches, extraCost));
+  }
+  if (NAVMESH.isBuilt())
+    report.push_back(TextUtils::format("  navmesh: %d polygons, %d portals", NAVMESH.getPolygonCount(),
+                                       NAVMESH.getPortalCount()));
+  return report;
+}
@@ -0,0 +1,63 @@
+/* PlannerComparison.h
+ *
+ * Runs the robot path planners side by side on the current world, so that their expansion
+ * counts and timings can be compared in game (see the "pathplanners" command) or headless (see
+ * PlannerBenchmark.h).
+ */
+
+#ifndef PLANNERCOMPARISON_H_
+#define PLANNERCOMPARISON_H_
+
+/* system interface headers */
+#include <string>
+#include <vector>
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+
+
+/* The results of one planner over a set of queries.
+ */
+struct PlannerStats {
+  PlannerStats() : expanded(0), found(0), cost(0), costMismatches(0), nodes(-1), memoryGrowth(-1) {}
+
+  /* The time below which the given share of the queries ran, in seconds.
+   * @param fraction Between 0 (the fastest query) and 1 (the slowest).
+   */
+  double getPercentile(double fraction) const;
+
+  double getTotalSeconds() const;
+
+  std::string name;
+  std::vector<double> seconds;  // wall time of each query
+  long expanded;
+  int found;
+  long cost;           // total cost of the paths found, in STRAIGHT_COST units per cell
+  int costMismatches;  // paths whose cost differs from the grid A* path (any-angle planners: found or not)
+  int nodes;           // search nodes the planner keeps after the queries, -1 if it does not tell
+  long memoryGrowth;   // growth of the peak resident set while the planner ran, in KB, -1 if unknown
+};
+
+
+/* Picks start/goal pairs among the open cells of the current OccupancyGrid, which must be built.
+ * @param queries The number of pairs wanted.  Fewer are picked if open cells are hard to find.
+ * @param seed Seeds the choice, so that runs can be repeated.  Does not use or disturb rand().
+ */
+void pickPlannerQueries(int queries, unsigned int seed, std::vector<MyNode> &starts, std::vector<MyNode> &goals);
+
+/* Plans the given queries with every planner, one planner after the other, on the current
+ * OccupancyGrid (and on the NavMesh, if it is built).
+ * @param stats Gets one entry per planner, grid A* first.
+ */
+void runPathPlanners(const std::vector<MyNode> &starts, const std::vector<MyNode> &goals,
+                     std::vector<PlannerStats> &stats);
+
+/* Plans the same random queries with every planner.
+ * @param queries The number of start/goal pairs to try.
+ * @param seed Seeds the choice of start/goal pairs, so that runs can be repeated.
+ * @return A report, one line per planner, ready for the control panel.
+ */
+std::vector<std::string> comparePathPlanners(int queries, unsigned int seed);
+
+
+#endif /* PLANNERCOMPARISON_H_ */
@@ -0,0 +1,118 @@
+/* PlanningScheduler.cxx
+ *
+ * See PlanningScheduler.h
+ */
+
+// interface header
+#include "PlanningScheduler.h"
+
+/* system implementation headers */
+#include <algorithm>
+
+// common implementation headers
+#include "StateDatabase.h"
+
+// initialize the singleton
+template <>
+PlanningScheduler* Singleton<PlanningScheduler>::_instance = (PlanningScheduler*)0;
+
+
+PlanningScheduler::PlanningScheduler() : submissions(0) {
+  resetStats();
+}
+
+
+PlanningScheduler::~PlanningScheduler() {
+}
+
+
+void PlanningScheduler::resetStats() {
+  lastBudget = 0;
+  lastExpansions = 0;
+  maxExpansions = 0;
+  totalExpansions = 0;
+  frames = 0;
+  busyFrames = 0;
+}
+
+
+void PlanningScheduler::clear() {
+  pending.clear();
+  resetStats();
+}
+
+
+void PlanningScheduler::submit(AnytimeAStarPlanner *search, Urgency urgency) {
+  for (unsigned int i = 0; i < pending.size(); i++) {
+    if (pending[i].search == search) {
+      pending[i].urgency = urgency;
+      return;
+    }
+  }
+  Entry entry;
+  entry.search = search;
+  entry.urgency = urgency;
+  entry.order = submissions++;
+  pending.push_back(entry);
+}
+
+
+void PlanningScheduler::cancel(AnytimeAStarPlanner *search) {
+  for (unsigned int i = 0; i < pending.size(); i++) {
+    if (pending[i].search == search) {
+      pending.erase(pending.begin() + i);
+      return;
+    }
+  }
+}
+
+
+int PlanningScheduler::pickNext() const {
+  int best = -1;
+  for (int i = 0; i < (int)pending.size(); i++) {
+    if (best < 0) {
+      best = i;
+      continue;
+    }
+    // a first path beats a better path, then the more urgent, then the older
+    const Entry &a = pending[i];
+    const Entry &b = pending[best];
+    const bool aHasPath = a.search->hasPath();
+    const bool bHasPath = b.search->hasPath();
+    if (aHasPath != bHasPath) {
+      if (!aHasPath)
+        best = i;
+    } else if (a.urgency != b.urgency) {
+      if (a.urgency > b.urgency)
+        best = i;
+    } else if ((int)(a.order - b.order) < 0) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+
+void PlanningScheduler::update() {
+  const int budget = BZDB.isSet("robotPlanningBudget") ? BZDB.evalInt("robotPlanningBudget") : 2000;
+  const int slice = std::max(1, BZDB.isSet("robotPlanningSlice") ? BZDB.evalInt("robotPlanningSlice") : 256);
+
+  int used = 0;
+  while (used < budget) {
+    const int next = pickNext();
+    if (next < 0)
+      break;
+    AnytimeAStarPlanner *search = pending[next].search;
+    used += search->expand(std::min(slice, budget - used));
+    if (!search->isSearching())
+      pending.erase(pending.begin() + next);
+  }
+
+  lastBudget = budget;
+  lastExpansions = used;
+  maxExpansions = std::max(maxExpansions, used);
+  totalExpansions += used;
+  frames++;
+  if (used >= budget && !pending.empty())
+    busyFrames++;
+}
@@ -0,0 +1,100 @@
+/* PlanningScheduler.h
+ *
+ * Runs the robots' anytime searches on the main thread, a slice at a time, within one budget of
+ * node expansions per frame shared by all the robots.
+ *
+ * With many local robots, several of them can lose sight of their next node in the same frame,
+ * and a search each makes for a spike.  Instead, a robot hands its AnytimeAStarPlanner to the
+ * scheduler, which expands at most robotPlanningBudget nodes per frame (2000 by default) over all
+ * the pending searches, robotPlanningSlice nodes (256 by default) at a time.  A search left
+ * unfinished at the end of the frame picks up where it left off the next frame.
+ *
+ * Each slice goes to the most urgent search that has no path yet; earlier submissions go first
+ * among equals.  Searches that already have a path, and only improve it, wait until every search
+ * without one has been served.  A search is dropped once it is done.
+ *
+ * Main thread only.
+ */
+
+#ifndef PLANNINGSCHEDULER_H_
+#define PLANNINGSCHEDULER_H_
+
+#include "common.h"
+
+/* system interface headers */
+#include <vector>
+
+/* common interface headers */
+#include "Singleton.h"
+
+/* local interface headers */
+#include "AnytimeAStar.h"
+
+#define PLANNINGSCHEDULER (PlanningScheduler::instance())
+
+
+class PlanningScheduler : public Singleton<PlanningScheduler> {
+public:
+  // how badly the robot needs its path, least urgent first
+  enum Urgency {
+    Idle,         // nothing more pressing
+    UnderFire,    // a shot came near the robot lately
+    CarryingFlag  // the robot has a flag to take somewhere
+  };
+
+  /* Queues a search, which must have been started.  Submitting a search that is already queued
+   * only changes its urgency.
+   * @param search The search to carry on.  Must stay valid until it is done or cancelled.
+   * @param urgency How soon the search should be served.
+   */
+  void submit(AnytimeAStarPlanner *search, Urgency urgency);
+
+  /* Drops a search from the queue, if it is there.
+   */
+  void cancel(AnytimeAStarPlanner *search);
+
+  /* Spends this frame's budget on the queued searches.  Called once per frame.
+   */
+  void update();
+
+  /* Forgets the queued searches and the stats.  Called when leaving the game.
+   */
+  void clear();
+
+  int getPendingCount() const { return (int)pending.size(); }
+
+  // stats of the last update(), and over all updates since the last resetStats()
+  int getLastBudget() const { return lastBudget; }
+  int getLastExpansions() const { return lastExpansions; }
+  int getMaxExpansions() const { return maxExpansions; }
+  long getTotalExpansions() const { return totalExpansions; }
+  long getFrameCount() const { return frames; }
+  long getBusyFrameCount() const { return busyFrames; }  // frames that ran out of budget with searches left
+
+  void resetStats();
+
+protected:
+  friend class Singleton<PlanningScheduler>;
+
+private:
+  PlanningScheduler();
+  ~PlanningScheduler();
+
+  struct Entry {
+    AnytimeAStarPlanner *search;
+    Urgency urgency;
+    unsigned int order;  // submission order, for ties
+  };
+
+  // index of the entry to serve next, -1 if there is none
+  int pickNext() const;
+
+  std::vector<Entry> pending;
+  unsigned int submissions;
+
+  int lastBudget, lastExpansions, maxExpansions;
+  long totalExpansions, frames, busyFrames;
+};
+
+
+#endif /* PLANNINGSCHEDULER_H_ */
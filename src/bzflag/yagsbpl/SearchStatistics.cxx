@@ -0,0 +1,121 @@
+/* SearchStatistics.cxx
+ *
+ * See SearchStatistics.h
+ */
+
+// interface header
+#include "SearchStatistics.h"
+
+// common implementation headers
+#include "TextUtils.h"
+
+// initialize the singleton
+template <>
+SearchStatistics* Singleton<SearchStatistics>::_instance = (SearchStatistics*)0;
+
+
+void SearchHistogram::reset() {
+  for (int i = 0; i < BucketCount; i++)
+    buckets[i] = 0;
+  count = 0;
+  sum = 0.0;
+  max = 0.0;
+}
+
+
+void SearchHistogram::add(double value) {
+  int bucket = 0;
+  for (double top = 1.0; value >= top && bucket < BucketCount - 1; top *= 2.0)
+    bucket++;
+  buckets[bucket]++;
+  count++;
+  sum += value;
+  if (value > max)
+    max = value;
+}
+
+
+double SearchHistogram::getPercentile(double fraction) const {
+  if (!count)
+    return 0.0;
+  const double wanted = fraction * count;
+  long seen = 0;
+  double top = 1.0;
+  for (int i = 0; i < BucketCount - 1; i++, top *= 2.0) {
+    seen += buckets[i];
+    if (seen >= wanted && seen > 0)
+      return (top < max) ? top : max;
+  }
+  return max;
+}
+
+
+SearchStatistics::SearchStatistics() {
+}
+
+
+SearchStatistics::~SearchStatistics() {
+}
+
+
+void SearchStatistics::Histograms::add(const SearchCounters &counters) {
+  searches++;
+  if (counters.inaccessibleSeeds > 0)
+    inaccessibleStarts++;
+  expanded.add(counters.expanded);
+  planMicroseconds.add(1.0e6 * counters.planSeconds);
+  // the planners that only count their expansions leave the rest at 0
+  if (counters.generated > 0) {
+    detailedSearches++;
+    generated.add(counters.generated);
+    heapPeak.add(counters.heapPeak);
+    hashCollisions.add(counters.hashCollisions);
+    successorMicroseconds.add(1.0e6 * counters.successorSeconds);
+  }
+}
+
+
+void SearchStatistics::record(int robot, const std::string &name, const SearchCounters &counters) {
+  total.add(counters);
+  Histograms &histograms = robots[robot];
+  histograms.name = name;
+  histograms.add(counters);
+}
+
+
+void SearchStatistics::reset() {
+  total = Histograms();
+  robots.clear();
+}
+
+
+std::string SearchStatistics::formatHistogram(const char *label, const SearchHistogram &histogram) {
+  return TextUtils::format("  %-16s mean %9.1f  p50 %8.0f  p90 %8.0f  p99 %8.0f  max %8.0f", label,
+                           histogram.getMean(), histogram.getPercentile(0.5), histogram.getPercentile(0.9),
+                           histogram.getPercentile(0.99), histogram.getMax());
+}
+
+
+std::vector<std::string> SearchStatistics::report() const {
+  std::vector<std::string> lines;
+  lines.push_back(TextUtils::format("robot searches: %ld (%ld with every counter), %ld from inaccessible starts",
+                                    total.searches, total.detailedSearches, total.inaccessibleStarts));
+  if (!total.searches)
+    return lines;
+  lines.push_back(formatHistogram("expanded", total.expanded));
+  lines.push_back(formatHistogram("plan us", total.planMicroseconds));
+  if (total.detailedSearches) {
+    lines.push_back(formatHistogram("generated", total.generated));
+    lines.push_back(formatHistogram("open list peak", total.heapPeak));
+    lines.push_back(formatHistogram("hash collisions", total.hashCollisions));
+    lines.push_back(formatHistogram("successors us", total.successorMicroseconds));
+  }
+  for (std::map<int, Histograms>::const_iterator it = robots.begin(); it != robots.end(); ++it) {
+    const Histograms &robot = it->second;
+    lines.push_back(TextUtils::format("  %-16s %6ld searches  expanded p50 %6.0f max %7.0f  plan us p50 %6.0f max %8.0f",
+                                      robot.name.c_str(), robot.searches, robot.expanded.getPercentile(0.5),
+                                      robot.expanded.getMax(), robot.planMicroseconds.getPercentile(0.5),
+                                      robot.planMicroseconds.getMax()));
+  }
+  return lines;
+}
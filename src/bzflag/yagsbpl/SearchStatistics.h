@@ -0,0 +1,112 @@
+/* SearchStatistics.h
+ *
+ * Histograms of the SearchCounters of the robots' path searches, over all the robots and per
+ * robot, so that a slow or wasteful search shows up in game (see the "searchstats" command)
+ * without rebuilding the client with debug output.
+ *
+ * Each value goes into a power-of-two bucket: recording a search costs a few additions, and the
+ * percentiles are only as precise as the buckets (the report gives the top of the bucket).  Only
+ * the "astar" planner counts the generated nodes, the open list peak, the hash collisions and the
+ * time in getSuccessors; searches by the other planners only add their expansions and wall time.
+ *
+ * Main thread only: the searches planned by the PathPlanningService workers are recorded when
+ * the robot polls for them.
+ */
+
+#ifndef SEARCHSTATISTICS_H_
+#define SEARCHSTATISTICS_H_
+
+#include "common.h"
+
+/* system interface headers */
+#include <map>
+#include <string>
+#include <vector>
+
+/* common interface headers */
+#include "Singleton.h"
+
+/* local interface headers */
+#include "yagsbpl_base.h"
+
+#define SEARCHSTATISTICS (SearchStatistics::instance())
+
+
+/* Counts values in power-of-two buckets: bucket 0 holds the values below 1, bucket i the values
+ * in [2^(i-1), 2^i).
+ */
+class SearchHistogram {
+public:
+  enum { BucketCount = 32 };
+
+  SearchHistogram() { reset(); }
+
+  void add(double value);
+  void reset();
+
+  long getCount() const { return count; }
+  double getMean() const { return count ? sum / count : 0.0; }
+  double getMax() const { return max; }
+
+  /* The value below which the given share of the values fall, rounded up to the top of its
+   * bucket, and never more than the largest value.
+   * @param fraction Between 0 and 1.
+   */
+  double getPercentile(double fraction) const;
+
+private:
+  long buckets[BucketCount];
+  long count;
+  double sum;
+  double max;
+};
+
+
+class SearchStatistics : public Singleton<SearchStatistics> {
+public:
+  /* Adds a finished search.
+   * @param robot The player id of the robot the search was for.
+   * @param name The robot's callsign, for the report.
+   * @param counters The counters of the search.
+   */
+  void record(int robot, const std::string &name, const SearchCounters &counters);
+
+  /* Forgets every search recorded so far.
+   */
+  void reset();
+
+  /* A report for the control panel: the histograms over all the robots, then a line per robot.
+   */
+  std::vector<std::string> report() const;
+
+protected:
+  friend class Singleton<SearchStatistics>;
+
+private:
+  SearchStatistics();
+  ~SearchStatistics();
+
+  struct Histograms {
+    Histograms() : searches(0), detailedSearches(0), inaccessibleStarts(0) {}
+    void add(const SearchCounters &counters);
+
+    std::string name;
+    long searches;
+    long detailedSearches;    // the searches that filled all their counters
+    long inaccessibleStarts;  // searches that could not start: the robot was off the grid
+    SearchHistogram expanded;
+    SearchHistogram generated;
+    SearchHistogram heapPeak;
+    SearchHistogram hashCollisions;
+    SearchHistogram successorMicroseconds;
+    SearchHistogram planMicroseconds;
+  };
+
+  static std::string formatHistogram(const char *label, const SearchHistogram &histogram);
+
+  Histograms total;
+  std::map<int, Histograms> robots;
+};
+
+
+#endif /* SEARCHSTATISTICS_H_ */
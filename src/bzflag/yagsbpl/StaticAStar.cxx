@@ -0,0 +1,41 @@
+/* StaticAStar.cxx
+ *
+ * See StaticAStar.h
+ */
+
+// interface header
+#include "StaticAStar.h"
+
+
+StaticAStarPlanner::StaticAStarPlanner() : expandCount(0) {
+  planner.setParams(HEAP_MODE_BUCKET);  // integer octile costs
+}
+
+
+bool StaticAStarPlanner::plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path) {
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+  return plan(grid, start, goal, path);
+}
+
+
+bool StaticAStarPlanner::plan(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal,
+                              std::vector<MyNode> &path) {
+  path.clear();
+  expandCount = 0;
+
+  // the node store only covers the grid
+  if (start.x < grid.getMinCoord() || start.x > grid.getMaxCoord() ||
+      start.y < grid.getMinCoord() || start.y > grid.getMaxCoord())
+    return false;
+
+  StaticGridGraph graph(grid);
+  planner.init(&graph, start, goal);
+  planner.plan();
+  expandCount = planner.expandcount;
+  if (!planner.pathFound())
+    return false;
+  path = planner.getPlannedPath();
+  return true;
+}
@@ -0,0 +1,153 @@
+/* StaticAStar.h
+ *
+ * The YAGSBPL-style A* of Static_A_star.h over the OccupancyGrid tile graph.
+ *
+ * GraphAStarPlanner searches the same graph through GraphFunctionContainer, whose functions are
+ * virtual and hand back their successors in two std::vectors.  Here the graph (StaticGridGraph),
+ * the heuristic (StaticOctileHeuristic) and the closed list (StaticGridNodeStore) are template
+ * parameters of the planner, so the whole expansion loop is compiled for MyNode and inlined.  The
+ * nodes, costs and heuristic are the same, so the paths cost the same too.
+ */
+
+#ifndef STATICASTAR_H_
+#define STATICASTAR_H_
+
+/* system interface headers */
+#include <vector>
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+#include "Static_A_star.h"
+
+
+/* -----------------------------------------------
+ * The 8-connected tile graph of an OccupancyGrid: the same successors as
+ * GraphFunctionContainer::getSuccessors().
+ */
+class StaticGridGraph : public Static_graph<StaticGridGraph, MyNode, int> {
+public:
+  enum { MaxSuccessors = 8 };
+
+  explicit StaticGridGraph(const OccupancyGrid &_grid) : grid(_grid) {}
+
+  inline int getSuccessors(MyNode &n, MyNode *s, int *c) {
+    int count = 0;
+    for (int i=-1; i<=1; i++) {
+      for (int j=-1; j<=1; j++) {
+        // the grid also treats everything outside the level as blocked
+        if ((i==0 && j==0) || !grid.isAccessible(n.x + i, n.y + j))
+          continue;
+        s[count].x = n.x + i;
+        s[count].y = n.y + j;
+        c[count] = (i && j) ? DIAGONAL_COST : STRAIGHT_COST;
+        count++;
+      }
+    }
+    return count;
+  }
+
+  const OccupancyGrid &grid;
+};
+
+
+/* -----------------------------------------------
+ * Octile distance, like GraphFunctionContainer::getHeuristics().
+ */
+class StaticOctileHeuristic {
+public:
+  inline int operator()(StaticGridGraph&, MyNode &n1, MyNode &n2) const {
+    return octileDistance(n2.x - n1.x, n2.y - n1.y);
+  }
+};
+
+
+/* -----------------------------------------------
+ * The closed list: a flat array with a pointer per cell of the grid, indexed like GridNodeStore.
+ * Only the nodes a search reaches are created, and they are kept for the next searches on a grid
+ * of the same size.
+ */
+class StaticGridNodeStore {
+public:
+  typedef SearchGraphNode<MyNode, int, Static_A_star_variables<int> > GraphNode;
+
+  StaticGridNodeStore() : minCoord(0), size(0), searchGeneration(1) {}
+
+  void newSearch(StaticGridGraph &graph) {
+    const unsigned int newSize = (unsigned int)(graph.grid.getMaxCoord() - graph.grid.getMinCoord() + 1);
+    if (newSize != size || graph.grid.getMinCoord() != minCoord) {
+      minCoord = graph.grid.getMinCoord();
+      size = newSize;
+      // the arena keeps the old nodes until the store goes away
+      index.assign(size * size, (GraphNode*)NULL);
+    }
+    searchGeneration++;
+    // on wrap-around, stale stamps could collide with the new generation: reset them all
+    if (searchGeneration == 0) {
+      for (unsigned int i = 0; i < index.size(); i++)
+        if (index[i])
+          index[i]->searchGeneration = 0;
+      searchGeneration = 1;
+    }
+  }
+
+  // the search only asks for nodes on the grid: the start, and accessible successors
+  inline GraphNode *get(MyNode &n) {
+    GraphNode *&np = index[(n.x - minCoord) * size + (n.y - minCoord)];
+    if (!np) {
+      np = nodeArena.allocate();
+      np->n = n;
+      np->initiated = false;
+      np->searchGeneration = searchGeneration;
+    } else if (np->searchGeneration != searchGeneration) {
+      np->initiated = false;
+      np->searchGeneration = searchGeneration;
+    }
+    return np;
+  }
+
+  int nodeCount() { return nodeArena.allocatedCount(); }
+
+private:
+  int minCoord;
+  unsigned int size;
+  std::vector<GraphNode*> index;
+  BumpArena<GraphNode> nodeArena;
+  unsigned int searchGeneration;
+};
+
+
+class StaticAStarPlanner {
+public:
+  StaticAStarPlanner();
+
+  /* Finds a shortest path from the start node to the goal node.
+   * @param start The node from which to start the search.
+   * @param goal The search will try to find a path to this node.
+   * @param path Writes the path here, from start to goal (inclusive).  Cleared if there is no path.
+   * @return True if a path was found, false otherwise.
+   */
+  bool plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* Same as above, on the given grid instead of the shared OccupancyGrid.
+   * @param grid The raster to search, already built (e.g. an OccupancyGrid::snapshot()).
+   */
+  bool plan(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* The number of nodes expanded by the last call to plan().
+   */
+  int getExpandCount() const { return expandCount; }
+
+  /* The number of nodes created by all searches so far.
+   */
+  int getNodeCount() { return planner.store.nodeCount(); }
+
+private:
+  StaticAStarPlanner(const StaticAStarPlanner&);
+  StaticAStarPlanner& operator=(const StaticAStarPlanner&);
+
+  Static_A_star_planner<StaticGridGraph, StaticOctileHeuristic, StaticGridNodeStore> planner;
+  int expandCount;
+};
+
+
+#endif /* STATICASTAR_H_ */
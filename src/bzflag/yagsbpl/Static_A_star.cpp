@@ -0,0 +1,136 @@
+// Compile-time specialised A* - see Static_A_star.h
+
+
+template <class Graph, class PlannerSpecificVariables>
+void Static_hash_node_store<Graph,PlannerSpecificVariables>::newSearch( Graph& theGraph )
+{
+	if ( graph != &theGraph || bins.size() != theGraph.getHashTableSize() )
+	{
+		// Another graph: the nodes and their bins are of no use. The arena keeps its blocks.
+		graph = &theGraph;
+		bins.clear();
+		bins.resize( theGraph.getHashTableSize() );
+	}
+	searchGeneration++;
+	// On wrap-around, stale stamps could collide with the new generation: reset them all.
+	if (searchGeneration == 0)
+	{
+		for (int a=0; a<bins.size(); a++)
+			for (int b=0; b<bins[a].size(); b++)
+				bins[a][b]->searchGeneration = 0;
+		searchGeneration = 1;
+	}
+}
+
+// -----------------------------
+
+template <class Graph, class PlannerSpecificVariables>
+SearchGraphNode< typename Graph::NodeType, typename Graph::CostType, PlannerSpecificVariables >*
+						Static_hash_node_store<Graph,PlannerSpecificVariables>::get( NodeType& n )
+{
+	std::vector< GraphNode* >& bin = bins[ graph->getHashBin(n) ];
+	for (int a=0; a<bin.size(); a++)
+		if ( bin[a]->n == n )
+		{
+			GraphNode* np = bin[a];
+			if ( np->searchGeneration != searchGeneration )
+			{
+				np->initiated = false;
+				np->searchGeneration = searchGeneration;
+			}
+			return (np);
+		}
+
+	// If new node, create it!
+	GraphNode* np = nodeArena.allocate();
+	np->n = n;
+	np->initiated = false;
+	np->searchGeneration = searchGeneration;
+	bin.push_back(np);
+	return (np);
+}
+
+// ==================================================================================
+
+template <class Graph, class Heuristic, class NodeStore, class OpenList>
+void Static_A_star_planner<Graph,Heuristic,NodeStore,OpenList>::init( Graph* theGraph , NodeType seed , NodeType target )
+{
+	graph = theGraph;
+	SeedNode = seed;
+	TargetNode = target;
+	store.newSearch( *graph );
+	heap.clear();
+	goalNode = NULL;
+	currentNode = NULL;
+	expandcount = 0;
+
+	GraphNode_p thisGraphNode = store.get( SeedNode );
+	thisGraphNode->plannerVars.g = 0;
+	thisGraphNode->plannerVars.expanded = false;
+	thisGraphNode->came_from = NULL;
+	thisGraphNode->f = heuristic( *graph, SeedNode, TargetNode );
+	thisGraphNode->initiated = true; // Always set this when other variables have already been set
+	heap.push( thisGraphNode );
+}
+
+// -----------------------------
+
+template <class Graph, class Heuristic, class NodeStore, class OpenList>
+void Static_A_star_planner<Graph,Heuristic,NodeStore,OpenList>::plan(void)
+{
+	while ( !heap.empty() )
+	{
+		// Get the node with least f-value
+		currentNode = heap.pop();
+		currentNode->plannerVars.expanded = true; // Put in closed list
+		expandcount++;
+
+		if ( graph->stopSearch( currentNode->n, TargetNode ) )
+		{
+			goalNode = currentNode;
+			break;
+		}
+		graph->forEachSuccessor( currentNode->n, *this );
+	}
+	currentNode = NULL;
+}
+
+// -----------------------------
+
+template <class Graph, class Heuristic, class NodeStore, class OpenList>
+inline void Static_A_star_planner<Graph,Heuristic,NodeStore,OpenList>::relax( NodeType& n , CostType cost )
+{
+	GraphNode_p thisNeighbourGraphNode = store.get( n );
+	CostType test_g_val = currentNode->plannerVars.g + cost;
+
+	if ( !thisNeighbourGraphNode->initiated )
+	{
+		thisNeighbourGraphNode->plannerVars.g = test_g_val;
+		thisNeighbourGraphNode->plannerVars.expanded = false;
+		thisNeighbourGraphNode->came_from = currentNode;
+		thisNeighbourGraphNode->f = test_g_val + heuristic( *graph, n, TargetNode );
+		thisNeighbourGraphNode->initiated = true; // Always set this when other variables have already been set
+		heap.push( thisNeighbourGraphNode );
+	}
+	else if ( !thisNeighbourGraphNode->plannerVars.expanded && test_g_val < thisNeighbourGraphNode->plannerVars.g )
+	{
+		// The heuristic part of f stays the same
+		thisNeighbourGraphNode->f += test_g_val - thisNeighbourGraphNode->plannerVars.g;
+		thisNeighbourGraphNode->plannerVars.g = test_g_val;
+		thisNeighbourGraphNode->came_from = currentNode;
+		// Since thisNeighbourGraphNode->f has decreased, move it up in the heap
+		heap.update( thisNeighbourGraphNode );
+	}
+}
+
+// ==================================================================================
+
+template <class Graph, class Heuristic, class NodeStore, class OpenList>
+std::vector< typename Graph::NodeType > Static_A_star_planner<Graph,Heuristic,NodeStore,OpenList>::getPlannedPath(void)
+{
+	std::vector<NodeType> ret;
+	for (GraphNode_p thisGraphNode = goalNode; thisGraphNode; thisGraphNode = thisGraphNode->came_from)
+		ret.push_back( thisGraphNode->n );
+	std::reverse( ret.begin(), ret.end() );
+	return (ret);
+}
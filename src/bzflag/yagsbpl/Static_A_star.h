@@ -0,0 +1,186 @@
+// A* with the graph, the heuristic, the closed list and the open list as template parameters,
+//   written against the YAGSBPL node and heap containers (see yagsbpl_base.h). Not part of the
+//   YAGSBPL distribution.
+//
+// A_star_planner reaches the graph through GenericSearchGraphDescriptor: every expansion calls
+//   _getSuccessors, which goes through a function pointer or a virtual function of the function
+//   container and fills two std::vectors, and every node it generates takes the same route for its
+//   hash bin and its heuristic. Here all of these are resolved at compile time, so for a given
+//   graph the compiler sees the whole inner loop and can inline it.
+//
+// Graph: derives from Static_graph<Graph, NodeType, CostType> (CRTP), and provides either
+//     template <class Visitor> void forEachSuccessor( NodeType& n , Visitor& v ); // calls v.relax(nn, cost)
+//   or (simpler, and turned into forEachSuccessor by Static_graph)
+//     enum { MaxSuccessors = ... };
+//     int getSuccessors( NodeType& n , NodeType* s , CostType* c ); // returns the count, at most MaxSuccessors
+//   and may redefine
+//     CostType getHeuristics( NodeType& n1 , NodeType& n2 ); // 0 by default
+//     bool stopSearch( NodeType& n , NodeType& target ); // n == target by default
+//     int getHashBin( NodeType& n ) and int getHashTableSize(void) // for Static_hash_node_store
+// Heuristic: CostType operator()( Graph& graph , NodeType& n1 , NodeType& n2 ). By default the
+//   graph's getHeuristics.
+// NodeStore (the closed list): gives the search node of a graph node.
+//     void newSearch( Graph& graph ); // forgets the last search, but may keep the nodes
+//     GraphNode* get( NodeType& n ); // 'initiated' is false if the node was not seen in this search
+//   By default the YAGSBPL hash table (Static_hash_node_store).
+// OpenList: push/pop/update/clear/empty, like HeapContainer (the default).
+//
+// Static_generic_graph adapts a GenericSearchGraphDescriptor to the Graph interface, so that any
+//   graph written for the other planners runs on this one too (with the same indirect calls).
+// The successors are asked for again at every expansion: there are no successor links, since with
+//   an inlined getSuccessors they cost more to keep than to compute.
+
+
+#ifndef __STATIC_A_STAR_6D2C8E1F4B73_H_
+#define __STATIC_A_STAR_6D2C8E1F4B73_H_
+
+
+#include <vector>
+#include <algorithm>
+#include "yagsbpl_base.h"
+
+template <class CostType>
+class Static_A_star_variables
+{
+public:
+	CostType g;
+	bool expanded; // Whether in closed list or not
+};
+
+// -----------------------------
+// CRTP base of the graphs. The defaults below are used unless the graph redefines them.
+
+template <class Derived, class NodeType_, class CostType_>
+class Static_graph
+{
+public:
+	typedef  NodeType_  NodeType;
+	typedef  CostType_  CostType;
+
+	// Walks the successors of 'n' through Derived::getSuccessors, on the stack
+	template <class Visitor>
+	void forEachSuccessor( NodeType& n , Visitor& v )
+	{
+		NodeType s[Derived::MaxSuccessors];
+		CostType c[Derived::MaxSuccessors];
+		int count = derived().getSuccessors( n, s, c );
+		for (int a=0; a<count; a++)
+			v.relax( s[a], c[a] );
+	}
+	CostType getHeuristics( NodeType& n1 , NodeType& n2 ) { return ( (CostType)0 ); }
+	bool stopSearch( NodeType& n , NodeType& target ) { return ( n == target ); }
+
+protected:
+	Derived& derived(void) { return ( *static_cast<Derived*>(this) ); }
+};
+
+// The default heuristic: the graph's own
+template <class Graph>
+class Static_graph_heuristic
+{
+public:
+	typename Graph::CostType operator()( Graph& graph , typename Graph::NodeType& n1 , typename Graph::NodeType& n2 )
+		{ return ( graph.getHeuristics( n1, n2 ) ); }
+};
+
+// -----------------------------
+// The default closed list: nodes in hash bins given by Graph::getHashBin, kept between searches.
+
+template <class Graph, class PlannerSpecificVariables>
+class Static_hash_node_store
+{
+public:
+	typedef  typename Graph::NodeType  NodeType;
+	typedef  typename Graph::CostType  CostType;
+	typedef  SearchGraphNode< NodeType, CostType, PlannerSpecificVariables >  GraphNode;
+
+	Graph* graph;
+	std::vector< std::vector< GraphNode* > > bins;
+	BumpArena< GraphNode > nodeArena;
+	unsigned int searchGeneration; // See HashTableContainer::searchGeneration
+
+	Static_hash_node_store() { graph = NULL; searchGeneration = 1; }
+	void newSearch( Graph& theGraph );
+	GraphNode* get( NodeType& n );
+	int nodeCount(void) { return ( nodeArena.allocatedCount() ); }
+};
+
+// -----------------------------
+// Adapter from the generic graph description of the other planners
+
+template <class NodeType_, class CostType_>
+class Static_generic_graph : public Static_graph< Static_generic_graph<NodeType_,CostType_>, NodeType_, CostType_ >
+{
+public:
+	typedef  NodeType_  NodeType;
+	typedef  CostType_  CostType;
+
+	GenericSearchGraphDescriptor<NodeType,CostType>* descriptor; // The seeds and the target are not used
+	std::vector< NodeType > neighbourBuffer;
+	std::vector< CostType > transitionCostBuffer;
+
+	Static_generic_graph( GenericSearchGraphDescriptor<NodeType,CostType>* theEnv_p=NULL ) { descriptor = theEnv_p; }
+	template <class Visitor>
+	void forEachSuccessor( NodeType& n , Visitor& v )
+	{
+		descriptor->_getSuccessors( n , &neighbourBuffer , &transitionCostBuffer );
+		for (int a=0; a<neighbourBuffer.size(); a++)
+			v.relax( neighbourBuffer[a], transitionCostBuffer[a] );
+	}
+	CostType getHeuristics( NodeType& n1 , NodeType& n2 ) { return ( descriptor->_getHeuristics( n1, n2 ) ); }
+	bool stopSearch( NodeType& n , NodeType& target ) { return ( descriptor->_stopSearch( n ) ); }
+	int getHashBin( NodeType& n ) { return ( descriptor->_getHashBin( n ) ); }
+	int getHashTableSize(void) { return ( descriptor->hashTableSize ); }
+};
+
+// -----------------------------
+
+template < class Graph,
+           class Heuristic = Static_graph_heuristic< Graph >,
+           class NodeStore = Static_hash_node_store< Graph, Static_A_star_variables<typename Graph::CostType> >,
+           class OpenList = HeapContainer< typename Graph::NodeType, typename Graph::CostType,
+                                           Static_A_star_variables<typename Graph::CostType> > >
+class Static_A_star_planner
+{
+public:
+	// typedef's for convenience:
+	typedef  typename Graph::NodeType  NodeType;
+	typedef  typename Graph::CostType  CostType;
+	typedef  Static_A_star_variables<CostType>  PlannerSpecificVariables;
+	typedef  SearchGraphNode< NodeType, CostType, PlannerSpecificVariables >*  GraphNode_p;
+
+	Graph* graph;
+	Heuristic heuristic;
+	NodeStore store;
+	OpenList heap;
+
+	// Member variables
+	NodeType SeedNode, TargetNode;
+	GraphNode_p goalNode; // The node the search stopped at, NULL if none
+	GraphNode_p currentNode; // The node being expanded
+	int expandcount;
+
+	// Initializer and planner
+	Static_A_star_planner() { graph = NULL; goalNode = NULL; currentNode = NULL; expandcount = 0; }
+	void setParams( int heapMd=HEAP_MODE_DARY ) // call to this is optional (HeapContainer open lists only).
+		{ heap.mode = heapMd; }
+	// Starts a search on theGraph (which must outlive the planner's use of it) from 'seed' to 'target'.
+	//   The node store decides what is kept from the last search.
+	void init( Graph* theGraph , NodeType seed , NodeType target );
+	void plan(void);
+	// Called back by Graph::forEachSuccessor for every successor of 'currentNode'
+	inline void relax( NodeType& n , CostType cost );
+
+	// Planner output access: ( to be called after plan() )
+	bool pathFound(void) { return ( goalNode != NULL ); }
+	CostType getPlannedPathCost(void) { return ( goalNode ? goalNode->plannerVars.g : (CostType)0 ); }
+	std::vector< NodeType > getPlannedPath(void); // From the seed to the goal. Empty if there is none.
+};
+
+// ------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------
+// Since we use templates, the definitions need to be included in the header file as well.
+
+#include "Static_A_star.cpp"
+
+#endif
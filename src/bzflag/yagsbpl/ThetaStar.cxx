@@ -0,0 +1,158 @@
+/* ThetaStar.cxx
+ *
+ * See ThetaStar.h
+ */
+
+// interface header
+#include "ThetaStar.h"
+
+/* system implementation headers */
+#include <algorithm>
+#include <math.h>
+
+
+// the 8 neighbours of a node, and what it costs to move there
+static const int neighbourDx[8]   = {-1, -1, -1,  0,  0,  1,  1,  1};
+static const int neighbourDy[8]   = {-1,  0,  1, -1,  1, -1,  0,  1};
+static const int neighbourCost[8] = {DIAGONAL_COST, STRAIGHT_COST, DIAGONAL_COST,
+                                     STRAIGHT_COST,                STRAIGHT_COST,
+                                     DIAGONAL_COST, STRAIGHT_COST, DIAGONAL_COST};
+
+
+/* Straight-line cost between two nodes, in STRAIGHT_COST units per cell.  Rounded down, so that
+ * it stays admissible as a heuristic.
+ */
+static inline int euclideanCost(int dx, int dy) {
+  return (int)(STRAIGHT_COST * sqrtf((float)(dx * dx + dy * dy)));
+}
+
+
+ThetaStarPlanner::ThetaStarPlanner() : expandCount(0), lineOfSightCount(0) {
+}
+
+
+bool ThetaStarPlanner::plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path) {
+  OccupancyGrid &grid = OCCUPANCYGRID;
+  if (!grid.isBuilt())
+    grid.build();
+  return plan(grid, start, goal, path);
+}
+
+
+bool ThetaStarPlanner::plan(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal,
+                            std::vector<MyNode> &path) {
+  path.clear();
+  expandCount = 0;
+  lineOfSightCount = 0;
+  store.reset(grid);
+
+  if (!store.contains(start.x, start.y) || !store.contains(goal.x, goal.y))
+    return false;
+
+  // index offsets of the 8 neighbours, in the same order as neighbourDx/neighbourDy
+  const int size = store.getSize();
+  int neighbourOffset[8];
+  for (int k = 0; k < 8; k++)
+    neighbourOffset[k] = neighbourDx[k] * size + neighbourDy[k];
+
+  const int startIndex = store.getIndex(start.x, start.y);
+  const int goalIndex  = store.getIndex(goal.x, goal.y);
+
+  // the start node is always allowed, even if the tank is touching a building.  It is its own
+  // parent, so that its successors can inherit it like any other parent.
+  store.visit(startIndex);
+  store[startIndex].g = 0;
+  store[startIndex].f = euclideanCost(goal.x - start.x, goal.y - start.y);
+  store[startIndex].parent = startIndex;
+  store.pushOrDecrease(startIndex);
+
+  while (!store.openEmpty()) {
+    const int current = store.popMin();
+    expandCount++;
+    const int cx = store.getX(current);
+    const int cy = store.getY(current);
+    GridNode &currentNode = store[current];
+
+    // the parent was taken on trust when this node was generated: check it now, and if it is
+    // out of sight, go through the best expanded neighbour instead (one is always in sight)
+    const int parent = currentNode.parent;
+    const int px0 = store.getX(parent);
+    const int py0 = store.getY(parent);
+    // a neighbouring parent is one step of the graph away, which is always allowed
+    if (abs(px0 - cx) > 1 || abs(py0 - cy) > 1) {
+      lineOfSightCount++;
+      if (!grid.isLineOpen(px0, py0, cx, cy)) {
+        currentNode.g = 0x7fffffff;
+        for (int k = 0; k < 8; k++) {
+          const int nx = cx + neighbourDx[k];
+          const int ny = cy + neighbourDy[k];
+          if (!store.contains(nx, ny))
+            continue;
+          const int next = current + neighbourOffset[k];
+          if (!store.isClosed(next))
+            continue;
+          const int g = store[next].g + neighbourCost[k];
+          if (g < currentNode.g) {
+            currentNode.g = g;
+            currentNode.parent = next;
+          }
+        }
+      }
+    }
+
+    if (current == goalIndex) {
+      // walk back to the start, then flip it around
+      for (int i = goalIndex; ; i = store[i].parent) {
+        MyNode node;
+        node.x = store.getX(i);
+        node.y = store.getY(i);
+        path.push_back(node);
+        if (i == startIndex)
+          break;
+      }
+      std::reverse(path.begin(), path.end());
+      return true;
+    }
+
+    store.close(current);
+    const int currentG = currentNode.g;
+    const int currentParent = currentNode.parent;
+    const int px = store.getX(currentParent);
+    const int py = store.getY(currentParent);
+    const int parentG = store[currentParent].g;
+
+    for (int k = 0; k < 8; k++) {
+      const int nx = cx + neighbourDx[k];
+      const int ny = cy + neighbourDy[k];
+      // the grid and the store cover the same cells, so this is also the bounds check
+      if (!grid.isAccessible(nx, ny))
+        continue;
+
+      const int next = current + neighbourOffset[k];
+      if (!store.isVisited(next))
+        store.visit(next);
+      else if (store.isClosed(next))
+        continue;
+
+      // path 2 of Theta*: straight from the parent, assuming it can see the neighbour
+      int g, nextParent;
+      if (currentParent != current) {
+        g = parentG + euclideanCost(nx - px, ny - py);
+        nextParent = currentParent;
+      } else {
+        g = currentG + neighbourCost[k];
+        nextParent = current;
+      }
+      GridNode &node = store[next];
+      if (g >= node.g)
+        continue;
+      node.g = g;
+      node.f = g + euclideanCost(goal.x - nx, goal.y - ny);
+      node.parent = nextParent;
+      store.pushOrDecrease(next);
+    }
+  }
+
+  // no path
+  return false;
+}
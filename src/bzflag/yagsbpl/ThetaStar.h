@@ -0,0 +1,65 @@
+/* ThetaStar.h
+ *
+ * Lazy Theta*: any-angle A* over the OccupancyGrid tile graph.
+ *
+ * Plain A* only moves between neighbouring cells, so its paths zig-zag in 45 degree steps and
+ * RobotPlayer::smoothPath() has to cast a ray per node afterwards to straighten them.  Theta*
+ * straightens the path during the search instead: a node may take its parent's parent as its own
+ * parent when the two can see each other, so the path ends up as a short list of turning points.
+ * The lazy variant assumes the grandparent is in sight when the node is generated, and only checks
+ * once the node is expanded (falling back to the best expanded neighbour if it is not), which
+ * takes one line-of-sight check per expanded node instead of one per generated node.
+ *
+ * Costs are Euclidean, in the same units as the octile costs (STRAIGHT_COST per cell), and line of
+ * sight is OccupancyGrid::isLineOpen().
+ *
+ * See: A. Nash, S. Koenig and C. Tovey, "Lazy Theta*: Any-Angle Path Planning and Path Length
+ * Analysis in 3D", AAAI 2010.
+ */
+
+#ifndef THETASTAR_H_
+#define THETASTAR_H_
+
+/* system interface headers */
+#include <vector>
+
+/* local interface headers */
+#include "GraphFunctionContainerUnified.h"
+#include "GridNodeStore.h"
+
+
+class ThetaStarPlanner {
+public:
+  ThetaStarPlanner();
+
+  /* Finds an any-angle path from the start node to the goal node.
+   * @param start The node from which to start the search.
+   * @param goal The search will try to find a path to this node.
+   * @param path Writes the turning points here, from start to goal (inclusive).  Each one can see
+   *             the next.  Cleared if there is no path.
+   * @return True if a path was found, false otherwise.
+   */
+  bool plan(const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* Same as above, on the given grid instead of the shared OccupancyGrid.  The grid is only read,
+   * so planners that do not share state can search the same grid from several threads.
+   * @param grid The raster to search, already built (e.g. an OccupancyGrid::snapshot()).
+   */
+  bool plan(const OccupancyGrid &grid, const MyNode &start, const MyNode &goal, std::vector<MyNode> &path);
+
+  /* The number of nodes expanded by the last call to plan().
+   */
+  int getExpandCount() const { return expandCount; }
+
+  /* The number of line-of-sight checks made by the last call to plan().
+   */
+  int getLineOfSightCount() const { return lineOfSightCount; }
+
+private:
+  GridNodeStore store;
+  int expandCount;
+  int lineOfSightCount;
+};
+
+
+#endif /* THETASTAR_H_ */
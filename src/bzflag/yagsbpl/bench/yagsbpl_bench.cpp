@@ -0,0 +1,361 @@
+/******************************************************************************************
+*                                                                                        *
+*    Benchmarks for the YAGSBPL containers and planners used by the robots.              *
+*                                                                                        *
+*    Self-contained: runs on synthetic 8-connected grids with random obstacles, so it    *
+*    does not need a world, a server or a display.                                       *
+*                                                                                        *
+*    Build:  make yagsbpl_bench   (from src/bzflag)                                      *
+*    Usage:  yagsbpl_bench [gridSize] [obstacleDensity] [queries] [seed]                 *
+*                                                                                        *
+******************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <ctime>
+#include <vector>
+#include "../yagsbpl_base.h"
+#include "../A_star.h"
+#include "../Static_A_star.h"
+
+// =============================================================================
+// Synthetic grid
+
+class BenchGrid
+{
+public:
+	int size;
+	std::vector<char> blocked;
+
+	BenchGrid(int gridSize, double density, unsigned int seed)
+	{
+		size = gridSize;
+		blocked.assign(size*size, 0);
+		srand(seed);
+		// Random rectangular "buildings", like a BZFlag map
+		int numBoxes = (int)(density * size * size / 24.0);
+		for (int a=0; a<numBoxes; a++)
+		{
+			int w = 1 + rand() % 8, h = 1 + rand() % 8;
+			int x0 = rand() % size, y0 = rand() % size;
+			for (int x=x0; x<x0+w && x<size; x++)
+				for (int y=y0; y<y0+h && y<size; y++)
+					blocked[y*size+x] = 1;
+		}
+	}
+	bool isAccessible(int x, int y) { return ( x>=0 && y>=0 && x<size && y<size && !blocked[y*size+x] ); }
+	void randomFreeCell(int& x, int& y)
+	{
+		do { x = rand() % size; y = rand() % size; } while ( !isAccessible(x, y) );
+	}
+};
+
+// Elapsed wall time in microseconds
+static double bench_usec(clock_t startclock)
+{
+	return ( 1.0e6 * (double)(clock()-startclock) / (double)CLOCKS_PER_SEC );
+}
+
+// =============================================================================
+// Open list benchmark: A* over the grid driving the container directly through push/pop/update,
+//   the same way A_star_planner does.
+
+class BenchNodeVars
+{
+public:
+	bool expanded;
+	bool opened;
+};
+
+struct HeapBenchResult
+{
+	double usec;
+	long expansions;
+	long pathCost;
+	int peakSize;
+};
+
+template <class CostType, class Heap>
+HeapBenchResult bench_heap(BenchGrid& grid, Heap& heap, int sx, int sy, int gx, int gy, bool octile)
+{
+	typedef SearchGraphNode<int,CostType,BenchNodeVars> Node;
+	const int size = grid.size;
+	std::vector<Node> nodes(size*size);
+	std::vector<CostType> g(size*size, (CostType)0);
+	HeapBenchResult res;
+	res.expansions = 0; res.pathCost = -1; res.peakSize = 0;
+
+	clock_t startclock = clock();
+	int start = sy*size + sx, goal = gy*size + gx;
+	for (int a=0; a<size*size; a++)
+	{
+		nodes[a].n = a;
+		nodes[a].plannerVars.expanded = false;
+		nodes[a].plannerVars.opened = false;
+	}
+	heap.clear();
+	nodes[start].f = 0;
+	nodes[start].plannerVars.opened = true;
+	heap.push(&nodes[start]);
+
+	while ( !heap.empty() )
+	{
+		if (heap.size() > res.peakSize)
+			res.peakSize = heap.size();
+		Node* np = heap.pop();
+		np->plannerVars.expanded = true;
+		res.expansions++;
+		if (np->n == goal)
+		{
+			res.pathCost = (long)g[goal];
+			break;
+		}
+		int x = np->n % size, y = np->n / size;
+		for (int i=-1; i<=1; i++)
+			for (int j=-1; j<=1; j++)
+			{
+				if ( (i==0 && j==0) || !grid.isAccessible(x+i, y+j) )
+					continue;
+				int nn = (y+j)*size + (x+i);
+				if (nodes[nn].plannerVars.expanded)
+					continue;
+				CostType step = octile ? (CostType)((i && j) ? 14 : 10) : (CostType)(10.0*sqrt((double)(i*i+j*j)));
+				CostType newg = g[np->n] + step;
+				if (nodes[nn].plannerVars.opened && newg >= g[nn])
+					continue;
+				int dx = abs(gx-(x+i)), dy = abs(gy-(y+j));
+				CostType h = octile ? (CostType)((dx<dy) ? (14*dx + 10*(dy-dx)) : (14*dy + 10*(dx-dy)))
+										: (CostType)(10.0*hypot((double)dx, (double)dy));
+				g[nn] = newg;
+				nodes[nn].f = newg + h;
+				if (nodes[nn].plannerVars.opened)
+					heap.update(&nodes[nn]);
+				else
+				{
+					nodes[nn].plannerVars.opened = true;
+					heap.push(&nodes[nn]);
+				}
+			}
+	}
+	res.usec = bench_usec(startclock);
+	heap.clear();
+	return (res);
+}
+
+static void print_heap_result(const char* name, std::vector<HeapBenchResult>& r)
+{
+	double usec = 0.0; long exp = 0; int peak = 0;
+	for (int a=0; a<r.size(); a++)
+	{
+		usec += r[a].usec;
+		exp += r[a].expansions;
+		if (r[a].peakSize > peak)
+			peak = r[a].peakSize;
+	}
+	printf("  %-32s %12.1f us/query %10ld expansions/query  peak open list %d\n",
+				name, usec / r.size(), exp / (long)r.size(), peak);
+}
+
+static void bench_open_lists(BenchGrid& grid, int queries)
+{
+	std::vector<int> sx(queries), sy(queries), gx(queries), gy(queries);
+	for (int q=0; q<queries; q++)
+	{
+		grid.randomFreeCell(sx[q], sy[q]);
+		grid.randomFreeCell(gx[q], gy[q]);
+	}
+
+	std::vector<HeapBenchResult> listRes, daryRes, daryIntRes, bucketRes;
+	KeyedListHeapContainer<int,double,BenchNodeVars> listHeap(20);
+	HeapContainer<int,double,BenchNodeVars> daryHeap(HEAP_MODE_DARY);
+	HeapContainer<int,int,BenchNodeVars> daryIntHeap(HEAP_MODE_DARY);
+	HeapContainer<int,int,BenchNodeVars> bucketHeap(HEAP_MODE_BUCKET);
+	for (int q=0; q<queries; q++)
+	{
+		listRes.push_back( bench_heap<double>(grid, listHeap, sx[q], sy[q], gx[q], gy[q], false) );
+		daryRes.push_back( bench_heap<double>(grid, daryHeap, sx[q], sy[q], gx[q], gy[q], false) );
+		daryIntRes.push_back( bench_heap<int>(grid, daryIntHeap, sx[q], sy[q], gx[q], gy[q], true) );
+		bucketRes.push_back( bench_heap<int>(grid, bucketHeap, sx[q], sy[q], gx[q], gy[q], true) );
+		// Sanity check: the containers must agree on the optimal cost
+		if ( daryIntRes[q].pathCost != bucketRes[q].pathCost )
+			printf("  MISMATCH on query %d: d-ary %ld, bucket %ld\n", q, daryIntRes[q].pathCost, bucketRes[q].pathCost);
+	}
+
+	printf("Open list (A* on the grid, %d queries):\n", queries);
+	print_heap_result("keyed list, double sqrt costs", listRes);
+	print_heap_result("4-ary heap, double sqrt costs", daryRes);
+	print_heap_result("4-ary heap, int octile costs", daryIntRes);
+	print_heap_result("bucket queue, int octile costs", bucketRes);
+}
+
+// =============================================================================
+// Planner benchmark: A_star_planner, which reaches the graph through virtual functions and
+//   std::vectors, against Static_A_star_planner on the same graph, both through the
+//   Static_generic_graph adapter and with the graph as a template parameter.
+
+static inline int bench_octile(int dx, int dy)
+{
+	dx = abs(dx); dy = abs(dy);
+	return ( (dx<dy) ? (14*dx + 10*(dy-dx)) : (14*dy + 10*(dx-dy)) );
+}
+
+// A cell of the grid. A_star_planner wants a class for its node type.
+class BenchCell
+{
+public:
+	int id; // y*size + x
+	bool operator==(const BenchCell& c) const { return ( id == c.id ); }
+};
+
+static inline BenchCell bench_cell(int id) { BenchCell c; c.id = id; return (c); }
+
+// The grid for the generic planners: one hash bin per cell.
+class BenchGraphFunctions : public SearchGraphDescriptorFunctionContainer<BenchCell,int>
+{
+public:
+	BenchGrid* grid;
+
+	BenchGraphFunctions(BenchGrid* g) { grid = g; }
+	int getHashBin(BenchCell& n) { return (n.id); }
+	bool isAccessible(BenchCell& n) { return ( grid->isAccessible(n.id % grid->size, n.id / grid->size) ); }
+	void getSuccessors(BenchCell& n, std::vector<BenchCell>* s, std::vector<int>* c)
+	{
+		s->clear(); c->clear();
+		int x = n.id % grid->size, y = n.id / grid->size;
+		for (int i=-1; i<=1; i++)
+			for (int j=-1; j<=1; j++)
+				if ( (i || j) && grid->isAccessible(x+i, y+j) )
+				{
+					s->push_back( bench_cell((y+j)*grid->size + (x+i)) );
+					c->push_back( (i && j) ? 14 : 10 );
+				}
+	}
+	int getHeuristics(BenchCell& n1, BenchCell& n2)
+		{ return ( bench_octile(n2.id % grid->size - n1.id % grid->size, n2.id / grid->size - n1.id / grid->size) ); }
+};
+
+// The same grid for Static_A_star_planner
+class BenchStaticGraph : public Static_graph<BenchStaticGraph,BenchCell,int>
+{
+public:
+	enum { MaxSuccessors = 8 };
+	BenchGrid* grid;
+
+	BenchStaticGraph(BenchGrid* g) { grid = g; }
+	inline int getSuccessors(BenchCell& n, BenchCell* s, int* c)
+	{
+		int count = 0;
+		int x = n.id % grid->size, y = n.id / grid->size;
+		for (int i=-1; i<=1; i++)
+			for (int j=-1; j<=1; j++)
+				if ( (i || j) && grid->isAccessible(x+i, y+j) )
+				{
+					s[count].id = (y+j)*grid->size + (x+i);
+					c[count] = (i && j) ? 14 : 10;
+					count++;
+				}
+		return (count);
+	}
+	inline int getHeuristics(BenchCell& n1, BenchCell& n2)
+		{ return ( bench_octile(n2.id % grid->size - n1.id % grid->size, n2.id / grid->size - n1.id / grid->size) ); }
+	inline int getHashBin(BenchCell& n) { return (n.id); }
+	int getHashTableSize(void) { return ( grid->size * grid->size ); }
+};
+
+static void bench_planners(BenchGrid& grid, int queries)
+{
+	std::vector<BenchCell> start(queries), goal(queries);
+	for (int q=0; q<queries; q++)
+	{
+		int x, y;
+		grid.randomFreeCell(x, y);
+		start[q].id = y*grid.size + x;
+		grid.randomFreeCell(x, y);
+		goal[q].id = y*grid.size + x;
+	}
+
+	BenchGraphFunctions functions(&grid);
+	GenericSearchGraphDescriptor<BenchCell,int> descriptor;
+	descriptor.func_container = &functions;
+	descriptor.hashTableSize = grid.size * grid.size;
+	Static_generic_graph<BenchCell,int> adaptedGraph(&descriptor);
+	BenchStaticGraph staticGraph(&grid);
+
+	// One planner each, kept between the queries as the robots do
+	A_star_planner<BenchCell,int> genericPlanner;
+	genericPlanner.setParams(1.0, HEAP_MODE_BUCKET);
+	Static_A_star_planner< Static_generic_graph<BenchCell,int> > adaptedPlanner;
+	adaptedPlanner.setParams(HEAP_MODE_BUCKET);
+	Static_A_star_planner< BenchStaticGraph > staticPlanner;
+	staticPlanner.setParams(HEAP_MODE_BUCKET);
+
+	double genericUsec = 0.0, adaptedUsec = 0.0, staticUsec = 0.0;
+	long genericExp = 0, adaptedExp = 0, staticExp = 0;
+	bool genericInit = false;
+	for (int q=0; q<queries; q++)
+	{
+		descriptor.SeedNodes.clear(); // init() adds SeedNode to the seeds
+		descriptor.SeedNode = start[q];
+		descriptor.TargetNode = goal[q];
+
+		clock_t startclock = clock();
+		if (genericInit)
+			genericPlanner.clearLastPlanAndInit(&descriptor);
+		else
+			genericPlanner.init(&descriptor);
+		genericInit = true;
+		genericPlanner.plan();
+		genericUsec += bench_usec(startclock);
+		genericExp += genericPlanner.counters.expanded;
+		std::vector<int> genericCosts = genericPlanner.getPlannedPathCosts();
+		long genericCost = genericCosts.size() ? genericCosts[0] : -1;
+
+		startclock = clock();
+		adaptedPlanner.init(&adaptedGraph, start[q], goal[q]);
+		adaptedPlanner.plan();
+		adaptedUsec += bench_usec(startclock);
+		adaptedExp += adaptedPlanner.expandcount;
+		long adaptedCost = adaptedPlanner.pathFound() ? adaptedPlanner.getPlannedPathCost() : -1;
+
+		startclock = clock();
+		staticPlanner.init(&staticGraph, start[q], goal[q]);
+		staticPlanner.plan();
+		staticUsec += bench_usec(startclock);
+		staticExp += staticPlanner.expandcount;
+		long staticCost = staticPlanner.pathFound() ? staticPlanner.getPlannedPathCost() : -1;
+
+		// Sanity check: the planners must agree on the optimal cost
+		if ( genericCost != adaptedCost || genericCost != staticCost )
+			printf("  MISMATCH on query %d: A_star %ld, adapter %ld, static %ld\n", q, genericCost, adaptedCost, staticCost);
+	}
+
+	printf("Planner (A* on the grid, int octile costs, bucket queue, %d queries):\n", queries);
+	printf("  %-32s %12.1f us/query %10ld expansions/query\n", "A_star_planner",
+				genericUsec / queries, genericExp / (long)queries);
+	printf("  %-32s %12.1f us/query %10ld expansions/query\n", "Static_A_star, generic adapter",
+				adaptedUsec / queries, adaptedExp / (long)queries);
+	printf("  %-32s %12.1f us/query %10ld expansions/query\n", "Static_A_star, static graph",
+				staticUsec / queries, staticExp / (long)queries);
+}
+
+// =============================================================================
+
+int main(int argc, char* argv[])
+{
+	int gridSize = (argc > 1) ? atoi(argv[1]) : 370; // 800-unit world at SCALE = 0.5*tankRadius
+	double density = (argc > 2) ? atof(argv[2]) : 0.15;
+	int queries = (argc > 3) ? atoi(argv[3]) : 50;
+	unsigned int seed = (argc > 4) ? atoi(argv[4]) : 1;
+
+	BenchGrid grid(gridSize, density, seed);
+	printf("Grid %dx%d, obstacle density %.2f, seed %u\n\n", gridSize, gridSize, density, seed);
+
+	srand(seed);
+	bench_open_lists(grid, queries);
+	printf("\n");
+	bench_planners(grid, queries);
+
+	return 0;
+}
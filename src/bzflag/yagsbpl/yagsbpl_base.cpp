@@ -26,7 +26,217 @@
 
 
 template <class NodeType, class CostType, class PlannerSpecificVariables>
-void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::push 
+void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::sift_up (int pos)
+{
+	heapItem_p item = items[pos];
+	while (pos > 0)
+	{
+		int parent = (pos-1) / arity;
+		if ( !less(item, items[parent]) )
+			break;
+		items[pos] = items[parent];
+		items[pos]->heapIndex = pos;
+		pos = parent;
+	}
+	items[pos] = item;
+	item->heapIndex = pos;
+}
+
+
+template <class NodeType, class CostType, class PlannerSpecificVariables>
+void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::sift_down (int pos)
+{
+	heapItem_p item = items[pos];
+	int count = items.size();
+	while (true)
+	{
+		int firstChild = arity*pos + 1;
+		if (firstChild >= count)
+			break;
+		int lastChild = firstChild + arity;
+		if (lastChild > count)
+			lastChild = count;
+		// Find the smallest child
+		int best = firstChild;
+		for (int c=firstChild+1; c<lastChild; c++)
+			if ( less(items[c], items[best]) )
+				best = c;
+		if ( !less(items[best], item) )
+			break;
+		items[pos] = items[best];
+		items[pos]->heapIndex = pos;
+		pos = best;
+	}
+	items[pos] = item;
+	item->heapIndex = pos;
+}
+
+
+template <class NodeType, class CostType, class PlannerSpecificVariables>
+void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::push
+									( SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* np )
+{
+	np->inHeap = true;
+	heap_size++;
+	
+	if (mode == HEAP_MODE_BUCKET)
+	{
+		long key = bucket_key(np);
+		if (heap_size == 1)
+		{
+			// Re-center the buckets on the first node so that they stay small
+			for (int a=0; a<buckets.size(); a++)
+				buckets[a].clear();
+			bucketBase = key;
+			bucketCursor = 0;
+		}
+		else if (key < bucketBase)
+		{
+			// Only happens with an inconsistent heuristic. Grow the bucket array downwards.
+			buckets.insert( buckets.begin(), bucketBase-key, std::vector<heapItem_p>() );
+			bucketCursor += bucketBase-key;
+			bucketBase = key;
+		}
+		int b = key - bucketBase;
+		if (b >= buckets.size())
+			buckets.resize(b+1);
+		if (b < bucketCursor)
+			bucketCursor = b;
+		np->heapKey = key;
+		np->heapIndex = buckets[b].size();
+		buckets[b].push_back(np);
+		return;
+	}
+	
+	items.push_back(np);
+	sift_up(items.size()-1);
+}
+
+
+template <class NodeType, class CostType, class PlannerSpecificVariables>
+SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* HeapContainer<NodeType,CostType,PlannerSpecificVariables>::pop(void)
+{
+	heapItem_p ret;
+	
+	if (mode == HEAP_MODE_BUCKET)
+	{
+		while ( buckets[bucketCursor].empty() )
+			bucketCursor++;
+		// Last in, first out within a bucket: favours the most recently generated (deepest) nodes.
+		ret = buckets[bucketCursor].back();
+		buckets[bucketCursor].pop_back();
+	}
+	else
+	{
+		ret = items[0];
+		items[0] = items.back();
+		items.pop_back();
+		if (!items.empty())
+			sift_down(0);
+	}
+	
+	ret->inHeap = false;
+	ret->heapIndex = -1;
+	heap_size--;
+	return ret;
+}
+
+
+template <class NodeType, class CostType, class PlannerSpecificVariables>
+SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* HeapContainer<NodeType,CostType,PlannerSpecificVariables>::top(void)
+{
+	if (mode == HEAP_MODE_BUCKET)
+	{
+		while ( buckets[bucketCursor].empty() )
+			bucketCursor++;
+		return ( buckets[bucketCursor].back() );
+	}
+	return ( items[0] );
+}
+
+
+template <class NodeType, class CostType, class PlannerSpecificVariables>
+void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::remove (SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* np)
+{
+	int pos = np->heapIndex;
+	
+	if (mode == HEAP_MODE_BUCKET)
+	{
+		std::vector<heapItem_p>& bucket = buckets[np->heapKey - bucketBase];
+		bucket[pos] = bucket.back();
+		bucket[pos]->heapIndex = pos;
+		bucket.pop_back();
+	}
+	else
+	{
+		heapItem_p last = items.back();
+		items.pop_back();
+		if (last != np)
+		{
+			// Move the last item into the hole, then restore the heap property in whichever direction
+			items[pos] = last;
+			last->heapIndex = pos;
+			if ( pos > 0 && less(last, items[(pos-1)/arity]) )
+				sift_up(pos);
+			else
+				sift_down(pos);
+		}
+	}
+	
+	np->inHeap = false;
+	np->heapIndex = -1;
+	heap_size--;
+}
+
+
+template <class NodeType, class CostType, class PlannerSpecificVariables>
+void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::update (SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* np)
+{
+	if (mode == HEAP_MODE_BUCKET)
+	{
+		if ( bucket_key(np) != np->heapKey )
+		{
+			remove(np);
+			push(np);
+		}
+		return;
+	}
+	
+	// The key may have moved either way (D* Lite raises keys as well as lowering them)
+	int pos = np->heapIndex;
+	sift_up(pos);
+	if (np->heapIndex == pos)
+		sift_down(pos);
+}
+
+
+template <class NodeType, class CostType, class PlannerSpecificVariables>
+void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::clear (void)
+{
+	for (int a=0; a<items.size(); a++)
+	{
+		items[a]->inHeap = false;
+		items[a]->heapIndex = -1;
+	}
+	items.clear();
+	for (int a=0; a<buckets.size(); a++)
+	{
+		for (int b=0; b<buckets[a].size(); b++)
+		{
+			buckets[a][b]->inHeap = false;
+			buckets[a][b]->heapIndex = -1;
+		}
+		buckets[a].clear();
+	}
+	bucketCursor = 0;
+	heap_size = 0;
+}
+
+// -------------
+
+
+template <class NodeType, class CostType, class PlannerSpecificVariables>
+void KeyedListHeapContainer<NodeType,CostType,PlannerSpecificVariables>::push 
 									( SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* np, 
 										SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* searchStart )
 {
@@ -87,7 +297,7 @@ void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::push
 
 
 template <class NodeType, class CostType, class PlannerSpecificVariables>
-SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* HeapContainer<NodeType,CostType,PlannerSpecificVariables>::pop(void)
+SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* KeyedListHeapContainer<NodeType,CostType,PlannerSpecificVariables>::pop(void)
 {
 	heapItem_p ret;
 	ret = end;
@@ -114,7 +324,7 @@ SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* HeapContainer<NodeT
 
 
 template <class NodeType, class CostType, class PlannerSpecificVariables>
-void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::remove (SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* np)
+void KeyedListHeapContainer<NodeType,CostType,PlannerSpecificVariables>::remove (SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* np)
 {
 	key_remove(np);
 	
@@ -138,7 +348,7 @@ void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::remove (SearchGr
 
 
 template <class NodeType, class CostType, class PlannerSpecificVariables>
-void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::key_init(heapItem_p item)
+void KeyedListHeapContainer<NodeType,CostType,PlannerSpecificVariables>::key_init(heapItem_p item)
 {
 	for (int a=0; a<keyCount; a++)
 	{
@@ -149,7 +359,7 @@ void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::key_init(heapIte
 
 
 template <class NodeType, class CostType, class PlannerSpecificVariables>
-void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::key_update(heapItem_p item)
+void KeyedListHeapContainer<NodeType,CostType,PlannerSpecificVariables>::key_update(heapItem_p item)
 		// To be called after instering item into heap
 {
 	if ( heap_size<=1 || start->f==end->f )
@@ -183,7 +393,7 @@ void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::key_update(heapI
 
 
 template <class NodeType, class CostType, class PlannerSpecificVariables>
-void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::key_remove(heapItem_p item)
+void KeyedListHeapContainer<NodeType,CostType,PlannerSpecificVariables>::key_remove(heapItem_p item)
 			// should be called before the nxt and prev are set to NULL.
 {
 	int itemTentativePos;
@@ -237,7 +447,7 @@ void HeapContainer<NodeType,CostType,PlannerSpecificVariables>::key_remove(heapI
 
 template <class NodeType, class CostType, class PlannerSpecificVariables>
 SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* 
-						HeapContainer<NodeType,CostType,PlannerSpecificVariables>::key_find (CostType f)
+						KeyedListHeapContainer<NodeType,CostType,PlannerSpecificVariables>::key_find (CostType f)
 {
 	CostType fRes = (start->f - end->f) / keyCountP1;
 	int pos = keyCount / 2; // level=2 to start with.
@@ -435,25 +645,56 @@ SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>*
 	// A SIGSEGV signal generated from here most likely 'getHashBin' returned a bin index larger than (hashTableSize-1).
 	for (int a=0; a<HashTable[hashBin].size(); a++)
 		if ( HashTable[hashBin][a]->n == n )
-			return (HashTable[hashBin][a]);
+		{
+			collisions += a;
+			return ( refresh(HashTable[hashBin][a]) );
+		}
+	collisions += HashTable[hashBin].size();
 	
 	// If new node, create it!
-	SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* newSearchGraphNode = 
-															new SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>;
+	SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* newSearchGraphNode = nodeArena.allocate();
 	newSearchGraphNode->n = n; // WARNING: Nothing else is set yet!
+	newSearchGraphNode->searchGeneration = searchGeneration;
 	if ( HashTable[hashBin].capacity() <= HashTable[hashBin].size()+1 )
 		HashTable[hashBin].reserve( HashTable[hashBin].capacity() + friendGraphDescriptor_p->hashBinSizeIncreaseStep );
 	HashTable[hashBin].push_back(newSearchGraphNode);
 	return ( newSearchGraphNode );
 }
 
+template <class NodeType, class CostType, class PlannerSpecificVariables>
+void HashTableContainer<NodeType,CostType,PlannerSpecificVariables>::initLinks
+						(NodeLinks<NodeType,CostType,PlannerSpecificVariables>& links, int count)
+{
+	links.init( count, linkTargetArena.allocate(count), linkCostArena.allocate(count) );
+}
+
+template <class NodeType, class CostType, class PlannerSpecificVariables>
+void HashTableContainer<NodeType,CostType,PlannerSpecificVariables>::newSearchGeneration(void)
+{
+	searchGeneration++;
+	// On wrap-around, stale stamps could collide with the new generation: reset them all.
+	if (searchGeneration == 0)
+	{
+		for (int a=0; a<hashTableSize; a++)
+			for (int b=0; b<HashTable[a].size(); b++)
+			{
+				HashTable[a][b]->initiated = false;
+				HashTable[a][b]->searchGeneration = 0;
+			}
+		searchGeneration = 1;
+	}
+}
+
 // =================================================================================
 
 
 template <class NodeType, class CostType, class PlannerSpecificVariables>
 void GenericPlanner<NodeType,CostType,PlannerSpecificVariables>::init
-						( GenericSearchGraphDescriptor<NodeType,CostType> theEnv , int heapKeyNum )
+						( GenericSearchGraphDescriptor<NodeType,CostType> theEnv , int heapMode )
 {
+	// Calling init again starts over with an empty hash table
+	delete GraphDescriptor; delete hash; delete heap;
+	
 	GraphDescriptor = new GenericSearchGraphDescriptor<NodeType,CostType>;
 	*GraphDescriptor = theEnv;
 	
@@ -461,7 +702,14 @@ void GenericPlanner<NodeType,CostType,PlannerSpecificVariables>::init
 	hash->friendGraphDescriptor_p = GraphDescriptor;
 	hash->init_HastTable( GraphDescriptor->hashTableSize );
 	
-	heap = new HeapContainer<NodeType,CostType,PlannerSpecificVariables>(heapKeyNum);
+	heap = new HeapContainer<NodeType,CostType,PlannerSpecificVariables>(heapMode);
 }
 
-
+template <class NodeType, class CostType, class PlannerSpecificVariables>
+void GenericPlanner<NodeType,CostType,PlannerSpecificVariables>::reinit
+						( GenericSearchGraphDescriptor<NodeType,CostType> theEnv )
+{
+	*GraphDescriptor = theEnv; // 'hash' keeps pointing to GraphDescriptor
+	hash->newSearchGeneration();
+	heap->clear();
+}
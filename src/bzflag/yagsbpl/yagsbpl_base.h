@@ -31,6 +31,11 @@
 #include <stdio.h>
 #include <vector>
 #include <cstdlib>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
 
 #define _yagsbpl_abs(x) ((x)>0?(x):(-x))
 
@@ -41,32 +46,113 @@ class SearchGraphNode;
 
 // ---
 
+// Bump allocator used by the hash table for nodes and their links.
+// Items are carved out of large blocks and are never freed individually: everything is released
+//   when the arena is destroyed. A planner that is kept alive between searches therefore stops
+//   allocating once the part of the graph it explores has been created.
+template <class T>
+class BumpArena
+{
+public:
+	int blockSize; // Number of items in a block
+	std::vector<T*> blocks;
+	int lastBlockSize, lastBlockUsed;
+	
+	BumpArena(int block_size=4096) { blockSize = block_size; lastBlockSize = 0; lastBlockUsed = 0; }
+	T* allocate(int count=1)
+	{
+		if ( blocks.empty() || lastBlockUsed + count > lastBlockSize )
+		{
+			lastBlockSize = (count > blockSize) ? count : blockSize;
+			blocks.push_back( new T[lastBlockSize] );
+			lastBlockUsed = 0;
+		}
+		T* ret = blocks.back() + lastBlockUsed;
+		lastBlockUsed += count;
+		return (ret);
+	}
+	int allocatedCount(void) { return ( blocks.empty() ? 0 : (blocks.size()-1)*blockSize + lastBlockUsed ); }
+	~BumpArena() { for (int a=0; a<blocks.size(); a++) delete[] blocks[a]; }
+private:
+	BumpArena(const BumpArena&); // not copyable - would free the blocks twice
+	BumpArena& operator=(const BumpArena&);
+};
+
+// Wall clock time in seconds, from an arbitrary origin. Safe to call from any thread.
+inline double yagsbpl_wall_clock(void)
+{
+	#ifdef _WIN32
+		LARGE_INTEGER frequency, count;
+		QueryPerformanceFrequency(&frequency);
+		QueryPerformanceCounter(&count);
+		return ( (double)count.QuadPart / (double)frequency.QuadPart );
+	#else
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		return ( (double)now.tv_sec + 1.0e-6 * (double)now.tv_usec );
+	#endif
+}
+
+// Counters of one search, filled in by the planner as it goes. Cheap enough to leave on: the
+//   counts are plain increments, and the clock is read twice per plan and once for every
+//   'successorTimingInterval' calls to getSuccessors (the time of the others is estimated).
+class SearchCounters
+{
+public:
+	int expanded; // Nodes taken out of the open list
+	int generated; // Nodes put in the open list for the first time
+	int heapPeak; // Largest size of the open list
+	int hashCollisions; // Other nodes looked at in the hash bins while looking nodes up
+	int successorCalls; // Calls to getSuccessors (the other expansions reused the stored links)
+	double successorSeconds; // Time spent in getSuccessors (estimated from the timed calls)
+	double planSeconds; // Wall time spent in plan()
+	int inaccessibleSeeds; // Seed nodes that were not accessible (the search cannot start from them)
+	
+	int successorTimingInterval; // Times one call to getSuccessors in this many. 1 times them all.
+	int timedSuccessorCalls; // The calls that were timed, and their time
+	double timedSuccessorSeconds;
+	
+	SearchCounters() { successorTimingInterval = 16; reset(); }
+	void reset(void)
+	{
+		expanded = 0; generated = 0; heapPeak = 0; hashCollisions = 0; successorCalls = 0;
+		successorSeconds = 0.0; planSeconds = 0.0; inaccessibleSeeds = 0;
+		timedSuccessorCalls = 0; timedSuccessorSeconds = 0.0;
+	}
+	// Whether the next call to getSuccessors should be timed
+	bool timeNextSuccessorCall(void) { return ( successorCalls % successorTimingInterval == 0 ); }
+	// Scales the timed calls up to all the calls. Called at the end of a plan.
+	void estimateSuccessorSeconds(void)
+	{
+		successorSeconds = timedSuccessorCalls ?
+			timedSuccessorSeconds * (double)successorCalls / (double)timedSuccessorCalls : 0.0;
+	}
+};
+
 // This class stores information about edges emanating from or incident to a node
+// The arrays are owned by the BumpArena of the hash table (see HashTableContainer::initLinks)
 template <class NodeType, class CostType, class PlannerSpecificVariables>
 class NodeLinks
 {
 public:
-	std::vector< SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* >* targets;
-	std::vector<CostType>* costs;
+	SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>** targets;
+	CostType* costs;
+	int count; // -1 if the links were not generated yet
 	
 	// -------------------
-	NodeLinks() { targets = NULL; costs = NULL; }
-	bool empty(void) { return (!targets); }
-	int size(void) { if (targets) return targets->size(); else return -1; }
-	void init(int count=0) { targets = new std::vector< SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* >(count); 
-						costs = new std::vector<CostType>(count); }
+	NodeLinks() { targets = NULL; costs = NULL; count = -1; }
+	bool empty(void) { return (count < 0); }
+	int size(void) { return (count); }
+	void init(int link_count, SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>** target_storage, 
+						CostType* cost_storage) { count = link_count; targets = target_storage; costs = cost_storage; }
 	
-	void push_back( SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* node_p , CostType cost )
-		{ targets->push_back(node_p) ; costs->push_back(cost); }
 	void set(int a, SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* node_p , CostType cost )
-		{ targets->operator[](a) = node_p ; costs->operator[](a) = cost; }
+		{ targets[a] = node_p ; costs[a] = cost; }
 	
 	SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* getLinkSearchGraphNode (int a) 
-		{ return (targets->operator[](a)); }
+		{ return (targets[a]); }
 	CostType getLinkCost (int a) 
-		{ return (costs->operator[](a)); }
-	
-	~NodeLinks() {  if(targets) delete targets;  if(costs) delete costs;  }
+		{ return (costs[a]); }
 };
 
 // Extension of NodeType for search problem
@@ -79,31 +165,82 @@ public:
 	// ---------------------------------------------------------------
 	// TODO for planner: Planner must set each of the following every time a "non-initiated" node is encountered.
 	bool initiated; // Used for tracking newly-create nodes by hash table. To be set to "true" by planner.
+	unsigned int searchGeneration; // Search that last touched the node (see HashTableContainer::refresh)
 	NodeLinks<NodeType,CostType,PlannerSpecificVariables> successors;
 	NodeLinks<NodeType,CostType,PlannerSpecificVariables> predecessors; // Planner may or may not use this
 	SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* came_from;
 	PlannerSpecificVariables plannerVars; // Other variables, if required by planner
 	CostType f; // f-value: Used for maintaining the heap
+	CostType f2; // Secondary key: breaks ties between equal f-values (d-ary heap only, e.g. D* Lite keys)
 	
 	// ---------------------------------------------------------------
 	// These variables are used by heap container
 	bool inHeap;
-	SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* prev;
-	SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* nxt;
+	int heapIndex; // Position in the heap array (or in the bucket, in bucket mode)
+	long heapKey; // Bucket the node was filed under (bucket mode only)
+	SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* prev; // Used by KeyedListHeapContainer only
+	SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* nxt; // Used by KeyedListHeapContainer only
 	
-	SearchGraphNode() { initiated=false; came_from=NULL; 
-								inHeap=false; prev=NULL; nxt=NULL; }
+	SearchGraphNode() { initiated=false; searchGeneration=0; came_from=NULL; f2=0;
+								inHeap=false; heapIndex=-1; heapKey=0; prev=NULL; nxt=NULL; }
 };
 
 // ---------------------------------------------------------------------
 
 
+// Open list used by the planners.
+// By default this is an array-backed d-ary min-heap on 'f' (ties broken on 'f2'). Every node remembers
+//   its position in the array (heapIndex), so 'remove' and 'update' are O(log n) instead of a list walk.
+// In HEAP_MODE_BUCKET it is a bucket queue indexed by the integer part of 'f' instead. That is only
+//   exact when all costs are integers (e.g. octile costs 10/14) and is fastest when the heuristic is
+//   consistent, so that the smallest non-empty bucket only moves forward.
+
+enum HeapContainerMode { HEAP_MODE_DARY, HEAP_MODE_BUCKET };
+
 template <class NodeType, class CostType, class PlannerSpecificVariables>
 class HeapContainer
 {
 public:
 	typedef  SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>*  heapItem_p;
 	
+	int mode;
+	int heap_size;
+	
+	// d-ary heap
+	int arity;
+	std::vector<heapItem_p> items;
+	void sift_up(int pos);
+	void sift_down(int pos);
+	bool less(heapItem_p a, heapItem_p b) { return ( a->f < b->f || (a->f == b->f && a->f2 < b->f2) ); }
+	
+	// Bucket queue
+	std::vector< std::vector<heapItem_p> > buckets;
+	long bucketBase; // f-value (key) of buckets[0]
+	int bucketCursor; // All buckets below this index are empty
+	long bucket_key(heapItem_p np) { return ( (long)(np->f) ); }
+	
+	HeapContainer(int heapMode=HEAP_MODE_DARY, int heapArity=4) { mode=heapMode; arity=heapArity; heap_size=0; 
+								bucketBase=0; bucketCursor=0; }
+	void push(heapItem_p np);
+	heapItem_p pop(void);
+	heapItem_p top(void); // The node 'pop' would return, left in the heap
+	void remove(heapItem_p np);
+	void update(heapItem_p np); // Call after np->f (or np->f2) has changed. np must be in the heap.
+	void clear(void);
+	bool empty(void) { return (heap_size==0); };
+	int size(void) { return (heap_size); };
+};
+
+// The original YAGSBPL open list: a sorted doubly linked list with a small index of key points.
+// 'push' and 'remove' degrade toward linear time on large open lists. Kept for comparison
+//   (see bench/yagsbpl_bench.cpp).
+
+template <class NodeType, class CostType, class PlannerSpecificVariables>
+class KeyedListHeapContainer
+{
+public:
+	typedef  SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>*  heapItem_p;
+	
 	int heap_size;
 	heapItem_p start;
 	heapItem_p end;
@@ -116,12 +253,13 @@ public:
 	void key_remove(heapItem_p item);
 	heapItem_p key_find(CostType f);
 	
-	HeapContainer(int kc=20) { heap_size=0; start=NULL; end=NULL; 
+	KeyedListHeapContainer(int kc=20) { heap_size=0; start=NULL; end=NULL; 
 								keyCount = kc; keyCountP1 = kc+1; keyPoints = new heapItem_p[kc]; keyVals = new CostType[kc]; }
-	~HeapContainer() { delete[] keyPoints; delete[] keyVals; }
+	~KeyedListHeapContainer() { delete[] keyPoints; delete[] keyVals; }
 	void push(heapItem_p np, heapItem_p searchStart=NULL);
 	heapItem_p pop(void);
 	void remove(heapItem_p np);
+	void update(heapItem_p np) { remove(np); push(np); }
 	void clear(void) { while (heap_size>0) pop(); };
 	bool empty(void) { return (heap_size==0); };
 	int size(void) { return (heap_size); };
@@ -227,21 +365,39 @@ template <class NodeType, class CostType, class PlannerSpecificVariables>
 class HashTableContainer
 {
 public:
+	typedef  SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>  GraphNode;
+	
 	GenericSearchGraphDescriptor<NodeType,CostType>* friendGraphDescriptor_p;
 	int hashTableSize;
-	std::vector< SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* >* HashTable;
+	std::vector< GraphNode* >* HashTable;
+	// Storage for the nodes and their links
+	BumpArena< GraphNode > nodeArena;
+	BumpArena< GraphNode* > linkTargetArena;
+	BumpArena< CostType > linkCostArena;
+	// Nodes stamped with an older generation count as not initiated. Starting a new search on the
+	//   same graph only needs to bump this, instead of walking the whole table.
+	unsigned int searchGeneration;
+	// Other nodes looked at in the bins by getNodeInHash, since the table was created
+	long collisions;
+	
+	HashTableContainer() { friendGraphDescriptor_p = NULL; hashTableSize = 0; HashTable = NULL; searchGeneration = 1; collisions = 0; }
 	void init_HastTable(int hash_table_size);
-	SearchGraphNode<NodeType,CostType,PlannerSpecificVariables>* getNodeInHash(NodeType n); // Returns pointer to already-existing
-	~HashTableContainer()
+	GraphNode* getNodeInHash(NodeType n); // Returns pointer to already-existing
+	void initLinks(NodeLinks<NodeType,CostType,PlannerSpecificVariables>& links, int count);
+	void newSearchGeneration(void);
+	// Must be called on every node pointer that was not obtained through getNodeInHash in the current
+	//   search (e.g. one read from the successor links), before its 'initiated' flag is looked at.
+	inline GraphNode* refresh(GraphNode* np)
 	{
-		if (HashTable)
+		if (np->searchGeneration != searchGeneration)
 		{
-			for (int a=0; a<hashTableSize; a++)
-				for (int b=0; b<HashTable[a].size(); b++)
-					delete HashTable[a][b];
-			delete[] HashTable;
+			np->initiated = false;
+			np->searchGeneration = searchGeneration;
 		}
-	};
+		return (np);
+	}
+	int nodeCount(void) { return (nodeArena.allocatedCount()); }
+	~HashTableContainer() { if (HashTable) delete[] HashTable; }; // The nodes belong to nodeArena
 };
 
 // =============================================================================
@@ -256,7 +412,11 @@ public:
 	HashTableContainer<NodeType,CostType,PlannerSpecificVariables>* hash;
 	HeapContainer<NodeType,CostType,PlannerSpecificVariables>* heap;
 	
-	void init( GenericSearchGraphDescriptor<NodeType,CostType> theEnv , int heapKeyNum=20 ); // A planner must call this explicitly.
+	GenericPlanner() { GraphDescriptor = NULL; hash = NULL; heap = NULL; }
+	void init( GenericSearchGraphDescriptor<NodeType,CostType> theEnv , int heapMode=HEAP_MODE_DARY ); // A planner must call this explicitly.
+	// Replaces the graph description (seeds, target, functions) but keeps the hash table and the
+	//   heap, so that a planner can be reused on the same graph. 'init' must have been called first.
+	void reinit( GenericSearchGraphDescriptor<NodeType,CostType> theEnv );
 	~GenericPlanner() { delete GraphDescriptor; delete hash; delete heap; }
 };
 
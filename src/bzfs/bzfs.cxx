@@ -231,6 +231,28 @@ static bool realPlayerWithNet(const PlayerId& id)
   return playerData && playerData->netHandler && playerData->player.isPlaying() && !playerData->isParting;
 }
 
+// robots added with MsgNewPlayer have no connection of their own: their
+// messages come over that of the player who added them, by robot index
+static std::map<int, int> robotOwner;
+
+static int getRobotOwner(int playerIndex)
+{
+  std::map<int, int>::const_iterator it = robotOwner.find(playerIndex);
+  if (it == robotOwner.end())
+    return InvalidPlayer;
+  return it->second;
+}
+
+// the connection a player's messages come over
+static NetHandler *getNetHandler(GameKeeper::Player *playerData)
+{
+  if (playerData->netHandler)
+    return playerData->netHandler;
+  GameKeeper::Player *ownerData
+    = GameKeeper::Player::getPlayerByIndex(getRobotOwner(playerData->getIndex()));
+  return ownerData ? ownerData->netHandler : NULL;
+}
+
 
 static int pwrite(GameKeeper::Player &playerData, const void *b, int l)
 {
@@ -249,6 +271,46 @@ char *getDirectMessageBuffer()
   return &sMsgBuf[2*sizeof(uint16_t)];
 }
 
+static int directMessage(GameKeeper::Player &playerData,
+			 uint16_t code, int len, const void *msg);
+
+// a robot added with MsgNewPlayer has no connection to hear on.  what its
+// player can act on goes over the player's connection, in a MsgRobotMessage:
+// the reject, and the messages to the robot alone.  the rest a robot gets
+// as a new player (MsgAccept, MsgSetVar, MsgTeamUpdate, MsgFlagUpdate,
+// MsgAddPlayer, MsgNewRabbit, MsgTimeUpdate, MsgGameTime) is on its
+// player's connection already, and the replies to requests (MsgGetWorld,
+// MsgQueryGame, MsgNegotiateFlags, MsgLagPing...) are for requests a robot
+// never makes: those messages all come as the player's own
+static int relayRobotMessage(GameKeeper::Player &robotData,
+			     uint16_t code, int len, const void *msg)
+{
+  if (code == MsgMessage) {
+    // team, admin and broadcast messages reach the player on its own
+    uint8_t dst;
+    nboUnpackUByte((char *)msg + PlayerIdPLen, dst);
+    if (dst != robotData.getIndex())
+      return len;
+  } else if (code != MsgReject) {
+    return len;
+  }
+
+  GameKeeper::Player *ownerData
+    = GameKeeper::Player::getPlayerByIndex(getRobotOwner(robotData.getIndex()));
+  if (!ownerData || !ownerData->netHandler
+      || len + PlayerIdPLen + (int)sizeof(uint16_t) > MaxPacketLen - 4)
+    return len;
+
+  char relay[MaxPacketLen];
+  void *bufStart = relay + 2*sizeof(uint16_t);
+  void *buf = nboPackUByte(bufStart, robotData.getIndex());
+  buf = nboPackUShort(buf, code);
+  memcpy(buf, msg, len);
+  buf = (char *)buf + len;
+  return directMessage(*ownerData, MsgRobotMessage,
+		       (char*)buf - (char*)bufStart, bufStart);
+}
+
 // FIXME? 4 bytes before msg must be valid memory, will get filled in with len+code
 // usually, the caller gets a buffer via getDirectMessageBuffer(), but for example
 // for MsgShotBegin the receiving buffer gets used directly
@@ -257,6 +319,8 @@ static int directMessage(GameKeeper::Player &playerData,
 {
   if (playerData.isParting)
     return -1;
+  if (!playerData.netHandler && getRobotOwner(playerData.getIndex()) != InvalidPlayer)
+    return relayRobotMessage(playerData, code, len, msg);
   // send message to one player
   void *bufStart = (char *)msg - 2*sizeof(uint16_t);
 
@@ -549,8 +613,9 @@ void sendIPUpdate(int targetPlayer, int playerIndex) {
   // playerIndex = -1: send info about all players
 
   GameKeeper::Player *playerData = GameKeeper::Player::getPlayerByIndex(playerIndex);
+  // robots on another player's connection have no address of their own
   if (playerIndex >= 0) {
-    if (!playerData || !playerData->player.isPlaying())
+    if (!playerData || !playerData->player.isPlaying() || !playerData->netHandler)
       return;
   }
 
@@ -579,7 +644,7 @@ void sendIPUpdate(int targetPlayer, int playerIndex) {
       playerData = GameKeeper::Player::getPlayerByIndex(i);
       if (!playerData)
 	continue;
-      if (playerData->player.isPlaying()) {
+      if (playerData->player.isPlaying() && playerData->netHandler) {
 	buf = playerData->packAdminInfo(buf);
 	++c;
       }
@@ -1804,8 +1869,9 @@ static void addPlayer(int playerIndex, GameKeeper::Player *playerData)
   const bool playerIsAntiBanned =
     playerData->accessInfo.hasPerm(PlayerAccessInfo::antiban);
 
-  // check against the ip ban list
-  in_addr playerIP = playerData->netHandler->getIPAddress();
+  // check against the ip ban list (a robot's is its owner's)
+  NetHandler *handler = getNetHandler(playerData);
+  in_addr playerIP = handler->getIPAddress();
   BanInfo info(playerIP);
   if (!playerIsAntiBanned && !clOptions->acl.validate(playerIP,&info)) {
     std::string rejectionMessage;
@@ -1865,7 +1931,7 @@ static void addPlayer(int playerIndex, GameKeeper::Player *playerData)
   // see if any watchers don't want this guy
   bz_AllowPlayerEventData_V1 allowData;
   allowData.callsign = playerData->player.getCallSign();
-  allowData.ipAddress = playerData->netHandler->getTargetIP();
+  allowData.ipAddress = handler->getTargetIP();
   allowData.playerID = playerIndex;
 
   worldEventManager.callEvents(bz_eAllowPlayer,&allowData);
@@ -1939,6 +2005,7 @@ static void addPlayer(int playerIndex, GameKeeper::Player *playerData)
   // accept player
   void *buf, *bufStart = getDirectMessageBuffer();
   buf = nboPackUByte(bufStart, playerIndex);
+  buf = nboPackUByte(buf, AcceptNewPlayer);
   int result = directMessage(*playerData, MsgAccept,
 			     (char*)buf-(char*)bufStart, bufStart);
   if (result == -1)
@@ -2143,6 +2210,52 @@ static void addPlayer(int playerIndex, GameKeeper::Player *playerData)
   playerData->player.setCompletelyAdded();
 }
 
+// a player adding a robot, which plays over the player's connection
+static void addRobot(int ownerIndex, uint8_t robot, void *buf)
+{
+  GameKeeper::Player *ownerData
+    = GameKeeper::Player::getPlayerByIndex(ownerIndex);
+  if (!ownerData)
+    return;
+
+  PlayerId robotIndex = 0xff;
+  if (!BZDB.isTrue(StateDatabase::BZDB_DISABLEBOTS))
+    robotIndex = getNewPlayerID();
+
+  // the owner learns the robot's id before anybody hears of the robot
+  void *reply, *replyStart = getDirectMessageBuffer();
+  reply = nboPackUByte(replyStart, robot);
+  reply = nboPackUByte(reply, robotIndex);
+  if (directMessage(*ownerData, MsgNewPlayer,
+		    (char*)reply-(char*)replyStart, replyStart) == -1
+      || robotIndex == 0xff)
+    return;
+
+  GameKeeper::Player *robotData
+    = new GameKeeper::Player(robotIndex, (bz_ServerSidePlayerHandler*)NULL);
+  robotOwner[robotIndex] = ownerIndex;
+
+  uint16_t rejectCode;
+  char     rejectMsg[MessageLen];
+  if (!robotData->player.unpackEnter(buf, rejectCode, rejectMsg)) {
+    rejectPlayer(robotIndex, rejectCode, rejectMsg);
+    return;
+  }
+  if (!robotData->player.isBot()) {
+    rejectPlayer(robotIndex, RejectBadType,
+		 "Communication error joining game [Rejected].");
+    return;
+  }
+  robotData->accessInfo.setName(robotData->player.getCallSign());
+  logDebugMessage(1,"Player %s [%d] has joined as a robot of %s [%d]\n",
+	 robotData->player.getCallSign(), robotIndex,
+	 ownerData->player.getCallSign(), ownerIndex);
+
+  // robots do not authenticate
+  robotData->_LSAState = GameKeeper::Player::done;
+  addPlayer(robotIndex, robotData);
+}
+
 
 void resetFlag(FlagInfo &flag)
 {
@@ -2379,6 +2492,15 @@ void removePlayer(int playerIndex, const char *reason, bool notify)
 
   playerData->isParting = true;
 
+  // the player's robots go with its connection
+  std::vector<int> robots;
+  std::map<int, int>::const_iterator it;
+  for (it = robotOwner.begin(); it != robotOwner.end(); ++it)
+    if (it->second == playerIndex)
+      robots.push_back(it->first);
+  for (unsigned int i = 0; i < robots.size(); i++)
+    removePlayer(robots[i], reason, notify);
+
   // call any on part events
   bz_PlayerJoinPartEventData_V1 partEventData;
   partEventData.eventType = bz_ePlayerPartEvent;
@@ -2390,7 +2512,7 @@ void removePlayer(int playerIndex, const char *reason, bool notify)
   if ((playerData->player.getTeam() != NoTeam) && strlen(playerData->player.getCallSign()))
     worldEventManager.callEvents(bz_ePlayerPartEvent,&partEventData);
 
-  if (notify) {
+  if (notify && playerData->netHandler) {
     // send a super kill to be polite
     // send message to one player
     // do not use directMessage as he can remove player
@@ -2413,7 +2535,8 @@ void removePlayer(int playerIndex, const char *reason, bool notify)
 	 playerData->player.getCallSign(),
 	 playerIndex, timeStamp.c_str(), reason);
   bool wasPlaying = playerData->player.isPlaying();
-  playerData->netHandler->closing();
+  if (playerData->netHandler)
+    playerData->netHandler->closing();
 
   zapFlagByPlayer(playerIndex);
 
@@ -2467,6 +2590,17 @@ void removePlayer(int playerIndex, const char *reason, bool notify)
     sendTeamUpdate(-1, teamNum);
   }
 
+  const int owner = getRobotOwner(playerIndex);
+  if (owner != InvalidPlayer) {
+    // the player who added a robot that never played still has to know
+    if (!wasPlaying) {
+      void *buf, *bufStart = getDirectMessageBuffer();
+      buf = nboPackUByte(bufStart, playerIndex);
+      directMessage(owner, MsgRemovePlayer, (char*)buf-(char*)bufStart, bufStart);
+    }
+    robotOwner.erase(playerIndex);
+  }
+
   playerData->close();
 
   if (wasPlaying) {
@@ -3875,7 +4009,7 @@ static void handleCommand(int t, const void *rawbuf, bool udp)
   GameKeeper::Player *playerData = GameKeeper::Player::getPlayerByIndex(t);
   if (!playerData)
     return;
-  NetHandler *handler = playerData->netHandler;
+  NetHandler *handler = getNetHandler(playerData);
 
   uint16_t len, code;
   void *buf = (char *)rawbuf;
@@ -3979,6 +4113,15 @@ static void handleCommand(int t, const void *rawbuf, bool udp)
       removePlayer(t, "left", false);
       break;
 
+    // player adding a robot
+    case MsgNewPlayer: {
+      // data: the player's number for the robot, then as MsgEnter
+      uint8_t robot;
+      buf = nboUnpackUByte(buf, robot);
+      addRobot(t, robot, buf);
+      break;
+    }
+
     case MsgNegotiateFlags: {
       void *bufStart;
       FlagTypeMap::iterator it;
@@ -4127,9 +4270,9 @@ static void handleCommand(int t, const void *rawbuf, bool udp)
 	  playerData = GameKeeper::Player::getPlayerByIndex(id);
       if (invalidPlayerAction(playerData->player, id, "grab a flag"))
 		  break;
-	  // sender should be grabber unless grabber is a bot
-	  // should also check if sender and bot are related
-	  if (id != t && !playerData->player.isBot()) break;
+	  // sender should be grabber (a robot's message is already the
+	  // robot's, see getMessagePlayer())
+	  if (id != t) break;
       // Sanity check
 	  if (flag < numFlags) {
 		  grabFlag(id, *FlagInfo::get(flag));
@@ -4146,9 +4289,8 @@ static void handleCommand(int t, const void *rawbuf, bool udp)
       buf = nboUnpackVector(buf, pos);
 	  buf = nboUnpackUByte(buf, id);
 	  playerData = GameKeeper::Player::getPlayerByIndex(id);
-	  // sender should be dropper unless dropper is a bot
-	  // should also check if sender and bot are related
-	  if (id != t && !playerData->player.isBot()) break;
+	  // sender should be dropper
+	  if (id != t) break;
       dropPlayerFlag(*playerData, pos);
       break;
     }
@@ -4165,9 +4307,8 @@ static void handleCommand(int t, const void *rawbuf, bool udp)
 	  if (invalidPlayerAction(playerData->player, id, "capture a flag"))
 		  break;
 	  playerData = GameKeeper::Player::getPlayerByIndex(id);
-	  // sender should be capturer unless capturer is a bot
-	  // should also check if sender and bot are related
-	  if (id != t && !playerData->player.isBot()) break;
+	  // sender should be capturer
+	  if (id != t) break;
       captureFlag(id, TeamColor(_team));
       break;
     }
@@ -4726,6 +4867,68 @@ static void handleCommand(int t, const void *rawbuf, bool udp)
   }
 }
 
+// the player a message is for: the sender, or one of the robots it added
+// with MsgNewPlayer.  most messages carry the player's id already, the
+// others get a robot's id appended
+static int getMessagePlayer(int sender, const void *rawbuf)
+{
+  uint16_t len, code;
+  void *buf = (char *)rawbuf;
+  buf = nboUnpackUShort(buf, len);
+  buf = nboUnpackUShort(buf, code);
+
+  int offset;
+  switch (code) {
+  case MsgShotBegin:
+  case MsgTransferFlag:
+    offset = 0;
+    break;
+  case MsgPlayerUpdate:
+  case MsgPlayerUpdateSmall:
+    offset = sizeof(float);
+    break;
+  case MsgGrabFlag:
+  case MsgCaptureFlag:
+    offset = sizeof(uint16_t);
+    break;
+  case MsgDropFlag:
+    offset = 3 * sizeof(float);
+    break;
+  // these have the robot's id appended
+  case MsgExit:
+  case MsgAlive:
+    offset = 0;
+    break;
+  case MsgTeleport:
+    offset = 2 * sizeof(uint16_t);
+    break;
+  case MsgShotEnd:
+    offset = PlayerIdPLen + sizeof(int16_t) + sizeof(uint16_t);
+    break;
+  case MsgKilled: {
+    // the reason decides where the id is: it must be there to be read
+    if (len < PlayerIdPLen + sizeof(int16_t))
+      return sender;
+    int16_t reason;
+    nboUnpackShort((char *)buf + PlayerIdPLen, reason);
+    offset = PlayerIdPLen + 2 * sizeof(int16_t) + FlagPackSize;
+    if (reason == PhysicsDriverDeath)
+      offset += sizeof(int32_t);
+    break;
+  }
+  default:
+    return sender;
+  }
+  if (len <= offset)
+    return sender;
+
+  uint8_t id;
+  nboUnpackUByte((char *)buf + offset, id);
+  if (id == sender || getRobotOwner(id) != sender)
+    return sender;
+  return id;
+}
+
 static void handleTcp(NetHandler &netPlayer, int i, const RxStatus e)
 {
   if (e != ReadAll) {
@@ -4749,36 +4952,9 @@ static void handleTcp(NetHandler &netPlayer, int i, const RxStatus e)
   buf = nboUnpackUShort(buf, len);
   buf = nboUnpackUShort(buf, code);
 
-  // trying to get the real player from the message: bots share tcp
-  // connection with the player
-  PlayerId t = i;
-  switch (code) {
-  case MsgShotBegin: {
-    nboUnpackUByte(buf, t);
-    break;
-  }
-  case MsgPlayerUpdate:
-  case MsgPlayerUpdateSmall: {
-    float timestamp;
-    buf = nboUnpackFloat(buf, timestamp);
-    buf = nboUnpackUByte(buf, t);
-    break;
-  }
-  default:
-    break;
-  }
-  // Make sure is a bot
-  GameKeeper::Player *playerData;
-  if (t != i) {
-    playerData = GameKeeper::Player::getPlayerByIndex(t);
-    if (!playerData || !playerData->player.isBot()) {
-      t = i;
-      playerData = GameKeeper::Player::getPlayerByIndex(t);
-    }
-    // Should check also if bot and player are related
-  } else {
-    playerData = GameKeeper::Player::getPlayerByIndex(t);
-  }
+  // the message may be for one of the player's robots
+  int t = getMessagePlayer(i, netPlayer.getTcpBuffer());
+  GameKeeper::Player *playerData = GameKeeper::Player::getPlayerByIndex(t);
 
   // simple ruleset, if player sends a MsgShotBegin over TCP he/she
   // must not be using the UDP link
@@ -4953,10 +5129,12 @@ static void doStuffOnPlayer(GameKeeper::Player &playerData)
     }
   }
 
-  // send lag pings
+  // send lag pings (not to robots without a connection, who cannot reply)
   bool warn;
   bool kick;
-  int nextPingSeqno = playerData.lagInfo.getNextPingSeqno(warn, kick);
+  int nextPingSeqno = 0;
+  if (playerData.netHandler)
+    nextPingSeqno = playerData.lagInfo.getNextPingSeqno(warn, kick);
   if (nextPingSeqno > 0) {
     void *buf, *bufStart = getDirectMessageBuffer();
     buf = nboPackUShort(bufStart, nextPingSeqno);
@@ -5006,7 +5184,9 @@ void rescanForBans ( bool isOperator, const char* callsign, int playerID )
 	for (int i = 0; i < curMaxPlayers; i++)
 	{
 		GameKeeper::Player *otherPlayer = GameKeeper::Player::getPlayerByIndex(i);
-		if (otherPlayer && !clOptions->acl.validate(otherPlayer->netHandler->getIPAddress()))
+		// robots without a connection go with their owner
+		if (otherPlayer && otherPlayer->netHandler
+		    && !clOptions->acl.validate(otherPlayer->netHandler->getIPAddress()))
 		{
 			// operators can override antiperms
 			if (!isOperator)
@@ -6369,8 +6549,8 @@ int main(int argc, char **argv)
 	      // send client the message that we are ready for him
 	      sendUDPupdate(id);
 
-	    // handle the command for UDP
-	    handleCommand(id, ubuf, true);
+	    // handle the command for UDP, maybe for one of the player's robots
+	    handleCommand(getMessagePlayer(id, ubuf), ubuf, true);
 
 	    // don't spend more than 250ms receiving udp
 	    if (TimeKeeper::getCurrent() - receiveTime > 0.25f) {
@@ -1063,7 +1063,9 @@ BZF_API bz_BasePlayerRecord * bz_getPlayerByIndex ( int index )
   playerRecord->verified = player->accessInfo.isVerified();
   playerRecord->globalUser = player->authentication.isGlobal();
 
-  playerRecord->ipAddress = player->netHandler->getTargetIP();
+  // robots may play over another player's connection
+  if (player->netHandler)
+    playerRecord->ipAddress = player->netHandler->getTargetIP();
 
   playerRecord->lag = player->lagInfo.getLag();
   playerRecord->update();
@@ -1158,7 +1160,7 @@ BZF_API const char* bz_getPlayerIPAddress( int playerID )
 {
   GameKeeper::Player *player = GameKeeper::Player::getPlayerByIndex(playerID);
 
-  if (!player)
+  if (!player || !player->netHandler)
     return NULL;
 
   return player->netHandler->getTargetIP();
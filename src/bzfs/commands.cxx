@@ -1889,11 +1889,14 @@ bool PlayerListCommand::operator() (const char	 *,
     for (int i = 0; i < curMaxPlayers; i++) {
       otherData = GameKeeper::Player::getPlayerByIndex(i);
       if (otherData && otherData->player.isPlaying()) {
+	// robots may play over another player's connection
+	const std::string hostInfo = otherData->netHandler
+	  ? otherData->netHandler->getPlayerHostInfo() : std::string("robot");
 	if (playerData->accessInfo.hasPerm(PlayerAccessInfo::playerList))
 	  snprintf(reply, MessageLen, "[%d]%-16s: %s",
 	    otherData->getIndex(),
 	    otherData->player.getCallSign(),
-	    otherData->netHandler->getPlayerHostInfo().c_str());
+	    hostInfo.c_str());
 	sendMessage(ServerPlayer, t, reply);
       }
     }
@@ -2876,7 +2879,9 @@ bool PollCommand::operator() (const char	 *message,
 	sendMessage(ServerPlayer, t, reply);
 	return true;
       }
-      targetIP = targetData->netHandler->getTargetIP();
+      // robots on another player's connection have no address
+      if (targetData->netHandler)
+	targetIP = targetData->netHandler->getTargetIP();
 
       // operators can override antiperms
       if (!playerData->accessInfo.isOperator()) {